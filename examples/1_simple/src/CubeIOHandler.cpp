@@ -50,14 +50,18 @@ CubeIOHandler::~CubeIOHandler( )
 void
 CubeIOHandler::showWorld( const double )
 {
-  const std::deque< std::unique_ptr< RotatingCube > > &cubes = cubeWorld_.getCubes( );
+  //
+  // rotation counts are discrete so the newest
+  // published state is printed without blending
+  //
+  const CubeStates &cubes = cubeWorld_.getSnapshots( ).latest( ).current;
 
   std::cout << "\r(Cube id, rotations) : ";
 
-  for ( auto &upCube : cubes )
+  for ( const CubeState &cube : cubes )
   {
-    std::cout << "(" << upCube->id( ) << ",";
-    std::cout << upCube->getRotations( ) << ") ; " << std::flush;
+    std::cout << "(" << cube.id << ",";
+    std::cout << cube.rotations << ") ; " << std::flush;
   }
 } // CubeIOHandler::showWorld
 
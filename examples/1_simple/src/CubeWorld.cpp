@@ -1,6 +1,7 @@
 #include "CubeWorld.hpp"
 
 #include "RotatingCube.hpp"
+#include "shared/core/JobSystem.hpp"
 
 #include <glm/gtc/constants.hpp>
 
@@ -22,8 +23,11 @@ std::uniform_real_distribution< float > realDist( 0.0, 1.0 );
 /////////////////////////////////////////////
 CubeWorld::CubeWorld( )
   : shs::World( )
-  , currentId_( 0 )
-  , cubes_( )
+  , currentId_      ( 0 )
+  , cubes_          ( )
+  , creationOrder_  ( )
+  , publishedStates_( )
+  , snapshots_      ( )
 {}
 
 
@@ -38,14 +42,43 @@ CubeWorld::~CubeWorld( ) {}
 /////////////////////////////////////////////
 void
 CubeWorld::update(
-                  const double worldTime, ///< update to this time
-                  const double timestep   ///< interval since last update
+                  const double,         ///< update to this time
+                  const double timestep ///< interval since last update
                   )
 {
-  for ( auto &upCube : cubes_ )
+  getJobSystem( ).parallelForRange(
+                                   0,
+                                   cubes_.size( ),
+                                   [ this, timestep ]( const std::size_t begin, const std::size_t end )
   {
-    upCube->update( worldTime, timestep );
+    rotateCubes( cubes_, begin, end, timestep );
+  } );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief CubeWorld::publishState
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+CubeWorld::publishState( )
+{
+  const CubeStore &cubes = cubes_;
+
+  const shs::ArrayView< const unsigned > ids       = cubes.getArray< ID >( );
+  const shs::ArrayView< const unsigned > rotations = cubes.getArray< ROTATIONS >( );
+
+  publishedStates_.resize( cubes.size( ) );
+
+  for ( std::size_t i = 0; i < publishedStates_.size( ); ++i )
+  {
+    publishedStates_[ i ].id        = ids[ i ];
+    publishedStates_[ i ].rotations = rotations[ i ];
   }
+
+  snapshots_.publish( publishedStates_ );
 }
 
 
@@ -60,11 +93,13 @@ CubeWorld::addRandomCube( )
                                                     realDist( randGen )
                                                     ) - 0.5f );
 
-  cubes_.push_back( std::unique_ptr< RotatingCube >( new RotatingCube(
-                                                                      axis,
-                                                                      realDist( randGen ) * scale,
-                                                                      currentId_++
-                                                                      ) ) );
+  creationOrder_.push_back( cubes_.create(
+                                          axis,
+                                          realDist( randGen ) * scale,
+                                          currentId_++,
+                                          0.0f,
+                                          0
+                                          ) );
 }
 
 
@@ -72,7 +107,11 @@ CubeWorld::addRandomCube( )
 void
 CubeWorld::removeOldestCube( )
 {
-  cubes_.pop_front( );
+  if ( !creationOrder_.empty( ) )
+  {
+    cubes_.destroy( creationOrder_.front( ) );
+    creationOrder_.pop_front( );
+  }
 }
 
 
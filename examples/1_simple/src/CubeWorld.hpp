@@ -2,16 +2,26 @@
 #pragma once
 
 #include "shared/core/World.hpp"
-#include <memory>
+#include "shared/core/SnapshotBuffer.hpp"
+#include "RotatingCube.hpp"
 #include <deque>
+#include <vector>
 
 
 namespace simple
 {
 
-class RotatingCube;
 
-typedef std::deque< std::unique_ptr< RotatingCube > > CubeVec;
+///
+/// \brief What the IO handler prints for each cube
+///
+struct CubeState
+{
+  unsigned id;
+  unsigned rotations;
+};
+
+typedef std::vector< CubeState > CubeStates;
 
 
 /////////////////////////////////////////////
@@ -47,22 +57,38 @@ public:
                ) final;
 
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief publishState
+  ///
+  ///        Copies every cube's id and rotation count into the
+  ///        snapshot read by the IO handler.
+  ///
+  ///////////////////////////////////////////////////////////////
+  virtual
+  void publishState ( ) final;
+
+
   void addRandomCube ( );
 
   void removeOldestCube ( );
 
   ///////////////////////////////////////////////////////////////
-  /// \brief getCube
-  /// \return
+  /// \brief getSnapshots
+  /// \return cube states published by the update thread,
+  ///         for the IO thread only
   ///////////////////////////////////////////////////////////////
-  const CubeVec&
-  getCubes( ) const { return cubes_; }
+  shs::SnapshotBuffer< CubeStates >&
+  getSnapshots( ) { return snapshots_; }
 
 
 private:
 
   unsigned currentId_;
-  CubeVec cubes_;
+  CubeStore cubes_;
+  std::deque< CubeHandle > creationOrder_; ///< oldest cube first
+
+  CubeStates publishedStates_;             ///< update thread only
+  shs::SnapshotBuffer< CubeStates > snapshots_;
 
 };
 
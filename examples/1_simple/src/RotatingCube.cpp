@@ -2,56 +2,42 @@
 
 #include "RotatingCube.hpp"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include "glm/gtx/transform.hpp"
+#include <glm/gtc/constants.hpp>
 
 
 namespace simple
 {
 
-///////////////////////////////////////////////////////////////
-/// \brief RotatingCube
-///////////////////////////////////////////////////////////////
-RotatingCube::RotatingCube(
-                           const glm::vec3 axis,
-                           const float     rotateRate,
-                           const unsigned  id
-                           )
-  : axis_                ( axis )
-  , rotateRate_          ( rotateRate )
-  , id_                  ( id )
-  , angle_               ( 0.0f )
-  , rotations_           ( 0 )
-{}
-
-
-
-///////////////////////////////////////////////////////////////
-/// \brief ~RotatingCube
-///////////////////////////////////////////////////////////////
-RotatingCube::~RotatingCube( )
-{}
-
 
 ///////////////////////////////////////////////////////////////
-/// \brief update
+/// \brief rotateCubes
 ///////////////////////////////////////////////////////////////
 void
-RotatingCube::update (
-                      const double,           ///< update to this time
-                      const double timestep   ///< interval since last update
-                      )
+rotateCubes(
+            CubeStore        &cubes,
+            const std::size_t begin,
+            const std::size_t end,
+            const double      timestep
+            )
 {
   constexpr float twoPi = glm::pi< float >() * 2.0f;
-  const float rotateAmount = rotateRate_ * static_cast< float >( timestep );
-  angle_ += rotateAmount;
+  const float dt        = static_cast< float >( timestep );
+
+  const float *pRotateRates = cubes.getArray< ROTATE_RATE >( ).data( );
+  float *pAngles            = cubes.getArray< ANGLE >( ).data( );
+  unsigned *pRotations      = cubes.getArray< ROTATIONS >( ).data( );
 
-  while ( angle_ > twoPi )
+  for ( std::size_t i = begin; i < end; ++i )
   {
-    angle_ -= twoPi;
-    ++rotations_;
+    pAngles[ i ] += pRotateRates[ i ] * dt;
+
+    while ( pAngles[ i ] > twoPi )
+    {
+      pAngles[ i ] -= twoPi;
+      ++pRotations[ i ];
+    }
   }
 }
 
-} // end namespace simple
 
+} // end namespace simple
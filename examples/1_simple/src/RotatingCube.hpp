@@ -1,66 +1,60 @@
 // RotatingCube.hpp
 #pragma once
 
+#include "shared/core/ComponentStore.hpp"
 
-#include "glm/glm.hpp"
+#include <glm/glm.hpp>
+#include <cstddef>
 
 
 namespace simple
 {
 
 
-/////////////////////////////////////////////
-/// \brief The RotatingCube class
 ///
-/// \author Logan Barnes
-/////////////////////////////////////////////
-class RotatingCube
-{
-
-public:
-
-  ///////////////////////////////////////////////////////////////
-  /// \brief RotatingCube
-  ///////////////////////////////////////////////////////////////
-  RotatingCube(
-               const glm::vec3 axis,
-               const float     rotateRate,
-               const unsigned  id
-               );
-
-
-  ///////////////////////////////////////////////////////////////
-  /// \brief ~RotatingCube
-  ///////////////////////////////////////////////////////////////
-  ~RotatingCube( );
-
-
-  ///////////////////////////////////////////////////////////////
-  /// \brief update
-  ///////////////////////////////////////////////////////////////
-  void update (
-               const double worldTime, ///< update to this time
-               const double timestep   ///< interval since last update
-               );
-
-  unsigned
-  getRotations( ) const { return rotations_; }
+/// \brief Tag type for rotating cube handles
+///
+struct RotatingCube;
 
-  unsigned
-  id( ) const { return id_; }
 
+///
+/// \brief Component indices into CubeStore
+///
+enum CubeComponent
+{
+  AXIS,
+  ROTATE_RATE,
+  ID,
+  ANGLE,
+  ROTATIONS
+};
 
-private:
 
-  const glm::vec3 axis_;
-  const float rotateRate_;
-  const unsigned id_;
+typedef shs::ComponentStore<
+    RotatingCube,
+    glm::vec3, // AXIS
+    float,     // ROTATE_RATE
+    unsigned,  // ID
+    float,     // ANGLE
+    unsigned   // ROTATIONS
+    > CubeStore;
 
-  float angle_;
-  unsigned rotations_;
+typedef CubeStore::HandleType CubeHandle;
 
 
-};
+///////////////////////////////////////////////////////////////
+/// \brief rotateCubes
+///
+///        Advances the cubes at dense indices [begin, end)
+///        by one timestep.
+///
+///////////////////////////////////////////////////////////////
+void rotateCubes (
+                  CubeStore        &cubes,
+                  const std::size_t begin,
+                  const std::size_t end,
+                  const double      timestep
+                  );
 
 
 } // end namespace simple
@@ -72,6 +72,14 @@ CubeCallback::handleKey(
       handler_.removeOldestCube( );
       break;
 
+    case GLFW_KEY_C:
+      handler_.toggleCapture( );
+      break;
+
+    case GLFW_KEY_T:
+      handler_.writeTrace( );
+      break;
+
     default:
       break;
     } // switch
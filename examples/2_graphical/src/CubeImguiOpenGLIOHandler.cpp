@@ -7,8 +7,16 @@
 #include "CubeCallback.hpp"
 
 // shared
+#include "shared/core/Trace.hpp"
 #include "shared/graphics/ImguiCallback.hpp"
+#include "shared/graphics/FrameCapture.hpp"
+#include "shared/graphics/GpuProfiler.hpp"
 #include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
+#include "shared/graphics/PendingProgram.hpp"
+#include "shared/graphics/ProgramCache.hpp"
+#include "shared/graphics/ShaderReloader.hpp"
+#include "shared/graphics/StreamingBuffer.hpp"
 #include "shared/graphics/GlmCamera.hpp"
 #include <imgui.h>
 #include <imgui_impl_glfw_gl3.h>
@@ -39,11 +47,31 @@ CubeImguiOpenGLIOHandler::CubeImguiOpenGLIOHandler( CubeWorld &cubeWorld )
   std::unique_ptr< CubeCallback > cubeCallback( new CubeCallback( *this ) );
   imguiCallback_->setCallback( std::move( cubeCallback ) );
 
-  glIds_.program =
-    shg::OpenGLHelper::createProgram(
-                                     SHADER_PATH + "simple/shader.vert",
-                                     SHADER_PATH + "simple/shader.frag"
-                                     );
+  shg::OpenGLHelper::setProgramCache( std::make_shared< shg::ProgramCache >( OUTPUT_PATH ) );
+
+  setProfiling( shg::GpuProfiler::isSupported( ) );
+
+#ifdef USE_TRACING
+  // written at exit
+  shs::Tracer::get( ).setOutputFile( OUTPUT_PATH + "trace.json" );
+#endif
+
+  const std::vector< std::string > shaders =
+  {
+    SHADER_PATH + "instanced/shader.vert",
+    SHADER_PATH + "simple/shader.frag"
+  };
+
+  // frames show a loading message until the program is ready
+  upPendingProgram_.reset( new shg::PendingProgram( shg::OpenGLHelper::createProgramAsync( shaders ) ) );
+
+  upShaderReloader_.reset( new shg::ShaderReloader( ) );
+  upShaderReloader_->watch(
+                           shaders,
+                           [ this ] ( const std::shared_ptr< GLuint > &spProgram )
+    {
+      _setProgram( spProgram );
+    } );
 
   std::vector< float > vbo =
   {
@@ -57,11 +85,6 @@ CubeImguiOpenGLIOHandler::CubeImguiOpenGLIOHandler( CubeWorld &cubeWorld )
     -1, -1,  1  // 8
   };
 
-  std::vector< shg::VAOElement > vao =
-  {
-    { "inPosition", 3, GL_FLOAT, nullptr }
-  };
-
   std::vector< unsigned short > ibo
   {
     3, 2, 6, 7, 4,
@@ -75,14 +98,6 @@ CubeImguiOpenGLIOHandler::CubeImguiOpenGLIOHandler( CubeWorld &cubeWorld )
                                                vbo.size( )
                                                );
 
-  glIds_.vao = shg::OpenGLHelper::createVao(
-                                            glIds_.program,
-                                            glIds_.vbo,
-                                            0,
-                                            vao
-                                            );
-
-
   glIds_.ibo = shg::OpenGLHelper::createBuffer(
                                                ibo.data( ),
                                                ibo.size( ),
@@ -104,7 +119,7 @@ CubeImguiOpenGLIOHandler::~CubeImguiOpenGLIOHandler( )
 void
 CubeImguiOpenGLIOHandler::addRandomCube( )
 {
-  cubeWorld_.addRandomCube( );
+  cubeWorld_.requestAddCube( );
 }
 
 
@@ -112,50 +127,103 @@ CubeImguiOpenGLIOHandler::addRandomCube( )
 void
 CubeImguiOpenGLIOHandler::removeOldestCube( )
 {
-  cubeWorld_.removeOldestCube( );
+  cubeWorld_.requestRemoveCube( );
+}
+
+
+
+void
+CubeImguiOpenGLIOHandler::toggleCapture( )
+{
+  if ( isCapturing( ) )
+  {
+    stopCapture( );
+  }
+  else
+  {
+    startCapture( OUTPUT_PATH + "capture.y4m" );
+  }
+}
+
+
+
+void
+CubeImguiOpenGLIOHandler::writeTrace( )
+{
+  shs::Tracer::get( ).writeChromeTrace( OUTPUT_PATH + "trace.json" );
 }
 
 
 
 void
-CubeImguiOpenGLIOHandler::_onRender( const double )
+CubeImguiOpenGLIOHandler::_onRender( const double alpha )
 {
   glm::vec3 color( 1.0f, 0.0f, 0.0 );
 
   shg::OpenGLHelper::clearFramebuffer( );
+
+  upShaderReloader_->update( );
+
+  if ( !_finishPipeline( ) )
+  {
+    return;
+  }
+
   glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 
-  glUseProgram( *glIds_.program );
+  shg::OpenGLHelper::useProgram( glIds_.program );
 
   const glm::mat4 projectionView = upCamera_->getPerspectiveProjectionViewMatrix( );
 
-  const CubeVec &cubes          = cubeWorld_.getCubes( );
-  glm::mat4 projectionViewModel = glm::mat4( );
-
-  for ( auto &upCube : cubes )
-  {
-    projectionViewModel = projectionView * upCube->getTransformationMatrix( );
-
-    shg::OpenGLHelper::setMatrixUniform(
-                                        glIds_.program,
-                                        "projectionViewModel",
-                                        glm::value_ptr( projectionViewModel )
-                                        );
-
-    shg::OpenGLHelper::setFloatUniform(
-                                       glIds_.program,
-                                       "color",
-                                       glm::value_ptr( color ),
-                                       3
-                                       );
-
-    shg::OpenGLHelper::renderBuffer(
-                                    glIds_.vao,
-                                    0,
-                                    15,
-                                    GL_TRIANGLE_STRIP,
-                                    glIds_.ibo
-                                    );
+  shg::OpenGLHelper::setMatrixUniform( projectionViewUniform_, glm::value_ptr( projectionView ) );
+  shg::OpenGLHelper::setFloatUniform ( colorUniform_, glm::value_ptr( color ), 3 );
+
+  //
+  // only the published snapshot is read here since the world
+  // may be mid-update on another thread. transforms are packed
+  // contiguously so every cube goes up in one upload and is
+  // drawn with one call
+  //
+  const CubeStates cubes = cubeWorld_.getSnapshots( ).interpolate( alpha );
+
+  transforms_.resize( cubes.size( ) );
+
+  for ( std::size_t i = 0; i < cubes.size( ); ++i )
+  {
+    transforms_[ i ] = cubes[ i ].transform;
+  }
+
+  shg::GpuProfiler::Scope cubesScope( getGpuProfiler( ), "cubes" );
+
+  if ( !transforms_.empty( ) )
+  {
+    const GLsizeiptr bytes = static_cast< GLsizeiptr >( transforms_.size( ) * sizeof( glm::mat4 ) );
+
+    // grow with headroom so adding cubes doesn't reallocate every frame
+    if ( !upInstances_ || upInstances_->getRegionSize( ) < bytes )
+    {
+      upInstances_.reset( new shg::StreamingBuffer( bytes * 2 ) );
+      _buildInstanceVaos( );
+    }
+
+    upInstances_->beginFrame( );
+
+    // the first write of a frame lands at the start of its region
+    upInstances_->write( transforms_.data( ), transforms_.size( ) );
+
+    // unmaps on drivers without persistent mapping, so must precede the draw
+    upInstances_->finishWrites( );
+
+    shg::OpenGLHelper::renderBufferInstanced(
+                                             instanceVaos_[ upInstances_->getRegion( ) ],
+                                             0,
+                                             15,
+                                             GL_TRIANGLE_STRIP,
+                                             static_cast< int >( transforms_.size( ) ),
+                                             glIds_.ibo
+                                             );
+
+    upInstances_->endFrame( );
   }
 
   glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
@@ -174,6 +242,16 @@ CubeImguiOpenGLIOHandler::_onGuiRender( )
 
   ImGui::Begin( "Cube Simulation", &alwaysOpen );
 
+  if ( upPendingProgram_ )
+  {
+    ImGui::Text( "Compiling shaders..." );
+  }
+
+  if ( !upShaderReloader_->getLastError( ).empty( ) )
+  {
+    ImGui::TextWrapped( "Shader reload failed:\n%s", upShaderReloader_->getLastError( ).c_str( ) );
+  }
+
   // FPS
   ImGui::Text(
               "Application average %.3f ms/frame (%.1f FPS)",
@@ -181,9 +259,28 @@ CubeImguiOpenGLIOHandler::_onGuiRender( )
               ImGui::GetIO( ).Framerate
               );
 
+  const shg::OpenGLStateCache::Counters &binds = shg::OpenGLStateCache::get( ).getFrameCounters( );
+
+  ImGui::Text(
+              "GL binds per frame: %zu issued, %zu skipped",
+              binds.issued,
+              binds.skipped
+              );
+
+  if ( upFrameCapture_ )
+  {
+    ImGui::Text(
+                "Recording: %zu frames written, %zu dropped",
+                upFrameCapture_->getFramesWritten( ),
+                upFrameCapture_->getFramesDropped( )
+                );
+  }
+
+  _onProfilerGui( OUTPUT_PATH + "profile.csv" );
+
   if ( ImGui::CollapsingHeader( "Controls", "controls", false, true ) )
   {
-    ImGui::Text( "ESC - exit\n\n A  - add random cube\n R  - remove oldest cube\n" );
+    ImGui::Text( "ESC - exit\n\n A  - add random cube\n R  - remove oldest cube\n C  - start/stop recording\n T  - write trace.json\n" );
   }
 
   ImGui::End( );
@@ -191,4 +288,107 @@ CubeImguiOpenGLIOHandler::_onGuiRender( )
 
 
 
+/////////////////////////////////////////////
+/// \brief CubeImguiOpenGLIOHandler::_finishPipeline
+///
+///        Finishes the pipeline once its program has
+///        linked. Returns false while it is still compiling.
+///
+/////////////////////////////////////////////
+bool
+CubeImguiOpenGLIOHandler::_finishPipeline( )
+{
+  if ( !upPendingProgram_ )
+  {
+    return true;
+  }
+
+  if ( !upPendingProgram_->isReady( ) )
+  {
+    return false;
+  }
+
+  _setProgram( upPendingProgram_->get( ) );
+  upPendingProgram_ = nullptr;
+
+  return true;
+} // CubeImguiOpenGLIOHandler::_finishPipeline
+
+
+
+/////////////////////////////////////////////
+/// \brief CubeImguiOpenGLIOHandler::_setProgram
+///
+///        Points the pipeline at a newly linked program.
+///        Locations may differ after a reload so
+///        everything that depends on them is rebuilt.
+///
+/////////////////////////////////////////////
+void
+CubeImguiOpenGLIOHandler::_setProgram( const std::shared_ptr< GLuint > &spProgram )
+{
+  glIds_.program = spProgram;
+
+  projectionViewUniform_ = shg::OpenGLHelper::getUniform( glIds_.program, "projectionView" );
+  colorUniform_          = shg::OpenGLHelper::getUniform( glIds_.program, "color" );
+
+  _buildInstanceVaos( );
+} // CubeImguiOpenGLIOHandler::_setProgram
+
+
+
+/////////////////////////////////////////////
+/// \brief CubeImguiOpenGLIOHandler::_buildInstanceVaos
+///
+///        Builds one VAO per streaming buffer region with
+///        the instance attributes fixed at that region's
+///        offset so drawing never has to re-point them.
+///        Rebuilt when the program or buffer changes.
+///
+/////////////////////////////////////////////
+void
+CubeImguiOpenGLIOHandler::_buildInstanceVaos( )
+{
+  instanceVaos_.clear( );
+
+  if ( !glIds_.program || !upInstances_ )
+  {
+    return;
+  }
+
+  std::vector< shg::VAOElement > vao =
+  {
+    { "inPosition", 3, GL_FLOAT, nullptr }
+  };
+
+  for ( unsigned region = 0; region < upInstances_->getNumRegions( ); ++region )
+  {
+    const GLintptr offset = static_cast< GLintptr >( region ) * upInstances_->getRegionSize( );
+
+    std::vector< shg::VAOElement > instanceVao =
+    {
+      { "inModel", 16, GL_FLOAT, reinterpret_cast< void* >( offset ) }
+    };
+
+    std::shared_ptr< GLuint > spVao = shg::OpenGLHelper::createVao(
+                                                                   glIds_.program,
+                                                                   glIds_.vbo,
+                                                                   0,
+                                                                   vao
+                                                                   );
+
+    shg::OpenGLHelper::addInstanceAttributes(
+                                             spVao,
+                                             glIds_.program,
+                                             upInstances_->getBuffer( ),
+                                             static_cast< GLsizei >( sizeof( glm::mat4 ) ),
+                                             instanceVao
+                                             );
+
+    instanceVaos_.push_back( spVao );
+  }
+} // CubeImguiOpenGLIOHandler::_buildInstanceVaos
+
+
+
 } // namespace example
@@ -3,6 +3,9 @@
 
 #include "shared/core/ImguiOpenGLIOHandler.hpp"
 #include  "shared/graphics/GraphicsForwardDeclarations.hpp"
+#include  "shared/graphics/UniformTable.hpp"
+#include <glm/mat4x4.hpp>
+#include <vector>
 
 
 namespace example
@@ -39,6 +42,10 @@ public:
 
   void removeOldestCube ( );
 
+  void toggleCapture ( );
+
+  void writeTrace ( );
+
 
 private:
 
@@ -48,10 +55,34 @@ private:
   virtual
   void _onGuiRender ( ) final;
 
+  bool _finishPipeline ( );
+
+  void _setProgram ( const std::shared_ptr< GLuint > &spProgram );
+
+  void _buildInstanceVaos ( );
+
   CubeWorld &cubeWorld_;
 
   shg::StandardPipeline glIds_;
 
+  // compiling in the background until _finishPipeline picks it up
+  std::unique_ptr< shg::PendingProgram > upPendingProgram_;
+
+  // rebuilds the program when its shader files are saved
+  std::unique_ptr< shg::ShaderReloader > upShaderReloader_;
+
+  // model matrices of every cube, re-streamed each frame
+  std::unique_ptr< shg::StreamingBuffer > upInstances_;
+
+  // blended transforms staged for upInstances_
+  std::vector< glm::mat4 > transforms_;
+
+  // one per region of upInstances_, instance attributes already set
+  std::vector< std::shared_ptr< GLuint > > instanceVaos_;
+
+  shg::UniformHandle projectionViewUniform_;
+  shg::UniformHandle colorUniform_;
+
 };
 
 
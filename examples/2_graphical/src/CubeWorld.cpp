@@ -1,7 +1,10 @@
 #include "CubeWorld.hpp"
 #include "RotatingCube.hpp"
+#include "shared/core/JobSystem.hpp"
 
 #include <glm/gtc/constants.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/transform.hpp>
 #include <random>
 
 namespace example
@@ -13,6 +16,38 @@ std::default_random_engine randGen;
 std::uniform_real_distribution< float > realDist( 0.0, 1.0 );
 }
 
+
+
+/////////////////////////////////////////////
+/// \brief blend
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+CubeStates
+blend(
+      const CubeStates &previous,
+      const CubeStates &current,
+      const double      alpha
+      )
+{
+  CubeStates result( current );
+
+  const float t = static_cast< float >( alpha );
+
+  for ( std::size_t i = 0; i < result.size( ) && i < previous.size( ); ++i )
+  {
+    if ( previous[ i ].id == current[ i ].id )
+    {
+      result[ i ].transform = previous[ i ].transform
+                              + ( current[ i ].transform - previous[ i ].transform ) * t;
+    }
+  }
+
+  return result;
+} // blend
+
+
+
 /////////////////////////////////////////////
 /// \brief CubeWorld::CubeWorld
 ///
@@ -20,8 +55,14 @@ std::uniform_real_distribution< float > realDist( 0.0, 1.0 );
 /////////////////////////////////////////////
 CubeWorld::CubeWorld( )
   : shs::World( )
-  , currentId_( 0 )
-  , cubes_( )
+  , currentId_      ( 0 )
+  , cubes_          ( )
+  , creationOrder_  ( )
+  , commandMutex_   ( )
+  , pendingCommands_( )
+  , appliedCommands_( )
+  , publishedStates_( )
+  , snapshots_      ( )
 {}
 
 
@@ -36,20 +77,105 @@ CubeWorld::~CubeWorld( ) {}
 /////////////////////////////////////////////
 void
 CubeWorld::update(
-                  const double worldTime, ///< update to this time
-                  const double timestep   ///< interval since last update
+                  const double,         ///< update to this time
+                  const double timestep ///< interval since last update
                   )
 {
-  for ( auto &upCube : cubes_ )
+  _applyCommands( );
+
+  getJobSystem( ).parallelForRange(
+                                   0,
+                                   cubes_.size( ),
+                                   [ this, timestep ]( const std::size_t begin, const std::size_t end )
   {
-    upCube->update( worldTime, timestep );
+    rotateCubes( cubes_, begin, end, timestep );
+  } );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief CubeWorld::publishState
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+CubeWorld::publishState( )
+{
+  const CubeStore &cubes = cubes_;
+
+  const shs::ArrayView< const unsigned >  ids        = cubes.getArray< ID >( );
+  const shs::ArrayView< const glm::mat4 > transforms = cubes.getArray< TRANSFORM >( );
+
+  publishedStates_.resize( cubes.size( ) );
+
+  for ( std::size_t i = 0; i < publishedStates_.size( ); ++i )
+  {
+    publishedStates_[ i ].id        = ids[ i ];
+    publishedStates_[ i ].transform = transforms[ i ];
   }
+
+  snapshots_.publish( publishedStates_ );
 }
 
 
 
 void
-CubeWorld::addRandomCube( )
+CubeWorld::requestAddCube( )
+{
+  std::lock_guard< std::mutex > lock( commandMutex_ );
+  pendingCommands_.push_back( ADD_CUBE );
+}
+
+
+
+void
+CubeWorld::requestRemoveCube( )
+{
+  std::lock_guard< std::mutex > lock( commandMutex_ );
+  pendingCommands_.push_back( REMOVE_CUBE );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief CubeWorld::_applyCommands
+///
+///        Runs on the update thread so the store is
+///        never resized while cubes are rotating or
+///        being published.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+CubeWorld::_applyCommands( )
+{
+  {
+    std::lock_guard< std::mutex > lock( commandMutex_ );
+    pendingCommands_.swap( appliedCommands_ );
+  }
+
+  for ( const CubeCommand command : appliedCommands_ )
+  {
+    switch ( command )
+    {
+    case ADD_CUBE:
+      _addRandomCube( );
+      break;
+
+    case REMOVE_CUBE:
+      _removeOldestCube( );
+      break;
+    }
+  }
+
+  appliedCommands_.clear( );
+} // CubeWorld::_applyCommands
+
+
+
+void
+CubeWorld::_addRandomCube( )
 {
   constexpr float scale = glm::pi< float >( );
   const glm::vec3 axis  = glm::normalize( glm::vec3(
@@ -58,29 +184,36 @@ CubeWorld::addRandomCube( )
                                                     realDist( randGen )
                                                     ) - 0.5f );
 
-  std::unique_ptr< RotatingCube > cube( new RotatingCube(
-                                                         axis,
-                                                         realDist( randGen ) * scale,
-                                                         currentId_++
-                                                         ) );
-
-  cube->setPosition( glm::vec3(
-                               realDist( randGen ),
-                               realDist( randGen ),
-                               realDist( randGen )
-                               ) * 10.0f - 5.0f );
-
-  cubes_.push_back( std::move( cube ) );
-} // CubeWorld::addRandomCube
+  const glm::vec3 position = glm::vec3(
+                                       realDist( randGen ),
+                                       realDist( randGen ),
+                                       realDist( randGen )
+                                       ) * 10.0f - 5.0f;
+
+  creationOrder_.push_back( cubes_.create(
+                                          axis.x,
+                                          axis.y,
+                                          axis.z,
+                                          realDist( randGen ) * scale,
+                                          currentId_++,
+                                          0.0f,
+                                          0,
+                                          position.x,
+                                          position.y,
+                                          position.z,
+                                          glm::translate( position )
+                                          ) );
+} // CubeWorld::_addRandomCube
 
 
 
 void
-CubeWorld::removeOldestCube( )
+CubeWorld::_removeOldestCube( )
 {
-  if ( !cubes_.empty( ) )
+  if ( !creationOrder_.empty( ) )
   {
-    cubes_.pop_front( );
+    cubes_.destroy( creationOrder_.front( ) );
+    creationOrder_.pop_front( );
   }
 }
 
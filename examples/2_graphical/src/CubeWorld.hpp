@@ -2,16 +2,43 @@
 #pragma once
 
 #include "shared/core/World.hpp"
-#include <memory>
+#include "shared/core/SnapshotBuffer.hpp"
+#include "RotatingCube.hpp"
 #include <deque>
+#include <mutex>
+#include <vector>
 
 
 namespace example
 {
 
-class RotatingCube;
 
-typedef std::deque< std::unique_ptr< RotatingCube > > CubeVec;
+///
+/// \brief What the renderer needs from each cube
+///
+struct CubeState
+{
+  unsigned id;
+  glm::mat4 transform;
+};
+
+typedef std::vector< CubeState > CubeStates;
+
+
+///////////////////////////////////////////////////////////////
+/// \brief blend
+///
+///        Blends the transforms of cubes present in both
+///        states. Cubes added, removed or moved within the
+///        store since the previous state use their current
+///        transform.
+///
+///////////////////////////////////////////////////////////////
+CubeStates blend (
+                  const CubeStates &previous,
+                  const CubeStates &current,
+                  const double      alpha
+                  );
 
 
 /////////////////////////////////////////////
@@ -47,22 +74,70 @@ public:
                ) final;
 
 
-  void addRandomCube ( );
+  ///////////////////////////////////////////////////////////////
+  /// \brief publishState
+  ///
+  ///        Copies every cube's id and transform into the
+  ///        snapshot read by the renderer.
+  ///
+  ///////////////////////////////////////////////////////////////
+  virtual
+  void publishState ( ) final;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief requestAddCube
+  ///
+  ///        Safe from any thread. The cube is added at the
+  ///        start of the next update.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void requestAddCube ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief requestRemoveCube
+  ///
+  ///        Safe from any thread. The oldest cube is removed
+  ///        at the start of the next update.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void requestRemoveCube ( );
 
-  void removeOldestCube ( );
 
   ///////////////////////////////////////////////////////////////
-  /// \brief getCube
-  /// \return
+  /// \brief getSnapshots
+  /// \return cube states published by the update thread,
+  ///         for the render thread only
   ///////////////////////////////////////////////////////////////
-  const CubeVec&
-  getCubes( ) const { return cubes_; }
+  shs::SnapshotBuffer< CubeStates >&
+  getSnapshots( ) { return snapshots_; }
 
 
 private:
 
+  enum CubeCommand
+  {
+    ADD_CUBE,
+    REMOVE_CUBE
+  };
+
+  void _applyCommands ( );
+
+  void _addRandomCube ( );
+
+  void _removeOldestCube ( );
+
   unsigned currentId_;
-  CubeVec cubes_;
+  CubeStore cubes_;
+  std::deque< CubeHandle > creationOrder_; ///< oldest cube first
+
+  std::mutex commandMutex_;
+  std::vector< CubeCommand > pendingCommands_; ///< guarded by commandMutex_
+  std::vector< CubeCommand > appliedCommands_; ///< update thread only
+
+  CubeStates publishedStates_;             ///< update thread only
+  shs::SnapshotBuffer< CubeStates > snapshots_;
 
 };
 
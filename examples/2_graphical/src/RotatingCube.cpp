@@ -2,75 +2,40 @@
 
 #include "RotatingCube.hpp"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include "glm/gtx/transform.hpp"
+#include "shared/core/TransformBatch.hpp"
 
 
 namespace example
 {
 
-///////////////////////////////////////////////////////////////
-/// \brief RotatingCube
-///////////////////////////////////////////////////////////////
-RotatingCube::RotatingCube(
-                           const glm::vec3 axis,
-                           const float rotateRate,
-                           const unsigned  id
-                           )
-  : axis_                ( axis )
-  , rotateRate_          ( rotateRate )
-  , id_                  ( id )
-  , angle_               ( 0.0f )
-  , rotations_           ( 0 )
-  , translateMatrix_     ( 1.0f )
-  , rotateMatrix_        ( 1.0f )
-  , transformationMatrix_( 1.0f )
-{}
-
 
 ///////////////////////////////////////////////////////////////
-/// \brief update
-/// \param worldTime
-/// \param timestep
+/// \brief rotateCubes
 ///////////////////////////////////////////////////////////////
 void
-RotatingCube::update (
-                      const double,           ///< update to this time
-                      const double timestep   ///< interval since last update
-                      )
+rotateCubes(
+            CubeStore        &cubes,
+            const std::size_t begin,
+            const std::size_t end,
+            const double      timestep
+            )
 {
-  constexpr float twoPi = glm::pi< float >() * 2.0f;
-  const float rotateAmount = rotateRate_ * static_cast< float >( timestep );
-  angle_ += rotateAmount;
-
-  while ( angle_ > twoPi )
+  const shs::TransformBatch::Arrays arrays =
   {
-    angle_ -= twoPi;
-    ++rotations_;
-  }
-
-  rotateMatrix_ = glm::rotate(
-                              rotateMatrix_,
-                              rotateAmount,
-                              axis_
-                              );
-
-  transformationMatrix_ = translateMatrix_ * rotateMatrix_;
-}
-
-
-
-///////////////////////////////////////////////////////////////
-/// \brief setPosition
-/// \param pos
-///////////////////////////////////////////////////////////////
-void
-RotatingCube::setPosition( const glm::vec3 pos )
-{
-  translateMatrix_ = glm::translate( glm::mat4( ), pos );
-  transformationMatrix_ = translateMatrix_ * rotateMatrix_;
+    cubes.getArray< AXIS_X >( ).data( ),
+    cubes.getArray< AXIS_Y >( ).data( ),
+    cubes.getArray< AXIS_Z >( ).data( ),
+    cubes.getArray< ROTATE_RATE >( ).data( ),
+    cubes.getArray< ANGLE >( ).data( ),
+    cubes.getArray< ROTATIONS >( ).data( ),
+    cubes.getArray< POSITION_X >( ).data( ),
+    cubes.getArray< POSITION_Y >( ).data( ),
+    cubes.getArray< POSITION_Z >( ).data( ),
+    reinterpret_cast< float* >( cubes.getArray< TRANSFORM >( ).data( ) ) // glm::mat4 is 16 packed floats
+  };
+
+  shs::TransformBatch::update( arrays, begin, end, timestep );
 }
 
 
 } // end namespace example
-
@@ -1,75 +1,77 @@
 // RotatingCube.hpp
 #pragma once
 
+#include "shared/core/ComponentStore.hpp"
 
 #include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
 
 
 namespace example
 {
 
 
-/////////////////////////////////////////////
-/// \brief The RotatingCube class
 ///
-/// \author Logan Barnes
-/////////////////////////////////////////////
-class RotatingCube
-{
-
-public:
-
-  ///////////////////////////////////////////////////////////////
-  /// \brief RotatingCube
-  ///////////////////////////////////////////////////////////////
-  RotatingCube(
-               const glm::vec3 axis,
-               const float rotateRate,
-               const unsigned  id
-               );
-
-
-  ///////////////////////////////////////////////////////////////
-  /// \brief ~RotatingCube
-  ///////////////////////////////////////////////////////////////
-  ~RotatingCube( ) = default;
-
-
-  ///////////////////////////////////////////////////////////////
-  /// \brief update
-  ///////////////////////////////////////////////////////////////
-  void update (
-               const double worldTime, ///< update to this time
-               const double timestep   ///< interval since last update
-               );
-
-  void setPosition( const glm::vec3 pos );
-
-  unsigned
-  getRotations( ) const { return rotations_; }
-
-  unsigned
-  id( ) const { return id_; }
-
-  const glm::mat4&
-  getTransformationMatrix( ) const { return transformationMatrix_; }
-
-
-private:
+/// \brief Tag type for rotating cube handles
+///
+struct RotatingCube;
 
-  const glm::vec3 axis_;
-  const float rotateRate_;
-  const unsigned id_;
 
-  float angle_;
-  unsigned rotations_;
+///
+/// \brief Component indices into CubeStore
+///
+enum CubeComponent
+{
+  AXIS_X,
+  AXIS_Y,
+  AXIS_Z,
+  ROTATE_RATE,
+  ID,
+  ANGLE,
+  ROTATIONS,
+  POSITION_X,
+  POSITION_Y,
+  POSITION_Z,
+  TRANSFORM
+};
 
-  glm::mat4 translateMatrix_;
-  glm::mat4 rotateMatrix_;
-  glm::mat4 transformationMatrix_;
 
-};
+//
+// axes and positions are split per coordinate
+// so shs::TransformBatch can update them in SIMD lanes
+//
+typedef shs::ComponentStore<
+    RotatingCube,
+    float,        // AXIS_X
+    float,        // AXIS_Y
+    float,        // AXIS_Z
+    float,        // ROTATE_RATE
+    unsigned,     // ID
+    float,        // ANGLE
+    std::int32_t, // ROTATIONS
+    float,        // POSITION_X
+    float,        // POSITION_Y
+    float,        // POSITION_Z
+    glm::mat4     // TRANSFORM
+    > CubeStore;
+
+typedef CubeStore::HandleType CubeHandle;
+
+
+///////////////////////////////////////////////////////////////
+/// \brief rotateCubes
+///
+///        Advances the cubes at dense indices [begin, end)
+///        by one timestep and rebuilds their transforms.
+///
+///////////////////////////////////////////////////////////////
+void rotateCubes (
+                  CubeStore        &cubes,
+                  const std::size_t begin,
+                  const std::size_t end,
+                  const double      timestep
+                  );
 
 
 } // end namespace example
-
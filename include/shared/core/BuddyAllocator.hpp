@@ -0,0 +1,122 @@
+// BuddyAllocator.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The BuddyAllocator class
+///
+///        Hands out ranges of an address space the allocator
+///        does not own, e.g. a block of GPU memory. Ranges are
+///        power of two sized and aligned to their own size, so
+///        any alignment up to the range size comes for free.
+///        Freed ranges merge with their buddy to keep
+///        fragmentation bounded. Lowest offsets are handed out
+///        first, which keeps the front of the space packed.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class BuddyAllocator
+{
+
+public:
+
+  static constexpr std::uint64_t INVALID_OFFSET = ~std::uint64_t( 0 );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief BuddyAllocator
+  /// \param size total bytes managed, a power of two
+  /// \param minRangeSize smallest range handed out, a power of
+  ///        two no larger than size
+  ///////////////////////////////////////////////////////////////
+  BuddyAllocator(
+                 const std::uint64_t size,
+                 const std::uint64_t minRangeSize
+                 );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief allocate
+  /// \param alignment power of two
+  /// \return offset of the new range or INVALID_OFFSET if no
+  ///         free range is large enough
+  ///////////////////////////////////////////////////////////////
+  std::uint64_t allocate (
+                          const std::uint64_t size,
+                          const std::uint64_t alignment = 1
+                          );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief free
+  ///
+  ///        Releases a range returned by allocate. Throws for
+  ///        offsets that are not allocated.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void free ( const std::uint64_t offset );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getRangeSize
+  /// \return size of the range allocated at offset, 0 if none
+  ///////////////////////////////////////////////////////////////
+  std::uint64_t getRangeSize ( const std::uint64_t offset ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getLargestFreeRange
+  /// \return size of the largest range allocate could return
+  ///////////////////////////////////////////////////////////////
+  std::uint64_t getLargestFreeRange ( ) const;
+
+
+  std::uint64_t
+  getSize( ) const { return std::uint64_t( 1 ) << maxOrder_; }
+
+  std::uint64_t
+  getMinRangeSize( ) const { return std::uint64_t( 1 ) << minOrder_; }
+
+
+  ///
+  /// \brief getBytesUsed
+  /// \return bytes in allocated ranges, rounding included
+  ///
+  std::uint64_t
+  getBytesUsed( ) const { return bytesUsed_; }
+
+
+  std::size_t
+  getAllocationCount( ) const { return allocated_.size( ); }
+
+
+  bool
+  isEmpty( ) const { return allocated_.empty( ); }
+
+
+private:
+
+  std::uint32_t _orderFor ( const std::uint64_t size ) const;
+
+  std::uint32_t minOrder_;
+  std::uint32_t maxOrder_;
+
+  std::vector< std::set< std::uint64_t > > freeRanges_;       ///< order - minOrder_ -> free offsets
+  std::unordered_map< std::uint64_t, std::uint32_t > allocated_; ///< offset -> order
+
+  std::uint64_t bytesUsed_;
+
+};
+
+
+} // namespace shs
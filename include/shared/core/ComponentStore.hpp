@@ -0,0 +1,544 @@
+// ComponentStore.hpp
+#pragma once
+
+#include "shared/core/Handle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The AlignedAllocator class
+///
+///        std::allocator replacement that aligns every array
+///        to Alignment bytes (a cache line by default) so
+///        component arrays can be loaded with aligned SIMD
+///        instructions.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename T, std::size_t Alignment = 64 >
+class AlignedAllocator
+{
+
+  static_assert( Alignment >= alignof( T ) && ( Alignment & ( Alignment - 1 ) ) == 0,
+                 "Alignment must be a power of two no smaller than alignof( T )" );
+
+public:
+
+  typedef T value_type;
+
+  template< typename U >
+  struct rebind
+  {
+    typedef AlignedAllocator< U, Alignment > other;
+  };
+
+  AlignedAllocator( ) noexcept = default;
+
+  template< typename U >
+  AlignedAllocator( const AlignedAllocator< U, Alignment >& ) noexcept {}
+
+  T *allocate ( const std::size_t count );
+
+  void deallocate (
+                    T *pMemory,
+                    const std::size_t
+                    ) noexcept;
+
+  template< typename U >
+  bool
+  operator==( const AlignedAllocator< U, Alignment >& ) const noexcept { return true; }
+
+  template< typename U >
+  bool
+  operator!=( const AlignedAllocator< U, Alignment >& ) const noexcept { return false; }
+
+};
+
+
+template< typename T >
+using AlignedVector = std::vector< T, AlignedAllocator< T > >;
+
+
+
+/////////////////////////////////////////////
+/// \brief The ArrayView class
+///
+///        Non-owning view of a contiguous component array.
+///        Invalidated by any create() or destroy() on the
+///        store it came from.
+///
+/////////////////////////////////////////////
+template< typename T >
+class ArrayView
+{
+
+public:
+
+  ArrayView(
+            T                *pData,
+            const std::size_t size
+            ) noexcept
+    : pData_( pData )
+    , size_ ( size )
+  {}
+
+  T*
+  begin( ) const noexcept { return pData_; }
+
+  T*
+  end( ) const noexcept { return pData_ + size_; }
+
+  T*
+  data( ) const noexcept { return pData_; }
+
+  std::size_t
+  size( ) const noexcept { return size_; }
+
+  bool
+  empty( ) const noexcept { return size_ == 0; }
+
+  T&
+  operator[]( const std::size_t index ) const noexcept { return pData_[ index ]; }
+
+
+private:
+
+  T *pData_;
+  std::size_t size_;
+
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief The ComponentStore class
+///
+///        Structure-of-arrays entity storage. Every entity
+///        has one value of each component type and each
+///        component lives in its own contiguous, cache line
+///        aligned array, so updates over one or two
+///        components stream linearly through memory.
+///
+///        Entities are referenced by stable handles. Dense
+///        indices (0 to size() - 1) are not stable: destroy()
+///        moves the last entity into the freed spot.
+///
+///        Components are accessed by position in the
+///        template argument list, e.g. get< 0 >( handle ).
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+class ComponentStore
+{
+
+public:
+
+  typedef Handle< Tag > HandleType;
+
+  template< std::size_t I >
+  using ComponentType = typename std::tuple_element< I, std::tuple< Components... > >::type;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief create
+  /// \return handle to a new entity with the given components
+  ///////////////////////////////////////////////////////////////
+  HandleType create ( Components ... components );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief destroy
+  ///
+  ///        Swap-removes the entity. Does nothing for dead
+  ///        handles.
+  ///
+  /// \return true if an entity was destroyed
+  ///////////////////////////////////////////////////////////////
+  bool destroy ( const HandleType handle );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief contains
+  ///////////////////////////////////////////////////////////////
+  bool
+  contains( const HandleType handle ) const { return handles_.isAlive( handle ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief size
+  ///////////////////////////////////////////////////////////////
+  std::size_t
+  size( ) const { return denseHandles_.size( ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief empty
+  ///////////////////////////////////////////////////////////////
+  bool
+  empty( ) const { return denseHandles_.empty( ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief reserve
+  ///////////////////////////////////////////////////////////////
+  void reserve ( const std::size_t count );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief clear
+  ///////////////////////////////////////////////////////////////
+  void clear ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getIndex
+  /// \return current dense index of a live entity
+  ///////////////////////////////////////////////////////////////
+  std::size_t getIndex ( const HandleType handle ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getHandle
+  /// \return handle of the entity at a dense index
+  ///////////////////////////////////////////////////////////////
+  HandleType
+  getHandle( const std::size_t index ) const { return denseHandles_[ index ]; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief get
+  /// \return component I of a live entity
+  ///////////////////////////////////////////////////////////////
+  template< std::size_t I >
+  ComponentType< I > &get ( const HandleType handle );
+
+  template< std::size_t I >
+  const ComponentType< I > &get ( const HandleType handle ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getArray
+  /// \return view of every entity's component I, in dense order
+  ///////////////////////////////////////////////////////////////
+  template< std::size_t I >
+  ArrayView< ComponentType< I > >
+  getArray( )
+  {
+    return ArrayView< ComponentType< I > >( std::get< I >( arrays_ ).data( ), size( ) );
+  }
+
+  template< std::size_t I >
+  ArrayView< const ComponentType< I > >
+  getArray( ) const
+  {
+    return ArrayView< const ComponentType< I > >( std::get< I >( arrays_ ).data( ), size( ) );
+  }
+
+
+private:
+
+  static constexpr std::uint32_t NO_ENTITY = std::numeric_limits< std::uint32_t >::max( );
+
+  template< std::size_t ... I >
+  void _pushBack (
+                  std::index_sequence< I... >,
+                  Components && ... components
+                  );
+
+  template< std::size_t ... I >
+  void _swapRemove (
+                    std::index_sequence< I... >,
+                    const std::size_t index
+                    );
+
+  template< std::size_t ... I >
+  void _reserve (
+                 std::index_sequence< I... >,
+                 const std::size_t count
+                 );
+
+  std::tuple< AlignedVector< Components >... > arrays_;
+
+  HandleAllocator< Tag > handles_;
+  std::vector< std::uint32_t > sparse_;   ///< handle index -> dense index
+  std::vector< HandleType > denseHandles_; ///< dense index -> handle
+
+};
+
+
+template< typename Tag, typename ... Components >
+constexpr std::uint32_t ComponentStore< Tag, Components... >::NO_ENTITY;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief AlignedAllocator::allocate
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, std::size_t Alignment >
+T*
+AlignedAllocator< T, Alignment >::allocate( const std::size_t count )
+{
+  if ( count > ( std::numeric_limits< std::size_t >::max( ) - Alignment - sizeof( void* ) ) / sizeof( T ) )
+  {
+    throw std::bad_alloc( );
+  }
+
+  //
+  // over-allocate and stash the original pointer
+  // just in front of the aligned block
+  //
+  void *pRaw = ::operator new( count * sizeof( T ) + Alignment + sizeof( void* ) );
+
+  const std::uintptr_t start   = reinterpret_cast< std::uintptr_t >( pRaw ) + sizeof( void* );
+  const std::uintptr_t aligned = ( start + Alignment - 1 ) & ~std::uintptr_t( Alignment - 1 );
+
+  reinterpret_cast< void** >( aligned )[ -1 ] = pRaw;
+
+  return reinterpret_cast< T* >( aligned );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief AlignedAllocator::deallocate
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, std::size_t Alignment >
+void
+AlignedAllocator< T, Alignment >::deallocate(
+                                             T *pMemory,
+                                             const std::size_t
+                                             ) noexcept
+{
+  if ( pMemory )
+  {
+    ::operator delete( reinterpret_cast< void** >( pMemory )[ -1 ] );
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::create
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+Handle< Tag >
+ComponentStore< Tag, Components... >::create( Components ... components )
+{
+  const HandleType handle = handles_.create( );
+
+  if ( !handle.isValid( ) )
+  {
+    throw std::length_error( "ComponentStore is out of entity handles" );
+  }
+
+  _pushBack( std::index_sequence_for< Components... >( ), std::move( components )... );
+
+  if ( sparse_.size( ) <= handle.getIndex( ) )
+  {
+    sparse_.resize( handle.getIndex( ) + 1, NO_ENTITY );
+  }
+
+  sparse_[ handle.getIndex( ) ] = static_cast< std::uint32_t >( denseHandles_.size( ) );
+  denseHandles_.push_back( handle );
+
+  return handle;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::destroy
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+bool
+ComponentStore< Tag, Components... >::destroy( const HandleType handle )
+{
+  if ( !handles_.destroy( handle ) )
+  {
+    return false;
+  }
+
+  const std::size_t index = sparse_[ handle.getIndex( ) ];
+  const HandleType moved  = denseHandles_.back( );
+
+  _swapRemove( std::index_sequence_for< Components... >( ), index );
+
+  denseHandles_[ index ]        = moved;
+  sparse_[ moved.getIndex( ) ]  = static_cast< std::uint32_t >( index );
+  sparse_[ handle.getIndex( ) ] = NO_ENTITY;
+  denseHandles_.pop_back( );
+
+  return true;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::reserve
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+void
+ComponentStore< Tag, Components... >::reserve( const std::size_t count )
+{
+  _reserve( std::index_sequence_for< Components... >( ), count );
+  denseHandles_.reserve( count );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::clear
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+void
+ComponentStore< Tag, Components... >::clear( )
+{
+  while ( !denseHandles_.empty( ) )
+  {
+    destroy( denseHandles_.back( ) );
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::getIndex
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+std::size_t
+ComponentStore< Tag, Components... >::getIndex( const HandleType handle ) const
+{
+  if ( !handles_.isAlive( handle ) )
+  {
+    throw std::out_of_range( "ComponentStore handle does not refer to a live entity" );
+  }
+
+  return sparse_[ handle.getIndex( ) ];
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::get
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+template< std::size_t I >
+typename ComponentStore< Tag, Components... >::template ComponentType< I >&
+ComponentStore< Tag, Components... >::get( const HandleType handle )
+{
+  return std::get< I >( arrays_ )[ getIndex( handle ) ];
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::get
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+template< std::size_t I >
+const typename ComponentStore< Tag, Components... >::template ComponentType< I >&
+ComponentStore< Tag, Components... >::get( const HandleType handle ) const
+{
+  return std::get< I >( arrays_ )[ getIndex( handle ) ];
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::_pushBack
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+template< std::size_t ... I >
+void
+ComponentStore< Tag, Components... >::_pushBack(
+                                                std::index_sequence< I... >,
+                                                Components && ... components
+                                                )
+{
+  // expands to one push_back per component array
+  int expand[] = { 0, ( std::get< I >( arrays_ ).push_back( std::move( components ) ), 0 )... };
+  static_cast< void >( expand );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::_swapRemove
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+template< std::size_t ... I >
+void
+ComponentStore< Tag, Components... >::_swapRemove(
+                                                  std::index_sequence< I... >,
+                                                  const std::size_t index
+                                                  )
+{
+  const std::size_t last = size( ) - 1;
+
+  if ( index != last )
+  {
+    int expand[] = { 0, ( std::get< I >( arrays_ )[ index ] = std::move( std::get< I >( arrays_ )[ last ] ), 0 )... };
+    static_cast< void >( expand );
+  }
+
+  int expand[] = { 0, ( std::get< I >( arrays_ ).pop_back( ), 0 )... };
+  static_cast< void >( expand );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief ComponentStore::_reserve
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag, typename ... Components >
+template< std::size_t ... I >
+void
+ComponentStore< Tag, Components... >::_reserve(
+                                               std::index_sequence< I... >,
+                                               const std::size_t count
+                                               )
+{
+  int expand[] = { 0, ( std::get< I >( arrays_ ).reserve( count ), 0 )... };
+  static_cast< void >( expand );
+}
+
+
+
+} // namespace shs
@@ -3,6 +3,7 @@
 
 
 #include <chrono>
+#include <atomic>
 #include "shared/core/Driver.hpp"
 
 
@@ -32,7 +33,7 @@ public:
   ContinuousDriver(
                    World     &world,
                    IOHandler &ioHandler
-                   ) noexcept;
+                   );
 
 
   /////////////////////////////////////////////
@@ -55,9 +56,24 @@ public:
             );
 
 
+  /////////////////////////////////////////////
+  /// \brief setTimeScale
+  ///
+  ///        Safe to call from the render thread while
+  ///        the simulation thread is running. Takes
+  ///        effect on the next loop iteration.
+  ///
+  /////////////////////////////////////////////
+  void
+  setTimeScale( const double timeScale ) { timeScale_ = timeScale; }
+
+  double
+  getTimeScale( ) const { return timeScale_; }
+
+
 protected:
 
-  double timeScale_;
+  std::atomic< double > timeScale_; ///< read by the simulation thread in threaded mode
   bool paused_;
 
 
@@ -85,6 +101,28 @@ private:
   void _runNFTRLoop ( );
 
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief _runThreadedLoop
+  ///
+  ///        Runs the No Faster Than Real-time update loop on a
+  ///        dedicated simulation thread while the calling thread
+  ///        handles IO and rendering. Worlds hand renderable
+  ///        state across through World::publishState().
+  ///
+  ///////////////////////////////////////////////////////////////
+  void _runThreadedLoop ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief _runSimulationThread
+  ///
+  ///        Fixed timestep accumulator loop executed by the
+  ///        simulation thread in threaded mode.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void _runSimulationThread ( );
+
+
   ///////////////////////////////////////////////////////////////
   /// \brief _getTimeSeconds
   ///////////////////////////////////////////////////////////////
@@ -102,6 +140,16 @@ private:
   const std::chrono::time_point< std::chrono::system_clock > initTime_;
 
 
+  //
+  // state shared between the render and simulation
+  // threads when running in threaded mode
+  //
+  std::atomic< bool > simRunning_;
+  std::atomic< bool > simPaused_;
+  std::atomic< double > lastStepTime_;
+  std::atomic< double > simDeltaTime_;
+
+
 };
 
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include <type_traits>
 
 
@@ -11,6 +12,7 @@ namespace shs
 
 class World;
 class IOHandler;
+class JobSystem;
 
 
 /////////////////////////////////////////////
@@ -31,14 +33,14 @@ public:
   Driver(
          World     &world,
          IOHandler &ioHandler
-         ) noexcept;
+         );
 
 
   /////////////////////////////////////////////
   /// \brief ~Driver
   /////////////////////////////////////////////
   virtual
-  ~Driver( ) = default;
+  ~Driver( );
 
 
   /////////////////////////////////////////////
@@ -80,11 +82,34 @@ public:
   void printProjectInfo ( const std::string name );
 
 
+  /////////////////////////////////////////////
+  /// \brief getJobSystem
+  /// \return scheduler shared with the world
+  /////////////////////////////////////////////
+  JobSystem&
+  getJobSystem( ) { return *upJobSystem_; }
+
+
 protected:
 
+  /////////////////////////////////////////////
+  /// \brief _updateWorld
+  ///
+  ///        Steps the world, releases the scratch
+  ///        memory its jobs used during the step and
+  ///        lets the world publish its new state.
+  ///
+  /////////////////////////////////////////////
+  void _updateWorld (
+                     const double worldTime,
+                     const double timeStep
+                     );
+
   World     &world_;
   IOHandler &ioHandler_;
 
+  std::unique_ptr< JobSystem > upJobSystem_;
+
 
 };
 
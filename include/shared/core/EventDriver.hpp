@@ -27,7 +27,7 @@ public:
   EventDriver(
               World     &world,
               IOHandler &ioHandler
-              ) noexcept;
+              );
 
 
   /////////////////////////////////////////////
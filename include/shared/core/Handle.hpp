@@ -0,0 +1,279 @@
+// Handle.hpp
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The Handle class
+///
+///        32 bit typed reference to a slot in a pool: the low
+///        24 bits are the slot index and the high 8 bits the
+///        generation the slot had when the handle was made.
+///        Handles to destroyed objects compare as dead
+///        instead of aliasing whatever reuses the slot.
+///
+///        Tag is any type used to keep handles of different
+///        pools from mixing.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename Tag >
+class Handle
+{
+
+public:
+
+  static constexpr std::uint32_t INDEX_BITS      = 24;
+  static constexpr std::uint32_t INDEX_MASK      = ( 1u << INDEX_BITS ) - 1;
+  static constexpr std::uint32_t GENERATION_MASK = 0xff;
+  static constexpr std::uint32_t MAX_SLOTS       = INDEX_MASK; ///< INDEX_MASK itself marks invalid handles
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief Handle
+  ///
+  ///        Default handles are invalid.
+  ///
+  ///////////////////////////////////////////////////////////////
+  constexpr
+  Handle( ) noexcept
+    : value_( INDEX_MASK )
+  {}
+
+
+  constexpr
+  Handle(
+         const std::uint32_t index,
+         const std::uint32_t generation
+         ) noexcept
+    : value_( ( index & INDEX_MASK ) | ( ( generation & GENERATION_MASK ) << INDEX_BITS ) )
+  {}
+
+
+  constexpr std::uint32_t
+  getIndex( ) const noexcept { return value_ & INDEX_MASK; }
+
+  constexpr std::uint32_t
+  getGeneration( ) const noexcept { return value_ >> INDEX_BITS; }
+
+  constexpr std::uint32_t
+  getValue( ) const noexcept { return value_; }
+
+  constexpr bool
+  isValid( ) const noexcept { return getIndex( ) != INDEX_MASK; }
+
+
+  constexpr bool
+  operator==( const Handle &other ) const noexcept { return value_ == other.value_; }
+
+  constexpr bool
+  operator!=( const Handle &other ) const noexcept { return value_ != other.value_; }
+
+
+private:
+
+  std::uint32_t value_;
+
+};
+
+
+template< typename Tag >
+constexpr std::uint32_t Handle< Tag >::INDEX_BITS;
+
+template< typename Tag >
+constexpr std::uint32_t Handle< Tag >::INDEX_MASK;
+
+template< typename Tag >
+constexpr std::uint32_t Handle< Tag >::GENERATION_MASK;
+
+template< typename Tag >
+constexpr std::uint32_t Handle< Tag >::MAX_SLOTS;
+
+
+
+/////////////////////////////////////////////
+/// \brief The HandleAllocator class
+///
+///        Hands out handles and tracks which are alive. Freed
+///        slots are reused with a bumped generation; a slot
+///        whose generation would wrap back to a value an old
+///        handle could still hold is retired for good.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename Tag >
+class HandleAllocator
+{
+
+public:
+
+  typedef Handle< Tag > HandleType;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief create
+  /// \return a new live handle, or an invalid handle if every
+  ///         slot is in use or retired
+  ///////////////////////////////////////////////////////////////
+  HandleType create ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief destroy
+  /// \return false if the handle was already dead
+  ///////////////////////////////////////////////////////////////
+  bool destroy ( const HandleType handle );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief isAlive
+  ///////////////////////////////////////////////////////////////
+  bool
+  isAlive( const HandleType handle ) const
+  {
+    return handle.isValid( )
+           && handle.getIndex( ) < generations_.size( )
+           && generations_[ handle.getIndex( ) ] == handle.getGeneration( );
+  }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getSlotCount
+  /// \return highest slot index ever used plus one
+  ///////////////////////////////////////////////////////////////
+  std::uint32_t
+  getSlotCount( ) const { return static_cast< std::uint32_t >( generations_.size( ) ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief clear
+  ///
+  ///        Kills every handle. Slots are kept so old handles
+  ///        stay dead.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void clear ( );
+
+
+private:
+
+  static constexpr std::uint32_t DEAD_BIT = 0x100; ///< set in generations_ while a slot is free
+
+  void _release ( const std::uint32_t index );
+
+  std::vector< std::uint32_t > generations_;
+  std::vector< std::uint32_t > freeSlots_;
+
+};
+
+
+template< typename Tag >
+constexpr std::uint32_t HandleAllocator< Tag >::DEAD_BIT;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleAllocator::create
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag >
+Handle< Tag >
+HandleAllocator< Tag >::create( )
+{
+  std::uint32_t index;
+
+  if ( !freeSlots_.empty( ) )
+  {
+    index = freeSlots_.back( );
+    freeSlots_.pop_back( );
+    generations_[ index ] &= ~DEAD_BIT;
+  }
+  else
+  {
+    if ( generations_.size( ) >= HandleType::MAX_SLOTS )
+    {
+      return HandleType( );
+    }
+
+    index = static_cast< std::uint32_t >( generations_.size( ) );
+    generations_.push_back( 0 );
+  }
+
+  return HandleType( index, generations_[ index ] );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleAllocator::destroy
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag >
+bool
+HandleAllocator< Tag >::destroy( const HandleType handle )
+{
+  if ( !isAlive( handle ) )
+  {
+    return false;
+  }
+
+  _release( handle.getIndex( ) );
+  return true;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleAllocator::clear
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag >
+void
+HandleAllocator< Tag >::clear( )
+{
+  for ( std::uint32_t index = 0; index < generations_.size( ); ++index )
+  {
+    if ( ( generations_[ index ] & DEAD_BIT ) == 0 )
+    {
+      _release( index );
+    }
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleAllocator::_release
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Tag >
+void
+HandleAllocator< Tag >::_release( const std::uint32_t index )
+{
+  const std::uint32_t generation = ( generations_[ index ] + 1 ) & HandleType::GENERATION_MASK;
+
+  generations_[ index ] = generation | DEAD_BIT;
+
+  //
+  // a wrapped generation would revive stale handles,
+  // so the slot is retired instead of reused
+  //
+  if ( generation != 0 )
+  {
+    freeSlots_.push_back( index );
+  }
+}
+
+
+
+} // namespace shs
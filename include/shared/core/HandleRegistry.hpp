@@ -0,0 +1,305 @@
+// HandleRegistry.hpp
+#pragma once
+
+#include "shared/core/Handle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The HandleRegistry class
+///
+///        Resources stored in an array indexed directly by
+///        handle slot, so a lookup is a generation check plus
+///        one array access. Resources can optionally be given
+///        a name, which is meant to be resolved to a handle
+///        once at setup and not on every use.
+///
+///        Handles stay valid until their resource is destroyed
+///        and never alias whatever reuses the slot afterwards.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename T, typename Tag = T >
+class HandleRegistry
+{
+
+public:
+
+  typedef Handle< Tag > HandleType;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief create
+  /// \param value resource to store
+  /// \param name optional name for find(), must be unused
+  /// \return handle to the new resource
+  ///////////////////////////////////////////////////////////////
+  HandleType create (
+                     T                  value,
+                     const std::string &name = ""
+                     );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief destroy
+  ///
+  ///        Drops the resource and its name. Does nothing for
+  ///        dead handles.
+  ///
+  /// \return true if a resource was destroyed
+  ///////////////////////////////////////////////////////////////
+  bool destroy ( const HandleType handle );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief find
+  /// \return handle registered under name or an invalid handle
+  ///////////////////////////////////////////////////////////////
+  HandleType find ( const std::string &name ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief get
+  /// \return the resource or nullptr if the handle is dead
+  ///////////////////////////////////////////////////////////////
+  T*
+  get( const HandleType handle )
+  {
+    return handles_.isAlive( handle ) ? &values_[ handle.getIndex( ) ] : nullptr;
+  }
+
+  const T*
+  get( const HandleType handle ) const
+  {
+    return handles_.isAlive( handle ) ? &values_[ handle.getIndex( ) ] : nullptr;
+  }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief contains
+  ///////////////////////////////////////////////////////////////
+  bool
+  contains( const HandleType handle ) const { return handles_.isAlive( handle ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief size
+  ///////////////////////////////////////////////////////////////
+  std::size_t
+  size( ) const { return size_; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getSlotCount
+  /// \return highest handle index ever used plus one, for
+  ///         arrays kept alongside the registry
+  ///////////////////////////////////////////////////////////////
+  std::uint32_t
+  getSlotCount( ) const { return static_cast< std::uint32_t >( slots_.size( ) ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getHandle
+  /// \return live handle using a slot or an invalid handle
+  ///         if the slot is free
+  ///////////////////////////////////////////////////////////////
+  HandleType
+  getHandle( const std::uint32_t index ) const { return slots_[ index ]; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief forEach
+  ///
+  ///        Calls function( T& ) for every live resource.
+  ///
+  ///////////////////////////////////////////////////////////////
+  template< typename Function >
+  void forEach ( Function function );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief clear
+  ///
+  ///        Destroys every resource. Old handles stay dead.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void clear ( );
+
+
+private:
+
+  HandleAllocator< Tag > handles_;
+
+  std::vector< T > values_;          ///< handle index -> resource
+  std::vector< HandleType > slots_;  ///< handle index -> live handle, invalid if free
+  std::vector< std::string > names_; ///< handle index -> name, empty if unnamed
+
+  std::unordered_map< std::string, HandleType > nameMap_;
+
+  std::size_t size_ = 0;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleRegistry::create
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, typename Tag >
+Handle< Tag >
+HandleRegistry< T, Tag >::create(
+                                 T                  value,
+                                 const std::string &name
+                                 )
+{
+  if ( !name.empty( ) && nameMap_.find( name ) != nameMap_.end( ) )
+  {
+    throw std::runtime_error( "Item '" + name + "' already exists in registry" );
+  }
+
+  const HandleType handle = handles_.create( );
+
+  if ( !handle.isValid( ) )
+  {
+    throw std::length_error( "HandleRegistry is out of handles" );
+  }
+
+  const std::size_t index = handle.getIndex( );
+
+  if ( values_.size( ) <= index )
+  {
+    values_.resize( index + 1 );
+    slots_.resize( index + 1 );
+    names_.resize( index + 1 );
+  }
+
+  values_[ index ] = std::move( value );
+  slots_[ index ]  = handle;
+  names_[ index ]  = name;
+
+  if ( !name.empty( ) )
+  {
+    nameMap_[ name ] = handle;
+  }
+
+  ++size_;
+
+  return handle;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleRegistry::destroy
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, typename Tag >
+bool
+HandleRegistry< T, Tag >::destroy( const HandleType handle )
+{
+  if ( !handles_.destroy( handle ) )
+  {
+    return false;
+  }
+
+  const std::size_t index = handle.getIndex( );
+
+  if ( !names_[ index ].empty( ) )
+  {
+    nameMap_.erase( names_[ index ] );
+    names_[ index ].clear( );
+  }
+
+  values_[ index ] = T( );
+  slots_[ index ]  = HandleType( );
+  --size_;
+
+  return true;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleRegistry::find
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, typename Tag >
+Handle< Tag >
+HandleRegistry< T, Tag >::find( const std::string &name ) const
+{
+  auto it = nameMap_.find( name );
+
+  return ( it == nameMap_.end( ) ) ? HandleType( ) : it->second;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleRegistry::forEach
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, typename Tag >
+template< typename Function >
+void
+HandleRegistry< T, Tag >::forEach( Function function )
+{
+  for ( std::size_t index = 0; index < slots_.size( ); ++index )
+  {
+    if ( slots_[ index ].isValid( ) )
+    {
+      function( values_[ index ] );
+    }
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief HandleRegistry::clear
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T, typename Tag >
+void
+HandleRegistry< T, Tag >::clear( )
+{
+  handles_.clear( );
+
+  for ( auto &value : values_ )
+  {
+    value = T( );
+  }
+
+  for ( auto &slot : slots_ )
+  {
+    slot = HandleType( );
+  }
+
+  for ( auto &name : names_ )
+  {
+    name.clear( );
+  }
+
+  nameMap_.clear( );
+  size_ = 0;
+}
+
+
+
+} // namespace shs
@@ -0,0 +1,145 @@
+// HeadlessDriver.hpp
+#pragma once
+
+
+#include "shared/core/Driver.hpp"
+
+
+namespace shs
+{
+
+
+class World;
+class IOHandler;
+
+
+/////////////////////////////////////////////
+/// \brief The HeadlessDriver class
+///
+///        Steps the world as fast as possible for a fixed
+///        number of steps or until a target world time is
+///        reached. The IOHandler is only serviced every
+///        'ioInterval' steps (or never when the interval is
+///        zero) so batch runs are not capped by the IO path.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class HeadlessDriver : public Driver
+{
+
+
+public:
+
+  /////////////////////////////////////////////
+  /// \brief HeadlessDriver
+  /// \param world
+  /// \param ioHandler
+  /// \param maxSteps   - stop after this many updates (0 = no limit)
+  /// \param endTime    - stop once world time reaches this value (<= 0 = no limit)
+  /// \param ioInterval - service the IOHandler every 'ioInterval' steps (0 = never)
+  /// \param timeStep   - world time between updates
+  /////////////////////////////////////////////
+  HeadlessDriver(
+                 World              &world,
+                 IOHandler          &ioHandler,
+                 const unsigned long maxSteps   = 0,
+                 const double        endTime    = 0.0,
+                 const unsigned long ioInterval = 0,
+                 const double        timeStep   = 0.1
+                 );
+
+
+  /////////////////////////////////////////////
+  /// \brief ~HeadlessDriver
+  /////////////////////////////////////////////
+  virtual
+  ~HeadlessDriver( ) = default;
+
+
+  /////////////////////////////////////////////
+  /// \brief exec
+  ///
+  ///        Accepted arguments (override constructor values):
+  ///          --steps=N
+  ///          --end-time=T
+  ///          --io-interval=K
+  ///          --time-step=DT
+  ///
+  /// \param argc
+  /// \param argv
+  /// \return
+  /////////////////////////////////////////////
+  virtual
+  int exec (
+            int          argc,
+            const char **argv
+            );
+
+
+  /////////////////////////////////////////////
+  /// \brief getStepsTaken
+  /// \return number of world updates from the last exec call
+  /////////////////////////////////////////////
+  unsigned long
+  getStepsTaken( ) const { return updateFrame_; }
+
+
+  /////////////////////////////////////////////
+  /// \brief getWorldTime
+  /// \return world time reached by the last exec call
+  /////////////////////////////////////////////
+  double
+  getWorldTime( ) const { return worldTime_; }
+
+
+  /////////////////////////////////////////////
+  /// \brief getStepsPerSecond
+  /// \return update throughput of the last exec call
+  /////////////////////////////////////////////
+  double
+  getStepsPerSecond( ) const { return stepsPerSecond_; }
+
+
+  /////////////////////////////////////////////
+  /// \brief setPrintStats
+  /// \param printStats - print throughput to stdout on exit
+  /////////////////////////////////////////////
+  void
+  setPrintStats( bool printStats ) { printStats_ = printStats; }
+
+
+private:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief _runBatchLoop
+  ///
+  ///        Updates the world back to back until a step or
+  ///        time limit is hit or an exit is requested.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void _runBatchLoop ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief _limitReached
+  ///////////////////////////////////////////////////////////////
+  bool _limitReached ( ) const;
+
+
+  unsigned long maxSteps_;
+  double endTime_;
+  unsigned long ioInterval_;
+  double timeStep_;
+
+  const double startTime_;
+  double worldTime_;
+  unsigned long updateFrame_;
+
+  double stepsPerSecond_;
+  bool printStats_;
+
+
+};
+
+
+} // namespace shs
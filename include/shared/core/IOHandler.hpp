@@ -86,6 +86,15 @@ public:
   isExitRequested( ) { return exitRequested_; }
 
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief interruptRequested
+  /// \return true if an interrupt signal (CTRL + C) was caught.
+  ///         Lets drivers that skip updateIO() still exit.
+  ///////////////////////////////////////////////////////////////
+  static
+  bool interruptRequested ( );
+
+
   ///////////////////////////////////////////////////////////////
   /// \brief setEventBased
   /// \param eventBased - true if IOHandler is being used
@@ -4,6 +4,7 @@
 #include "shared/core/OpenGLIOHandler.hpp"
 #include <memory>
 #include <functional>
+#include <string>
 
 
 ///
@@ -79,6 +80,18 @@ public:
 
 protected:
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief _onProfilerGui
+  ///
+  ///        Draws the profiler breakdown, for use inside an
+  ///        ImGui window from _onGuiRender.
+  ///
+  /// \param csvPath file for the CSV export button, no button
+  ///                if empty
+  ///////////////////////////////////////////////////////////////
+  void _onProfilerGui ( const std::string &csvPath = "" );
+
+
   ImguiCallback_t imguiCallback_;
 
 
@@ -0,0 +1,381 @@
+// JobSystem.hpp
+#pragma once
+
+#include "shared/core/ScratchArena.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace shs
+{
+
+
+class JobSystem;
+
+
+/////////////////////////////////////////////
+/// \brief The TaskGraph class
+///
+///        Set of tasks with dependencies. A task can only
+///        depend on tasks added before it, so every graph is
+///        acyclic by construction. The same graph can be run
+///        any number of times.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class TaskGraph
+{
+
+public:
+
+  typedef std::size_t TaskId;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief addTask
+  /// \param task         - work to run
+  /// \param dependencies - tasks that must finish first
+  /// \return id used to depend on this task
+  ///////////////////////////////////////////////////////////////
+  TaskId addTask (
+                  std::function< void( ) >        task,
+                  std::initializer_list< TaskId > dependencies = {}
+                  );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief addTask
+  ///////////////////////////////////////////////////////////////
+  TaskId addTask (
+                  std::function< void( ) >     task,
+                  const std::vector< TaskId > &dependencies
+                  );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief size
+  ///////////////////////////////////////////////////////////////
+  std::size_t
+  size( ) const { return nodes_.size( ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief clear
+  ///////////////////////////////////////////////////////////////
+  void
+  clear( ) { nodes_.clear( ); }
+
+
+private:
+
+  friend class JobSystem;
+
+  struct Node
+  {
+    std::function< void( ) > task;
+    std::vector< TaskId > successors;
+    unsigned dependencyCount;
+  };
+
+  std::vector< Node > nodes_;
+
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief The JobSystem class
+///
+///        Work-stealing scheduler shared by the driver and the
+///        world. Each thread owns a job queue; idle workers
+///        steal from the others. Threads waiting on a
+///        parallelFor or a TaskGraph run jobs instead of
+///        blocking, so jobs may themselves start nested work.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class JobSystem
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief JobSystem
+  /// \param numThreads - threads doing work, including the
+  ///                     calling thread (0 uses every core)
+  ///////////////////////////////////////////////////////////////
+  explicit
+  JobSystem( unsigned numThreads = 0 );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ~JobSystem
+  ///////////////////////////////////////////////////////////////
+  ~JobSystem( );
+
+
+  JobSystem( const JobSystem& )            = delete;
+  JobSystem &operator=( const JobSystem& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getNumThreads
+  /// \return worker threads plus the calling thread
+  ///////////////////////////////////////////////////////////////
+  unsigned
+  getNumThreads( ) const { return numWorkers_ + 1; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief parallelForRange
+  ///
+  ///        Splits [begin, end) into chunks of at most grainSize
+  ///        indices and calls func( chunkBegin, chunkEnd ) for
+  ///        each one. Returns once every chunk is done. The
+  ///        first exception thrown by func is rethrown here.
+  ///
+  /// \param grainSize - chunk size (0 picks one per thread count)
+  ///////////////////////////////////////////////////////////////
+  template< typename RangeFunc >
+  void parallelForRange (
+                         const std::size_t begin,
+                         const std::size_t end,
+                         RangeFunc         func,
+                         std::size_t       grainSize = 0
+                         );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief parallelFor
+  ///
+  ///        Calls func( index ) for every index in [begin, end).
+  ///
+  ///////////////////////////////////////////////////////////////
+  template< typename Func >
+  void parallelFor (
+                    const std::size_t begin,
+                    const std::size_t end,
+                    Func              func,
+                    const std::size_t grainSize = 0
+                    );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief run
+  ///
+  ///        Runs every task in the graph once its dependencies
+  ///        finish and returns when all tasks are done. Tasks
+  ///        depending on a task that threw are skipped and the
+  ///        exception is rethrown here.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void run ( TaskGraph &graph );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getScratchArena
+  /// \return scratch memory owned by the calling thread; valid
+  ///         until resetScratchArenas() (once per world update)
+  ///////////////////////////////////////////////////////////////
+  ScratchArena &getScratchArena ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief resetScratchArenas
+  ///
+  ///        Must not be called while jobs are running.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void resetScratchArenas ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getSerial
+  /// \return job system without worker threads for worlds that
+  ///         aren't owned by a driver
+  ///////////////////////////////////////////////////////////////
+  static
+  JobSystem &getSerial ( );
+
+
+private:
+
+  class WaitGroup
+  {
+  public:
+
+    explicit
+    WaitGroup( const std::size_t count )
+      : remaining( count )
+      , failed( false )
+    {}
+
+    void fail ( std::exception_ptr exception );
+
+    void rethrowIfFailed ( );
+
+    std::atomic< std::size_t > remaining;
+    std::atomic< bool > failed;
+
+  private:
+
+    std::mutex mutex_;
+    std::exception_ptr exception_;
+  };
+
+  struct Job
+  {
+    std::function< void( ) > func;
+    WaitGroup *pGroup;
+  };
+
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    std::deque< Job > jobs;
+  };
+
+  void _submit ( std::vector< Job > &jobs );
+
+  bool _tryRunJob ( const unsigned threadIndex );
+
+  void _wait ( WaitGroup &group );
+
+  void _workerLoop ( const unsigned threadIndex );
+
+  unsigned _getThreadIndex ( ) const;
+
+  unsigned numWorkers_;
+
+  std::vector< std::unique_ptr< WorkQueue > > queues_;       ///< one per worker plus one for outside threads
+  std::vector< std::unique_ptr< ScratchArena > > arenas_;    ///< one per worker
+
+  std::mutex outsideArenaMutex_;
+  std::unordered_map< std::thread::id, std::unique_ptr< ScratchArena > > outsideArenas_;
+  std::vector< std::thread > workers_;
+
+  std::atomic< std::size_t > queuedJobs_;
+  std::atomic< bool > running_;
+
+  std::mutex sleepMutex_;
+  std::condition_variable wakeCondition_;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief JobSystem::parallelForRange
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename RangeFunc >
+void
+JobSystem::parallelForRange(
+                            const std::size_t begin,
+                            const std::size_t end,
+                            RangeFunc         func,
+                            std::size_t       grainSize
+                            )
+{
+  if ( end <= begin )
+  {
+    return;
+  }
+
+  const std::size_t count = end - begin;
+
+  if ( grainSize == 0 )
+  {
+    //
+    // a few chunks per thread keeps
+    // stealing effective when work is uneven
+    //
+    const std::size_t targetChunks = std::size_t( getNumThreads( ) ) * 4;
+    grainSize = ( count + targetChunks - 1 ) / targetChunks;
+  }
+
+  const std::size_t numChunks = ( count + grainSize - 1 ) / grainSize;
+
+  if ( numChunks == 1 || numWorkers_ == 0 )
+  {
+    func( begin, end );
+    return;
+  }
+
+  WaitGroup group( numChunks - 1 );
+
+  std::vector< Job > jobs;
+  jobs.reserve( numChunks - 1 );
+
+  for ( std::size_t chunk = 1; chunk < numChunks; ++chunk )
+  {
+    const std::size_t chunkBegin = begin + chunk * grainSize;
+    const std::size_t chunkEnd   = std::min( end, chunkBegin + grainSize );
+
+    jobs.push_back( Job{ [ &func, chunkBegin, chunkEnd ] { func( chunkBegin, chunkEnd ); }, &group } );
+  }
+
+  _submit( jobs );
+
+  //
+  // the first chunk runs here while the rest are stolen
+  //
+  try
+  {
+    func( begin, std::min( end, begin + grainSize ) );
+  }
+  catch ( ... )
+  {
+    group.fail( std::current_exception( ) );
+  }
+
+  _wait( group );
+  group.rethrowIfFailed( );
+} // JobSystem::parallelForRange
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief JobSystem::parallelFor
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename Func >
+void
+JobSystem::parallelFor(
+                       const std::size_t begin,
+                       const std::size_t end,
+                       Func              func,
+                       const std::size_t grainSize
+                       )
+{
+  parallelForRange(
+                   begin,
+                   end,
+                   [ &func ]( const std::size_t chunkBegin, const std::size_t chunkEnd )
+  {
+    for ( std::size_t i = chunkBegin; i < chunkEnd; ++i )
+    {
+      func( i );
+    }
+  },
+                   grainSize
+                   );
+}
+
+
+
+} // namespace shs
@@ -5,6 +5,7 @@
 #include "shared/graphics/GraphicsForwardDeclarations.hpp"
 
 #include <memory>
+#include <string>
 
 
 namespace shs
@@ -80,6 +81,7 @@ public:
   /// \brief resize
   ///
   ///        Updates the camera aspect ratio and OpenGL viewport.
+  ///        Stops any capture, its frames all share one size.
   ///
   ///////////////////////////////////////////////////////////////
   virtual
@@ -89,10 +91,61 @@ public:
                );
 
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief startCapture
+  ///
+  ///        Records every rendered frame (without GUI) at the
+  ///        current framebuffer size, in pixels rather than screen
+  ///        coordinates. Resizing the window stops the capture.
+  ///        The extension of filePath picks
+  ///        the format, see shg::FrameCapture.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void startCapture (
+                     const std::string &filePath,
+                     const int          fps = 60
+                     );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief stopCapture
+  ///
+  ///        Writes out frames still in flight and closes the file.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void stopCapture ( );
+
+
+  bool
+  isCapturing( ) const { return upFrameCapture_ != nullptr; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief setProfiling
+  ///
+  ///        Turns GPU/CPU timing of each frame on or off. Every
+  ///        frame is timed as "frame" with "render" and "capture"
+  ///        (and "gui" with ImGui) nested inside. _onRender can
+  ///        add its own scopes through getGpuProfiler( ).
+  ///
+  ///////////////////////////////////////////////////////////////
+  void setProfiling ( const bool profile );
+
+
+  ///
+  /// \brief getGpuProfiler
+  /// \return the profiler or nullptr if profiling is off
+  ///
+  shg::GpuProfiler*
+  getGpuProfiler( ) { return upGpuProfiler_.get( ); }
+
+
 protected:
 
   std::unique_ptr< shg::GlfwWrapper >        upGlfwWrapper_;
   std::unique_ptr< shg::GlmCamera< float > > upCamera_;
+  std::unique_ptr< shg::FrameCapture >       upFrameCapture_;
+  std::unique_ptr< shg::GpuProfiler >        upGpuProfiler_;
 
   int windowWidth_;
   int windowHeight_;
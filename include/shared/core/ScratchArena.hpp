@@ -0,0 +1,111 @@
+// ScratchArena.hpp
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The ScratchArena class
+///
+///        Bump allocator for short lived, per-thread scratch
+///        memory. Allocations are never freed individually;
+///        reset() releases everything at once. Memory that
+///        overflowed into extra blocks is merged into a single
+///        block on reset so steady state frames never allocate.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class ScratchArena
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ScratchArena
+  /// \param blockSize - initial capacity in bytes
+  ///////////////////////////////////////////////////////////////
+  explicit
+  ScratchArena( const std::size_t blockSize = 64 * 1024 );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief allocate
+  /// \return uninitialized memory valid until the next reset()
+  ///////////////////////////////////////////////////////////////
+  void *allocate (
+                  const std::size_t bytes,
+                  const std::size_t alignment = alignof( std::max_align_t )
+                  );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief allocate
+  /// \return uninitialized array of 'count' T's
+  ///////////////////////////////////////////////////////////////
+  template< typename T >
+  T *allocate ( const std::size_t count );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief reset
+  ///
+  ///        Invalidates all previous allocations.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void reset ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getBytesUsed
+  /// \return bytes handed out since the last reset
+  ///////////////////////////////////////////////////////////////
+  std::size_t
+  getBytesUsed( ) const { return bytesUsed_; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getCapacity
+  /// \return total bytes owned by the arena
+  ///////////////////////////////////////////////////////////////
+  std::size_t getCapacity ( ) const;
+
+
+private:
+
+  struct Block
+  {
+    std::unique_ptr< unsigned char[] > memory;
+    std::size_t size;
+  };
+
+  void _addBlock ( const std::size_t minSize );
+
+  std::vector< Block > blocks_;
+  std::size_t blockSize_;
+  std::size_t offset_;
+  std::size_t bytesUsed_;
+
+};
+
+
+
+template< typename T >
+T*
+ScratchArena::allocate( const std::size_t count )
+{
+  static_assert( std::is_trivially_destructible< T >::value,
+                 "ScratchArena never runs destructors" );
+
+  return static_cast< T* >( allocate( sizeof( T ) * count, alignof( T ) ) );
+}
+
+
+
+} // namespace shs
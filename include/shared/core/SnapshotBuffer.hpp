@@ -0,0 +1,383 @@
+// SnapshotBuffer.hpp
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+#include <cstddef>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The TripleBuffer class
+///
+///        Lock-free single producer, single consumer triple
+///        buffer. The writer fills getWriteBuffer() and calls
+///        publish(); the reader calls update() to pick up the
+///        newest published buffer. Neither side ever blocks
+///        and the reader never sees a partially written state.
+///
+///        Variable sized states (std::vector etc.) are fine:
+///        each buffer keeps its capacity so a writer copying
+///        a similar sized state does not reallocate, and the
+///        reader only ever touches its own buffer.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename T >
+class TripleBuffer
+{
+
+  static_assert( std::is_copy_assignable< T >::value,
+                 "TripleBuffer state must be copy assignable" );
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief TripleBuffer
+  /// \param initial - value every buffer starts with
+  ///////////////////////////////////////////////////////////////
+  explicit
+  TripleBuffer( const T &initial = T( ) );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getWriteBuffer
+  /// \return buffer owned by the writer until the next publish()
+  ///////////////////////////////////////////////////////////////
+  T&
+  getWriteBuffer( ) { return buffers_[ writeIndex_ ]; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief publish
+  ///
+  ///        Makes the write buffer available to the reader and
+  ///        hands the writer a free buffer.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void publish ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief update
+  /// \return true if a newer buffer was published since the
+  ///         last call and is now the read buffer
+  ///////////////////////////////////////////////////////////////
+  bool update ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getReadBuffer
+  /// \return buffer owned by the reader until the next update()
+  ///////////////////////////////////////////////////////////////
+  const T&
+  getReadBuffer( ) const { return buffers_[ readIndex_ ]; }
+
+
+private:
+
+  static constexpr unsigned char INDEX_MASK = 0x3;
+  static constexpr unsigned char DIRTY_BIT  = 0x4;
+
+  std::array< T, 3 > buffers_;
+
+  unsigned char writeIndex_;
+  std::atomic< unsigned char > middle_; ///< index of the shared buffer plus dirty bit
+  unsigned char readIndex_;
+
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief The Snapshot struct
+///
+///        The two most recent published states of a world
+///        and the world time of the current one.
+/////////////////////////////////////////////
+template< typename T >
+struct Snapshot
+{
+  T previous;
+  T current;
+  double worldTime;
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief The SnapshotBuffer class
+///
+///        Publishes world state from World::update (or
+///        World::publishState) to IOHandler::showWorld
+///        without locks. The reader gets both the previous
+///        and current states so it can blend them by the
+///        alpha passed to showWorld.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename T >
+class SnapshotBuffer
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief SnapshotBuffer
+  /// \param initial - state returned before anything is published
+  ///////////////////////////////////////////////////////////////
+  explicit
+  SnapshotBuffer( const T &initial = T( ) );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief publish
+  ///
+  ///        Update thread only. The previously published
+  ///        state becomes the snapshot's 'previous' state.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void publish (
+                const T     &state,
+                const double worldTime = 0.0
+                );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief latest
+  ///
+  ///        Render thread only. Picks up the newest snapshot
+  ///        if one was published.
+  ///
+  ///////////////////////////////////////////////////////////////
+  const Snapshot< T > &latest ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief interpolate
+  ///
+  ///        Render thread only. Blends the previous and current
+  ///        states of the newest snapshot by alpha.
+  ///
+  ///////////////////////////////////////////////////////////////
+  T interpolate ( const double alpha );
+
+
+private:
+
+  TripleBuffer< Snapshot< T > > buffer_;
+  T lastPublished_;
+
+};
+
+
+
+///////////////////////////////////////////////////////////////
+/// \brief blend
+///
+///        Linear blend of floating point values. Worlds provide
+///        their own blend( const State&, const State&, double )
+///        overload (found through ADL) for custom state types.
+///
+///////////////////////////////////////////////////////////////
+template< typename T >
+typename std::enable_if< std::is_floating_point< T >::value, T >::type
+blend(
+      const T      previous,
+      const T      current,
+      const double alpha
+      )
+{
+  return static_cast< T >( previous + ( current - previous ) * alpha );
+}
+
+
+///////////////////////////////////////////////////////////////
+/// \brief blend
+///
+///        Discrete values can't be blended so the current
+///        value is used.
+///
+///////////////////////////////////////////////////////////////
+template< typename T >
+typename std::enable_if< std::is_integral< T >::value || std::is_enum< T >::value, T >::type
+blend(
+      const T,
+      const T current,
+      const double
+      )
+{
+  return current;
+}
+
+
+///////////////////////////////////////////////////////////////
+/// \brief blend
+///
+///        Element-wise blend of fixed size arrays.
+///
+///////////////////////////////////////////////////////////////
+template< typename T, std::size_t N >
+std::array< T, N >
+blend(
+      const std::array< T, N > &previous,
+      const std::array< T, N > &current,
+      const double              alpha
+      )
+{
+  std::array< T, N > result;
+
+  for ( std::size_t i = 0; i < N; ++i )
+  {
+    result[ i ] = blend( previous[ i ], current[ i ], alpha );
+  }
+
+  return result;
+}
+
+
+///////////////////////////////////////////////////////////////
+/// \brief interpolate
+/// \return the snapshot's states blended by alpha
+///////////////////////////////////////////////////////////////
+template< typename T >
+T
+interpolate(
+            const Snapshot< T > &snapshot,
+            const double         alpha
+            )
+{
+  return blend( snapshot.previous, snapshot.current, alpha );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief TripleBuffer::TripleBuffer
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+TripleBuffer< T >::TripleBuffer( const T &initial )
+  : buffers_   ( { { initial, initial, initial } } )
+  , writeIndex_( 0 )
+  , middle_    ( 1 )
+  , readIndex_ ( 2 )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief TripleBuffer::publish
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+void
+TripleBuffer< T >::publish( )
+{
+  const unsigned char shared = static_cast< unsigned char >( writeIndex_ | DIRTY_BIT );
+
+  writeIndex_ = static_cast< unsigned char >(
+                                             middle_.exchange( shared, std::memory_order_acq_rel )
+                                             & INDEX_MASK
+                                             );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief TripleBuffer::update
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+bool
+TripleBuffer< T >::update( )
+{
+  if ( ( middle_.load( std::memory_order_relaxed ) & DIRTY_BIT ) == 0 )
+  {
+    return false;
+  }
+
+  readIndex_ = static_cast< unsigned char >(
+                                            middle_.exchange( readIndex_, std::memory_order_acq_rel )
+                                            & INDEX_MASK
+                                            );
+  return true;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief SnapshotBuffer::SnapshotBuffer
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+SnapshotBuffer< T >::SnapshotBuffer( const T &initial )
+  : buffer_       ( Snapshot< T >{ initial, initial, 0.0 } )
+  , lastPublished_( initial )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief SnapshotBuffer::publish
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+void
+SnapshotBuffer< T >::publish(
+                             const T     &state,
+                             const double worldTime
+                             )
+{
+  Snapshot< T > &snapshot = buffer_.getWriteBuffer( );
+
+  snapshot.previous  = lastPublished_;
+  snapshot.current   = state;
+  snapshot.worldTime = worldTime;
+
+  buffer_.publish( );
+
+  lastPublished_ = state;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief SnapshotBuffer::latest
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+const Snapshot< T >&
+SnapshotBuffer< T >::latest( )
+{
+  buffer_.update( );
+  return buffer_.getReadBuffer( );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief SnapshotBuffer::interpolate
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+T
+SnapshotBuffer< T >::interpolate( const double alpha )
+{
+  return shs::interpolate( latest( ), alpha );
+}
+
+
+
+} // namespace shs
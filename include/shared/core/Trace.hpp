@@ -0,0 +1,251 @@
+// Trace.hpp
+#pragma once
+
+#include "ThirdpartyDefinesConfig.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+///
+/// \brief SHS_TRACE_SCOPE
+///
+///        Records the rest of the enclosing block as an event
+///        named name, which must be a string literal or
+///        otherwise outlive the trace. Compiles to nothing
+///        unless the project is configured with USE_TRACING.
+///        SHS_TRACE_THREAD_NAME labels the calling thread the
+///        same way.
+///
+#ifdef USE_TRACING
+#define SHS_TRACE_CONCAT_( a, b )     a ## b
+#define SHS_TRACE_CONCAT( a, b )      SHS_TRACE_CONCAT_( a, b )
+#define SHS_TRACE_SCOPE( name )       shs::TraceScope SHS_TRACE_CONCAT( shsTraceScope, __LINE__ )( name )
+#define SHS_TRACE_THREAD_NAME( name ) shs::Tracer::get( ).setThreadName( name )
+#else
+#define SHS_TRACE_SCOPE( name )
+#define SHS_TRACE_THREAD_NAME( name )
+#endif
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The Tracer class
+///
+///        Collects timed events from any number of threads.
+///        Each thread appends to its own buffer of fixed size
+///        chunks without locking; only a thread's first event
+///        takes a lock to register its buffer. Chunks are
+///        handed to the tracer when a trace is written, which
+///        can happen while other threads keep recording, and
+///        every few chunks by the recording thread itself if
+///        the tracer is not busy. Only the newest events of each
+///        thread are kept, see setMaxEventsPerThread.
+///
+///        Traces are written in the Chrome trace event format
+///        (chrome://tracing or https://ui.perfetto.dev).
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class Tracer
+{
+
+public:
+
+  ///
+  /// \brief A complete event, times in nanoseconds since the
+  ///        tracer was created
+  ///
+  struct Event
+  {
+    const char *name;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief get
+  /// \return the process wide tracer
+  ///////////////////////////////////////////////////////////////
+  static
+  Tracer &get ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ~Tracer
+  ///
+  ///        Writes the output file, if one was set, at exit.
+  ///
+  ///////////////////////////////////////////////////////////////
+  ~Tracer( );
+
+  Tracer( const Tracer& )            = delete;
+  Tracer &operator=( const Tracer& ) = delete;
+
+
+  ///
+  /// \brief setEnabled pauses or resumes recording, on by default
+  ///
+  void
+  setEnabled( const bool enabled ) { enabled_.store( enabled, std::memory_order_relaxed ); }
+
+  bool
+  isEnabled( ) const { return enabled_.load( std::memory_order_relaxed ); }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief now
+  /// \return nanoseconds since the tracer was created
+  ///////////////////////////////////////////////////////////////
+  std::uint64_t now ( ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief record
+  ///
+  ///        Appends an event to the calling thread's buffer.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void record (
+               const char         *name,
+               const std::uint64_t startNs,
+               const std::uint64_t endNs
+               );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief setThreadName
+  ///
+  ///        Labels the calling thread in written traces.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void setThreadName ( const std::string &name );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief setOutputFile
+  ///
+  ///        File the trace is written to when the tracer is
+  ///        destroyed at exit. Empty to write nothing.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void setOutputFile ( const std::string &filePath );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief writeChromeTrace
+  ///
+  ///        Writes every event recorded since the last clear().
+  ///
+  ///////////////////////////////////////////////////////////////
+  void writeChromeTrace ( const std::string &filePath );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief setMaxEventsPerThread
+  ///
+  ///        Caps the events kept for each thread, dropping the
+  ///        oldest beyond it. 2^20 by default.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void setMaxEventsPerThread ( const std::size_t maxEvents );
+
+
+  ///
+  /// \brief getDroppedEventCount
+  /// \return events dropped by the cap since the last clear()
+  ///
+  std::size_t getDroppedEventCount ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getEvents
+  /// \return every event recorded since the last clear() by
+  ///         each thread, indexed by thread id
+  ///////////////////////////////////////////////////////////////
+  std::vector< std::vector< Event > > getEvents ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief clear
+  ///
+  ///        Drops every event recorded so far and resets the
+  ///        dropped event count.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void clear ( );
+
+
+private:
+
+  class ThreadBuffer;
+
+  Tracer( );
+
+  ThreadBuffer &_getThreadBuffer ( );
+
+  void _collect ( );
+
+  std::atomic< bool > enabled_;
+  std::uint64_t startNs_;
+
+  std::mutex mutex_;
+  std::vector< std::unique_ptr< ThreadBuffer > > buffers_;
+  std::string outputFile_;
+  std::size_t maxEventsPerThread_;
+
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief The TraceScope class
+///
+///        Records its own lifetime with the tracer. Normally
+///        created through SHS_TRACE_SCOPE.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class TraceScope
+{
+
+public:
+
+  explicit
+  TraceScope( const char *name )
+    : name_( Tracer::get( ).isEnabled( ) ? name : nullptr )
+    , startNs_( name_ ? Tracer::get( ).now( ) : 0 )
+  {}
+
+
+  ~TraceScope( )
+  {
+    if ( name_ )
+    {
+      Tracer::get( ).record( name_, startNs_, Tracer::get( ).now( ) );
+    }
+  }
+
+
+  TraceScope( const TraceScope& )            = delete;
+  TraceScope &operator=( const TraceScope& ) = delete;
+
+
+private:
+
+  const char *name_;
+  std::uint64_t startNs_;
+
+};
+
+
+} // namespace shs
@@ -0,0 +1,106 @@
+// TransformBatch.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace shs
+{
+
+
+/////////////////////////////////////////////
+/// \brief The TransformBatch class
+///
+///        Batched update for entities spinning about a fixed
+///        axis at a fixed rate. Works on structure-of-arrays
+///        state (see ComponentStore) and composes each model
+///        matrix directly from position, axis and angle, 4 or 8
+///        entities at a time with SSE or AVX when the CPU
+///        supports it. Angles are wrapped to [0, 2pi) every
+///        step so nothing accumulates drift.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class TransformBatch
+{
+
+public:
+
+  enum SimdLevel
+  {
+    SCALAR,
+    SSE,
+    AVX
+  };
+
+
+  ///
+  /// \brief Entity arrays, all indexed by the same dense index
+  ///
+  struct Arrays
+  {
+    const float *pAxisX; ///< unit rotation axes
+    const float *pAxisY;
+    const float *pAxisZ;
+
+    const float *pRotateRates; ///< radians per second
+
+    float *pAngles;             ///< radians, kept in [0, 2pi)
+    std::int32_t *pRevolutions; ///< full turns completed (may be null)
+
+    const float *pPositionX;
+    const float *pPositionY;
+    const float *pPositionZ;
+
+    float *pMatrices; ///< 16 floats per entity, column major (OpenGL/glm layout)
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief update
+  ///
+  ///        Advances angles of entities [begin, end) by
+  ///        timestep and rewrites their model matrices using
+  ///        the widest instruction set the CPU supports.
+  ///        Disjoint ranges may be updated concurrently.
+  ///
+  ///////////////////////////////////////////////////////////////
+  static
+  void update (
+               const Arrays     &arrays,
+               const std::size_t begin,
+               const std::size_t end,
+               const double      timestep
+               );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief update
+  ///
+  ///        Same as above with an explicit instruction set
+  ///        (clamped to what the CPU supports).
+  ///
+  ///////////////////////////////////////////////////////////////
+  static
+  void update (
+               const Arrays     &arrays,
+               const std::size_t begin,
+               const std::size_t end,
+               const double      timestep,
+               const SimdLevel   level
+               );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getSupportedSimdLevel
+  /// \return widest kernel usable on this CPU
+  ///////////////////////////////////////////////////////////////
+  static
+  SimdLevel getSupportedSimdLevel ( );
+
+
+};
+
+
+} // namespace shs
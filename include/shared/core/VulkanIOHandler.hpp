@@ -3,6 +3,7 @@
 
 #include "shared/core/IOHandler.hpp"
 #include <memory>
+#include <string>
 
 
 namespace shg
@@ -33,10 +34,13 @@ public:
 
   ///////////////////////////////////////////////////////////////
   /// \brief Renderer
+  /// \param pipelineCacheFile where compiled pipelines are kept
+  ///        between runs, empty to recompile every run
   ///////////////////////////////////////////////////////////////
   VulkanIOHandler(
-                  World &world,
-                  bool  printInfo = true
+                  World             &world,
+                  bool               printInfo         = true,
+                  const std::string &pipelineCacheFile = ""
                   );
 
 
@@ -1,10 +1,15 @@
 // World.hpp
 #pragma once
 
+#include <atomic>
+
 
 namespace shs
 {
 
+class JobSystem;
+
+
 /////////////////////////////////////////////
 /// \brief The World class
 ///
@@ -38,6 +43,20 @@ public:
                );
 
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief publishState
+  ///
+  ///        Called on the update thread after every completed
+  ///        update, whichever loop drives the world. Worlds
+  ///        copy whatever showWorld() reads into a snapshot
+  ///        here so rendering never sees a half finished
+  ///        update, even when updates run on another thread.
+  ///
+  ///////////////////////////////////////////////////////////////
+  virtual
+  void publishState ( );
+
+
   ///////////////////////////////////////////////////////////////
   /// \brief requestExit_
   ///////////////////////////////////////////////////////////////
@@ -52,9 +71,28 @@ public:
   requestingExit( ) { return requestExit_; }
 
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief setJobSystem
+  ///
+  ///        Called by the driver that owns the job system.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void
+  setJobSystem( JobSystem *pJobSystem ) { pJobSystem_ = pJobSystem; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getJobSystem
+  /// \return the driver's job system for parallel updates, or a
+  ///         serial one if no driver owns this world
+  ///////////////////////////////////////////////////////////////
+  JobSystem &getJobSystem ( );
+
+
 private:
 
-  bool requestExit_;
+  std::atomic< bool > requestExit_;
+  JobSystem *pJobSystem_;
 
 };
 
@@ -0,0 +1,121 @@
+// DrawBatch.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The DrawBatch class
+///
+///        Records indexed draws that share a VAO, index buffer
+///        and program and submits them all with a single
+///        glMultiDrawElementsIndirect. Each draw carries a
+///        fixed size block of data which is uploaded to a
+///        shader storage buffer; shaders index it with
+///        gl_DrawIDARB (see shaders/indirect).
+///
+///        Needs GL 4.3 and ARB_shader_draw_parameters. Check
+///        isSupported and fall back to OpenGLHelper::renderBuffer
+///        without them.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class DrawBatch
+{
+
+public:
+
+  ///
+  /// \brief Layout required by GL_DRAW_INDIRECT_BUFFER
+  ///
+  struct DrawElementsCommand
+  {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief DrawBatch
+  /// \param drawDataSize bytes of per draw data, laid out as the
+  ///                     shader's std430 struct
+  /// \param binding      shader storage binding the data uses
+  ///////////////////////////////////////////////////////////////
+  explicit
+  DrawBatch(
+            const std::size_t drawDataSize,
+            const GLuint      binding = 0
+            );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief addDraw
+  /// \param count      indices to draw
+  /// \param firstIndex offset into the index buffer, in indices
+  /// \param baseVertex added to every index
+  /// \param pDrawData  drawDataSize bytes copied for this draw
+  ///////////////////////////////////////////////////////////////
+  void addDraw (
+                const GLuint count,
+                const GLuint firstIndex,
+                const GLint  baseVertex,
+                const void  *pDrawData
+                );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief submit
+  ///
+  ///        Uploads everything recorded since the last clear and
+  ///        draws it in one call. The program must already be
+  ///        in use.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void submit (
+               const std::shared_ptr< GLuint > &spVao,
+               const std::shared_ptr< GLuint > &spIbo,
+               const GLenum                     mode = GL_TRIANGLES,
+               const GLenum                     iboType = GL_UNSIGNED_SHORT
+               );
+
+
+  void clear ( );
+
+
+  std::size_t
+  size( ) const { return commands_.size( ); }
+
+  bool
+  empty( ) const { return commands_.empty( ); }
+
+
+  static
+  bool isSupported ( );
+
+
+private:
+
+  std::size_t drawDataSize_;
+  GLuint binding_;
+
+  std::vector< DrawElementsCommand > commands_;
+  std::vector< unsigned char > drawData_;
+
+  std::shared_ptr< GLuint > spCommandBuffer_;
+  std::shared_ptr< GLuint > spDrawDataBuffer_;
+
+};
+
+
+} // namespace shg
@@ -0,0 +1,149 @@
+// FrameCapture.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The FrameCapture class
+///
+///        Records the default framebuffer to disk without
+///        stalling the GPU. Each capture starts an asynchronous
+///        glReadPixels into one of a ring of pixel pack buffers
+///        and first maps the frame that buffer received
+///        numBuffers captures ago, whose fence has normally
+///        signaled by then. A worker thread converts and writes
+///        the frames:
+///
+///          *.ppm  one binary PPM per frame (name_000000.ppm, ...)
+///          *.y4m  a single YUV4MPEG2 4:4:4 stream
+///          other  raw RGB8 frames back to back, top row first
+///
+///        If the writer falls behind, or a readback is not done
+///        within a second, frames are dropped rather than slowing
+///        the sim down. Must be created, used and
+///        destroyed with the OpenGL context current.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class FrameCapture
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief FrameCapture
+  /// \param filePath   output file, the extension picks the format
+  /// \param width      captured width in pixels
+  /// \param height     captured height in pixels
+  /// \param fps        frame rate written to Y4M headers
+  /// \param numBuffers pack buffers in the ring (readback latency)
+  ///////////////////////////////////////////////////////////////
+  FrameCapture(
+               const std::string &filePath,
+               const int          width,
+               const int          height,
+               const int          fps = 60,
+               const std::size_t  numBuffers = 3
+               );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ~FrameCapture
+  ///
+  ///        Reads back frames still in flight and waits for the
+  ///        writer to finish.
+  ///
+  ///////////////////////////////////////////////////////////////
+  ~FrameCapture( );
+
+  FrameCapture( const FrameCapture& )            = delete;
+  FrameCapture &operator=( const FrameCapture& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief capture
+  ///
+  ///        Queues a readback of the lower left width x height
+  ///        pixels of the back buffer. Call after rendering and
+  ///        before swapping.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void capture ( );
+
+
+  std::size_t getFramesCaptured ( ) const;
+
+  std::size_t getFramesWritten ( ) const;
+
+  std::size_t getFramesDropped ( ) const;
+
+  std::size_t
+  getStallCount( ) const { return stallCount_; }
+
+
+private:
+
+  enum Format
+  {
+    RAW,
+    PPM,
+    Y4M
+  };
+
+  struct Slot
+  {
+    std::shared_ptr< GLuint > spBuffer;
+    GLsync fence;
+    std::size_t frame;
+  };
+
+  void _readSlot ( Slot &slot );
+
+  void _writeFrames ( );
+
+  void _writeFrame (
+                    const std::vector< unsigned char > &rgba,
+                    const std::size_t                   frame
+                    );
+
+  std::string filePath_;
+  Format format_;
+  int width_;
+  int height_;
+  int fps_;
+
+  std::vector< Slot > slots_;
+  std::size_t nextFrame_;
+  std::size_t stallCount_;
+
+  std::ofstream stream_; ///< raw and y4m output
+
+  // shared with the writer thread
+  mutable std::mutex mutex_;
+  std::condition_variable frameReady_;
+  std::deque< std::pair< std::size_t, std::vector< unsigned char > > > frames_;
+  std::size_t framesWritten_;
+  std::size_t framesDropped_;
+  bool stopping_;
+
+  std::thread writer_;
+
+};
+
+
+} // namespace shg
@@ -0,0 +1,208 @@
+// GpuProfiler.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The GpuProfiler class
+///
+///        Times nested scopes on both the CPU and the GPU. Each
+///        scope writes GL_TIMESTAMP queries at its start and
+///        end. Frames rotate through a ring of query sets and a
+///        frame is only read back once its queries are
+///        available, normally a few frames later, so reading
+///        results never waits on the GPU. If the GPU falls so far
+///        behind that a frame's query set is still busy when it
+///        comes around again, that frame is skipped and counted
+///        as dropped.
+///
+///        Must be created, used and destroyed with the OpenGL
+///        context current.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class GpuProfiler
+{
+
+public:
+
+  ///
+  /// \brief Timing of one scope in a read back frame
+  ///
+  struct ScopeTiming
+  {
+    std::string name;
+    int depth;    ///< number of enclosing scopes
+    double cpuMs;
+    double gpuMs;
+  };
+
+
+  ///
+  /// \brief The Scope class
+  ///
+  ///        Times its own lifetime. A null profiler makes it a
+  ///        no-op so scopes can stay in code with profiling off.
+  ///
+  class Scope
+  {
+
+  public:
+
+    Scope(
+          GpuProfiler       *pProfiler,
+          const std::string &name
+          );
+
+    ~Scope( );
+
+    Scope( const Scope& )            = delete;
+    Scope &operator=( const Scope& ) = delete;
+
+
+  private:
+
+    GpuProfiler *pProfiler_;
+
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief GpuProfiler
+  /// \param latency frames recorded before the oldest is reused
+  ///////////////////////////////////////////////////////////////
+  explicit
+  GpuProfiler( const std::size_t latency = 4 );
+
+
+  ~GpuProfiler( );
+
+  GpuProfiler( const GpuProfiler& )            = delete;
+  GpuProfiler &operator=( const GpuProfiler& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief isSupported
+  /// \return true if the context has timestamp queries
+  ///////////////////////////////////////////////////////////////
+  static
+  bool isSupported ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief beginFrame
+  ///
+  ///        Starts recording into the next query set. Scopes
+  ///        outside beginFrame and endFrame are ignored.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void beginFrame ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief endFrame
+  ///
+  ///        Closes open scopes and reads back every recorded
+  ///        frame whose queries are available.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void endFrame ( );
+
+
+  void beginScope ( const std::string &name );
+
+  void endScope ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getTimings
+  /// \return scopes of the newest read back frame in the order
+  ///         they were started
+  ///////////////////////////////////////////////////////////////
+  const std::vector< ScopeTiming >&
+  getTimings( ) const { return timings_; }
+
+
+  ///
+  /// \brief getTimingsFrame
+  /// \return frame number the timings came from
+  ///
+  std::uint64_t
+  getTimingsFrame( ) const { return timingsFrame_; }
+
+
+  std::uint64_t
+  getFramesDropped( ) const { return framesDropped_; }
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief startCsv
+  ///
+  ///        Appends every frame read back from now on to a CSV
+  ///        file with the columns frame,scope,depth,cpu_ms,gpu_ms.
+  ///        Scope names are always quoted.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void startCsv ( const std::string &filePath );
+
+
+  void stopCsv ( );
+
+
+  bool
+  isWritingCsv( ) const { return csv_.is_open( ); }
+
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  struct Query
+  {
+    std::size_t timing; ///< index into Frame::timings
+    GLuint begin;
+    GLuint end;
+    Clock::time_point cpuStart;
+  };
+
+  struct Frame
+  {
+    std::vector< ScopeTiming > timings;
+    std::vector< Query > queries;
+    std::vector< GLuint > queryPool; ///< pairs, reused every time the frame comes around
+    std::vector< std::size_t > open; ///< stack of open query indices
+    GLuint last;                     ///< last timestamp issued, done once all are
+    std::uint64_t number;
+    bool pending;                    ///< recorded and not read back yet
+  };
+
+  bool _tryRead ( Frame &frame );
+
+  std::vector< Frame > frames_;
+  std::size_t current_;
+  bool recording_;
+
+  std::uint64_t frameNumber_;
+  std::uint64_t framesDropped_;
+
+  std::vector< ScopeTiming > timings_;
+  std::uint64_t timingsFrame_;
+
+  std::ofstream csv_;
+
+};
+
+
+} // namespace shg
@@ -20,6 +20,14 @@ struct VAOSettings;
 class OpenGLWrapper;
 class VulkanGlfwWrapper;
 class OpenGLHelper;
+class ProgramCache;
+class PendingProgram;
+class ShaderReloader;
+class DrawBatch;
+class FrameCapture;
+class TextureLoader;
+class GpuProfiler;
+class StreamingBuffer;
 
 class GlfwWrapper;
 class Callback;
@@ -2,6 +2,9 @@
 #pragma once
 
 #include "shared/graphics/GraphicsForwardDeclarations.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
+#include "shared/graphics/PendingProgram.hpp"
+#include "shared/graphics/UniformTable.hpp"
 
 #include <glad/glad.h>
 
@@ -39,10 +42,38 @@ public:
   static
   void setDefaults ( );
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief setProgramCache
+  ///
+  ///        Programs made by createProgram are loaded from and
+  ///        saved to this cache. Pass nullptr to always compile.
+  ///
+  ///////////////////////////////////////////////////////////////
+  static
+  void setProgramCache ( std::shared_ptr< ProgramCache > spCache );
+
+  static
+  std::shared_ptr< ProgramCache > getProgramCache ( );
+
   template< typename ... Shaders >
   static
   std::shared_ptr< GLuint >  createProgram ( const Shaders ... shaders );
 
+  ///////////////////////////////////////////////////////////////
+  /// \brief createProgramAsync
+  ///
+  ///        Submits every shader and the link without waiting on
+  ///        any of them. Start all programs first, then poll
+  ///        PendingProgram::isReady or call get when needed.
+  ///
+  ///////////////////////////////////////////////////////////////
+  template< typename ... Shaders >
+  static
+  PendingProgram             createProgramAsync ( const Shaders ... shaders );
+
+  static
+  PendingProgram             createProgramAsync ( const std::vector< std::string > &filePaths );
+
   static
   std::shared_ptr< GLuint >  createTextureArray (
                                                  GLsizei width,
@@ -92,6 +123,41 @@ public:
                                        );
 
 
+  ///
+  /// \brief addInstanceAttributes
+  ///
+  ///        Adds per-instance attributes from spInstanceVbo to an
+  ///        existing VAO. Elements with more than 4 floats
+  ///        (e.g. a mat4 with size 16) take consecutive vec4
+  ///        attribute locations.
+  ///
+  static
+  void addInstanceAttributes (
+                              const std::shared_ptr< GLuint > &spVao,
+                              const std::shared_ptr< GLuint > &spProgram,
+                              const std::shared_ptr< GLuint > &spInstanceVbo,
+                              const GLsizei                    totalStride,
+                              const std::vector< VAOElement > &elements,
+                              const GLuint                     divisor = 1
+                              );
+
+  ///
+  /// \brief streamBuffer
+  ///
+  ///        Replaces the whole contents of a buffer that changes
+  ///        every frame. The old storage is orphaned so the
+  ///        driver never waits on draws still reading it.
+  ///
+  template< typename T >
+  static
+  void streamBuffer (
+                     const std::shared_ptr< GLuint > &spBuffer,
+                     const size_t                     numElements,
+                     const T                         *pData,
+                     const GLenum                     bufferType = GL_ARRAY_BUFFER
+                     );
+
+
   static
   std::shared_ptr< GLuint > createFramebuffer (
                                                GLsizei                         width,
@@ -121,10 +187,43 @@ public:
   static
   void clearFramebuffer ( );
 
+  static
+  void useProgram ( const std::shared_ptr< GLuint > &spProgram );
+
+  ///
+  /// \brief deleteProgram
+  ///
+  ///        Deletes program along with its cached uniform table
+  ///        so a later program given the same id never sees
+  ///        stale locations. Use for every program deletion.
+  ///
+  static
+  void deleteProgram ( const GLuint program );
+
+  ///
+  /// \brief getUniform
+  ///
+  ///        Looks the uniform up in the table built when the
+  ///        program was linked. Fetch handles once and use the
+  ///        handle overloads below in render loops.
+  ///
+  static
+  UniformHandle getUniform (
+                            const std::shared_ptr< GLuint > &spProgram,
+                            const std::string               &uniform
+                            );
+
   static
   void setTextureUniform (
                           const std::shared_ptr< GLuint > &spProgram,
-                          const std::string                uniform,
+                          const std::string               &uniform,
+                          const std::shared_ptr< GLuint > &spTexture,
+                          int                              activeTex
+                          );
+
+  static
+  void setTextureUniform (
+                          const UniformHandle             &uniform,
                           const std::shared_ptr< GLuint > &spTexture,
                           int                              activeTex
                           );
@@ -132,31 +231,55 @@ public:
   static
   void setIntUniform (
                       const std::shared_ptr< GLuint > &spProgram,
-                      const std::string                uniform,
+                      const std::string               &uniform,
                       const int                       *pValue,
                       const int                        size = 1,
                       const int                        count = 1
                       );
 
+  static
+  void setIntUniform (
+                      const UniformHandle &uniform,
+                      const int           *pValue,
+                      const int            size = 1,
+                      const int            count = 1
+                      );
+
   static
   void setFloatUniform (
                         const std::shared_ptr< GLuint > &spProgram,
-                        const std::string                uniform,
+                        const std::string               &uniform,
                         const float                     *pValue,
                         const int                        size = 1,
                         const int                        count = 1
                         );
 
+  static
+  void setFloatUniform (
+                        const UniformHandle &uniform,
+                        const float         *pValue,
+                        const int            size = 1,
+                        const int            count = 1
+                        );
+
 
   static
   void setMatrixUniform (
                          const std::shared_ptr< GLuint > &spProgram,
-                         const std::string                uniform,
+                         const std::string               &uniform,
                          const float                     *pValue,
                          const int                        size = 4,
                          const int                        count = 1
                          );
 
+  static
+  void setMatrixUniform (
+                         const UniformHandle &uniform,
+                         const float         *pValue,
+                         const int            size = 4,
+                         const int            count = 1
+                         );
+
   static
   void renderBuffer (
                      const std::shared_ptr< GLuint > &spVao,
@@ -168,6 +291,18 @@ public:
                      const GLenum                     iboType = GL_UNSIGNED_SHORT
                      );
 
+  static
+  void renderBufferInstanced (
+                              const std::shared_ptr< GLuint > &spVao,
+                              const int                        start,
+                              const int                        verts,
+                              const GLenum                     mode,
+                              const int                        instances,
+                              const std::shared_ptr< GLuint > &spIbo = nullptr,
+                              const void                      *pOffset = 0,
+                              const GLenum                     iboType = GL_UNSIGNED_SHORT
+                              );
+
 
 //  void setBlending ( bool blend );
 
@@ -187,30 +322,27 @@ private:
 
   static
   std::shared_ptr< GLuint > _createShader (
-                                           GLenum            shaderType,
-                                           const std::string filePath
+                                           GLenum             shaderType,
+                                           const std::string &source
                                            );
 
   static
-  std::shared_ptr< GLuint > _createShader ( const std::string filePath );
+  void _checkShader (
+                     const GLuint       shader,
+                     const std::string &filePath
+                     );
 
-  template< typename ... Shaders >
   static
-  void _createShader (
-                      IdVec            *pIds,
-                      const std::string filePath
-                      );
+  std::shared_ptr< GLuint > _createProgram ( const std::vector< std::string > &filePaths );
 
-  template< typename ... Shaders >
   static
-  void _createShader (
-                      IdVec            *pIds,
-                      const std::string filePath,
-                      const Shaders ... shaders
-                      );
+  std::shared_ptr< GLuint > _createProgram ( const IdVec shaderIds );
 
   static
-  std::shared_ptr< GLuint > _createProgram ( const IdVec shaderIds );
+  void _checkProgram (
+                      const GLuint program,
+                      const IdVec &shaderIds
+                      );
 };
 
 
@@ -226,55 +358,23 @@ template< typename ... Shaders >
 std::shared_ptr< GLuint >
 OpenGLHelper::createProgram( const Shaders ... shaders )
 {
-  IdVec shaderIds;
-
-  // create and compile all the shaders
-  OpenGLHelper::_createShader( &shaderIds, shaders ... );
-
-  // link shaders and create OpenGL program
-  return OpenGLHelper::_createProgram( shaderIds );
+  return OpenGLHelper::_createProgram( std::vector< std::string >{ shaders ... } );
 }
 
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// \brief OpenGLHelper::_createShader
-///
-///        Base case for templated shader creation functions
+/// \brief OpenGLHelper::createProgramAsync
+/// \param shaders
+/// \return
 ///
 /// \author Logan Barnes
 ////////////////////////////////////////////////////////////////////////////////
 template< typename ... Shaders >
-void
-OpenGLHelper::_createShader(
-                            IdVec            *pIds,
-                            const std::string filePath
-                            )
+PendingProgram
+OpenGLHelper::createProgramAsync( const Shaders ... shaders )
 {
-  // create/compile shader and add it to list of shaders
-  pIds->emplace_back( OpenGLHelper::_createShader( filePath ) );
-}
-
-
-
-////////////////////////////////////////////////////////////////////////////////
-/// \brief OpenGLHelper::_createShader
-///
-/// \author Logan Barnes
-////////////////////////////////////////////////////////////////////////////////
-template< typename ... Shaders >
-void
-OpenGLHelper::_createShader(
-                            IdVec            *pIds,      ///<
-                            const std::string filePath, ///<
-                            const Shaders ... shaders   ///<
-                            )
-{
-  // create/compile shader and add it to list of shaders
-  pIds->emplace_back( OpenGLHelper::_createShader( filePath ) );
-
-  // repeat for the rest of the shaders
-  OpenGLHelper::_createShader( pIds, shaders ... );
+  return OpenGLHelper::createProgramAsync( std::vector< std::string >{ shaders ... } );
 }
 
 
@@ -297,12 +397,12 @@ OpenGLHelper::createBuffer(
   std::shared_ptr< GLuint > upBuffer( new GLuint,
                                      [ ] ( auto pID )
     {
-      glDeleteBuffers( 1, pID );
+      OpenGLStateCache::get( ).deleteBuffers( 1, pID );
       delete pID;
     } );
 
   glGenBuffers( 1, upBuffer.get( ) );
-  glBindBuffer( type, *upBuffer );
+  OpenGLStateCache::get( ).bindBuffer( type, *upBuffer );
   glBufferData(
                type,
                static_cast< GLsizeiptr >( numElements * sizeof( T ) ),
@@ -310,8 +410,6 @@ OpenGLHelper::createBuffer(
                usage
                );
 
-  glBindBuffer( type, 0 );
-
   return upBuffer;
 } // OpenGLHelper::addBuffer
 
@@ -370,19 +468,44 @@ OpenGLHelper::updateBuffer(
 {
   constexpr auto typeSizeBytes = sizeof( T );
 
-  glBindBuffer( bufferType, *upBuffer );
+  OpenGLStateCache::get( ).bindBuffer( bufferType, *upBuffer );
   glBufferSubData(
                   bufferType,
                   static_cast< GLintptr >( elementOffset * typeSizeBytes ),
                   static_cast< GLsizeiptr >( numElements * typeSizeBytes ),
                   pData
                   );
-
-  glBindBuffer( bufferType, 0 );
 } // OpenGLHelper::updateBuffer
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::streamBuffer
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+template< typename T >
+void
+OpenGLHelper::streamBuffer(
+                           const std::shared_ptr< GLuint > &spBuffer,    ///<
+                           const size_t                     numElements, ///<
+                           const T                         *pData,       ///<
+                           const GLenum                     bufferType   ///<
+                           )
+{
+  OpenGLStateCache::get( ).bindBuffer( bufferType, *spBuffer );
+
+  // new storage every call (orphaning), filled in the same call
+  glBufferData(
+               bufferType,
+               static_cast< GLsizeiptr >( numElements * sizeof( T ) ),
+               pData,
+               GL_STREAM_DRAW
+               );
+} // OpenGLHelper::streamBuffer
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief createStandardPipeline
 /// \return
@@ -403,13 +526,7 @@ OpenGLHelper::createStandardPipeline(
 {
   StandardPipeline glIds;
 
-  IdVec shaders;
-  for ( auto &shaderFile : shaderFiles )
-  {
-    shaders.emplace_back(OpenGLHelper::_createShader(shaderFile));
-  }
-
-  glIds.program = OpenGLHelper::_createProgram( shaders );
+  glIds.program = OpenGLHelper::_createProgram( shaderFiles );
 
   glIds.vbo = OpenGLHelper::createBuffer(
                                          pData,
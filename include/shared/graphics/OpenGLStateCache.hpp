@@ -0,0 +1,188 @@
+// OpenGLStateCache.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The OpenGLStateCache class
+///
+///        Shadows the object bindings of one OpenGL context and
+///        drops binds that would not change anything. There is a
+///        cache per GLFW context, found through the context
+///        current on the calling thread, so switching contexts
+///        or moving one to another thread needs no extra calls.
+///        Functions mirror the GL calls they replace, deletes
+///        included, so deleted ids that get reused are never
+///        mistaken for a cached binding. Deletes are only seen by
+///        the current context's cache, so objects shared between
+///        contexts must be deleted with the others invalidated.
+///
+///        Every bind made through OpenGLHelper, OpenGLWrapper and
+///        StreamingBuffer goes through here. Code that binds
+///        objects directly without restoring them must call
+///        invalidate( ) before the cache is used again.
+///        GlfwWrapper calls releaseContext before destroying its
+///        window, other code creating contexts must do the same.
+///
+///        Element array bindings belong to the bound vertex array
+///        and are tracked per vertex array.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class OpenGLStateCache
+{
+
+public:
+
+  ///
+  /// \brief Binds issued to the driver and binds skipped
+  ///        because the object was already bound
+  ///
+  struct Counters
+  {
+    std::size_t issued  = 0;
+    std::size_t skipped = 0;
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief get
+  /// \return cache for the context current on the calling thread,
+  ///         created on first use
+  ///////////////////////////////////////////////////////////////
+  static
+  OpenGLStateCache &get ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief releaseContext
+  ///
+  ///        Drops the cache of a context about to be destroyed
+  ///        so a new context at the same address starts clean.
+  ///        References returned by get for it become invalid.
+  ///
+  ///////////////////////////////////////////////////////////////
+  static
+  void releaseContext ( const void *pContext );
+
+
+  void bindBuffer (
+                   const GLenum target,
+                   const GLuint buffer
+                   );
+
+  void bindVertexArray ( const GLuint vertexArray );
+
+  void useProgram ( const GLuint program );
+
+  void activeTexture ( const GLenum unit );
+
+  void bindTexture (
+                    const GLenum target,
+                    const GLuint texture
+                    );
+
+  void bindFramebuffer (
+                        const GLenum target,
+                        const GLuint framebuffer
+                        );
+
+
+  void deleteBuffers (
+                      const GLsizei n,
+                      const GLuint *pBuffers
+                      );
+
+  void deleteVertexArrays (
+                           const GLsizei n,
+                           const GLuint *pVertexArrays
+                           );
+
+  void deleteProgram ( const GLuint program );
+
+  void deleteTextures (
+                       const GLsizei n,
+                       const GLuint *pTextures
+                       );
+
+  void deleteFramebuffers (
+                           const GLsizei n,
+                           const GLuint *pFramebuffers
+                           );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief invalidate
+  ///
+  ///        Forgets every cached binding so the next bind of
+  ///        each kind is always issued. Needed after foreign GL
+  ///        code changed bindings of this context.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void invalidate ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief endFrame
+  ///
+  ///        Makes the counters gathered since the last call
+  ///        available through getFrameCounters and restarts
+  ///        them.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void endFrame ( );
+
+
+  ///
+  /// \brief getFrameCounters
+  /// \return counters of the last completed frame
+  ///
+  const Counters&
+  getFrameCounters( ) const { return lastFrame_; }
+
+
+private:
+
+  OpenGLStateCache( );
+
+  static
+  std::unordered_map< const void*, std::unique_ptr< OpenGLStateCache > > &_caches ( );
+
+  bool _changed (
+                 GLuint      &cached,
+                 const GLuint id
+                 );
+
+  static
+  void _forget (
+                std::unordered_map< std::uint64_t, GLuint > &map,
+                const GLuint                                 id
+                );
+
+  std::unordered_map< std::uint64_t, GLuint > buffers_;        ///< by target
+  std::unordered_map< std::uint64_t, GLuint > elementBuffers_; ///< by vertex array
+  std::unordered_map< std::uint64_t, GLuint > textures_;       ///< by unit and target
+
+  GLuint vertexArray_;
+  GLuint program_;
+  GLuint activeTexture_;
+  GLuint drawFramebuffer_;
+  GLuint readFramebuffer_;
+
+  Counters current_;
+  Counters lastFrame_;
+
+};
+
+
+} // namespace shg
@@ -2,11 +2,12 @@
 #pragma once
 
 #include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/core/HandleRegistry.hpp"
 
+#include <functional>
 #include <string>
 #include <sstream>
 #include <vector>
-#include <unordered_map>
 
 
 namespace shg
@@ -52,15 +53,65 @@ struct FrameBuffer
 };
 
 
+///
+/// \brief The Program struct
+///
+struct Program
+{
+  GLuint id;
+  UniformTable uniforms;
+};
+
+
+///
+/// \brief The Texture struct
+///
+struct Texture
+{
+  GLuint id;
+};
+
+
+///
+/// \brief The IndexBuffer struct
+///
+struct IndexBuffer
+{
+  GLuint ibo;
+};
+
+
 class CallbackSingleton;
 class Callback;
 
 
+///
+/// \brief The OpenGLWrapper class
+///
+///        Resources live in handle registries. Names are looked up
+///        in a hash map, so code that draws every frame should
+///        resolve them to handles once with the get*Handle
+///        functions and use the handle overloads, which validate
+///        the handle and index straight into an array.
+///
+///        Every context the wrapper draws with must share objects
+///        with the others. Vertex arrays can not be shared, so each
+///        context gets its own table of them, indexed by buffer
+///        handle and filled when buffers are added or the context
+///        is made current rather than in the middle of a frame.
+///
 class OpenGLWrapper
 {
 
 public:
 
+  typedef shs::Handle< Program > ProgramHandle;
+  typedef shs::Handle< Texture > TextureHandle;
+  typedef shs::Handle< Buffer > BufferHandle;
+  typedef shs::Handle< IndexBuffer > IndexBufferHandle;
+  typedef shs::Handle< FrameBuffer > FramebufferHandle;
+
+
   explicit
   OpenGLWrapper( );
 
@@ -71,16 +122,26 @@ public:
                     GLsizei height = 480
                     );
 
+  // name to handle lookups, these throw for unknown names
+  ProgramHandle getProgramHandle ( const std::string &name ) const;
+  TextureHandle getTextureHandle ( const std::string &name ) const;
+  BufferHandle getBufferHandle ( const std::string &name ) const;
+  IndexBufferHandle getIndexBufferHandle ( const std::string &name ) const;
+  FramebufferHandle getFramebufferHandle ( const std::string &name ) const;
+
   // getters and setters
-  GLuint getTexture ( const std::string name );
-  void setTexture (
-                   const std::string name,
-                   const GLuint      id,
-                   const bool        forceOverride = false,
-                   const bool        forceDelete = false
-                   );
+  GLuint getTexture ( const std::string &name );
+  GLuint getTexture ( const TextureHandle texture );
+
+  TextureHandle setTexture (
+                            const std::string &name,
+                            const GLuint       id,
+                            const bool         forceOverride = false,
+                            const bool         forceDelete = false
+                            );
 
-  GLuint getBuffer ( const std::string name );
+  GLuint getBuffer ( const std::string &name );
+  GLuint getBuffer ( const BufferHandle buffer );
 
   GLsizei
   getViewportWidth( ) { return viewportWidth_; }
@@ -89,66 +150,83 @@ public:
   getViewportHeight( ) { return viewportHeight_; }
 
 
-  void addProgram (
-                   const std::string name,
-                   const std::string vertFilePath,
-                   const std::string fragFilePath
-                   );
+  ProgramHandle addProgram (
+                            const std::string &name,
+                            const std::string &vertFilePath,
+                            const std::string &fragFilePath
+                            );
 
-  void addTextureArray (
-                        const std::string name,
-                        GLsizei           width,
-                        GLsizei           height,
-                        float            *pArray = NULL,
-                        bool              linear = false
-                        );
+  TextureHandle addTextureArray (
+                                 const std::string &name,
+                                 GLsizei            width,
+                                 GLsizei            height,
+                                 float             *pArray = NULL,
+                                 bool               linear = false
+                                 );
+
+  TextureHandle addTextureImage (
+                                 const std::string &name,
+                                 GLsizei            width,
+                                 GLsizei            height,
+                                 const std::string &filename
+                                 );
 
-  void addTextureImage (
-                        const std::string name,
-                        GLsizei           width,
-                        GLsizei           height,
-                        const std::string filename
-                        );
+  template< typename T >
+  BufferHandle addBuffer (
+                          const std::string &name,
+                          const T           *pData,
+                          const size_t       numElements,
+                          const GLenum       type,
+                          const VAOSettings &settings,
+                          const bool         forceOverride = false
+                          );
 
   template< typename T >
-  void addBuffer (
-                  const std::string  name,
-                  const T           *pData,
-                  const size_t       numElements,
-                  const GLenum       type,
-                  const VAOSettings &settings,
-                  const bool         forceOverride = false
-                  );
+  IndexBufferHandle addIndexBuffer (
+                                    const std::string &name,
+                                    const T           *pData,
+                                    const size_t       numElements,
+                                    const GLenum       type,
+                                    const bool         forceOverride = false
+                                    );
 
   template< typename T >
-  void addIndexBuffer (
-                       const std::string name,
-                       const T          *pData,
-                       const size_t      numElements,
-                       const GLenum      type,
-                       const bool        forceOverride = false
-                       );
+  void updateBuffer (
+                     const std::string &bufferName,
+                     const size_t       elementOffset,
+                     const size_t       numElements,
+                     const float       *pData,
+                     const GLenum       bufferType = GL_ARRAY_BUFFER
+                     );
 
   template< typename T >
   void updateBuffer (
-                     const std::string bufferName,
-                     const size_t      elementOffset,
-                     const size_t      numElements,
-                     const float      *pData,
-                     const GLenum      bufferType = GL_ARRAY_BUFFER
+                     const BufferHandle buffer,
+                     const size_t       elementOffset,
+                     const size_t       numElements,
+                     const float       *pData,
+                     const GLenum       bufferType = GL_ARRAY_BUFFER
                      );
 
 
-  void addFramebuffer (
-                       const std::string buffer,
-                       GLsizei           width,
-                       GLsizei           height,
-                       const std::string texture
-                       );
-  void bindFramebuffer ( const std::string name = "" );
+  FramebufferHandle addFramebuffer (
+                                    const std::string &buffer,
+                                    GLsizei            width,
+                                    GLsizei            height,
+                                    const std::string &texture
+                                    );
+
+  void bindFramebuffer ( const std::string &name = "" );
+  void bindFramebuffer ( const FramebufferHandle framebuffer );
+
+  void swapFramebuffers (
+                         const std::string &fbo1,
+                         const std::string &fbo2
+                         );
+
   void swapFramebuffers (
-                         const std::string fbo1,
-                         const std::string fbo2
+                         const FramebufferHandle fbo1,
+                         const FramebufferHandle fbo2
                          );
 
   void clearWindow (
@@ -163,55 +241,93 @@ public:
                     GLsizei height
                     );
 
-  void useProgram ( const std::string program );
+  void useProgram ( const std::string &program );
+  void useProgram ( const ProgramHandle program );
 
   void renderBuffer (
-                     const std::string buffer,
-                     const int         start,
-                     const int         verts,
-                     const GLenum      mode,
-                     const std::string ibo = "",
-                     const void       *pOffset = 0,
-                     const GLenum      iboType = GL_UNSIGNED_SHORT
+                     const std::string &buffer,
+                     const int          start,
+                     const int          verts,
+                     const GLenum       mode,
+                     const std::string &ibo = "",
+                     const void        *pOffset = 0,
+                     const GLenum       iboType = GL_UNSIGNED_SHORT
                      );
 
+  void renderBuffer (
+                     const BufferHandle      buffer,
+                     const int               start,
+                     const int               verts,
+                     const GLenum            mode,
+                     const IndexBufferHandle ibo = IndexBufferHandle( ),
+                     const void             *pOffset = 0,
+                     const GLenum            iboType = GL_UNSIGNED_SHORT
+                     );
+
+
+  ///
+  /// \brief getUniform
+  /// \return handle for use with OpenGLHelper's handle
+  ///         based setters
+  ///
+  UniformHandle getUniform (
+                            const std::string &program,
+                            const std::string &uniform
+                            );
+
+  UniformHandle getUniform (
+                            const ProgramHandle program,
+                            const std::string  &uniform
+                            );
 
   void setTextureUniform (
-                          const std::string program,
-                          const std::string uniform,
-                          const std::string texture,
-                          int               activeTex
+                          const std::string &program,
+                          const std::string &uniform,
+                          const std::string &texture,
+                          int                activeTex
                           );
+
+  void setTextureUniform (
+                          const UniformHandle &uniform,
+                          const TextureHandle  texture,
+                          int                  activeTex
+                          );
+
   void setBoolUniform (
-                       const std::string program,
-                       const std::string uniform,
-                       bool              var
+                       const std::string &program,
+                       const std::string &uniform,
+                       bool               var
                        );
   void setIntUniform (
-                      const std::string program,
-                      const std::string uniform,
-                      int               value
+                      const std::string &program,
+                      const std::string &uniform,
+                      int                value
                       );
 
   void setFloatUniform (
-                        const std::string program,
-                        const std::string uniform,
-                        const float      *pValue,
-                        const int         size  = 1,
-                        const int         count = 1
+                        const std::string &program,
+                        const std::string &uniform,
+                        const float       *pValue,
+                        const int          size  = 1,
+                        const int          count = 1
                         );
 
   void setMatrixUniform (
-                         const std::string program,
-                         const std::string uniform,
-                         const float      *pValue,
-                         const int         size  = 4,
-                         const int         count = 1
+                         const std::string &program,
+                         const std::string &uniform,
+                         const float       *pValue,
+                         const int          size  = 4,
+                         const int          count = 1
                          );
 
   void swapTextures (
-                     const std::string tex1,
-                     const std::string tex2
+                     const std::string &tex1,
+                     const std::string &tex2
+                     );
+
+  void swapTextures (
+                     const TextureHandle tex1,
+                     const TextureHandle tex2
                      );
 
   void setBlending ( bool blend );
@@ -228,11 +344,11 @@ public:
                         );
 
   void bindBufferToTexture (
-                            const std::string texture,
-                            GLuint            bufId,
-                            int               alignment,
-                            int               width,
-                            int               height
+                            const std::string &texture,
+                            GLuint             bufId,
+                            int                alignment,
+                            int                width,
+                            int                height
                             );
 
   void setClearColor (
@@ -243,14 +359,49 @@ public:
                       );
 
   void destroyTexture (
-                       const std::string name,
-                       const bool        glDelete = true
+                       const std::string &name,
+                       const bool         glDelete = true
                        );
-  void destroyFramebuffer ( const std::string name );
 
+  void destroyTexture (
+                       const TextureHandle texture,
+                       const bool          glDelete = true
+                       );
+
+  void destroyFramebuffer ( const std::string &name );
+  void destroyFramebuffer ( const FramebufferHandle framebuffer );
+
+
+  ///
+  /// \brief registerContext
+  ///
+  ///        Adds a context sharing objects with the wrapper.
+  ///        With makeCurrent the context's vertex arrays are
+  ///        built as soon as buffers are added, even while
+  ///        another registered context with its own makeCurrent
+  ///        is current. Without it they are built the next time
+  ///        the context is passed to setCurrentContext.
+  ///
+  void registerContext (
+                        void                          *pContext,
+                        const std::function< void( ) > makeCurrent = nullptr
+                        );
 
-  void
-  setCurrentContext( void *pContext ) { pContext_ = pContext; }
+  ///
+  /// \brief setCurrentContext
+  ///
+  ///        Tells the wrapper which context is current. Unknown
+  ///        contexts are registered. The first context set is
+  ///        assumed to be the one used before any was set.
+  ///
+  void setCurrentContext ( void *pContext );
+
+  ///
+  /// \brief getVertexArrayCount
+  /// \return vertex arrays built so far in pContext,
+  ///         0 for unknown contexts
+  ///
+  std::size_t getVertexArrayCount ( const void *pContext ) const;
 
 
 private:
@@ -264,58 +415,96 @@ private:
                       const std::string fragment_path
                       );
 
-  GLuint _getVAO ( const Buffer &buf );
+  GLint _getUniformLocation (
+                              const std::string &program,
+                              const std::string &uniform
+                              );
+
+  GLuint _getVAO (
+                  const BufferHandle handle,
+                  const Buffer      &buf
+                  );
 
   GLuint _addVAOToBuffer (
                           const GLuint       vbo,
                           const VAOSettings &settings
                           ) const;
 
+  ///
+  /// \brief The ContextVAOs struct
+  ///
+  struct ContextVAOs
+  {
+    void *pContext;
+    std::function< void( ) > makeCurrent;
+    std::vector< GLuint > vaos;         ///< buffer handle index -> vertex array, 0 if not built
+    std::vector< GLuint > orphanedVaos; ///< deleted once the context is current
+    bool dirty;                         ///< buffers or programs changed since the last build
+  };
+
+  std::size_t _findContext ( void *pContext );
+
+  bool _inContext (
+                   const std::size_t                            index,
+                   const std::function< void( ContextVAOs& ) > &function
+                   );
 
-  template< typename Map >
-  static
-  void _checkItemExists (
-                         const std::string &key,
-                         const Map         &map,
-                         const std::string &mapDiscription = ""
-                         );
+  void _buildVAOs ( );
+  void _buildContextVAOs ( ContextVAOs &context );
+  void _orphanVAOs ( const BufferHandle buffer );
 
+  TextureHandle _addTexture (
+                             const std::string &name,
+                             const GLuint       id
+                             );
 
-  template< typename Map, typename Val, typename DeleteFunction >
-  static
-  void _replaceItemId (
-                       const std::string &key,
-                       Map               &map,
-                       const Val         val,
-                       const std::string &mapDiscription = "",
-                       const bool        forceOverride = false,
-                       const bool        forceDelete = false,
-                       DeleteFunction    delFunc = [] ( ) {}
-                       );
 
+  ///
+  /// \brief _get
+  /// \return the live resource behind handle
+  /// \throws std::runtime_error for dead handles
+  ///
+  template< typename T >
+  static
+  T &_get (
+           shs::HandleRegistry< T > &registry,
+           const shs::Handle< T >    handle,
+           const char               *description
+           );
+
+
+  ///
+  /// \brief _find
+  /// \return the handle registered as name
+  /// \throws std::runtime_error for unknown names
+  ///
+  template< typename T >
+  static
+  shs::Handle< T > _find (
+                          const shs::HandleRegistry< T > &registry,
+                          const std::string              &name,
+                          const char                     *description
+                          );
 
-  std::unordered_map< std::string, GLuint > programs_;
-  std::unordered_map< std::string, GLuint > textures_;
-  std::unordered_map< std::string, Buffer > buffers_;
-  std::unordered_map< std::string, unsigned > indexBuffers_;
-  std::unordered_map< std::string, FrameBuffer > framebuffers_;
 
-  typedef std::unordered_map< void*, GLuint > ContextVAOMap;
-  typedef std::unordered_map< GLuint, ContextVAOMap > BufferVAOMap;
+  shs::HandleRegistry< Program > programs_;
+  shs::HandleRegistry< Texture > textures_;
+  shs::HandleRegistry< Buffer > buffers_;
+  shs::HandleRegistry< IndexBuffer > indexBuffers_;
+  shs::HandleRegistry< FrameBuffer > framebuffers_;
 
-  BufferVAOMap vaoMap_;
+  std::vector< ContextVAOs > contexts_;
+  std::size_t currentContext_;
 
   GLsizei viewportWidth_, viewportHeight_;
-
-  void *pContext_;
 };
 
 
 
 template< typename T >
-void
+OpenGLWrapper::BufferHandle
 OpenGLWrapper::addBuffer(
-                         const std::string  name,
+                         const std::string &name,
                          const T           *pData,
                          const size_t       numElements,
                          const GLenum       type,
@@ -323,7 +512,9 @@ OpenGLWrapper::addBuffer(
                          const bool         forceOverride
                          )
 {
-  if ( buffers_.find( name ) != buffers_.end( ) )
+  BufferHandle handle = buffers_.find( name );
+
+  if ( handle.isValid( ) )
   {
     if ( !forceOverride )
     {
@@ -332,15 +523,18 @@ OpenGLWrapper::addBuffer(
       throw std::runtime_error( msg.str( ) );
     }
 
-    Buffer &buffer = buffers_[ name ];
-    vaoMap_.erase( buffer.vbo );
-    glDeleteBuffers( 1, &buffer.vbo );
+    _orphanVAOs( handle );
+    OpenGLStateCache::get( ).deleteBuffers( 1, &buffers_.get( handle )->vbo );
+  }
+  else
+  {
+    handle = buffers_.create( Buffer( ), name );
   }
 
-  Buffer &buffer = buffers_[ name ];
+  Buffer &buffer = *buffers_.get( handle );
 
   glGenBuffers( 1, &buffer.vbo );
-  glBindBuffer( GL_ARRAY_BUFFER, buffer.vbo );
+  OpenGLStateCache::get( ).bindBuffer( GL_ARRAY_BUFFER, buffer.vbo );
   glBufferData(
                GL_ARRAY_BUFFER,
                static_cast< GLsizeiptr >( numElements * sizeof( T ) ),
@@ -348,24 +542,28 @@ OpenGLWrapper::addBuffer(
                type
                );
 
-  glBindBuffer( GL_ARRAY_BUFFER, 0 );
-
   buffer.settings = settings;
+
+  _buildVAOs( );
+
+  return handle;
 } // OpenGLWrapper::addBuffer
 
 
 
 template< typename T >
-void
+OpenGLWrapper::IndexBufferHandle
 OpenGLWrapper::addIndexBuffer(
-                              const std::string name,
-                              const T          *pData,
-                              const size_t      numElements,
-                              const GLenum      type,
-                              const bool        forceOverride
+                              const std::string &name,
+                              const T           *pData,
+                              const size_t       numElements,
+                              const GLenum       type,
+                              const bool         forceOverride
                               )
 {
-  if ( indexBuffers_.find( name ) != indexBuffers_.end( ) )
+  IndexBufferHandle handle = indexBuffers_.find( name );
+
+  if ( handle.isValid( ) )
   {
     if ( !forceOverride )
     {
@@ -374,14 +572,17 @@ OpenGLWrapper::addIndexBuffer(
       throw std::runtime_error( msg.str( ) );
     }
 
-    GLuint &ibo = indexBuffers_[ name ];
-    glDeleteBuffers( 1, &ibo );
+    OpenGLStateCache::get( ).deleteBuffers( 1, &indexBuffers_.get( handle )->ibo );
+  }
+  else
+  {
+    handle = indexBuffers_.create( IndexBuffer( ), name );
   }
 
-  GLuint &ibo = indexBuffers_[ name ];
+  GLuint &ibo = indexBuffers_.get( handle )->ibo;
 
   glGenBuffers( 1, &ibo );
-  glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ibo );
+  OpenGLStateCache::get( ).bindBuffer( GL_ELEMENT_ARRAY_BUFFER, ibo );
   glBufferData(
                GL_ELEMENT_ARRAY_BUFFER,
                static_cast< GLsizeiptr >( numElements * sizeof( T ) ),
@@ -389,7 +590,7 @@ OpenGLWrapper::addIndexBuffer(
                type
                );
 
-  glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+  return handle;
 } // OpenGLWrapper::addIndexBuffer
 
 
@@ -397,79 +598,87 @@ OpenGLWrapper::addIndexBuffer(
 template< typename T >
 void
 OpenGLWrapper::updateBuffer(
-                            const std::string bufferName,
-                            const size_t      elementOffset,
-                            const size_t      numElements,
-                            const float      *pData,
-                            const GLenum      bufferType
+                            const std::string &bufferName,
+                            const size_t       elementOffset,
+                            const size_t       numElements,
+                            const float       *pData,
+                            const GLenum       bufferType
                             )
 {
-  _checkItemExists( bufferName, buffers_, "buffer" );
+  updateBuffer< T >(
+                    _find( buffers_, bufferName, "buffer" ),
+                    elementOffset,
+                    numElements,
+                    pData,
+                    bufferType
+                    );
+}
+
 
-  Buffer &buffer = buffers_[ bufferName ];
 
+template< typename T >
+void
+OpenGLWrapper::updateBuffer(
+                            const BufferHandle buffer,
+                            const size_t       elementOffset,
+                            const size_t       numElements,
+                            const float       *pData,
+                            const GLenum       bufferType
+                            )
+{
   constexpr auto floatSize = sizeof( float );
 
-  glBindBuffer( bufferType, buffer.vbo );
+  OpenGLStateCache::get( ).bindBuffer( bufferType, _get( buffers_, buffer, "buffer" ).vbo );
   glBufferSubData(
                   bufferType,
                   static_cast< GLintptr >( elementOffset * floatSize ),
                   static_cast< GLsizeiptr >( numElements * floatSize ),
                   pData
                   );
-
-  glBindBuffer( bufferType, 0 );
 } // OpenGLWrapper::updateBuffer
 
 
 
-template< typename Map >
-void
-OpenGLWrapper::_checkItemExists(
-                                const std::string &key,
-                                const Map         &map,
-                                const std::string &mapDiscription
-                                )
+template< typename T >
+T&
+OpenGLWrapper::_get(
+                    shs::HandleRegistry< T > &registry,
+                    const shs::Handle< T >    handle,
+                    const char               *description
+                    )
 {
-  if ( map.find( key ) == map.end( ) )
+  T *pItem = registry.get( handle );
+
+  if ( !pItem )
   {
     std::stringstream msg;
-    msg << "Item '" << key << "' not found in " << mapDiscription << " map.";
+    msg << "Invalid or destroyed " << description << " handle.";
     throw std::runtime_error( msg.str( ) );
   }
+
+  return *pItem;
 }
 
 
 
-template< typename Map, typename Val, typename DeleteFunction >
-void
-OpenGLWrapper::_replaceItemId(
-                              const std::string &key,
-                              Map               &map,
-                              const Val          val,
-                              const std::string &mapDiscription,
-                              const bool         forceOverride,
-                              const bool         forceDelete,
-                              DeleteFunction     delFunc
-                              )
+template< typename T >
+shs::Handle< T >
+OpenGLWrapper::_find(
+                     const shs::HandleRegistry< T > &registry,
+                     const std::string              &name,
+                     const char                     *description
+                     )
 {
-  if ( map.find( key ) != map.end( ) && map.at( key ) != val )
-  {
-    if ( !forceOverride )
-    {
-      std::stringstream msg;
-      msg << "Item '" << key << "' already exists in "
-          << mapDiscription << " map and 'forceOverride' is false.";
-      throw std::runtime_error( msg.str( ) );
-    }
+  const shs::Handle< T > handle = registry.find( name );
 
-    if ( forceDelete )
-    {
-      delFunc( );
-    }
+  if ( !handle.isValid( ) )
+  {
+    std::stringstream msg;
+    msg << "Item '" << name << "' not found in " << description << " registry.";
+    throw std::runtime_error( msg.str( ) );
   }
 
-  map[ key ] = val;
+  return handle;
 }
 
 
@@ -0,0 +1,86 @@
+// PendingProgram.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <functional>
+#include <memory>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The PendingProgram class
+///
+///        A program whose shaders have been submitted for
+///        compiling and linking but whose status has not been
+///        checked yet (see OpenGLHelper::createProgramAsync).
+///        With GL_KHR/ARB_parallel_shader_compile the driver
+///        builds it on its own threads and isReady polls
+///        GL_COMPLETION_STATUS without blocking. Without the
+///        extension it always reports ready and get blocks.
+///
+///        Must only be used with the creating context current.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class PendingProgram
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief PendingProgram
+  /// \param spProgram program with its link already issued
+  /// \param finish    checks compile and link status, throwing
+  ///                  std::runtime_error on failure
+  ///////////////////////////////////////////////////////////////
+  PendingProgram(
+                 std::shared_ptr< GLuint > spProgram,
+                 std::function< void( ) >  finish
+                 );
+
+  PendingProgram( PendingProgram&& )            = default;
+  PendingProgram &operator=( PendingProgram&& ) = default;
+
+  PendingProgram( const PendingProgram& )            = delete;
+  PendingProgram &operator=( const PendingProgram& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief isReady
+  /// \return true if get will not wait on the driver
+  ///////////////////////////////////////////////////////////////
+  bool isReady ( ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief get
+  ///
+  ///        Waits for the program if needed and checks it the
+  ///        first time it is called. Throws std::runtime_error
+  ///        with the driver's log if compiling or linking failed.
+  ///
+  ///////////////////////////////////////////////////////////////
+  std::shared_ptr< GLuint > get ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief isParallelCompileSupported
+  /// \return true if the current context compiles in parallel
+  ///////////////////////////////////////////////////////////////
+  static
+  bool isParallelCompileSupported ( );
+
+
+private:
+
+  std::shared_ptr< GLuint > spProgram_;
+  std::function< void( ) > finish_; ///< empty once checked
+
+};
+
+
+} // namespace shg
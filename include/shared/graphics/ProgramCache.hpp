@@ -0,0 +1,104 @@
+// ProgramCache.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The ProgramCache class
+///
+///        Stores linked program binaries on disk so later runs
+///        skip compiling and linking shaders. Entries are keyed
+///        by a hash of every shader stage and source along with
+///        the GL vendor, renderer and version, so a driver update
+///        or an edited shader (defines included) never loads an
+///        old binary. A binary the driver rejects anyway counts
+///        as stale and is rebuilt.
+///
+///        Must be created with the OpenGL context current. Does
+///        nothing (every lookup misses) when the driver offers
+///        no program binary formats.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class ProgramCache
+{
+
+public:
+
+  struct Stats
+  {
+    std::size_t hits   = 0;
+    std::size_t misses = 0;
+    std::size_t stale  = 0; ///< binaries the driver refused (also misses)
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ProgramCache
+  /// \param directory existing directory the binaries live in
+  ///////////////////////////////////////////////////////////////
+  explicit
+  ProgramCache( const std::string &directory );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief makeKey
+  /// \param parts everything the program is built from, e.g.
+  ///              each stage's file extension and source
+  ///////////////////////////////////////////////////////////////
+  std::uint64_t makeKey ( const std::vector< std::string > &parts ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief load
+  /// \return new linked program from the binary stored for key
+  ///         or 0 if there is none or it is stale
+  ///////////////////////////////////////////////////////////////
+  GLuint load ( const std::uint64_t key );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief store
+  ///
+  ///        Saves the binary of program (linked with
+  ///        GL_PROGRAM_BINARY_RETRIEVABLE_HINT) under key.
+  ///        Failures only cost the next run a compile.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void store (
+              const std::uint64_t key,
+              const GLuint        program
+              ) const;
+
+
+  bool
+  isSupported( ) const { return supported_; }
+
+  const Stats&
+  getStats( ) const { return stats_; }
+
+
+private:
+
+  std::string _getPath ( const std::uint64_t key ) const;
+
+  std::string directory_;
+  std::string driver_;
+  bool supported_;
+
+  Stats stats_;
+
+};
+
+
+} // namespace shg
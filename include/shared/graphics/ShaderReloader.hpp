@@ -0,0 +1,108 @@
+// ShaderReloader.hpp
+#pragma once
+
+#include "shared/graphics/PendingProgram.hpp"
+
+#include <glad/glad.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The ShaderReloader class
+///
+///        Watches shader files and rebuilds the programs made
+///        from them when they change. Rebuilds go through
+///        OpenGLHelper::createProgramAsync, so update never
+///        waits on the compiler; a program is only handed to
+///        its callback once it has linked. If the new sources
+///        fail to compile or link the old program stays in use
+///        and the error is kept for getLastError.
+///
+///        Uses inotify on Linux and file modification times
+///        everywhere else.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class ShaderReloader
+{
+
+public:
+
+  typedef std::function< void( const std::shared_ptr< GLuint >& ) > ReloadCallback;
+
+
+  ShaderReloader( );
+
+  ~ShaderReloader( );
+
+  ShaderReloader( const ShaderReloader& )            = delete;
+  ShaderReloader &operator=( const ShaderReloader& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief watch
+  /// \param filePaths shaders the program was created from
+  /// \param onReload  receives each successfully rebuilt program
+  ///                  (from inside update)
+  ///////////////////////////////////////////////////////////////
+  void watch (
+              const std::vector< std::string > &filePaths,
+              ReloadCallback                    onReload
+              );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief update
+  ///
+  ///        Starts rebuilds for changed files and swaps in the
+  ///        ones that finished. Call once per frame, between
+  ///        frames, with the context current.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void update ( );
+
+
+  std::size_t
+  getReloadCount( ) const { return reloadCount_; }
+
+  const std::string&
+  getLastError( ) const { return lastError_; }
+
+
+private:
+
+  struct WatchedProgram
+  {
+    std::vector< std::string > filePaths;
+    std::vector< long long > modifiedTimes; ///< only used without inotify
+    ReloadCallback onReload;
+
+    bool changed;
+    std::unique_ptr< PendingProgram > upPending;
+  };
+
+  void _markChanged ( const std::string &filePath );
+
+  void _pollChanges ( );
+
+  std::vector< WatchedProgram > programs_;
+
+  int inotify_; ///< -1 when falling back to modification times
+  std::unordered_map< int, std::string > directories_; ///< watch descriptor -> directory
+
+  std::size_t reloadCount_;
+  std::string lastError_;
+
+};
+
+
+} // namespace shg
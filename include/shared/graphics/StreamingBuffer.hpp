@@ -0,0 +1,210 @@
+// StreamingBuffer.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The StreamingBuffer class
+///
+///        A buffer split into numRegions equal regions, one per
+///        frame in flight. Each frame writes into its own region
+///        while the GPU is still reading the previous ones, and a
+///        fence per region keeps the CPU from overwriting data
+///        that has not been consumed yet.
+///
+///        With glBufferStorage (GL 4.4 or ARB_buffer_storage) the
+///        buffer is mapped once, persistently and coherently, so
+///        writes go straight to GPU visible memory. Otherwise each
+///        region is mapped unsynchronized for the frame instead.
+///
+///        Usage per frame:
+///
+///          beginFrame( );
+///          offset = write( pData, count );  // any number of times
+///          finishWrites( );
+///          ... draws sourcing getBuffer( ) at offset ...
+///          endFrame( );
+///
+///        Without persistent mapping the region stays mapped
+///        until finishWrites, and drawing from a mapped buffer
+///        is an error, so finishWrites must come before the
+///        first draw that sources the buffer.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class StreamingBuffer
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief StreamingBuffer
+  /// \param regionSize bytes available to each frame
+  /// \param numRegions frames that can be in flight at once
+  /// \param target     binding point used to create the buffer
+  ///////////////////////////////////////////////////////////////
+  explicit
+  StreamingBuffer(
+                  const GLsizeiptr regionSize,
+                  const unsigned   numRegions = 3,
+                  const GLenum     target = GL_ARRAY_BUFFER
+                  );
+
+  ~StreamingBuffer( );
+
+  StreamingBuffer( const StreamingBuffer& )            = delete;
+  StreamingBuffer &operator=( const StreamingBuffer& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief beginFrame
+  ///
+  ///        Moves to the next region, waiting only if the GPU
+  ///        has not finished the frame that last used it.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void beginFrame ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief finishWrites
+  ///
+  ///        Ends this frame's writes, unmapping the region when
+  ///        it is not persistently mapped. Call before drawing
+  ///        from the buffer. endFrame calls it if needed.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void finishWrites ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief endFrame
+  ///
+  ///        Fences the current region. Call after the last draw
+  ///        reading this frame's data has been issued.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void endFrame ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief allocate
+  /// \return offset into the buffer of bytes free bytes in the
+  ///         current region, aligned to alignment (a power of 2)
+  ///
+  ///         Throws std::runtime_error if the region is full
+  ///         or finishWrites has already been called.
+  ///////////////////////////////////////////////////////////////
+  GLintptr allocate (
+                     const GLsizeiptr bytes,
+                     const GLsizeiptr alignment = 16
+                     );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief write
+  /// \return offset of the copied elements within the buffer
+  ///////////////////////////////////////////////////////////////
+  template< typename T >
+  GLintptr write (
+                  const T          *pData,
+                  const std::size_t numElements,
+                  const GLsizeiptr  alignment = alignof( T ) < 16 ? 16 : alignof( T )
+                  );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getPointer
+  /// \return mapped address of offset (inside the current region)
+  ///////////////////////////////////////////////////////////////
+  void *getPointer ( const GLintptr offset ) const;
+
+
+  const std::shared_ptr< GLuint >&
+  getBuffer( ) const { return spBuffer_; }
+
+  GLsizeiptr
+  getRegionSize( ) const { return regionSize_; }
+
+  unsigned
+  getNumRegions( ) const { return static_cast< unsigned >( fences_.size( ) ); }
+
+  ///
+  /// \brief getRegion
+  /// \return region written this frame, for per-region state
+  ///         such as vertex array objects
+  ///
+  unsigned
+  getRegion( ) const { return region_; }
+
+  GLsizeiptr
+  getBytesUsed( ) const { return used_; }
+
+  bool
+  isPersistent( ) const { return persistent_; }
+
+  ///
+  /// \brief getStallCount
+  /// \return number of beginFrame calls that had to wait on the GPU
+  ///
+  std::size_t
+  getStallCount( ) const { return stalls_; }
+
+
+private:
+
+  void _waitForRegion ( const unsigned region );
+
+  GLenum target_;
+  GLsizeiptr regionSize_;
+  bool persistent_;
+
+  std::shared_ptr< GLuint > spBuffer_;
+  char *pMapped_;                 ///< start of the buffer (persistent) or current region
+  std::vector< GLsync > fences_;
+
+  unsigned region_;
+  GLsizeiptr used_;
+  bool inFrame_;
+  bool writing_;  ///< between beginFrame and finishWrites
+
+  std::size_t stalls_;
+
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::write
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+template< typename T >
+GLintptr
+StreamingBuffer::write(
+                       const T          *pData,
+                       const std::size_t numElements,
+                       const GLsizeiptr  alignment
+                       )
+{
+  const GLsizeiptr bytes  = static_cast< GLsizeiptr >( numElements * sizeof( T ) );
+  const GLintptr   offset = allocate( bytes, alignment );
+
+  std::memcpy( getPointer( offset ), pData, static_cast< std::size_t >( bytes ) );
+
+  return offset;
+} // StreamingBuffer::write
+
+
+
+} // namespace shg
@@ -0,0 +1,240 @@
+// TextureLoader.hpp
+#pragma once
+
+#include "shared/core/Handle.hpp"
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The TextureLoader class
+///
+///        Streams textures in without hitching the render loop.
+///        Worker threads decode images straight into a
+///        persistently mapped GL_PIXEL_UNPACK_BUFFER (or heap
+///        memory when buffer storage is missing or an image
+///        does not fit). Once per frame, update uploads
+///        finished images with glTexSubImage2D, builds mipmaps
+///        and hands staging memory back once the GPU is done
+///        with it.
+///
+///        Loads are tracked with handles; poll getStatus and
+///        use getTexture once READY. Everything except the
+///        decoders runs on the thread owning the context.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class TextureLoader
+{
+
+public:
+
+  typedef shs::Handle< TextureLoader > TextureHandle;
+
+  enum Status
+  {
+    LOADING,
+    READY,
+    FAILED ///< also returned for released or unknown handles
+  };
+
+
+  ///
+  /// \brief Decodes one image on a worker thread
+  ///
+  class Decoder
+  {
+  public:
+
+    virtual
+    ~Decoder( ) = default;
+
+    ///
+    /// \brief readSize fills the image dimensions
+    ///
+    virtual
+    bool readSize (
+                   int &width,
+                   int &height
+                   ) = 0;
+
+    ///
+    /// \brief readPixels writes width * height RGBA8 texels,
+    ///        row 0 first (row 0 ends up at t = 0)
+    ///
+    virtual
+    bool readPixels ( unsigned char *pRgba ) = 0;
+  };
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief TextureLoader
+  /// \param stagingSize      bytes of mapped staging memory
+  /// \param uploadBudget     bytes uploaded per update at most
+  ///                         (at least one image is always sent)
+  /// \param numThreads       decoder threads
+  ///////////////////////////////////////////////////////////////
+  explicit
+  TextureLoader(
+                const std::size_t stagingSize  = 64 << 20,
+                const std::size_t uploadBudget = 16 << 20,
+                const unsigned    numThreads   = 2
+                );
+
+  ~TextureLoader( );
+
+  TextureLoader( const TextureLoader& )            = delete;
+  TextureLoader &operator=( const TextureLoader& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief load
+  /// \return handle to track the texture with
+  ///////////////////////////////////////////////////////////////
+  TextureHandle load ( std::unique_ptr< Decoder > upDecoder );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief loadFile
+  ///
+  ///        Loads a binary (P6) PPM with 8 bit channels.
+  ///
+  ///////////////////////////////////////////////////////////////
+  TextureHandle loadFile ( const std::string &filePath );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief update
+  ///
+  ///        Uploads decoded images and recycles staging memory.
+  ///        Call once per frame.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void update ( );
+
+
+  Status getStatus ( const TextureHandle handle ) const;
+
+  ///
+  /// \brief getTexture
+  /// \return the texture once READY, nullptr before that
+  ///
+  std::shared_ptr< GLuint > getTexture ( const TextureHandle handle ) const;
+
+  ///
+  /// \brief getError
+  /// \return why a FAILED load failed
+  ///
+  std::string getError ( const TextureHandle handle ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief release
+  ///
+  ///        Forgets the handle and cancels the load if it is
+  ///        still running. Queued loads are dropped, a decode in
+  ///        progress stops at its next step (a readPixels call
+  ///        already under way runs to completion and its result
+  ///        is discarded). Textures already handed out stay
+  ///        alive while they are referenced.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void release ( const TextureHandle handle );
+
+
+  bool
+  isPersistent( ) const { return pStaging_ != nullptr; }
+
+
+private:
+
+  static constexpr std::size_t NO_STAGING = static_cast< std::size_t >( -1 );
+
+  struct Job
+  {
+    TextureHandle handle;
+    std::unique_ptr< Decoder > upDecoder;
+
+    int width;
+    int height;
+
+    std::size_t stagingOffset;
+    std::size_t stagingSize;
+    std::vector< unsigned char > heapPixels; ///< used when not staged
+
+    std::string error;
+
+    std::shared_ptr< std::atomic< bool > > spCancelled; ///< set by release
+  };
+
+  struct Entry
+  {
+    Status status;
+    std::shared_ptr< GLuint > spTexture;
+    std::string error;
+    std::shared_ptr< std::atomic< bool > > spCancelled; ///< while LOADING
+  };
+
+  struct Upload
+  {
+    GLsync fence;
+    std::vector< std::pair< std::size_t, std::size_t > > ranges; ///< staging to free
+  };
+
+  void _decodeJobs ( );
+
+  void _decode ( Job &job );
+
+  std::shared_ptr< GLuint > _upload ( const Job &job );
+
+  void _retireUploads ( );
+
+  // need mutex_ held
+  std::size_t _allocateStaging ( const std::size_t size );
+
+  void _freeStaging (
+                     const std::size_t offset,
+                     const std::size_t size
+                     );
+
+  // render thread only
+  shs::HandleAllocator< TextureLoader > handles_;
+  std::vector< Entry > entries_;
+  std::deque< Upload > uploads_;
+
+  std::shared_ptr< GLuint > spStaging_;
+  unsigned char *pStaging_;
+  std::size_t stagingSize_;
+  std::size_t uploadBudget_;
+
+  // shared with the decoder threads
+  std::mutex mutex_;
+  std::condition_variable workAvailable_;
+  std::condition_variable stagingFreed_;
+
+  std::deque< std::unique_ptr< Job > > pending_;
+  std::deque< std::unique_ptr< Job > > decoded_;
+  std::map< std::size_t, std::size_t > freeStaging_; ///< offset -> size
+  bool stopping_;
+
+  std::vector< std::thread > workers_;
+
+};
+
+
+} // namespace shg
@@ -0,0 +1,83 @@
+// UniformTable.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_map>
+
+
+namespace shg
+{
+
+
+///
+/// \brief The UniformHandle struct
+///
+///        Location of one active uniform along with the GLSL type
+///        and array size it was declared with. Default constructed
+///        handles point at location -1, which OpenGL silently
+///        ignores, matching glGetUniformLocation for unknown names.
+///
+struct UniformHandle
+{
+  GLint  location = -1;
+  GLenum type     = GL_NONE;
+  GLint  count    = 0;
+
+  bool
+  isValid( ) const { return location >= 0; }
+};
+
+
+/////////////////////////////////////////////
+/// \brief The UniformTable class
+///
+///        Every active uniform of a linked program, queried once
+///        with GL_ACTIVE_UNIFORMS so setting uniforms rarely needs
+///        glGetUniformLocation. Array uniforms are reachable both
+///        as "name" and "name[0]". Other names ("lights[2]",
+///        "s[1].field") fall back to glGetUniformLocation once and
+///        the result, found or not, is cached.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class UniformTable
+{
+
+public:
+
+  UniformTable( ) = default;
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief UniformTable
+  /// \param program linked program to query
+  ///////////////////////////////////////////////////////////////
+  explicit
+  UniformTable( const GLuint program );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getUniform
+  /// \return handle for name or an invalid handle if the
+  ///         program has no such active uniform. Handles found
+  ///         by the fallback lookup have type GL_NONE.
+  ///////////////////////////////////////////////////////////////
+  UniformHandle getUniform ( const std::string &name ) const;
+
+
+  std::size_t
+  size( ) const { return uniforms_.size( ); }
+
+
+private:
+
+  GLuint program_ = 0;
+
+  // grows with fallback lookups on the GL thread
+  mutable std::unordered_map< std::string, UniformHandle > uniforms_;
+
+};
+
+
+} // namespace shg
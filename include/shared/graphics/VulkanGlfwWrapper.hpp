@@ -3,6 +3,8 @@
 
 #include "graphics/vulkan/VDeleter.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <functional>
 #include <vector>
@@ -10,28 +12,68 @@
 #include <vulkan/vulkan.h>
 
 
+namespace shs
+{
+
+class JobSystem;
+
+}
+
+
 namespace shg
 {
 
 class GlfwWrapper;
 class Callback;
+class VulkanMemoryAllocator;
+class VulkanUploader;
 
 
 ///
 /// \brief The VulkanGlfwWrapper class
 ///
+///        Renders with several frames in flight. Each frame
+///        slot owns its own command pool, semaphores and fence,
+///        so the CPU records frame N + 1 while the GPU is still
+///        rendering frame N. A slot is only reused once the GPU
+///        has signaled its fence.
+///
+///        Draws set with setDrawRecorder are split into batches
+///        recorded into secondary command buffers across the
+///        job system's threads, then executed by the frame's
+///        primary command buffer.
+///
+///        Buffer and image data goes through getUploader( ) and
+///        is copied on a transfer only queue when the device has
+///        one, overlapping the copies with rendering.
+///
 class VulkanGlfwWrapper
 {
 
 public:
 
+  ///
+  /// \brief Records draws [begin, end) into a secondary command
+  ///        buffer continuing the wrapper's render pass, with
+  ///        the graphics pipeline already bound. Called from
+  ///        several threads at once.
+  ///
+  typedef std::function< void ( VkCommandBuffer commandBuffer, const std::size_t begin, const std::size_t end ) >
+    DrawRecorder;
+
+
   ///////////////////////////////////////////////////////////////////////////////////
   //
   //  Initialization functions
   //
   ///////////////////////////////////////////////////////////////////////////////////
 
-  VulkanGlfwWrapper( );
+  ///
+  /// \brief VulkanGlfwWrapper
+  /// \param framesInFlight frames the CPU may record ahead of the GPU
+  ///
+  explicit
+  VulkanGlfwWrapper( const uint32_t framesInFlight = 2 );
 
   ~VulkanGlfwWrapper( );
 
@@ -58,6 +100,21 @@ public:
   void createRenderPass ( );
 
 
+  ///
+  /// \brief createPipelineCache
+  ///
+  ///        Creates the cache pipelines are built with, seeded
+  ///        from filePath if it holds data from this exact GPU
+  ///        and driver. The cache is written back to filePath
+  ///        by syncDevice and on destruction. An empty path
+  ///        keeps the cache in memory only.
+  ///
+  /// \param filePath
+  ///
+  virtual
+  void createPipelineCache ( const std::string &filePath );
+
+
   ///
   /// \brief createGraphicsPipeline
   /// \param vertexFile
@@ -78,6 +135,9 @@ public:
   ///
   /// \brief createCommandPool
   ///
+  ///        One transient pool per frame in flight so a
+  ///        frame's pool can be reset while others are pending.
+  ///
   virtual
   void createCommandPool ( );
 
@@ -85,15 +145,20 @@ public:
   ///
   /// \brief createCommandBuffers
   ///
+  ///        Allocates a command buffer per frame in flight.
+  ///        Buffers are recorded every frame in drawFrame.
+  ///
   virtual
   void createCommandBuffers ( );
 
 
   ///
-  /// \brief createSemaphores
+  /// \brief createSyncObjects
+  ///
+  ///        Semaphores and a fence per frame in flight.
   ///
   virtual
-  void createSemaphores ( );
+  void createSyncObjects ( );
 
 
 
@@ -113,6 +178,12 @@ public:
 
   //////////////////////////////////////////////////
   /// \brief drawFrame
+  ///
+  ///        Waits for the current frame slot to be free,
+  ///        records and submits it, then moves to the next
+  ///        slot. Only blocks when the CPU is a full
+  ///        framesInFlight ahead of the GPU.
+  ///
   //////////////////////////////////////////////////
   virtual
   void drawFrame ( );
@@ -148,6 +219,79 @@ public:
   void setCallback (std::unique_ptr< Callback > upCallback );
 
 
+  ///
+  /// \brief setJobSystem
+  /// \param pJobSystem threads secondary command buffers are
+  ///        recorded on, nullptr records on the calling thread
+  ///
+  void
+  setJobSystem( shs::JobSystem *pJobSystem ) { pJobSystem_ = pJobSystem; }
+
+
+  ///
+  /// \brief setDrawRecorder
+  ///
+  ///        Replaces the default full screen draw. Every frame
+  ///        the draws are split into batches, each recorded
+  ///        into its own secondary command buffer in parallel,
+  ///        and executed by the primary buffer in batch order.
+  ///
+  /// \param drawCount number of draws handed to recorder
+  /// \param recorder empty to go back to the default draw
+  /// \param drawsPerBuffer batch size, 0 picks one from the
+  ///        job system's thread count
+  ///
+  void setDrawRecorder (
+                        const std::size_t drawCount,
+                        DrawRecorder      recorder,
+                        const std::size_t drawsPerBuffer = 0
+                        );
+
+
+  ///
+  /// \brief getMemoryAllocator
+  /// \return allocator for buffer and image memory, valid
+  ///         once a window has been created
+  ///
+  VulkanMemoryAllocator&
+  getMemoryAllocator( ) { return *upMemoryAllocator_; }
+
+
+  ///
+  /// \brief getUploader
+  /// \return staging uploader feeding the transfer queue,
+  ///         submitted and retired by drawFrame. Valid once a
+  ///         window has been created.
+  ///
+  VulkanUploader&
+  getUploader( ) { return *upUploader_; }
+
+
+  ///
+  /// \brief getPipelineCreationMs
+  /// \return time the last createGraphicsPipeline spent in
+  ///         vkCreateGraphicsPipelines
+  ///
+  double
+  getPipelineCreationMs( ) const { return pipelineCreationMs_; }
+
+
+  ///
+  /// \brief getFramesInFlight
+  ///
+  uint32_t
+  getFramesInFlight( ) const { return framesInFlight_; }
+
+
+  ///
+  /// \brief getCurrentFrame
+  /// \return frame slot being recorded, for indexing
+  ///         per-frame resources such as uniform regions
+  ///
+  uint32_t
+  getCurrentFrame( ) const { return currentFrame_; }
+
+
 private:
 
   //////////////////////////////////////////////////
@@ -208,6 +352,30 @@ private:
   virtual
   void _createImageViews ( );
 
+  //////////////////////////////////////////////////
+  /// \brief _recordCommandBuffer
+  /// \param commandBuffer reset buffer of the current frame
+  /// \param imageIndex swap chain image being rendered to
+  //////////////////////////////////////////////////
+  virtual
+  void _recordCommandBuffer (
+                             VkCommandBuffer commandBuffer,
+                             const uint32_t  imageIndex
+                             );
+
+  //////////////////////////////////////////////////
+  /// \brief _recordSecondaryCommandBuffers
+  /// \param imageIndex swap chain image being rendered to
+  /// \return number of buffers recorded into
+  ///         secondaryCommandBuffers_
+  //////////////////////////////////////////////////
+  uint32_t _recordSecondaryCommandBuffers ( const uint32_t imageIndex );
+
+  //////////////////////////////////////////////////
+  /// \brief _savePipelineCache
+  //////////////////////////////////////////////////
+  void _savePipelineCache ( );
+
 
   //
   // member vars
@@ -234,6 +402,12 @@ protected:
 
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
+  VkQueue transferQueue_;     ///< graphicsQueue_ without a transfer only family
+  uint32_t transferFamily_;
+
+  // destroyed before the device, uploader before the allocator
+  std::unique_ptr< VulkanMemoryAllocator > upMemoryAllocator_;
+  std::unique_ptr< VulkanUploader > upUploader_;
 
   VDeleter< VkSwapchainKHR > swapChain_ {
     device_, vkDestroySwapchainKHR
@@ -254,18 +428,57 @@ protected:
     device_, vkDestroyPipeline
   };
 
-  VDeleter< VkCommandPool > commandPool_ {
-    device_, vkDestroyCommandPool
+  VDeleter< VkPipelineCache > pipelineCache_ {
+    device_, vkDestroyPipelineCache
   };
-  std::vector< VkCommandBuffer > commandBuffers_;
+  std::string pipelineCacheFile_;
+  double pipelineCreationMs_ = 0.0;
 
-  VDeleter< VkSemaphore > imageAvailableSemaphore_ {
-    device_, vkDestroySemaphore
-  };
-  VDeleter< VkSemaphore > renderFinishedSemaphore_ {
-    device_, vkDestroySemaphore
+  //
+  // per frame in flight, indexed by currentFrame_
+  //
+  uint32_t framesInFlight_;
+  uint32_t currentFrame_ = 0;
+
+  std::vector< VDeleter< VkCommandPool > > commandPools_;
+  std::vector< VkCommandBuffer > commandBuffers_; ///< freed with their pools
+  std::vector< VkCommandBuffer > acquireCommandBuffers_; ///< upload acquires, ahead of commandBuffers_
+
+  //
+  // one pool per secondary buffer rather than per thread, so a
+  // batch can be recorded by whichever thread picks it up
+  // without locking, including threads outside the job system
+  //
+  struct SecondaryCommandBuffer
+  {
+    explicit
+    SecondaryCommandBuffer( const VDeleter< VkDevice > &device )
+      : pool{ device, vkDestroyCommandPool }
+    {}
+
+    VDeleter< VkCommandPool > pool;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE; ///< freed with pool
   };
 
+  std::vector< std::vector< std::unique_ptr< SecondaryCommandBuffer > > > secondaryCommandBuffers_; ///< [frame][batch]
+  std::vector< VkCommandBuffer > executeCommandBuffers_;
+
+  shs::JobSystem *pJobSystem_ = nullptr;
+  DrawRecorder drawRecorder_;
+  std::size_t drawCount_      = 0;
+  std::size_t drawsPerBuffer_ = 0;
+
+  std::vector< VDeleter< VkSemaphore > > imageAvailableSemaphores_;
+  std::vector< VDeleter< VkSemaphore > > renderFinishedSemaphores_;
+  std::vector< VDeleter< VkFence > > inFlightFences_;
+
+  //
+  // per swap chain image, fence of the last frame that rendered
+  // to it or VK_NULL_HANDLE, so an image handed back out of order
+  // is not written while an older frame still uses it
+  //
+  std::vector< VkFence > imagesInFlight_;
+
 };
 
 
@@ -0,0 +1,292 @@
+// VulkanMemoryAllocator.hpp
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace shs
+{
+
+class BuddyAllocator;
+
+}
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The VulkanMemoryAllocator class
+///
+///        Sub-allocates buffers and images from a few large
+///        blocks of device memory per memory type instead of
+///        calling vkAllocateMemory for every resource, which
+///        runs into maxMemoryAllocationCount (often 4096)
+///        quickly. Ranges within a block come from a buddy
+///        allocator. Resources larger than half a block get a
+///        dedicated allocation of their own.
+///
+///        Host visible blocks stay mapped for their lifetime.
+///
+///        Not thread safe. Memory must not be in use by the GPU
+///        when it is freed or moved.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class VulkanMemoryAllocator
+{
+
+public:
+
+  static constexpr uint32_t DEDICATED = ~0u;
+
+
+  ///
+  /// \brief A range of device memory
+  ///
+  struct Allocation
+  {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset   = 0;
+    VkDeviceSize size     = 0;       ///< bytes requested
+    void *pMapped         = nullptr; ///< host address of offset, if host visible
+    uint32_t memoryType   = 0;
+    uint32_t block        = DEDICATED;
+
+    bool
+    isValid( ) const { return memory != VK_NULL_HANDLE; }
+  };
+
+
+  ///
+  /// \brief Usage of one memory type or all of them
+  ///
+  struct Stats
+  {
+    uint32_t blockCount      = 0;
+    uint32_t dedicatedCount  = 0;
+    uint64_t allocationCount = 0; ///< sub-allocations and dedicated allocations
+    VkDeviceSize bytesReserved = 0; ///< device memory allocated from the driver
+    VkDeviceSize bytesUsed     = 0; ///< handed out, including rounding
+  };
+
+
+  ///
+  /// \brief Called by defragment for each allocation it moves.
+  ///        Copies the data from 'from' to 'to' and rebinds
+  ///        or recreates the resource using it. Returning false
+  ///        leaves the allocation where it is.
+  ///
+  typedef std::function< bool ( const Allocation &from, const Allocation &to ) > MoveFunction;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief VulkanMemoryAllocator
+  /// \param blockSize bytes per block, rounded up to a power of two
+  ///////////////////////////////////////////////////////////////
+  VulkanMemoryAllocator(
+                        VkPhysicalDevice   physicalDevice,
+                        VkDevice           device,
+                        const VkDeviceSize blockSize = 64 * 1024 * 1024
+                        );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ~VulkanMemoryAllocator
+  ///
+  ///        Frees every block and dedicated allocation.
+  ///
+  ///////////////////////////////////////////////////////////////
+  ~VulkanMemoryAllocator( );
+
+  VulkanMemoryAllocator( const VulkanMemoryAllocator& )            = delete;
+  VulkanMemoryAllocator &operator=( const VulkanMemoryAllocator& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief allocate
+  /// \param requirements from vkGet*MemoryRequirements
+  /// \param properties flags the memory type must have
+  /// \param dedicated give the resource its own device memory
+  ///////////////////////////////////////////////////////////////
+  Allocation allocate (
+                       const VkMemoryRequirements &requirements,
+                       const VkMemoryPropertyFlags properties,
+                       const bool                  dedicated = false
+                       );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief free
+  ///
+  ///        Releases the range and resets allocation.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void free ( Allocation &allocation );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief createBuffer
+  /// \return new buffer bound to *pAllocation
+  ///////////////////////////////////////////////////////////////
+  VkBuffer createBuffer (
+                         const VkDeviceSize          size,
+                         const VkBufferUsageFlags    usage,
+                         const VkMemoryPropertyFlags properties,
+                         Allocation                 *pAllocation
+                         );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief destroyBuffer
+  ///
+  ///        Destroys buffer and frees its allocation.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void destroyBuffer (
+                      VkBuffer    buffer,
+                      Allocation &allocation
+                      );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief bindImage
+  ///
+  ///        Allocates memory for image and binds it. Images
+  ///        larger than half a block get dedicated memory.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void bindImage (
+                  VkImage                     image,
+                  const VkMemoryPropertyFlags properties,
+                  Allocation                 *pAllocation
+                  );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief flush
+  ///
+  ///        Makes host writes visible to the device. Only needed
+  ///        for host visible memory that is not host coherent.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void flush (
+              const Allocation  &allocation,
+              const VkDeviceSize offset = 0,
+              const VkDeviceSize size   = VK_WHOLE_SIZE
+              );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief defragment
+  ///
+  ///        Moves allocations out of the emptiest blocks into
+  ///        fuller ones through move, then releases blocks left
+  ///        empty. Dedicated allocations never move.
+  ///
+  /// \param maxBytesMoved stops once this many bytes have moved
+  /// \return number of allocations moved
+  ///////////////////////////////////////////////////////////////
+  uint32_t defragment (
+                       const MoveFunction &move,
+                       const VkDeviceSize  maxBytesMoved = ~VkDeviceSize( 0 )
+                       );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief releaseEmptyBlocks
+  ///
+  ///        Returns blocks holding no allocations to the driver.
+  ///        Empty blocks are otherwise kept for reuse.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void releaseEmptyBlocks ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getStats
+  /// \return usage summed over every memory type
+  ///////////////////////////////////////////////////////////////
+  Stats getStats ( ) const;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief getStats
+  /// \return usage of a single memory type
+  ///////////////////////////////////////////////////////////////
+  Stats getStats ( const uint32_t memoryType ) const;
+
+
+  VkDeviceSize
+  getBlockSize( ) const { return blockSize_; }
+
+
+private:
+
+  struct Range
+  {
+    VkDeviceSize size;
+    VkDeviceSize alignment;
+  };
+
+  struct Block
+  {
+    VkDeviceMemory memory = VK_NULL_HANDLE; ///< VK_NULL_HANDLE once released
+    char *pMapped         = nullptr;
+    std::unique_ptr< shs::BuddyAllocator > upRanges;
+    std::unordered_map< VkDeviceSize, Range > ranges; ///< offset -> live range
+  };
+
+  struct MemoryType
+  {
+    std::vector< Block > blocks;
+    uint32_t dedicatedCount     = 0;
+    VkDeviceSize dedicatedBytes = 0;
+  };
+
+  uint32_t _findMemoryType (
+                            const uint32_t              typeBits,
+                            const VkMemoryPropertyFlags properties
+                            ) const;
+
+  VkDeviceMemory _allocateMemory (
+                                  const VkDeviceSize size,
+                                  const uint32_t     memoryType,
+                                  void             **ppMapped
+                                  );
+
+  void _freeMemory ( VkDeviceMemory memory );
+
+  bool _allocateFromBlock (
+                           const uint32_t     memoryType,
+                           const uint32_t     block,
+                           const VkDeviceSize size,
+                           const VkDeviceSize alignment,
+                           Allocation        *pAllocation
+                           );
+
+  uint32_t _createBlock ( const uint32_t memoryType );
+
+  VkDevice device_;
+
+  VkPhysicalDeviceMemoryProperties memoryProperties_;
+  VkDeviceSize nonCoherentAtomSize_;
+  uint32_t maxAllocationCount_;
+  uint32_t deviceAllocationCount_;
+
+  VkDeviceSize blockSize_;
+  VkDeviceSize minRangeSize_; ///< also keeps buffers and images off each other's pages
+
+  std::vector< MemoryType > memoryTypes_;
+
+};
+
+
+} // namespace shg
@@ -0,0 +1,278 @@
+// VulkanUploader.hpp
+#pragma once
+
+#include "shared/graphics/VulkanMemoryAllocator.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief The VulkanUploader class
+///
+///        Copies buffer and image data to device local memory
+///        through a persistently mapped staging ring. Uploads
+///        are queued on the CPU and submitted in batches, one
+///        command buffer per batch, on a dedicated transfer
+///        queue when the device has one. Rendering keeps going
+///        while a batch is copied and the ring space it used is
+///        reclaimed once its fence signals.
+///
+///        When the transfer and graphics queue families differ,
+///        finished uploads are released by the transfer queue
+///        and acquired by the next frame through recordAcquire.
+///        Each batch then signals a semaphore the frame's submit
+///        has to wait on. When they are the same family,
+///        transferQueue must be the queue frames are submitted
+///        to so submission order covers the copies.
+///
+///        Usage:
+///
+///          id = uploadBuffer( buffer, 0, pData, size );
+///          ... once per frame ...
+///          submit( );
+///          retire( );
+///          recordAcquire( graphicsCommandBuffer, waitSemaphores, waitStages );
+///          ... submit graphicsCommandBuffer waiting on waitSemaphores ...
+///          if ( isComplete( id ) ) ... draw with buffer ...
+///
+///        Not thread safe. Destroy only once the graphics queue
+///        no longer waits on any semaphores handed out.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+class VulkanUploader
+{
+
+public:
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief VulkanUploader
+  /// \param transferFamily family of transferQueue
+  /// \param graphicsFamily family the uploaded resources are
+  ///        used on
+  /// \param framesInFlight frames the graphics queue may be
+  ///        behind recordAcquire
+  /// \param ringSize staging bytes, the largest single upload
+  ///////////////////////////////////////////////////////////////
+  VulkanUploader(
+                 VkDevice               device,
+                 VulkanMemoryAllocator &allocator,
+                 VkQueue                transferQueue,
+                 const uint32_t         transferFamily,
+                 const uint32_t         graphicsFamily,
+                 const uint32_t         framesInFlight = 2,
+                 const VkDeviceSize     ringSize       = 32 * 1024 * 1024
+                 );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief ~VulkanUploader
+  ///
+  ///        Waits for batches still being copied.
+  ///
+  ///////////////////////////////////////////////////////////////
+  ~VulkanUploader( );
+
+  VulkanUploader( const VulkanUploader& )            = delete;
+  VulkanUploader &operator=( const VulkanUploader& ) = delete;
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief uploadBuffer
+  ///
+  ///        Stages size bytes of pData to be copied to buffer at
+  ///        offset. Blocks only if the ring is full of batches
+  ///        the GPU has not copied yet.
+  ///
+  /// \return id to pass to isComplete
+  ///////////////////////////////////////////////////////////////
+  uint64_t uploadBuffer (
+                         VkBuffer           buffer,
+                         const VkDeviceSize offset,
+                         const void        *pData,
+                         const VkDeviceSize size
+                         );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief uploadImage
+  ///
+  ///        Stages tightly packed texels for mip level 0, layer 0
+  ///        of image. The image's previous contents are discarded
+  ///        and it ends up in SHADER_READ_ONLY_OPTIMAL.
+  ///
+  /// \param alignment staging offset alignment, a multiple of
+  ///        the texel size
+  /// \return id to pass to isComplete
+  ///////////////////////////////////////////////////////////////
+  uint64_t uploadImage (
+                        VkImage                  image,
+                        const VkExtent3D         extent,
+                        const void              *pData,
+                        const VkDeviceSize       size,
+                        const VkImageAspectFlags aspect    = VK_IMAGE_ASPECT_COLOR_BIT,
+                        const VkDeviceSize       alignment = 16
+                        );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief submit
+  ///
+  ///        Records every queued upload into one command buffer
+  ///        and submits it to the transfer queue.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void submit ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief retire
+  ///
+  ///        Frees the ring space of batches the GPU finished
+  ///        without waiting on any others.
+  ///
+  ///////////////////////////////////////////////////////////////
+  void retire ( );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief recordAcquire
+  ///
+  ///        Makes uploads retired since the last call visible to
+  ///        the graphics queue. Must be recorded ahead of any
+  ///        command using them and called once every frame.
+  ///
+  ///        With a separate transfer family, appends semaphores
+  ///        the submit of commandBuffer must wait on. They are
+  ///        signalled again framesInFlight calls later, by when
+  ///        that submit has to have finished.
+  ///
+  /// \return false if there was nothing to record
+  ///////////////////////////////////////////////////////////////
+  bool recordAcquire (
+                      VkCommandBuffer                      commandBuffer,
+                      std::vector< VkSemaphore >          &waitSemaphores,
+                      std::vector< VkPipelineStageFlags > &waitStages
+                      );
+
+
+  ///////////////////////////////////////////////////////////////
+  /// \brief isComplete
+  /// \return true once the upload has been copied and retired
+  ///////////////////////////////////////////////////////////////
+  bool
+  isComplete( const uint64_t id ) const { return id <= completedId_; }
+
+
+  VkDeviceSize
+  getRingSize( ) const { return ringSize_; }
+
+  ///
+  /// \brief getBytesInFlight
+  /// \return staged bytes not yet retired, padding included
+  ///
+  VkDeviceSize
+  getBytesInFlight( ) const { return head_ - tail_; }
+
+  bool
+  usesTransferQueue( ) const { return transferFamily_ != graphicsFamily_; }
+
+  ///
+  /// \brief getStallCount
+  /// \return number of uploads that had to wait for ring space
+  ///
+  std::size_t
+  getStallCount( ) const { return stalls_; }
+
+
+private:
+
+  struct BufferCopy
+  {
+    VkBuffer buffer;
+    VkBufferCopy region;
+  };
+
+  struct ImageCopy
+  {
+    VkImage image;
+    VkBufferImageCopy region;
+  };
+
+  struct Batch
+  {
+    VkCommandPool pool            = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE; ///< freed with pool
+    VkFence fence                 = VK_NULL_HANDLE;
+    VkSemaphore semaphore         = VK_NULL_HANDLE; ///< signalled when releasing
+    uint64_t id                   = 0;
+    uint64_t ringEnd              = 0;
+
+    std::vector< VkBufferMemoryBarrier > bufferAcquires;
+    std::vector< VkImageMemoryBarrier > imageAcquires;
+  };
+
+  VkDeviceSize _stage (
+                       const void        *pData,
+                       const VkDeviceSize size,
+                       const VkDeviceSize alignment
+                       );
+
+  std::unique_ptr< Batch > _createBatch ( );
+
+  void _destroyBatch ( Batch &batch );
+
+  VkSemaphore _getSemaphore ( );
+
+  VkDevice device_;
+  VulkanMemoryAllocator &allocator_;
+  VkQueue transferQueue_;
+  uint32_t transferFamily_;
+  uint32_t graphicsFamily_;
+  uint32_t framesInFlight_;
+
+  VkBuffer ring_;
+  VulkanMemoryAllocator::Allocation ringAllocation_;
+  VkDeviceSize ringSize_;
+
+  //
+  // running byte counts, so head_ % ringSize_ is the write
+  // position and head_ - tail_ the bytes in flight
+  //
+  uint64_t head_;
+  uint64_t tail_;
+
+  std::vector< BufferCopy > bufferCopies_; ///< queued for the next batch
+  std::vector< ImageCopy > imageCopies_;
+
+  std::deque< std::unique_ptr< Batch > > inFlight_; ///< oldest first
+  std::vector< std::unique_ptr< Batch > > freeBatches_;
+
+  std::vector< VkBufferMemoryBarrier > bufferAcquires_; ///< retired, not yet recorded
+  std::vector< VkImageMemoryBarrier > imageAcquires_;
+  bool retiredSinceAcquire_;
+
+  std::vector< VkSemaphore > acquireSemaphores_; ///< signalled by retired batches
+  std::deque< std::pair< uint64_t, VkSemaphore > > waitedSemaphores_; ///< by acquire call
+  std::vector< VkSemaphore > freeSemaphores_;
+  uint64_t acquireCalls_;
+
+  uint64_t nextId_;
+  uint64_t completedId_;
+
+  std::size_t stalls_;
+
+};
+
+
+} // namespace shg
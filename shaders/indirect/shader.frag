@@ -0,0 +1,15 @@
+#version 430
+
+
+flat in vec4 drawColor;
+
+
+layout( location = 0 ) out vec4 outColor;
+
+
+void main( void )
+{
+
+  outColor = drawColor;
+
+}
@@ -0,0 +1,43 @@
+#version 430
+#extension GL_ARB_shader_draw_parameters : require
+
+
+layout( location = 0 ) in vec3 inPosition;
+
+
+//
+// one entry per draw in a DrawBatch, picked with gl_DrawIDARB
+//
+struct DrawData
+{
+  mat4 model;
+  vec4 color;
+};
+
+layout( std430, binding = 0 ) readonly buffer Draws
+{
+  DrawData draws[];
+};
+
+
+uniform mat4 projectionView = mat4( 1.0 );
+
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+flat out vec4 drawColor;
+
+
+
+void main( void )
+{
+
+  DrawData draw = draws[ gl_DrawIDARB ];
+
+  drawColor   = draw.color;
+  gl_Position = projectionView * draw.model * vec4( inPosition, 1.0 );
+
+}
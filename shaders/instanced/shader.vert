@@ -0,0 +1,24 @@
+#version 410
+#extension GL_ARB_separate_shader_objects : enable
+
+
+layout( location = 0 ) in vec3 inPosition;
+layout( location = 1 ) in mat4 inModel; // per instance, locations 1-4
+
+
+uniform mat4 projectionView = mat4( 1.0 );
+
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+
+
+void main( void )
+{
+
+  gl_Position = projectionView * inModel * vec4( inPosition, 1.0 );
+
+}
@@ -0,0 +1,15 @@
+#version 410
+
+
+uniform vec3 lightColors[ 3 ];
+
+
+layout( location = 0 ) out vec4 outColor;
+
+
+void main( void )
+{
+
+  outColor = vec4( lightColors[ 0 ] + lightColors[ 1 ] + lightColors[ 2 ], 1.0 );
+
+}
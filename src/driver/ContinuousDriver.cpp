@@ -2,9 +2,13 @@
 
 #include "shared/core/World.hpp"
 #include "shared/core/IOHandler.hpp"
+#include "shared/core/Trace.hpp"
 
 #include <iostream>
 #include <cstdlib>
+#include <thread>
+#include <exception>
+#include <algorithm>
 
 
 
@@ -17,6 +21,9 @@ namespace
 
 const double MAX_TIMESTEP_NFTR_LOOP = 0.05;
 
+// longest the simulation thread sleeps before re-checking for exit
+const double MAX_SIM_THREAD_SLEEP = 0.005;
+
 }
 
 
@@ -29,7 +36,7 @@ const double MAX_TIMESTEP_NFTR_LOOP = 0.05;
 ContinuousDriver::ContinuousDriver(
                                    World     &world,
                                    IOHandler &ioHandler
-                                   ) noexcept
+                                   )
   : Driver( world, ioHandler )
   , timeScale_  ( 1.0 )
   , paused_     ( false )
@@ -38,6 +45,10 @@ ContinuousDriver::ContinuousDriver(
   , worldTime_  ( startTime_ )
   , updateFrame_( 0 )
   , initTime_   ( std::chrono::system_clock::now( ) )
+  , simRunning_  ( false )
+  , simPaused_   ( false )
+  , lastStepTime_( 0.0 )
+  , simDeltaTime_( timeStep_ * timeScale_ )
 {}
 
 
@@ -55,6 +66,7 @@ ContinuousDriver::exec(
                        )
 {
   bool useGameLoop( true );
+  bool useThreads( false );
 
   for ( int i = 1; i < argc; ++i )
   {
@@ -62,13 +74,21 @@ ContinuousDriver::exec(
     {
       useGameLoop = false;
     }
+    else if ( std::string( argv[ i ] ) == "--loop=threaded" )
+    {
+      useThreads = true;
+    }
     else
     {
       std::cerr << "WARNING: Unknown argument given: " << argv[ i ] << std::endl;
     }
   }
 
-  if ( useGameLoop )
+  if ( useThreads )
+  {
+    _runThreadedLoop( );
+  }
+  else if ( useGameLoop )
   {
     _runNFTRLoop( );
   }
@@ -96,17 +116,25 @@ ContinuousDriver::_runAFAPLoop( )
 {
   while ( !ioHandler_.isExitRequested( ) )
   {
+    SHS_TRACE_SCOPE( "frame" );
+
     // check for input
-    ioHandler_.updateIO( );
+    {
+      SHS_TRACE_SCOPE( "updateIO" );
+      ioHandler_.updateIO( );
+    }
 
     if ( !paused_ )
     {
-      world_.update( worldTime_, timeStep_ );
+      _updateWorld( worldTime_, timeStep_ );
       ++updateFrame_;
       worldTime_ = updateFrame_ * timeStep_ + startTime_;
     }
 
-    ioHandler_.showWorld( 1.0 );
+    {
+      SHS_TRACE_SCOPE( "showWorld" );
+      ioHandler_.showWorld( 1.0 );
+    }
   }
 } // ContinuousDriver::_runAFAPLoop
 
@@ -129,7 +157,7 @@ ContinuousDriver::_runNFTRLoop( )
   double currentTime = _getTimeSeconds( );
   double accumulator = 0.0;
 
-  double deltaTime = timeStep_ * timeScale_;
+  double deltaTime = timeStep_ * timeScale_.load( );
 
   double newTime, frameTime, alpha;
 
@@ -138,8 +166,13 @@ ContinuousDriver::_runNFTRLoop( )
   //
   while ( !ioHandler_.isExitRequested( ) )
   {
+    SHS_TRACE_SCOPE( "frame" );
+
     // check for input
-    ioHandler_.updateIO( );
+    {
+      SHS_TRACE_SCOPE( "updateIO" );
+      ioHandler_.updateIO( );
+    }
 
     if ( !paused_ )
     {
@@ -155,11 +188,11 @@ ContinuousDriver::_runNFTRLoop( )
 
       accumulator += frameTime;
 
-      deltaTime = timeStep_ * timeScale_;
+      deltaTime = timeStep_ * timeScale_.load( );
 
       while ( accumulator >= deltaTime )
       {
-        world_.update( worldTime_, deltaTime );
+        _updateWorld( worldTime_, deltaTime );
 
         worldTime_  += deltaTime;
         accumulator -= deltaTime;
@@ -172,12 +205,169 @@ ContinuousDriver::_runNFTRLoop( )
 
     alpha = accumulator / deltaTime;
 
-    ioHandler_.showWorld( alpha );
+    {
+      SHS_TRACE_SCOPE( "showWorld" );
+      ioHandler_.showWorld( alpha );
+    }
   }
 } // ContinuousDriver::_runNFTRLoop
 
 
 
+/////////////////////////////////////////////
+/// \brief ContinuousDriver::_runThreadedLoop
+///
+///        Renders on the calling thread while the world
+///        updates on its own thread
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ContinuousDriver::_runThreadedLoop( )
+{
+  std::exception_ptr simException = nullptr;
+
+  simPaused_    = paused_;
+  simDeltaTime_ = timeStep_ * timeScale_.load( );
+  lastStepTime_ = _getTimeSeconds( );
+  simRunning_   = true;
+
+  std::thread simThread(
+                        [ this, &simException ]
+    {
+      try
+      {
+        _runSimulationThread( );
+      }
+      catch ( ... )
+      {
+        simException = std::current_exception( );
+      }
+
+      simRunning_ = false;
+    } );
+
+  try
+  {
+    //
+    // Loop until the user closes the window
+    // or the world requests an exit
+    //
+    while ( simRunning_ && !ioHandler_.isExitRequested( ) )
+    {
+      SHS_TRACE_SCOPE( "frame" );
+
+      // check for input
+      {
+        SHS_TRACE_SCOPE( "updateIO" );
+        ioHandler_.updateIO( );
+      }
+
+      simPaused_ = paused_;
+
+      double alpha = 1.0;
+
+      if ( !paused_ )
+      {
+        alpha = ( _getTimeSeconds( ) - lastStepTime_ ) / simDeltaTime_;
+        alpha = std::max( 0.0, std::min( 1.0, alpha ) );
+      }
+
+      {
+        SHS_TRACE_SCOPE( "showWorld" );
+        ioHandler_.showWorld( alpha );
+      }
+    }
+  }
+  catch ( ... )
+  {
+    //
+    // never leave the simulation thread joinable
+    // while unwinding or std::terminate is called
+    //
+    simRunning_ = false;
+    simThread.join( );
+    throw;
+  }
+
+  simRunning_ = false;
+  simThread.join( );
+
+  if ( simException )
+  {
+    std::rethrow_exception( simException );
+  }
+} // ContinuousDriver::_runThreadedLoop
+
+
+
+/////////////////////////////////////////////
+/// \brief ContinuousDriver::_runSimulationThread
+///
+///        Fixed timestep updates No Faster Than Real-time
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ContinuousDriver::_runSimulationThread( )
+{
+  double currentTime = _getTimeSeconds( );
+  double accumulator = 0.0;
+
+  double deltaTime = timeStep_ * timeScale_.load( );
+
+  double newTime, frameTime;
+
+  SHS_TRACE_THREAD_NAME( "simulation" );
+
+  while ( simRunning_ && !world_.requestingExit( ) )
+  {
+    if ( simPaused_ )
+    {
+      currentTime = _getTimeSeconds( );
+      std::this_thread::sleep_for( std::chrono::duration< double >( MAX_SIM_THREAD_SLEEP ) );
+      continue;
+    }
+
+    newTime   = _getTimeSeconds( );
+    frameTime = std::min( newTime - currentTime, MAX_TIMESTEP_NFTR_LOOP );
+
+    currentTime = newTime;
+
+    accumulator += frameTime;
+
+    deltaTime = timeStep_ * timeScale_.load( );
+
+    while ( accumulator >= deltaTime && !world_.requestingExit( ) )
+    {
+      _updateWorld( worldTime_, deltaTime );
+
+      ++updateFrame_;
+      worldTime_  += deltaTime;
+      accumulator -= deltaTime;
+    }
+
+    //
+    // let the render thread know when the last published
+    // state was current so it can compute an interpolation
+    //
+    simDeltaTime_ = deltaTime;
+    lastStepTime_ = currentTime - accumulator;
+
+    //
+    // nothing to do until the next step is due
+    //
+    const double sleepTime = std::min( deltaTime - accumulator, MAX_SIM_THREAD_SLEEP );
+
+    if ( sleepTime > 0.0 )
+    {
+      std::this_thread::sleep_for( std::chrono::duration< double >( sleepTime ) );
+    }
+  }
+} // ContinuousDriver::_runSimulationThread
+
+
+
 /////////////////////////////////////////////
 /// \brief ContinuousDriver::_getTimeSeconds
 ///
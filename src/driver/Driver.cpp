@@ -1,5 +1,9 @@
 #include "shared/core/Driver.hpp"
 
+#include "shared/core/World.hpp"
+#include "shared/core/JobSystem.hpp"
+#include "shared/core/Trace.hpp"
+
 #include <iostream>
 #include <sstream>
 
@@ -18,10 +22,28 @@ namespace shs
 Driver::Driver(
                World     &world,
                IOHandler &ioHandler
-               ) noexcept
-  : world_     ( world )
-  , ioHandler_ ( ioHandler )
-{}
+               )
+  : world_      ( world )
+  , ioHandler_  ( ioHandler )
+  , upJobSystem_( new JobSystem( ) )
+{
+  world_.setJobSystem( upJobSystem_.get( ) );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Driver::~Driver
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+Driver::~Driver( )
+{
+  if ( &world_.getJobSystem( ) == upJobSystem_.get( ) )
+  {
+    world_.setJobSystem( nullptr );
+  }
+}
 
 
 
@@ -72,4 +94,28 @@ Driver::printProjectInfo( const std::string name )
 
 
 
+/////////////////////////////////////////////
+/// \brief Driver::_updateWorld
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Driver::_updateWorld(
+                     const double worldTime,
+                     const double timeStep
+                     )
+{
+  SHS_TRACE_SCOPE( "update" );
+
+  world_.update( worldTime, timeStep );
+  upJobSystem_->resetScratchArenas( );
+
+  {
+    SHS_TRACE_SCOPE( "publishState" );
+    world_.publishState( );
+  }
+}
+
+
+
 } // namespace shs
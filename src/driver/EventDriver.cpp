@@ -2,6 +2,7 @@
 
 #include "shared/core/World.hpp"
 #include "shared/core/IOHandler.hpp"
+#include "shared/core/Trace.hpp"
 
 #include <iostream>
 
@@ -27,7 +28,7 @@ const double MAX_TIMESTEP_NFTR_LOOP = 0.05;
 EventDriver::EventDriver(
                          World     &world,
                          IOHandler &ioHandler
-                         ) noexcept
+                         )
   : Driver( world, ioHandler )
 {
   ioHandler_.setEventBased( true );
@@ -77,10 +78,18 @@ EventDriver::_runEventLoop( )
 {
   do
   {
-    ioHandler_.showWorld( 1.0 );
+    SHS_TRACE_SCOPE( "frame" );
+
+    {
+      SHS_TRACE_SCOPE( "showWorld" );
+      ioHandler_.showWorld( 1.0 );
+    }
 
     // check for input
-    ioHandler_.waitForIO( );
+    {
+      SHS_TRACE_SCOPE( "waitForIO" );
+      ioHandler_.waitForIO( );
+    }
   }
   while ( !ioHandler_.isExitRequested( ) );
 
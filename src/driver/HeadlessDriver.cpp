@@ -0,0 +1,207 @@
+#include "shared/core/HeadlessDriver.hpp"
+
+#include "shared/core/World.hpp"
+#include "shared/core/IOHandler.hpp"
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
+
+
+namespace shs
+{
+
+
+namespace
+{
+
+///
+/// \brief argValue
+/// \return true and sets 'value' if 'arg' starts with 'prefix'
+///
+bool
+argValue(
+         const std::string &arg,
+         const std::string &prefix,
+         std::string       *pValue
+         )
+{
+  if ( arg.compare( 0, prefix.length( ), prefix ) != 0 )
+  {
+    return false;
+  }
+
+  *pValue = arg.substr( prefix.length( ) );
+  return true;
+}
+
+
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief HeadlessDriver::HeadlessDriver
+/// \param world
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+HeadlessDriver::HeadlessDriver(
+                               World              &world,
+                               IOHandler          &ioHandler,
+                               const unsigned long maxSteps,
+                               const double        endTime,
+                               const unsigned long ioInterval,
+                               const double        timeStep
+                               )
+  : Driver( world, ioHandler )
+  , maxSteps_      ( maxSteps )
+  , endTime_       ( endTime )
+  , ioInterval_    ( ioInterval )
+  , timeStep_      ( timeStep )
+  , startTime_     ( 0.0 )
+  , worldTime_     ( startTime_ )
+  , updateFrame_   ( 0 )
+  , stepsPerSecond_( 0.0 )
+  , printStats_    ( true )
+{}
+
+
+
+/////////////////////////////////////////////
+/// \brief HeadlessDriver::exec
+/// \return
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+int
+HeadlessDriver::exec(
+                     int          argc, ///< number of arguments
+                     const char **argv  ///< array of argument strings
+                     )
+{
+  for ( int i = 1; i < argc; ++i )
+  {
+    const std::string arg( argv[ i ] );
+    std::string value;
+
+    try
+    {
+      if ( argValue( arg, "--steps=", &value ) )
+      {
+        maxSteps_ = std::stoul( value );
+      }
+      else if ( argValue( arg, "--end-time=", &value ) )
+      {
+        endTime_ = std::stod( value );
+      }
+      else if ( argValue( arg, "--io-interval=", &value ) )
+      {
+        ioInterval_ = std::stoul( value );
+      }
+      else if ( argValue( arg, "--time-step=", &value ) )
+      {
+        timeStep_ = std::stod( value );
+      }
+      else
+      {
+        std::cerr << "WARNING: Unknown argument given: " << arg << std::endl;
+      }
+    }
+    catch ( const std::logic_error& )
+    {
+      std::cerr << "WARNING: Invalid value given: " << arg << std::endl;
+    }
+  }
+
+  _runBatchLoop( );
+
+  ioHandler_.onLoopExit( );
+
+  if ( printStats_ )
+  {
+    std::cout << "Ran " << updateFrame_ << " steps to world time " << worldTime_
+              << " (" << stepsPerSecond_ << " steps/second)" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+} // HeadlessDriver::exec
+
+
+
+/////////////////////////////////////////////
+/// \brief HeadlessDriver::_runBatchLoop
+///
+///        Runs sim as fast as the world allows
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+HeadlessDriver::_runBatchLoop( )
+{
+  updateFrame_    = 0;
+  worldTime_      = startTime_;
+  stepsPerSecond_ = 0.0;
+
+  const auto wallStart = std::chrono::steady_clock::now( );
+
+  while ( !_limitReached( ) )
+  {
+    if ( ioInterval_ > 0 && updateFrame_ % ioInterval_ == 0 )
+    {
+      ioHandler_.updateIO( );
+
+      if ( ioHandler_.isExitRequested( ) )
+      {
+        break;
+      }
+
+      ioHandler_.showWorld( 1.0 );
+    }
+    else if ( IOHandler::interruptRequested( ) )
+    {
+      break;
+    }
+
+    _updateWorld( worldTime_, timeStep_ );
+    ++updateFrame_;
+    worldTime_ = updateFrame_ * timeStep_ + startTime_;
+  }
+
+  const std::chrono::duration< double > wallSecs = std::chrono::steady_clock::now( ) - wallStart;
+
+  if ( wallSecs.count( ) > 0.0 )
+  {
+    stepsPerSecond_ = updateFrame_ / wallSecs.count( );
+  }
+} // HeadlessDriver::_runBatchLoop
+
+
+
+/////////////////////////////////////////////
+/// \brief HeadlessDriver::_limitReached
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+HeadlessDriver::_limitReached( ) const
+{
+  if ( maxSteps_ > 0 && updateFrame_ >= maxSteps_ )
+  {
+    return true;
+  }
+
+  if ( endTime_ > 0.0 && worldTime_ >= endTime_ )
+  {
+    return true;
+  }
+
+  return world_.requestingExit( );
+}
+
+
+
+} // namespace shs
@@ -0,0 +1,159 @@
+// ContinuousDriverUnitTests.cpp
+#include "shared/core/ContinuousDriver.hpp"
+#include "shared/core/World.hpp"
+#include "shared/core/IOHandler.hpp"
+
+#include "gmock/gmock.h"
+
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+
+namespace
+{
+
+
+///
+/// \brief The ThreadRecordingWorld class
+///
+class ThreadRecordingWorld : public shs::World
+{
+
+public:
+
+  ThreadRecordingWorld( unsigned exitAfter )
+    : updates( 0 )
+    , published( 0 )
+    , exitAfter_( exitAfter )
+  {}
+
+  virtual
+  void
+  update(
+         const double,
+         const double
+         ) final
+  {
+    updateThread = std::this_thread::get_id( );
+
+    if ( ++updates >= exitAfter_ )
+    {
+      requestExit( );
+    }
+  }
+
+  virtual
+  void
+  publishState( ) final
+  {
+    ++published;
+  }
+
+  std::atomic< unsigned > updates;
+  std::atomic< unsigned > published;
+  std::thread::id updateThread;
+
+
+private:
+
+  unsigned exitAfter_;
+
+};
+
+
+///
+/// \brief The AlphaRecordingIOHandler class
+///
+class AlphaRecordingIOHandler : public shs::IOHandler
+{
+
+public:
+
+  AlphaRecordingIOHandler( shs::World &world )
+    : shs::IOHandler( world, false )
+    , shows( 0 )
+    , alphaInRange( true )
+  {}
+
+  virtual
+  void
+  showWorld( const double alpha ) final
+  {
+    showThread    = std::this_thread::get_id( );
+    alphaInRange &= ( alpha >= 0.0 && alpha <= 1.0 );
+    ++shows;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+  }
+
+  unsigned long shows;
+  bool alphaInRange;
+  std::thread::id showThread;
+
+};
+
+
+///
+/// \brief The ThrowingIOHandler class
+///
+class ThrowingIOHandler : public shs::IOHandler
+{
+
+public:
+
+  ThrowingIOHandler( shs::World &world )
+    : shs::IOHandler( world, false )
+  {}
+
+  virtual
+  void
+  showWorld( const double ) final
+  {
+    throw std::runtime_error( "render failure" );
+  }
+
+};
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ThreadedLoopUpdatesOnSeparateThread
+/////////////////////////////////////////////////////////////////
+TEST( ContinuousDriverUnitTests, ThreadedLoopUpdatesOnSeparateThread )
+{
+  ThreadRecordingWorld world( 2 );
+  AlphaRecordingIOHandler io( world );
+
+  shs::ContinuousDriver driver( world, io );
+
+  const char *argv[] = { "test", "--loop=threaded" };
+  EXPECT_EQ( EXIT_SUCCESS, driver.exec( 2, argv ) );
+
+  EXPECT_EQ( 2u, world.updates );
+  EXPECT_EQ( 2u, world.published );
+
+  EXPECT_GT( io.shows, 0u );
+  EXPECT_TRUE( io.alphaInRange );
+
+  EXPECT_EQ( std::this_thread::get_id( ), io.showThread );
+  EXPECT_NE( std::this_thread::get_id( ), world.updateThread );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ThreadedLoopJoinsWhenRenderingThrows
+/////////////////////////////////////////////////////////////////
+TEST( ContinuousDriverUnitTests, ThreadedLoopJoinsWhenRenderingThrows )
+{
+  ThreadRecordingWorld world( 1000000 );
+  ThrowingIOHandler io( world );
+
+  shs::ContinuousDriver driver( world, io );
+
+  const char *argv[] = { "test", "--loop=threaded" };
+  EXPECT_THROW( driver.exec( 2, argv ), std::runtime_error );
+}
+
+
+
+} // namespace
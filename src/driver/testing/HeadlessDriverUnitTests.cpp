@@ -0,0 +1,210 @@
+// HeadlessDriverUnitTests.cpp
+#include "shared/core/HeadlessDriver.hpp"
+#include "shared/core/World.hpp"
+#include "shared/core/IOHandler.hpp"
+
+#include "gmock/gmock.h"
+
+
+namespace
+{
+
+
+///
+/// \brief The CountingWorld class
+///
+class CountingWorld : public shs::World
+{
+
+public:
+
+  CountingWorld( unsigned long exitAfter = 0 )
+    : updates( 0 )
+    , lastTime( -1.0 )
+    , exitAfter_( exitAfter )
+  {}
+
+  virtual
+  void
+  update(
+         const double worldTime,
+         const double
+         ) final
+  {
+    ++updates;
+    lastTime = worldTime;
+
+    if ( exitAfter_ > 0 && updates >= exitAfter_ )
+    {
+      requestExit( );
+    }
+  }
+
+  unsigned long updates;
+  double lastTime;
+
+
+private:
+
+  unsigned long exitAfter_;
+
+};
+
+
+///
+/// \brief The CountingIOHandler class
+///
+class CountingIOHandler : public shs::IOHandler
+{
+
+public:
+
+  CountingIOHandler( shs::World &world )
+    : shs::IOHandler( world, false )
+    , ioUpdates( 0 )
+    , shows( 0 )
+  {}
+
+  virtual
+  void
+  updateIO( ) final
+  {
+    ++ioUpdates;
+  }
+
+  virtual
+  void
+  showWorld( const double ) final
+  {
+    ++shows;
+  }
+
+  unsigned long ioUpdates;
+  unsigned long shows;
+
+};
+
+
+///
+/// \brief The HeadlessDriverUnitTests class
+///
+class HeadlessDriverUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief HeadlessDriverUnitTests
+  /////////////////////////////////////////////////////////////////
+  HeadlessDriverUnitTests( )
+    : world_( )
+    , io_( world_ )
+  {}
+
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ~HeadlessDriverUnitTests
+  /////////////////////////////////////////////////////////////////
+  virtual
+  ~HeadlessDriverUnitTests( )
+  {}
+
+
+  CountingWorld world_;
+  CountingIOHandler io_;
+
+};
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief StopsAfterMaxSteps
+/////////////////////////////////////////////////////////////////
+TEST_F( HeadlessDriverUnitTests, StopsAfterMaxSteps )
+{
+  shs::HeadlessDriver driver( world_, io_, 250 );
+  driver.setPrintStats( false );
+
+  const char *argv[] = { "test" };
+  EXPECT_EQ( EXIT_SUCCESS, driver.exec( 1, argv ) );
+
+  EXPECT_EQ( 250u, world_.updates );
+  EXPECT_EQ( 250u, driver.getStepsTaken( ) );
+  EXPECT_GT( driver.getStepsPerSecond( ), 0.0 );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief StopsAtEndTime
+/////////////////////////////////////////////////////////////////
+TEST_F( HeadlessDriverUnitTests, StopsAtEndTime )
+{
+  shs::HeadlessDriver driver( world_, io_, 0, 1.0, 0, 0.25 );
+  driver.setPrintStats( false );
+
+  const char *argv[] = { "test" };
+  driver.exec( 1, argv );
+
+  EXPECT_EQ( 4u, world_.updates );
+  EXPECT_DOUBLE_EQ( 0.75, world_.lastTime );
+  EXPECT_DOUBLE_EQ( 1.0, driver.getWorldTime( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief NeverCallsIOWithZeroInterval
+/////////////////////////////////////////////////////////////////
+TEST_F( HeadlessDriverUnitTests, NeverCallsIOWithZeroInterval )
+{
+  shs::HeadlessDriver driver( world_, io_, 100 );
+  driver.setPrintStats( false );
+
+  const char *argv[] = { "test" };
+  driver.exec( 1, argv );
+
+  EXPECT_EQ( 100u, world_.updates );
+  EXPECT_EQ( 0u, io_.ioUpdates );
+  EXPECT_EQ( 0u, io_.shows );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief CallsIOEveryInterval
+/////////////////////////////////////////////////////////////////
+TEST_F( HeadlessDriverUnitTests, CallsIOEveryInterval )
+{
+  shs::HeadlessDriver driver( world_, io_ );
+  driver.setPrintStats( false );
+
+  const char *argv[] = { "test", "--steps=100", "--io-interval=10" };
+  driver.exec( 3, argv );
+
+  EXPECT_EQ( 100u, world_.updates );
+  EXPECT_EQ( 10u, io_.ioUpdates );
+  EXPECT_EQ( 10u, io_.shows );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief StopsWhenWorldRequestsExit
+/////////////////////////////////////////////////////////////////
+TEST( HeadlessDriverExitTest, StopsWhenWorldRequestsExit )
+{
+  CountingWorld world( 42 );
+  CountingIOHandler io( world );
+
+  shs::HeadlessDriver driver( world, io, 1000 );
+  driver.setPrintStats( false );
+
+  const char *argv[] = { "test" };
+  driver.exec( 1, argv );
+
+  EXPECT_EQ( 42u, world.updates );
+}
+
+
+
+} // namespace
@@ -5,6 +5,7 @@
 #include "graphics/glfw/CallbackSingleton.hpp"
 
 #ifdef USE_OPENGL
+#include "shared/graphics/OpenGLStateCache.hpp"
 #include <glad/glad.h>
 #endif
 
@@ -49,6 +50,10 @@ GlfwWrapper::~GlfwWrapper( )
 {
   if ( pWindow_ )
   {
+#ifdef USE_OPENGL
+    OpenGLStateCache::releaseContext( pWindow_ );
+#endif
+
     glfwDestroyWindow( pWindow_ );
     pWindow_ = nullptr;
   }
@@ -0,0 +1,151 @@
+#include "shared/graphics/DrawBatch.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+
+namespace shg
+{
+
+
+
+/////////////////////////////////////////////
+/// \brief DrawBatch::DrawBatch
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+DrawBatch::DrawBatch(
+                     const std::size_t drawDataSize,
+                     const GLuint      binding
+                     )
+  : drawDataSize_( drawDataSize )
+  , binding_( binding )
+{
+  if ( !isSupported( ) )
+  {
+    throw std::runtime_error( "DrawBatch needs GL 4.3 and ARB_shader_draw_parameters" );
+  }
+
+  spCommandBuffer_  = OpenGLHelper::createBuffer< DrawElementsCommand >(
+                                                                        nullptr,
+                                                                        0,
+                                                                        GL_DRAW_INDIRECT_BUFFER,
+                                                                        GL_STREAM_DRAW
+                                                                        );
+  spDrawDataBuffer_ = OpenGLHelper::createBuffer< unsigned char >(
+                                                                  nullptr,
+                                                                  0,
+                                                                  GL_SHADER_STORAGE_BUFFER,
+                                                                  GL_STREAM_DRAW
+                                                                  );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief DrawBatch::addDraw
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+DrawBatch::addDraw(
+                   const GLuint count,
+                   const GLuint firstIndex,
+                   const GLint  baseVertex,
+                   const void  *pDrawData
+                   )
+{
+  commands_.push_back( DrawElementsCommand{ count, 1, firstIndex, baseVertex, 0 } );
+
+  const std::size_t offset = drawData_.size( );
+  drawData_.resize( offset + drawDataSize_ );
+
+  if ( drawDataSize_ > 0 )
+  {
+    std::memcpy( drawData_.data( ) + offset, pDrawData, drawDataSize_ );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief DrawBatch::submit
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+DrawBatch::submit(
+                  const std::shared_ptr< GLuint > &spVao,
+                  const std::shared_ptr< GLuint > &spIbo,
+                  const GLenum                     mode,
+                  const GLenum                     iboType
+                  )
+{
+  if ( commands_.empty( ) )
+  {
+    return;
+  }
+
+  OpenGLHelper::streamBuffer(
+                             spCommandBuffer_,
+                             commands_.size( ),
+                             commands_.data( ),
+                             GL_DRAW_INDIRECT_BUFFER
+                             );
+
+  if ( drawDataSize_ > 0 )
+  {
+    OpenGLHelper::streamBuffer(
+                               spDrawDataBuffer_,
+                               drawData_.size( ),
+                               drawData_.data( ),
+                               GL_SHADER_STORAGE_BUFFER
+                               );
+
+    // also sets the generic binding, which the cache already holds
+    glBindBufferBase( GL_SHADER_STORAGE_BUFFER, binding_, *spDrawDataBuffer_ );
+  }
+
+  OpenGLStateCache::get( ).bindVertexArray( *spVao );
+  OpenGLStateCache::get( ).bindBuffer( GL_ELEMENT_ARRAY_BUFFER, *spIbo );
+
+  glMultiDrawElementsIndirect(
+                              mode,
+                              iboType,
+                              nullptr,
+                              static_cast< GLsizei >( commands_.size( ) ),
+                              0
+                              );
+} // DrawBatch::submit
+
+
+
+/////////////////////////////////////////////
+/// \brief DrawBatch::clear
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+DrawBatch::clear( )
+{
+  commands_.clear( );
+  drawData_.clear( );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief DrawBatch::isSupported
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+DrawBatch::isSupported( )
+{
+  return GLAD_GL_VERSION_4_3 && GLAD_GL_ARB_shader_draw_parameters;
+}
+
+
+
+} // namespace shg
@@ -0,0 +1,415 @@
+#include "shared/graphics/FrameCapture.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+// frames waiting for the writer before new ones are dropped
+constexpr std::size_t MAX_QUEUED_FRAMES = 8;
+
+// one second, only reached if the GPU is far behind, the frame is dropped
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
+
+///
+/// \brief getExtension
+///
+std::string
+getExtension( const std::string &filePath )
+{
+  const size_t dot = filePath.find_last_of( '.' );
+
+  if ( dot == std::string::npos )
+  {
+    return "";
+  }
+
+  std::string ext = filePath.substr( dot );
+  std::transform( ext.begin( ), ext.end( ), ext.begin( ), ::tolower );
+
+  return ext;
+}
+
+
+///
+/// \brief toByte clamps a BT.601 result to [0, 255]
+///
+unsigned char
+toByte( const int value )
+{
+  return static_cast< unsigned char >( std::min( 255, std::max( 0, value ) ) );
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::FrameCapture
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+FrameCapture::FrameCapture(
+                           const std::string &filePath,
+                           const int          width,
+                           const int          height,
+                           const int          fps,
+                           const std::size_t  numBuffers
+                           )
+  : filePath_( filePath )
+  , format_( RAW )
+  , width_( width )
+  , height_( height )
+  , fps_( fps )
+  , nextFrame_( 0 )
+  , stallCount_( 0 )
+  , framesWritten_( 0 )
+  , framesDropped_( 0 )
+  , stopping_( false )
+{
+  if ( width_ <= 0 || height_ <= 0 || numBuffers == 0 )
+  {
+    throw std::runtime_error( "FrameCapture needs a positive size and at least one buffer" );
+  }
+
+  const std::string ext = getExtension( filePath_ );
+
+  format_ = ( ext == ".ppm" ) ? PPM : ( ext == ".y4m" ) ? Y4M : RAW;
+
+  if ( format_ != PPM )
+  {
+    stream_.open( filePath_, std::ios::out | std::ios::binary | std::ios::trunc );
+
+    if ( !stream_.is_open( ) )
+    {
+      throw std::runtime_error( "Could not open capture file: " + filePath_ );
+    }
+  }
+
+  if ( format_ == Y4M )
+  {
+    stream_ << "YUV4MPEG2 W" << width_ << " H" << height_ << " F" << fps_ << ":1 Ip A1:1 C444\n";
+  }
+
+  const std::size_t frameSize = static_cast< std::size_t >( width_ ) * static_cast< std::size_t >( height_ ) * 4;
+
+  for ( std::size_t i = 0; i < numBuffers; ++i )
+  {
+    slots_.push_back( Slot{
+                        OpenGLHelper::createBuffer< unsigned char >(
+                                                                    nullptr,
+                                                                    frameSize,
+                                                                    GL_PIXEL_PACK_BUFFER,
+                                                                    GL_STREAM_READ
+                                                                    ),
+                        nullptr,
+                        0
+                      } );
+  }
+
+  // reads into client memory everywhere else
+  OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+  writer_ = std::thread( &FrameCapture::_writeFrames, this );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::~FrameCapture
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+FrameCapture::~FrameCapture( )
+{
+  // oldest first so frames stay in order
+  for ( std::size_t i = 0; i < slots_.size( ); ++i )
+  {
+    Slot &slot = slots_[ ( nextFrame_ + i ) % slots_.size( ) ];
+
+    if ( slot.fence )
+    {
+      _readSlot( slot );
+    }
+  }
+
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    stopping_ = true;
+  }
+
+  frameReady_.notify_one( );
+  writer_.join( );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::capture
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+FrameCapture::capture( )
+{
+  Slot &slot = slots_[ nextFrame_ % slots_.size( ) ];
+
+  // hand off the frame this buffer got last time around
+  if ( slot.fence )
+  {
+    _readSlot( slot );
+  }
+
+  OpenGLStateCache &cache = OpenGLStateCache::get( );
+
+  cache.bindFramebuffer( GL_READ_FRAMEBUFFER, 0 );
+  cache.bindBuffer( GL_PIXEL_PACK_BUFFER, *slot.spBuffer );
+
+  glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+
+  // returns immediately, the copy happens on the GPU
+  glReadPixels( 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+
+  cache.bindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+  slot.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+  slot.frame = nextFrame_++;
+} // FrameCapture::capture
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::getFramesCaptured
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::size_t
+FrameCapture::getFramesCaptured( ) const
+{
+  return nextFrame_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::getFramesWritten
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::size_t
+FrameCapture::getFramesWritten( ) const
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+  return framesWritten_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::getFramesDropped
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::size_t
+FrameCapture::getFramesDropped( ) const
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+  return framesDropped_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::_readSlot
+///
+///        Copies a finished readback out of its buffer and
+///        queues it for the writer.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+FrameCapture::_readSlot( Slot &slot )
+{
+  GLenum result = glClientWaitSync( slot.fence, 0, 0 );
+
+  if ( result == GL_TIMEOUT_EXPIRED )
+  {
+    ++stallCount_;
+    result = glClientWaitSync( slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS );
+  }
+
+  glDeleteSync( slot.fence );
+  slot.fence = nullptr;
+
+  // mapping now would block on the unfinished readback
+  if ( result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED )
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    ++framesDropped_;
+    return;
+  }
+
+  const std::size_t frameSize = static_cast< std::size_t >( width_ ) * static_cast< std::size_t >( height_ ) * 4;
+
+  std::vector< unsigned char > rgba( frameSize );
+
+  OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_PACK_BUFFER, *slot.spBuffer );
+
+  const void *pPixels = glMapBufferRange(
+                                         GL_PIXEL_PACK_BUFFER,
+                                         0,
+                                         static_cast< GLsizeiptr >( frameSize ),
+                                         GL_MAP_READ_BIT
+                                         );
+
+  if ( pPixels )
+  {
+    std::memcpy( rgba.data( ), pPixels, frameSize );
+  }
+
+  glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+  OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+  std::unique_lock< std::mutex > lock( mutex_ );
+
+  if ( !pPixels || frames_.size( ) >= MAX_QUEUED_FRAMES )
+  {
+    ++framesDropped_;
+    return;
+  }
+
+  frames_.emplace_back( slot.frame, std::move( rgba ) );
+
+  lock.unlock( );
+  frameReady_.notify_one( );
+} // FrameCapture::_readSlot
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::_writeFrames
+///
+///        Writer thread loop.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+FrameCapture::_writeFrames( )
+{
+  std::unique_lock< std::mutex > lock( mutex_ );
+
+  for ( ;; )
+  {
+    frameReady_.wait( lock, [ this ] { return stopping_ || !frames_.empty( ); } );
+
+    if ( frames_.empty( ) )
+    {
+      break; // stopping and everything is written
+    }
+
+    std::pair< std::size_t, std::vector< unsigned char > > frame = std::move( frames_.front( ) );
+    frames_.pop_front( );
+
+    lock.unlock( );
+    _writeFrame( frame.second, frame.first );
+    lock.lock( );
+
+    ++framesWritten_;
+  }
+
+  if ( stream_.is_open( ) )
+  {
+    stream_.close( );
+  }
+} // FrameCapture::_writeFrames
+
+
+
+/////////////////////////////////////////////
+/// \brief FrameCapture::_writeFrame
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+FrameCapture::_writeFrame(
+                          const std::vector< unsigned char > &rgba,
+                          const std::size_t                   frame
+                          )
+{
+  const std::size_t width  = static_cast< std::size_t >( width_ );
+  const std::size_t height = static_cast< std::size_t >( height_ );
+
+  // GL rows start at the bottom, every format here starts at the top
+  auto pixel = [ & ] ( const std::size_t x, const std::size_t y )
+               {
+                 return &rgba[ ( ( height - 1 - y ) * width + x ) * 4 ];
+               };
+
+  if ( format_ == Y4M )
+  {
+    std::vector< unsigned char > planes( width * height * 3 );
+
+    unsigned char *pY = planes.data( );
+    unsigned char *pU = pY + width * height;
+    unsigned char *pV = pU + width * height;
+
+    // BT.601 studio range
+    for ( std::size_t y = 0; y < height; ++y )
+    {
+      for ( std::size_t x = 0; x < width; ++x, ++pY, ++pU, ++pV )
+      {
+        const unsigned char *p = pixel( x, y );
+        const int r = p[ 0 ], g = p[ 1 ], b = p[ 2 ];
+
+        *pY = toByte( ( ( 66 * r + 129 * g + 25 * b + 128 ) >> 8 ) + 16 );
+        *pU = toByte( ( ( -38 * r - 74 * g + 112 * b + 128 ) >> 8 ) + 128 );
+        *pV = toByte( ( ( 112 * r - 94 * g - 18 * b + 128 ) >> 8 ) + 128 );
+      }
+    }
+
+    stream_ << "FRAME\n";
+    stream_.write( reinterpret_cast< const char* >( planes.data( ) ), static_cast< std::streamsize >( planes.size( ) ) );
+    return;
+  }
+
+  std::vector< unsigned char > rgb;
+  rgb.reserve( width * height * 3 );
+
+  for ( std::size_t y = 0; y < height; ++y )
+  {
+    for ( std::size_t x = 0; x < width; ++x )
+    {
+      const unsigned char *p = pixel( x, y );
+      rgb.insert( rgb.end( ), p, p + 3 );
+    }
+  }
+
+  if ( format_ == PPM )
+  {
+    std::stringstream name;
+    name << filePath_.substr( 0, filePath_.size( ) - 4 ) << "_" << std::setw( 6 ) << std::setfill( '0' ) << frame << ".ppm";
+
+    std::ofstream file( name.str( ), std::ios::out | std::ios::binary | std::ios::trunc );
+
+    file << "P6\n" << width_ << " " << height_ << "\n255\n";
+    file.write( reinterpret_cast< const char* >( rgb.data( ) ), static_cast< std::streamsize >( rgb.size( ) ) );
+    return;
+  }
+
+  stream_.write( reinterpret_cast< const char* >( rgb.data( ) ), static_cast< std::streamsize >( rgb.size( ) ) );
+} // FrameCapture::_writeFrame
+
+
+
+} // namespace shg
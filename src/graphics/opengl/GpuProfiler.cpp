@@ -0,0 +1,391 @@
+#include "shared/graphics/GpuProfiler.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+constexpr double NS_PER_MS = 1.0e6;
+
+
+///
+/// \brief writeCsvString writes str as a quoted CSV field,
+///        doubling quotes and keeping rows on one line
+///
+void
+writeCsvString(
+               std::ostream      &out,
+               const std::string &str
+               )
+{
+  out << '"';
+
+  for ( const char c : str )
+  {
+    if ( c == '"' )
+    {
+      out << "\"\"";
+    }
+    else if ( static_cast< unsigned char >( c ) < 0x20 )
+    {
+      out << ' ';
+    }
+    else
+    {
+      out << c;
+    }
+  }
+
+  out << '"';
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::Scope::Scope
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+GpuProfiler::Scope::Scope(
+                          GpuProfiler       *pProfiler,
+                          const std::string &name
+                          )
+  : pProfiler_( pProfiler )
+{
+  if ( pProfiler_ )
+  {
+    pProfiler_->beginScope( name );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::Scope::~Scope
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+GpuProfiler::Scope::~Scope( )
+{
+  if ( pProfiler_ )
+  {
+    pProfiler_->endScope( );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::GpuProfiler
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+GpuProfiler::GpuProfiler( const std::size_t latency )
+  : frames_( std::max< std::size_t >( latency, 1 ) )
+  , current_( 0 )
+  , recording_( false )
+  , frameNumber_( 0 )
+  , framesDropped_( 0 )
+  , timingsFrame_( 0 )
+{
+  if ( !isSupported( ) )
+  {
+    throw std::runtime_error( "GpuProfiler requires timestamp queries (GL 3.3 or ARB_timer_query)" );
+  }
+
+  for ( Frame &frame : frames_ )
+  {
+    frame.last    = 0;
+    frame.number  = 0;
+    frame.pending = false;
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::~GpuProfiler
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+GpuProfiler::~GpuProfiler( )
+{
+  for ( Frame &frame : frames_ )
+  {
+    if ( !frame.queryPool.empty( ) )
+    {
+      glDeleteQueries( static_cast< GLsizei >( frame.queryPool.size( ) ), frame.queryPool.data( ) );
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::isSupported
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+GpuProfiler::isSupported( )
+{
+  return GLAD_GL_VERSION_3_3 || GLAD_GL_ARB_timer_query;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::beginFrame
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+GpuProfiler::beginFrame( )
+{
+  if ( recording_ )
+  {
+    endFrame( );
+  }
+
+  ++frameNumber_;
+
+  Frame &frame = frames_[ current_ ];
+
+  //
+  // the GPU is a whole ring behind, skip the
+  // frame instead of waiting for its queries
+  //
+  if ( frame.pending && !_tryRead( frame ) )
+  {
+    ++framesDropped_;
+    return;
+  }
+
+  frame.timings.clear( );
+  frame.queries.clear( );
+  frame.open.clear( );
+  frame.number = frameNumber_;
+
+  recording_ = true;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::endFrame
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+GpuProfiler::endFrame( )
+{
+  if ( recording_ )
+  {
+    while ( !frames_[ current_ ].open.empty( ) )
+    {
+      endScope( );
+    }
+
+    frames_[ current_ ].pending = !frames_[ current_ ].queries.empty( );
+    recording_                  = false;
+
+    current_ = ( current_ + 1 ) % frames_.size( );
+  }
+
+  //
+  // oldest first, queries complete in order so the
+  // first frame that is not ready ends the search
+  //
+  for ( std::size_t i = 0; i < frames_.size( ); ++i )
+  {
+    Frame &frame = frames_[ ( current_ + i ) % frames_.size( ) ];
+
+    if ( frame.pending && !_tryRead( frame ) )
+    {
+      break;
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::beginScope
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+GpuProfiler::beginScope( const std::string &name )
+{
+  if ( !recording_ )
+  {
+    return;
+  }
+
+  Frame &frame = frames_[ current_ ];
+
+  const std::size_t queryIndex = frame.queries.size( );
+
+  if ( frame.queryPool.size( ) < ( queryIndex + 1 ) * 2 )
+  {
+    const std::size_t oldSize = frame.queryPool.size( );
+
+    frame.queryPool.resize( std::max< std::size_t >( 16, oldSize * 2 ) );
+    glGenQueries(
+                 static_cast< GLsizei >( frame.queryPool.size( ) - oldSize ),
+                 frame.queryPool.data( ) + oldSize
+                 );
+  }
+
+  Query query;
+  query.timing = frame.timings.size( );
+  query.begin  = frame.queryPool[ queryIndex * 2 ];
+  query.end    = frame.queryPool[ queryIndex * 2 + 1 ];
+
+  frame.timings.push_back( ScopeTiming{ name, static_cast< int >( frame.open.size( ) ), 0.0, 0.0 } );
+  frame.open.push_back( queryIndex );
+
+  glQueryCounter( query.begin, GL_TIMESTAMP );
+  query.cpuStart = Clock::now( );
+
+  frame.queries.push_back( query );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::endScope
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+GpuProfiler::endScope( )
+{
+  if ( !recording_ || frames_[ current_ ].open.empty( ) )
+  {
+    return;
+  }
+
+  Frame &frame = frames_[ current_ ];
+  Query &query = frame.queries[ frame.open.back( ) ];
+
+  frame.open.pop_back( );
+
+  const std::chrono::duration< double, std::milli > cpuTime = Clock::now( ) - query.cpuStart;
+
+  frame.timings[ query.timing ].cpuMs = cpuTime.count( );
+
+  glQueryCounter( query.end, GL_TIMESTAMP );
+  frame.last = query.end;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::startCsv
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+GpuProfiler::startCsv( const std::string &filePath )
+{
+  stopCsv( );
+
+  csv_.open( filePath, std::ios::out | std::ios::trunc );
+
+  if ( !csv_.is_open( ) )
+  {
+    throw std::runtime_error( "Failed to open profiler output file " + filePath );
+  }
+
+  csv_ << "frame,scope,depth,cpu_ms,gpu_ms\n";
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::stopCsv
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+GpuProfiler::stopCsv( )
+{
+  if ( csv_.is_open( ) )
+  {
+    csv_.close( );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief GpuProfiler::_tryRead
+///
+///        Reads a frame's timestamps if they are all
+///        available. Timestamps complete in order, so only
+///        the last one issued is checked.
+///
+/// \return false if the frame is not ready yet
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+GpuProfiler::_tryRead( Frame &frame )
+{
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv( frame.last, GL_QUERY_RESULT_AVAILABLE, &available );
+
+  if ( !available )
+  {
+    return false;
+  }
+
+  for ( const Query &query : frame.queries )
+  {
+    GLuint64 begin = 0;
+    GLuint64 end   = 0;
+
+    glGetQueryObjectui64v( query.begin, GL_QUERY_RESULT, &begin );
+    glGetQueryObjectui64v( query.end,   GL_QUERY_RESULT, &end   );
+
+    frame.timings[ query.timing ].gpuMs = ( end > begin ) ? static_cast< double >( end - begin ) / NS_PER_MS : 0.0;
+  }
+
+  frame.pending = false;
+
+  // never replace newer timings with older ones
+  if ( frame.number > timingsFrame_ )
+  {
+    timings_      = frame.timings;
+    timingsFrame_ = frame.number;
+  }
+
+  if ( csv_.is_open( ) )
+  {
+    for ( const ScopeTiming &timing : frame.timings )
+    {
+      csv_ << frame.number << ',';
+      writeCsvString( csv_, timing.name );
+      csv_ << ','
+           << timing.depth << ','
+           << timing.cpuMs << ','
+           << timing.gpuMs << '\n';
+    }
+  }
+
+  return true;
+}
+
+
+
+} // namespace shg
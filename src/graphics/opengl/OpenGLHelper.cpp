@@ -1,4 +1,5 @@
 #include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/ProgramCache.hpp"
 
 #include <string>
 #include <iostream>
@@ -16,6 +17,20 @@ namespace shg
 namespace
 {
 
+///
+/// \brief programUniforms
+///
+///        Uniform tables of every live program, keyed by id.
+///        Entries are added at link time and dropped by
+///        OpenGLHelper::deleteProgram.
+///
+std::unordered_map< GLuint, UniformTable > &
+programUniforms( )
+{
+  static std::unordered_map< GLuint, UniformTable > tables;
+  return tables;
+}
+
 const std::unordered_map< std::string, GLenum > shaderTypes =
 {
   { ".vert", GL_VERTEX_SHADER },
@@ -26,6 +41,30 @@ const std::unordered_map< std::string, GLenum > shaderTypes =
   { ".comp", GL_COMPUTE_SHADER }
 };
 
+
+std::shared_ptr< ProgramCache > &
+programCache( )
+{
+  static std::shared_ptr< ProgramCache > spCache;
+  return spCache;
+}
+
+
+std::string
+getShaderExtension( const std::string &filePath )
+{
+  size_t dot = filePath.find_last_of( "." );
+
+  std::string ext = ( dot == std::string::npos ) ? "" : filePath.substr( dot );
+
+  if ( shaderTypes.find( ext ) == shaderTypes.end( ) )
+  {
+    throw std::runtime_error( "Unknown shader extension: " + ext );
+  }
+
+  return ext;
+}
+
 }
 
 
@@ -59,6 +98,32 @@ OpenGLHelper::setDefaults( )
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::setProgramCache
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::setProgramCache( std::shared_ptr< ProgramCache > spCache )
+{
+  programCache( ) = spCache;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::getProgramCache
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+std::shared_ptr< ProgramCache >
+OpenGLHelper::getProgramCache( )
+{
+  return programCache( );
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief OpenGLHelper::addTextureArray
 /// \return
@@ -81,13 +146,13 @@ OpenGLHelper::createTextureArray(
                                       new GLuint,
                                       [ ] ( auto pID )
     {
-      glDeleteTextures( 1, pID );
+      OpenGLStateCache::get( ).deleteTextures( 1, pID );
       delete pID;
     }
                                       );
 
   glGenTextures( 1, spTexture.get( ) );
-  glBindTexture( GL_TEXTURE_2D, *spTexture );
+  OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, *spTexture );
 
   glTexParameteri( GL_TEXTURE_2D,     GL_TEXTURE_WRAP_S,   wrapType );
   glTexParameteri( GL_TEXTURE_2D,     GL_TEXTURE_WRAP_T,   wrapType );
@@ -119,7 +184,7 @@ OpenGLHelper::createVao(
   std::shared_ptr< GLuint > spVao( new GLuint,
                                   [ ] ( auto pID )
     {
-      glDeleteVertexArrays( 1, pID );
+      OpenGLStateCache::get( ).deleteVertexArrays( 1, pID );
       delete pID;
     } );
 
@@ -127,12 +192,12 @@ OpenGLHelper::createVao(
   // Initialize the vertex array object
   //
   glGenVertexArrays( 1, spVao.get( ) );
-  glBindVertexArray( *spVao );
+  OpenGLStateCache::get( ).bindVertexArray( *spVao );
 
   //
   // bind buffer and save program id for loop
   //
-  glBindBuffer( GL_ARRAY_BUFFER, *spVbo );
+  OpenGLStateCache::get( ).bindBuffer( GL_ARRAY_BUFFER, *spVbo );
 
   //
   // iteratoe through all elements
@@ -165,15 +230,74 @@ OpenGLHelper::createVao(
                           );
   }
 
-  // Unbind buffers.
-  glBindBuffer( GL_ARRAY_BUFFER, 0 );
-  glBindVertexArray( 0 );
-
   return spVao;
 } // createVao
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::addInstanceAttributes
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::addInstanceAttributes(
+                                    const std::shared_ptr< GLuint > &spVao,         ///<
+                                    const std::shared_ptr< GLuint > &spProgram,     ///<
+                                    const std::shared_ptr< GLuint > &spInstanceVbo, ///<
+                                    const GLsizei                    totalStride,   ///<
+                                    const std::vector< VAOElement > &elements,      ///<
+                                    const GLuint                     divisor        ///<
+                                    )
+{
+  OpenGLStateCache::get( ).bindVertexArray( *spVao );
+  OpenGLStateCache::get( ).bindBuffer( GL_ARRAY_BUFFER, *spInstanceVbo );
+
+  for ( const auto &vaoElmt : elements )
+  {
+    int pos = glGetAttribLocation( *spProgram, vaoElmt.name.c_str( ) );
+
+    if ( pos < 0 )
+    {
+      std::stringstream msg;
+      msg << "attrib location "
+          << vaoElmt.name
+          << " not found for program "
+          << *spProgram;
+
+      throw std::runtime_error( msg.str( ) );
+    }
+
+    //
+    // attributes are at most 4 components wide so
+    // matrices are split into one location per column
+    //
+    const GLint columns    = ( vaoElmt.size + 3 ) / 4;
+    const GLint columnSize = std::min( vaoElmt.size, 4 );
+
+    for ( GLint column = 0; column < columns; ++column )
+    {
+      const GLuint position = static_cast< GLuint >( pos + column );
+
+      const char *pOffset = static_cast< const char* >( vaoElmt.pointer )
+                            + static_cast< size_t >( column * columnSize ) * sizeof( float );
+
+      glEnableVertexAttribArray( position );
+      glVertexAttribPointer(
+                            position,
+                            columnSize,
+                            vaoElmt.type,
+                            GL_FALSE,
+                            totalStride,
+                            pOffset
+                            );
+      glVertexAttribDivisor( position, divisor );
+    }
+  }
+} // OpenGLHelper::addInstanceAttributes
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief OpenGLHelper::createFramebuffer
 /// \return
@@ -208,21 +332,21 @@ OpenGLHelper::createFramebuffer(
   spFbo = std::shared_ptr< GLuint >( new GLuint,
                                     [ spRbo ] ( auto pID )
     {
-      glDeleteFramebuffers( 1, pID );
+      OpenGLStateCache::get( ).deleteFramebuffers( 1, pID );
       delete pID;
     }
                                     );
 
 
   glGenFramebuffers( 1, spFbo.get( ) );
-  glBindFramebuffer( GL_FRAMEBUFFER, *spFbo );
+  OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, *spFbo );
 
   //
   // set color attachment if there is one
   //
   if ( spColorTex )
   {
-    glBindTexture( GL_TEXTURE_2D, *spColorTex );
+    OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, *spColorTex );
 
     glFramebufferTexture2D(
                            GL_FRAMEBUFFER,
@@ -240,7 +364,7 @@ OpenGLHelper::createFramebuffer(
 
   if ( spDepthTex )
   {
-    glBindTexture( GL_TEXTURE_2D, *spDepthTex );
+    OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, *spDepthTex );
 
     glFramebufferTexture2D(
                            GL_FRAMEBUFFER,
@@ -268,7 +392,7 @@ OpenGLHelper::createFramebuffer(
     throw std::runtime_error( "Framebuffer creation failed" );
   }
 
-  glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+  OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, 0 );
 
   return spFbo;
 } // createFramebuffer
@@ -284,7 +408,7 @@ OpenGLHelper::createFramebuffer(
 void
 OpenGLHelper::bindFramebuffer( )
 {
-  glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+  OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, 0 );
 }
 
 
@@ -298,7 +422,7 @@ OpenGLHelper::bindFramebuffer( )
 void
 OpenGLHelper::bindFramebuffer( const std::shared_ptr< GLuint > &spFbo )
 {
-  glBindFramebuffer( GL_FRAMEBUFFER, *spFbo );
+  OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, *spFbo );
 }
 
 
@@ -316,6 +440,59 @@ OpenGLHelper::clearFramebuffer( )
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::useProgram
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::useProgram( const std::shared_ptr< GLuint > &spProgram )
+{
+  OpenGLStateCache::get( ).useProgram( *spProgram );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::deleteProgram
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::deleteProgram( const GLuint program )
+{
+  programUniforms( ).erase( program );
+  OpenGLStateCache::get( ).deleteProgram( program );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::getUniform
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+UniformHandle
+OpenGLHelper::getUniform(
+                         const std::shared_ptr< GLuint > &spProgram, ///<
+                         const std::string               &uniform    ///<
+                         )
+{
+  std::unordered_map< GLuint, UniformTable > &tables = programUniforms( );
+
+  auto it = tables.find( *spProgram );
+
+  // programs linked outside OpenGLHelper get a table on first use
+  if ( it == tables.end( ) )
+  {
+    it = tables.emplace( *spProgram, UniformTable( *spProgram ) ).first;
+  }
+
+  return it->second.getUniform( uniform );
+} // OpenGLHelper::getUniform
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief OpenGLHelper::setTextureUniform
 ///
@@ -324,14 +501,31 @@ OpenGLHelper::clearFramebuffer( )
 void
 OpenGLHelper::setTextureUniform(
                                 const std::shared_ptr< GLuint > &spProgram, ///<
-                                const std::string                uniform,   ///<
+                                const std::string               &uniform,   ///<
                                 const std::shared_ptr< GLuint > &spTexture, ///<
                                 int                              activeTex  ///<
                                 )
 {
-  glActiveTexture( static_cast< GLenum >( GL_TEXTURE0 + activeTex ) );
-  glUniform1i( glGetUniformLocation( *spProgram, uniform.c_str( ) ), activeTex );
-  glBindTexture( GL_TEXTURE_2D, *spTexture );
+  setTextureUniform( getUniform( spProgram, uniform ), spTexture, activeTex );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::setTextureUniform
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::setTextureUniform(
+                                const UniformHandle             &uniform,   ///<
+                                const std::shared_ptr< GLuint > &spTexture, ///<
+                                int                              activeTex  ///<
+                                )
+{
+  OpenGLStateCache::get( ).activeTexture( static_cast< GLenum >( GL_TEXTURE0 + activeTex ) );
+  glUniform1i( uniform.location, activeTex );
+  OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, *spTexture );
 }
 
 
@@ -344,29 +538,47 @@ OpenGLHelper::setTextureUniform(
 void
 OpenGLHelper::setIntUniform(
                             const std::shared_ptr< GLuint > &spProgram, ///<
-                            const std::string                uniform,   ///<
+                            const std::string               &uniform,   ///<
                             const int                       *pValue,    ///<
                             const int                        size,      ///<
                             const int                        count      ///<
                             )
+{
+  setIntUniform( getUniform( spProgram, uniform ), pValue, size, count );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::setIntUniform
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::setIntUniform(
+                            const UniformHandle &uniform, ///<
+                            const int           *pValue,  ///<
+                            const int            size,    ///<
+                            const int            count    ///<
+                            )
 {
   switch ( size )
   {
 
   case 1:
-    glUniform1i( glGetUniformLocation( *spProgram, uniform.c_str( ) ), *pValue );
+    glUniform1i( uniform.location, *pValue );
     break;
 
   case 2:
-    glUniform2iv( glGetUniformLocation( *spProgram, uniform.c_str( ) ), count, pValue );
+    glUniform2iv( uniform.location, count, pValue );
     break;
 
   case 3:
-    glUniform3iv( glGetUniformLocation( *spProgram, uniform.c_str( ) ), count, pValue );
+    glUniform3iv( uniform.location, count, pValue );
     break;
 
   case 4:
-    glUniform4iv( glGetUniformLocation( *spProgram, uniform.c_str( ) ), count, pValue );
+    glUniform4iv( uniform.location, count, pValue );
     break;
 
   default:
@@ -389,29 +601,47 @@ OpenGLHelper::setIntUniform(
 void
 OpenGLHelper::setFloatUniform(
                               const std::shared_ptr< GLuint > &spProgram, ///<
-                              const std::string                uniform,   ///<
+                              const std::string               &uniform,   ///<
                               const float                     *pValue,    ///<
                               const int                        size,      ///<
                               const int                        count      ///<
                               )
+{
+  setFloatUniform( getUniform( spProgram, uniform ), pValue, size, count );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::setFloatUniform
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::setFloatUniform(
+                              const UniformHandle &uniform, ///<
+                              const float         *pValue,  ///<
+                              const int            size,    ///<
+                              const int            count    ///<
+                              )
 {
   switch ( size )
   {
 
   case 1:
-    glUniform1f( glGetUniformLocation( *spProgram, uniform.c_str( ) ), *pValue );
+    glUniform1f( uniform.location, *pValue );
     break;
 
   case 2:
-    glUniform2fv( glGetUniformLocation( *spProgram, uniform.c_str( ) ), count, pValue );
+    glUniform2fv( uniform.location, count, pValue );
     break;
 
   case 3:
-    glUniform3fv( glGetUniformLocation( *spProgram, uniform.c_str( ) ), count, pValue );
+    glUniform3fv( uniform.location, count, pValue );
     break;
 
   case 4:
-    glUniform4fv( glGetUniformLocation( *spProgram, uniform.c_str( ) ), count, pValue );
+    glUniform4fv( uniform.location, count, pValue );
     break;
 
   default:
@@ -434,17 +664,35 @@ OpenGLHelper::setFloatUniform(
 void
 OpenGLHelper::setMatrixUniform(
                                const std::shared_ptr< GLuint > &spProgram, ///<
-                               const std::string                uniform,   ///<
+                               const std::string               &uniform,   ///<
                                const float                     *pValue,    ///<
                                const int                        size,      ///<
                                const int                        count      ///<
                                )
+{
+  setMatrixUniform( getUniform( spProgram, uniform ), pValue, size, count );
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::setMatrixUniform
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::setMatrixUniform(
+                               const UniformHandle &uniform, ///<
+                               const float         *pValue,  ///<
+                               const int            size,    ///<
+                               const int            count    ///<
+                               )
 {
   switch ( size )
   {
   case 2:
     glUniformMatrix2fv(
-                       glGetUniformLocation( *spProgram, uniform.c_str( ) ),
+                       uniform.location,
                        count,
                        GL_FALSE,
                        pValue
@@ -453,7 +701,7 @@ OpenGLHelper::setMatrixUniform(
 
   case 3:
     glUniformMatrix3fv(
-                       glGetUniformLocation( *spProgram, uniform.c_str( ) ),
+                       uniform.location,
                        count,
                        GL_FALSE,
                        pValue
@@ -463,7 +711,7 @@ OpenGLHelper::setMatrixUniform(
 
   case 4:
     glUniformMatrix4fv(
-                       glGetUniformLocation( *spProgram, uniform.c_str( ) ),
+                       uniform.location,
                        count,
                        GL_FALSE,
                        pValue
@@ -497,24 +745,53 @@ OpenGLHelper::renderBuffer(
                            const GLenum                     iboType
                            )
 {
-  glBindVertexArray( *spVao );
+  OpenGLStateCache::get( ).bindVertexArray( *spVao );
 
   if ( spIbo )
   {
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, *spIbo );
+    OpenGLStateCache::get( ).bindBuffer( GL_ELEMENT_ARRAY_BUFFER, *spIbo );
     glDrawElements( mode, verts, iboType, pOffset );
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
   }
   else
   {
     glDrawArrays( mode, start, verts );
   }
-
-  glBindVertexArray( 0 );
 } // OpenGLHelper::renderBuffer
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::renderBufferInstanced
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+void
+OpenGLHelper::renderBufferInstanced(
+                                    const std::shared_ptr< GLuint > &spVao,
+                                    const int                        start,
+                                    const int                        verts,
+                                    const GLenum                     mode,
+                                    const int                        instances,
+                                    const std::shared_ptr< GLuint > &spIbo,
+                                    const void                      *pOffset,
+                                    const GLenum                     iboType
+                                    )
+{
+  OpenGLStateCache::get( ).bindVertexArray( *spVao );
+
+  if ( spIbo )
+  {
+    OpenGLStateCache::get( ).bindBuffer( GL_ELEMENT_ARRAY_BUFFER, *spIbo );
+    glDrawElementsInstanced( mode, verts, iboType, pOffset, instances );
+  }
+  else
+  {
+    glDrawArraysInstanced( mode, start, verts, instances );
+  }
+} // OpenGLHelper::renderBufferInstanced
+
+
+
 //void
 //OpenGLHelper::setBlending( bool blend )
 //{
@@ -603,10 +880,18 @@ OpenGLHelper::_readFile( const std::string filePath )
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::_createShader
+///
+///        Submits the source for compiling. The status is left for
+///        _checkShader so the driver can compile every stage at once.
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
 std::shared_ptr< GLuint >
 OpenGLHelper::_createShader(
-                            GLenum            shaderType,
-                            const std::string filePath
+                            GLenum             shaderType,
+                            const std::string &source
                             )
 {
   std::shared_ptr< GLuint > upShader( new GLuint,
@@ -619,15 +904,23 @@ OpenGLHelper::_createShader(
   GLuint shader = glCreateShader( shaderType );
   *upShader = shader;
 
-  // Load shader
-  std::string shaderStr    = _readFile( filePath );
-  const char *shaderSource = shaderStr.c_str( );
+  const char *shaderSource = source.c_str( );
 
   // Compile shader
   glShaderSource( shader, 1, &shaderSource, nullptr );
   glCompileShader( shader );
 
-  // Check shader
+  return upShader;
+} // OpenGLHelper::_createShader
+
+
+
+void
+OpenGLHelper::_checkShader(
+                           const GLuint       shader,
+                           const std::string &filePath
+                           )
+{
   GLint result = GL_FALSE;
   glGetShaderiv( shader, GL_COMPILE_STATUS, &result );
 
@@ -635,36 +928,116 @@ OpenGLHelper::_createShader(
   {
     int logLength = 0;
     glGetShaderiv( shader, GL_INFO_LOG_LENGTH, &logLength );
-    std::vector< char > shaderError( static_cast< size_t >( logLength ) );
+    std::vector< char > shaderError( static_cast< size_t >( logLength ) + 1 );
     glGetShaderInfoLog( shader, logLength, nullptr, shaderError.data( ) );
 
     // shader will get deleted when shared_ptr goes out of scope
 
-    throw std::runtime_error( "(Shader) " + std::string( shaderError.data( ) ) );
+    throw std::runtime_error( "(Shader) " + filePath + "\n" + std::string( shaderError.data( ) ) );
   }
-
-  return upShader;
-} // OpenGLHelper::_createShader
+} // OpenGLHelper::_checkShader
 
 
 
 std::shared_ptr< GLuint >
-OpenGLHelper::_createShader( const std::string filePath )
+OpenGLHelper::_createProgram( const std::vector< std::string > &filePaths )
 {
-  size_t dot = filePath.find_last_of( "." );
+  return OpenGLHelper::createProgramAsync( filePaths ).get( );
+}
 
-  std::string ext = filePath.substr( dot );
 
-  if ( shaderTypes.find( ext ) == shaderTypes.end( ) )
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::createProgramAsync
+///
+///        Reads every shader and, when a ProgramCache is set, tries
+///        the binary stored for those exact sources before compiling.
+///        Otherwise all stages are compiled and linked without
+///        checking in between; the returned PendingProgram checks
+///        them and writes the binary back to the cache.
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
+PendingProgram
+OpenGLHelper::createProgramAsync( const std::vector< std::string > &filePaths )
+{
+  std::vector< std::string > sources;
+
+  // key parts are each stage's extension followed by its source
+  for ( const auto &filePath : filePaths )
   {
-    throw std::runtime_error( "Unknown shader extension: " + ext );
+    sources.emplace_back( getShaderExtension( filePath ) );
+    sources.emplace_back( _readFile( filePath ) );
   }
 
-  return OpenGLHelper::_createShader( shaderTypes.at( ext ), filePath );
-} // OpenGLHelper::_createShader
+  const std::shared_ptr< ProgramCache > spCache = programCache( );
+
+  std::uint64_t key = 0;
+
+  if ( spCache && spCache->isSupported( ) )
+  {
+    key = spCache->makeKey( sources );
+
+    GLuint program = spCache->load( key );
+
+    if ( program != 0 )
+    {
+      std::shared_ptr< GLuint > upProgram( new GLuint( program ),
+                                          [ ] ( auto pID )
+        {
+          OpenGLHelper::deleteProgram( *pID );
+          delete pID;
+        } );
+
+      programUniforms( )[ program ] = UniformTable( program );
+
+      return PendingProgram( upProgram, nullptr );
+    }
+  }
+
+  IdVec shaderIds;
+
+  // submit all the shaders
+  for ( size_t i = 0; i < filePaths.size( ); ++i )
+  {
+    shaderIds.emplace_back( OpenGLHelper::_createShader(
+                                                        shaderTypes.at( sources[ i * 2 ] ),
+                                                        sources[ i * 2 + 1 ]
+                                                        ) );
+  }
+
+  // link shaders and create OpenGL program
+  std::shared_ptr< GLuint > upProgram = OpenGLHelper::_createProgram( shaderIds );
+
+  const GLuint program = *upProgram;
+
+  return PendingProgram(
+                        upProgram,
+                        [ program, shaderIds, filePaths, spCache, key ]
+    {
+      for ( size_t i = 0; i < shaderIds.size( ); ++i )
+      {
+        OpenGLHelper::_checkShader( *shaderIds[ i ], filePaths[ i ] );
+      }
 
+      OpenGLHelper::_checkProgram( program, shaderIds );
+
+      if ( spCache && spCache->isSupported( ) )
+      {
+        spCache->store( key, program );
+      }
+    } );
+} // OpenGLHelper::createProgramAsync
 
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief OpenGLHelper::_createProgram
+///
+///        Submits the link. The status is left for _checkProgram.
+///
+/// \author Logan Barnes
+////////////////////////////////////////////////////////////////////////////////
 std::shared_ptr< GLuint >
 OpenGLHelper::_createProgram( const IdVec shaderIds )
 {
@@ -676,7 +1049,7 @@ OpenGLHelper::_createProgram( const IdVec shaderIds )
         glDeleteShader( *upShader );
       }
 
-      glDeleteProgram( *pID );
+      OpenGLHelper::deleteProgram( *pID );
       delete pID;
     } );
 
@@ -689,9 +1062,24 @@ OpenGLHelper::_createProgram( const IdVec shaderIds )
     glAttachShader( program, *upShader );
   }
 
+  if ( programCache( ) && programCache( )->isSupported( ) )
+  {
+    glProgramParameteri( program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+  }
+
   glLinkProgram( program );
 
-  // Check program
+  return upProgram;
+} // OpenGLHelper::_createProgram
+
+
+
+void
+OpenGLHelper::_checkProgram(
+                            const GLuint program,
+                            const IdVec &shaderIds
+                            )
+{
   GLint result = GL_FALSE;
   glGetProgramiv( program, GL_LINK_STATUS, &result );
 
@@ -699,7 +1087,7 @@ OpenGLHelper::_createProgram( const IdVec shaderIds )
   {
     int logLength = 0;
     glGetProgramiv( program, GL_INFO_LOG_LENGTH, &logLength );
-    std::vector< char > programError( static_cast< size_t >( logLength ) );
+    std::vector< char > programError( static_cast< size_t >( logLength ) + 1 );
     glGetProgramInfoLog( program, logLength, NULL, programError.data( ) );
 
     // shaders and programs get deleted with shared_ptr goes out of scope
@@ -712,8 +1100,8 @@ OpenGLHelper::_createProgram( const IdVec shaderIds )
     glDetachShader( program, *upShader );
   }
 
-  return upProgram;
-} // OpenGLHelper::_createProgram
+  programUniforms( )[ program ] = UniformTable( program );
+} // OpenGLHelper::_checkProgram
 
 
 
@@ -0,0 +1,499 @@
+#include "shared/graphics/OpenGLStateCache.hpp"
+
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+// binding the driver may hold that the cache doesn't know about
+constexpr GLuint UNKNOWN = std::numeric_limits< GLuint >::max( );
+
+
+// bumped on every release so threads drop their remembered cache
+std::atomic< std::uint64_t > releases( 0 );
+
+
+std::mutex&
+cacheMutex( )
+{
+  static std::mutex mutex;
+
+  return mutex;
+}
+
+
+std::uint64_t
+textureKey(
+           const GLuint unit,
+           const GLenum target
+           )
+{
+  return ( static_cast< std::uint64_t >( unit ) << 32 ) | target;
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::get
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+OpenGLStateCache&
+OpenGLStateCache::get( )
+{
+  //
+  // remembered per thread so the map is only searched when
+  // the thread switches contexts or one is released
+  //
+  static thread_local const void *pLastContext       = nullptr;
+  static thread_local OpenGLStateCache *pLastCache   = nullptr;
+  static thread_local std::uint64_t lastReleases     = 0;
+
+  const void *pContext           = glfwGetCurrentContext( );
+  const std::uint64_t releaseNum = releases.load( );
+
+  if ( pLastCache && pContext == pLastContext && releaseNum == lastReleases )
+  {
+    return *pLastCache;
+  }
+
+  std::lock_guard< std::mutex > lock( cacheMutex( ) );
+
+  std::unique_ptr< OpenGLStateCache > &upCache = _caches( )[ pContext ];
+
+  if ( !upCache )
+  {
+    upCache.reset( new OpenGLStateCache( ) );
+  }
+
+  pLastContext = pContext;
+  pLastCache   = upCache.get( );
+  lastReleases = releaseNum;
+
+  return *upCache;
+} // OpenGLStateCache::get
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::releaseContext
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::releaseContext( const void *pContext )
+{
+  std::lock_guard< std::mutex > lock( cacheMutex( ) );
+
+  if ( _caches( ).erase( pContext ) )
+  {
+    ++releases;
+  }
+} // OpenGLStateCache::releaseContext
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::_caches
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::unordered_map< const void*, std::unique_ptr< OpenGLStateCache > >&
+OpenGLStateCache::_caches( )
+{
+  static std::unordered_map< const void*, std::unique_ptr< OpenGLStateCache > > caches;
+
+  return caches;
+} // OpenGLStateCache::_caches
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::OpenGLStateCache
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+OpenGLStateCache::OpenGLStateCache( )
+{
+  invalidate( );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::bindBuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::bindBuffer(
+                             const GLenum target,
+                             const GLuint buffer
+                             )
+{
+  if ( target == GL_ELEMENT_ARRAY_BUFFER )
+  {
+    // without a known vertex array there is nothing to key on
+    if ( vertexArray_ == UNKNOWN )
+    {
+      ++current_.issued;
+      glBindBuffer( target, buffer );
+      return;
+    }
+
+    auto it = elementBuffers_.emplace( vertexArray_, UNKNOWN ).first;
+
+    if ( _changed( it->second, buffer ) )
+    {
+      glBindBuffer( target, buffer );
+    }
+
+    return;
+  }
+
+  auto it = buffers_.emplace( target, UNKNOWN ).first;
+
+  if ( _changed( it->second, buffer ) )
+  {
+    glBindBuffer( target, buffer );
+  }
+} // OpenGLStateCache::bindBuffer
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::bindVertexArray
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::bindVertexArray( const GLuint vertexArray )
+{
+  if ( _changed( vertexArray_, vertexArray ) )
+  {
+    glBindVertexArray( vertexArray );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::useProgram
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::useProgram( const GLuint program )
+{
+  if ( _changed( program_, program ) )
+  {
+    glUseProgram( program );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::activeTexture
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::activeTexture( const GLenum unit )
+{
+  if ( _changed( activeTexture_, unit ) )
+  {
+    glActiveTexture( unit );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::bindTexture
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::bindTexture(
+                              const GLenum target,
+                              const GLuint texture
+                              )
+{
+  if ( activeTexture_ == UNKNOWN )
+  {
+    ++current_.issued;
+    glBindTexture( target, texture );
+    return;
+  }
+
+  auto it = textures_.emplace( textureKey( activeTexture_, target ), UNKNOWN ).first;
+
+  if ( _changed( it->second, texture ) )
+  {
+    glBindTexture( target, texture );
+  }
+} // OpenGLStateCache::bindTexture
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::bindFramebuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::bindFramebuffer(
+                                  const GLenum target,
+                                  const GLuint framebuffer
+                                  )
+{
+  bool changed = false;
+
+  if ( target == GL_FRAMEBUFFER )
+  {
+    changed = drawFramebuffer_ != framebuffer || readFramebuffer_ != framebuffer;
+
+    drawFramebuffer_ = framebuffer;
+    readFramebuffer_ = framebuffer;
+  }
+  else
+  {
+    GLuint &cached = ( target == GL_READ_FRAMEBUFFER ? readFramebuffer_ : drawFramebuffer_ );
+
+    changed = cached != framebuffer;
+    cached  = framebuffer;
+  }
+
+  if ( changed )
+  {
+    ++current_.issued;
+    glBindFramebuffer( target, framebuffer );
+  }
+  else
+  {
+    ++current_.skipped;
+  }
+} // OpenGLStateCache::bindFramebuffer
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::deleteBuffers
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::deleteBuffers(
+                                const GLsizei n,
+                                const GLuint *pBuffers
+                                )
+{
+  for ( GLsizei i = 0; i < n; ++i )
+  {
+    _forget( buffers_,        pBuffers[ i ] );
+    _forget( elementBuffers_, pBuffers[ i ] );
+  }
+
+  glDeleteBuffers( n, pBuffers );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::deleteVertexArrays
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::deleteVertexArrays(
+                                     const GLsizei n,
+                                     const GLuint *pVertexArrays
+                                     )
+{
+  for ( GLsizei i = 0; i < n; ++i )
+  {
+    elementBuffers_.erase( pVertexArrays[ i ] );
+
+    if ( vertexArray_ == pVertexArrays[ i ] )
+    {
+      vertexArray_ = UNKNOWN;
+    }
+  }
+
+  glDeleteVertexArrays( n, pVertexArrays );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::deleteProgram
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::deleteProgram( const GLuint program )
+{
+  if ( program_ == program )
+  {
+    program_ = UNKNOWN;
+  }
+
+  glDeleteProgram( program );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::deleteTextures
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::deleteTextures(
+                                 const GLsizei n,
+                                 const GLuint *pTextures
+                                 )
+{
+  for ( GLsizei i = 0; i < n; ++i )
+  {
+    _forget( textures_, pTextures[ i ] );
+  }
+
+  glDeleteTextures( n, pTextures );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::deleteFramebuffers
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::deleteFramebuffers(
+                                     const GLsizei n,
+                                     const GLuint *pFramebuffers
+                                     )
+{
+  for ( GLsizei i = 0; i < n; ++i )
+  {
+    if ( drawFramebuffer_ == pFramebuffers[ i ] )
+    {
+      drawFramebuffer_ = UNKNOWN;
+    }
+
+    if ( readFramebuffer_ == pFramebuffers[ i ] )
+    {
+      readFramebuffer_ = UNKNOWN;
+    }
+  }
+
+  glDeleteFramebuffers( n, pFramebuffers );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::invalidate
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::invalidate( )
+{
+  buffers_.clear( );
+  elementBuffers_.clear( );
+  textures_.clear( );
+
+  vertexArray_     = UNKNOWN;
+  program_         = UNKNOWN;
+  activeTexture_   = UNKNOWN;
+  drawFramebuffer_ = UNKNOWN;
+  readFramebuffer_ = UNKNOWN;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::endFrame
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::endFrame( )
+{
+  lastFrame_ = current_;
+  current_   = Counters( );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::_changed
+///
+///        Records id as bound and counts the bind.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+OpenGLStateCache::_changed(
+                           GLuint      &cached,
+                           const GLuint id
+                           )
+{
+  if ( cached == id )
+  {
+    ++current_.skipped;
+    return false;
+  }
+
+  ++current_.issued;
+  cached = id;
+
+  return true;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief OpenGLStateCache::_forget
+///
+///        Marks every binding of a deleted id as unknown. The
+///        driver resets some of them to 0 but ones held by other
+///        vertex arrays or texture units keep the old object
+///        alive, so unknown is the only safe answer.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+OpenGLStateCache::_forget(
+                          std::unordered_map< std::uint64_t, GLuint > &map,
+                          const GLuint                                 id
+                          )
+{
+  for ( auto &binding : map )
+  {
+    if ( binding.second == id )
+    {
+      binding.second = UNKNOWN;
+    }
+  }
+}
+
+
+
+} // namespace shg
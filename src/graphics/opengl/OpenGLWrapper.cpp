@@ -5,6 +5,7 @@
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <utility>
 #include <sstream>
 #include <stdexcept>
 
@@ -17,9 +18,10 @@ namespace shg
 /// \brief OpenGLWrapper::OpenGLWrapper
 ///
 OpenGLWrapper::OpenGLWrapper( )
-  : viewportWidth_( 0 )
+  : contexts_( 1, ContextVAOs{ nullptr, nullptr, { }, { }, true } )
+  , currentContext_( 0 )
+  , viewportWidth_( 0 )
   , viewportHeight_( 0 )
-  , pContext_( nullptr )
 {}
 
 
@@ -29,35 +31,51 @@ OpenGLWrapper::OpenGLWrapper( )
 ///
 OpenGLWrapper::~OpenGLWrapper( )
 {
-  for ( auto &it : programs_ )
+  programs_.forEach( [ ]( Program &program )
+                    {
+                      OpenGLHelper::deleteProgram( program.id );
+                    } );
+
+  textures_.forEach( [ ]( Texture &texture )
+                    {
+                      OpenGLStateCache::get( ).deleteTextures( 1, &texture.id );
+                    } );
+
+  buffers_.forEach( [ ]( Buffer &buffer )
+                   {
+                     OpenGLStateCache::get( ).deleteBuffers( 1, &buffer.vbo );
+                   } );
+
+  indexBuffers_.forEach( [ ]( IndexBuffer &buffer )
+                        {
+                          OpenGLStateCache::get( ).deleteBuffers( 1, &buffer.ibo );
+                        } );
+
+  //
+  // vertex arrays of contexts that can not be made
+  // current here go with their context
+  //
+  for ( std::size_t i = 0; i < contexts_.size( ); ++i )
   {
-    glDeleteProgram( it.second );
-  }
-
-  for ( auto &it : textures_ )
-  {
-    glDeleteTextures( 1, &( it.second ) );
-  }
-
-  for ( auto &it : buffers_ )
-  {
-    glDeleteBuffers( 1, &( it.second.vbo ) );
-  }
+    _inContext( i, [ ]( ContextVAOs &context )
+               {
+                 for ( GLuint &vao : context.vaos )
+                 {
+                   OpenGLStateCache::get( ).deleteVertexArrays( 1, &vao );
+                 }
 
-  for ( auto &vaos : vaoMap_ )
-  {
-    for ( auto &it : vaos.second )
-    {
-      glDeleteVertexArrays( 1, &it.second );
-    }
+                 for ( GLuint &vao : context.orphanedVaos )
+                 {
+                   OpenGLStateCache::get( ).deleteVertexArrays( 1, &vao );
+                 }
+               } );
   }
 
-  for ( auto &it : framebuffers_ )
-  {
-    const FrameBuffer &buffer = it.second;
-    glDeleteFramebuffers( 1, &( buffer.fbo ) );
-    glDeleteRenderbuffers( 1, &( buffer.rbo ) );
-  }
+  framebuffers_.forEach( [ ]( FrameBuffer &buffer )
+                        {
+                          OpenGLStateCache::get( ).deleteFramebuffers( 1, &buffer.fbo );
+                          glDeleteRenderbuffers( 1, &buffer.rbo );
+                        } );
 }
 
 
@@ -98,46 +116,116 @@ OpenGLWrapper::setDefaults(
 
 
 
+// name lookups
+OpenGLWrapper::ProgramHandle
+OpenGLWrapper::getProgramHandle( const std::string &name ) const
+{
+  return _find( programs_, name, "programs" );
+}
+
+
+
+OpenGLWrapper::TextureHandle
+OpenGLWrapper::getTextureHandle( const std::string &name ) const
+{
+  return _find( textures_, name, "textures" );
+}
+
+
+
+OpenGLWrapper::BufferHandle
+OpenGLWrapper::getBufferHandle( const std::string &name ) const
+{
+  return _find( buffers_, name, "buffer" );
+}
+
+
+
+OpenGLWrapper::IndexBufferHandle
+OpenGLWrapper::getIndexBufferHandle( const std::string &name ) const
+{
+  return _find( indexBuffers_, name, "indexBuffer" );
+}
+
+
+
+OpenGLWrapper::FramebufferHandle
+OpenGLWrapper::getFramebufferHandle( const std::string &name ) const
+{
+  return _find( framebuffers_, name, "framebuffers" );
+}
+
+
+
 // getters
 GLuint
-OpenGLWrapper::getTexture( const std::string name )
+OpenGLWrapper::getTexture( const std::string &name )
 {
-  _checkItemExists( name, textures_, "texture" );
-  return textures_[ name ];
+  return getTexture( getTextureHandle( name ) );
 }
 
 
 
-void
+GLuint
+OpenGLWrapper::getTexture( const TextureHandle texture )
+{
+  return _get( textures_, texture, "texture" ).id;
+}
+
+
+
+OpenGLWrapper::TextureHandle
 OpenGLWrapper::setTexture(
-                          const std::string name,
-                          const GLuint      id,
-                          const bool        forceOverride,
-                          const bool        forceDelete
+                          const std::string &name,
+                          const GLuint       id,
+                          const bool         forceOverride,
+                          const bool         forceDelete
                           )
 {
-  _replaceItemId(
-                 name,
-                 textures_,
-                 id,
-                 "texture",
-                 forceOverride,
-                 forceDelete,
-                 [ this, &name ]( )
-                 {
-                   glDeleteTextures( 1, &( this->textures_[ name ] ) );
-                 }
-                 );
+  const TextureHandle handle = textures_.find( name );
+
+  if ( !handle.isValid( ) )
+  {
+    return textures_.create( Texture{ id }, name );
+  }
+
+  Texture &texture = *textures_.get( handle );
+
+  if ( texture.id != id )
+  {
+    if ( !forceOverride )
+    {
+      std::stringstream msg;
+      msg << "Item '" << name << "' already exists in "
+          << "texture registry and 'forceOverride' is false.";
+      throw std::runtime_error( msg.str( ) );
+    }
+
+    if ( forceDelete )
+    {
+      OpenGLStateCache::get( ).deleteTextures( 1, &texture.id );
+    }
+  }
+
+  texture.id = id;
 
+  return handle;
 }
 
 
 
 GLuint
-OpenGLWrapper::getBuffer( const std::string name )
+OpenGLWrapper::getBuffer( const std::string &name )
 {
-  _checkItemExists( name, buffers_, "buffer" );
-  return buffers_[ name ].vbo;
+  return getBuffer( getBufferHandle( name ) );
+}
+
+
+
+GLuint
+OpenGLWrapper::getBuffer( const BufferHandle buffer )
+{
+  return _get( buffers_, buffer, "buffer" ).vbo;
 }
 
 
@@ -148,38 +236,50 @@ OpenGLWrapper::getBuffer( const std::string name )
 /// \param vertFilePath
 /// \param fragFilePath
 ///
-void
+OpenGLWrapper::ProgramHandle
 OpenGLWrapper::addProgram(
-                          const std::string name,
-                          const std::string vertFilePath,
-                          const std::string fragFilePath
+                          const std::string &name,
+                          const std::string &vertFilePath,
+                          const std::string &fragFilePath
                           )
 
 {
-  programs_[ name ] = OpenGLWrapper::_loadShader( vertFilePath, fragFilePath );
+  const GLuint program = OpenGLWrapper::_loadShader( vertFilePath, fragFilePath );
+
+  const ProgramHandle handle = programs_.find( name );
+
+  if ( handle.isValid( ) )
+  {
+    Program &existing = *programs_.get( handle );
+    OpenGLHelper::deleteProgram( existing.id );
+
+    existing = Program{ program, UniformTable( program ) };
+    return handle;
+  }
+
+  const ProgramHandle created = programs_.create( Program{ program, UniformTable( program ) }, name );
+
+  // buffers added before their program
+  _buildVAOs( );
+
+  return created;
 }
 
 
 
-void
+OpenGLWrapper::TextureHandle
 OpenGLWrapper::addTextureArray(
-                               const std::string name,
-                               GLsizei           width,
-                               GLsizei           height,
-                               float            *pArray,
-                               bool              linear
+                               const std::string &name,
+                               GLsizei            width,
+                               GLsizei            height,
+                               float             *pArray,
+                               bool               linear
                                )
 
 {
-
-  if ( textures_.find( name ) != textures_.end( ) )
-  {
-    glDeleteTextures( 1, &( textures_[ name ] ) );
-  }
-
   GLuint texture;
   glGenTextures( 1, &texture );
-  glBindTexture( GL_TEXTURE_2D, texture );
+  OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, texture );
 
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
@@ -197,28 +297,23 @@ OpenGLWrapper::addTextureArray(
 
   glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, pArray );
 
-  textures_[ name ] = texture;
+  return _addTexture( name, texture );
 
 } // addTextureArray
 
 
 
-void
+OpenGLWrapper::TextureHandle
 OpenGLWrapper::addTextureImage(
-                               const std::string name,
-                               GLsizei           width,
-                               GLsizei           height,
-                               const std::       string
+                               const std::string &name,
+                               GLsizei            width,
+                               GLsizei            height,
+                               const std::string&
                                )
 {
-  if ( textures_.find( name ) != textures_.end( ) )
-  {
-    glDeleteTextures( 1, &( textures_[ name ] ) );
-  }
-
   GLuint texture;
   glGenTextures( 1, &texture );
-  glBindTexture( GL_TEXTURE_2D, texture );
+  OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, texture );
 
   glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,      GL_REPEAT );
   glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,      GL_REPEAT );
@@ -227,12 +322,40 @@ OpenGLWrapper::addTextureImage(
 
   glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, NULL );
 
-  textures_[ name ] = texture;
+  return _addTexture( name, texture );
 
 } // addTextureImage
 
 
 
+///
+/// \brief OpenGLWrapper::_addTexture
+///
+///        Registers a new texture or replaces (and deletes)
+///        the one already registered as name.
+///
+OpenGLWrapper::TextureHandle
+OpenGLWrapper::_addTexture(
+                           const std::string &name,
+                           const GLuint       id
+                           )
+{
+  const TextureHandle handle = textures_.find( name );
+
+  if ( handle.isValid( ) )
+  {
+    Texture &texture = *textures_.get( handle );
+    OpenGLStateCache::get( ).deleteTextures( 1, &texture.id );
+
+    texture.id = id;
+    return handle;
+  }
+
+  return textures_.create( Texture{ id }, name );
+}
+
+
+
 GLuint
 OpenGLWrapper::_addVAOToBuffer(
                                const GLuint      vbo,
@@ -241,15 +364,13 @@ OpenGLWrapper::_addVAOToBuffer(
 {
   GLuint vao;
 
-  glBindBuffer( GL_ARRAY_BUFFER, vbo );
+  OpenGLStateCache::get( ).bindBuffer( GL_ARRAY_BUFFER, vbo );
 
   // Initialize the vertex array object.
   glGenVertexArrays( 1, &vao );
-  glBindVertexArray( vao );
+  OpenGLStateCache::get( ).bindVertexArray( vao );
 
-  _checkItemExists( settings.program, programs_, "programs" );
-
-  const GLuint &program = programs_.at( settings.program );
+  const GLuint program = programs_.get( _find( programs_, settings.program, "programs" ) )->id;
 
   for ( size_t i = 0; i < settings.settings.size( ); ++i )
   {
@@ -280,54 +401,271 @@ OpenGLWrapper::_addVAOToBuffer(
                           );
   }
 
-  // Unbind buffers.
-  glBindBuffer( GL_ARRAY_BUFFER, 0 );
-  glBindVertexArray( 0 );
-
   return vao;
 
 } // OpenGLWrapper::addVAOToBuffer
 
 
 
+///
+/// \brief OpenGLWrapper::_getVAO
+///
+///        Vertex arrays are normally built ahead of time. One is
+///        only missing here if the buffer's program was never
+///        added, in which case building it throws.
+///
 GLuint
-OpenGLWrapper::_getVAO( const Buffer &buf )
+OpenGLWrapper::_getVAO(
+                       const BufferHandle handle,
+                       const Buffer      &buf
+                       )
 {
-  ContextVAOMap &vaos = vaoMap_[ buf.vbo ];
+  std::vector< GLuint > &vaos = contexts_[ currentContext_ ].vaos;
+  const std::size_t index     = handle.getIndex( );
 
-  if ( vaos.find( pContext_ ) == vaos.end( ) )
+  if ( index >= vaos.size( ) || vaos[ index ] == 0 )
   {
-    vaos[ pContext_ ] = _addVAOToBuffer( buf.vbo, buf.settings );
+    vaos.resize( std::max( vaos.size( ), index + 1 ), 0 );
+    vaos[ index ] = _addVAOToBuffer( buf.vbo, buf.settings );
   }
 
-  return vaos[ pContext_ ];
+  return vaos[ index ];
+}
+
 
+
+void
+OpenGLWrapper::registerContext(
+                               void                          *pContext,
+                               const std::function< void( ) > makeCurrent
+                               )
+{
+  const std::size_t index = _findContext( pContext );
+
+  contexts_[ index ].makeCurrent = makeCurrent;
+
+  _inContext( index, [ this ]( ContextVAOs &context ){ _buildContextVAOs( context ); } );
 }
 
 
 
 void
+OpenGLWrapper::setCurrentContext( void *pContext )
+{
+  const std::size_t index = _findContext( pContext );
+
+  currentContext_ = index;
+
+  // usually built when the buffers were added, by then
+  if ( contexts_[ currentContext_ ].dirty )
+  {
+    _buildContextVAOs( contexts_[ currentContext_ ] );
+  }
+}
+
+
+
+std::size_t
+OpenGLWrapper::getVertexArrayCount( const void *pContext ) const
+{
+  for ( const ContextVAOs &context : contexts_ )
+  {
+    if ( context.pContext == pContext )
+    {
+      return static_cast< std::size_t >(
+        std::count_if( context.vaos.begin( ), context.vaos.end( ), [ ]( const GLuint vao ){ return vao != 0; } )
+        );
+    }
+  }
+
+  return 0;
+}
+
+
+
+///
+/// \brief OpenGLWrapper::_findContext
+/// \return index of the context, registering it if needed
+///
+std::size_t
+OpenGLWrapper::_findContext( void *pContext )
+{
+  for ( std::size_t i = 0; i < contexts_.size( ); ++i )
+  {
+    if ( contexts_[ i ].pContext == pContext )
+    {
+      return i;
+    }
+  }
+
+  // the first context given is the one that was in use
+  if ( contexts_.size( ) == 1 && contexts_[ 0 ].pContext == nullptr )
+  {
+    contexts_[ 0 ].pContext = pContext;
+    return 0;
+  }
+
+  contexts_.push_back( ContextVAOs{ pContext, nullptr, { }, { }, true } );
+
+  return contexts_.size( ) - 1;
+}
+
+
+
+///
+/// \brief OpenGLWrapper::_inContext
+///
+///        Runs function with the context at index current,
+///        switching to it and back if both it and the current
+///        context can be made current.
+///
+/// \return false if the context could not be made current
+///
+bool
+OpenGLWrapper::_inContext(
+                          const std::size_t                            index,
+                          const std::function< void( ContextVAOs& ) > &function
+                          )
+{
+  if ( index == currentContext_ )
+  {
+    function( contexts_[ index ] );
+    return true;
+  }
+
+  ContextVAOs &context = contexts_[ index ];
+  ContextVAOs &current = contexts_[ currentContext_ ];
+
+  if ( !context.makeCurrent || !current.makeCurrent )
+  {
+    return false;
+  }
+
+  // each context has its own state cache, so nothing to invalidate
+  context.makeCurrent( );
+
+  function( context );
+
+  current.makeCurrent( );
+
+  return true;
+}
+
+
+
+///
+/// \brief OpenGLWrapper::_buildVAOs
+///
+///        Builds missing vertex arrays in every context that
+///        can be reached from the current one.
+///
+void
+OpenGLWrapper::_buildVAOs( )
+{
+  for ( std::size_t i = 0; i < contexts_.size( ); ++i )
+  {
+    // stays set in contexts that can't be reached from here
+    contexts_[ i ].dirty = true;
+
+    _inContext( i, [ this ]( ContextVAOs &context ){ _buildContextVAOs( context ); } );
+  }
+}
+
+
+
+///
+/// \brief OpenGLWrapper::_buildContextVAOs
+///
+///        Must be called with context current. Deletes orphaned
+///        vertex arrays and builds one for every buffer whose
+///        program has been added.
+///
+void
+OpenGLWrapper::_buildContextVAOs( ContextVAOs &context )
+{
+  if ( !context.orphanedVaos.empty( ) )
+  {
+    OpenGLStateCache::get( ).deleteVertexArrays(
+                                                static_cast< GLsizei >( context.orphanedVaos.size( ) ),
+                                                context.orphanedVaos.data( )
+                                                );
+    context.orphanedVaos.clear( );
+  }
+
+  context.vaos.resize( buffers_.getSlotCount( ), 0 );
+
+  for ( std::uint32_t index = 0; index < buffers_.getSlotCount( ); ++index )
+  {
+    const BufferHandle handle = buffers_.getHandle( index );
+
+    if ( context.vaos[ index ] == 0 && handle.isValid( ) )
+    {
+      const Buffer &buf = *buffers_.get( handle );
+
+      if ( programs_.find( buf.settings.program ).isValid( ) )
+      {
+        context.vaos[ index ] = _addVAOToBuffer( buf.vbo, buf.settings );
+      }
+    }
+  }
+
+  context.dirty = false;
+}
+
+
+
+///
+/// \brief OpenGLWrapper::_orphanVAOs
+///
+///        Marks a buffer's vertex arrays for deletion in every
+///        context so they are rebuilt for its new storage.
+///
+void
+OpenGLWrapper::_orphanVAOs( const BufferHandle buffer )
+{
+  const std::size_t index = buffer.getIndex( );
+
+  for ( ContextVAOs &context : contexts_ )
+  {
+    if ( index < context.vaos.size( ) && context.vaos[ index ] != 0 )
+    {
+      context.orphanedVaos.push_back( context.vaos[ index ] );
+      context.vaos[ index ] = 0;
+      context.dirty         = true;
+    }
+  }
+}
+
+
+
+OpenGLWrapper::FramebufferHandle
 OpenGLWrapper::addFramebuffer(
-                              const std::string buffer,
-                              GLsizei           width,
-                              GLsizei           height,
-                              const std::string texture
+                              const std::string &buffer,
+                              GLsizei            width,
+                              GLsizei            height,
+                              const std::string &texture
                               )
 
 {
-  _checkItemExists( texture, textures_, "textures" );
+  const GLuint textureId = getTexture( texture );
 
-  if ( framebuffers_.find( buffer ) != framebuffers_.end( ) )
+  FramebufferHandle handle = framebuffers_.find( buffer );
+
+  if ( handle.isValid( ) )
   {
-    FrameBuffer &buf = framebuffers_[ buffer ];
-    glDeleteFramebuffers( 1, &buf.fbo );
+    FrameBuffer &buf = *framebuffers_.get( handle );
+    OpenGLStateCache::get( ).deleteFramebuffers( 1, &buf.fbo );
     glDeleteRenderbuffers( 1, &buf.rbo );
   }
+  else
+  {
+    handle = framebuffers_.create( FrameBuffer( ), buffer );
+  }
 
-  FrameBuffer &buf = framebuffers_[ buffer ];
+  FrameBuffer &buf = *framebuffers_.get( handle );
 
   glGenFramebuffers( 1, &buf.fbo );
-  glBindFramebuffer( GL_FRAMEBUFFER, buf.fbo );
+  OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, buf.fbo );
 
   glGenRenderbuffers( 1, &buf.rbo );
   glBindRenderbuffer( GL_RENDERBUFFER, buf.rbo );
@@ -338,46 +676,68 @@ OpenGLWrapper::addFramebuffer(
   glFramebufferTexture2D( GL_FRAMEBUFFER,
                          GL_COLOR_ATTACHMENT0,
                          GL_TEXTURE_2D,
-                         textures_[ texture ],
+                         textureId,
                          0 );
 
   // attach a renderbuffer to depth attachment point
   glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, buf.rbo );
 
-    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, 0 );
+
+  return handle;
 
 } // OpenGLWrapper::addFramebuffer
 
 
 
 void
-OpenGLWrapper::bindFramebuffer( const std::string name )
+OpenGLWrapper::bindFramebuffer( const std::string &name )
 {
   if ( name.length( ) == 0 )
   {
-    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, 0 );
     return;
   }
 
-  _checkItemExists( name, framebuffers_, "framebuffers" );
-  glBindFramebuffer( GL_FRAMEBUFFER, framebuffers_.at( name ).fbo );
+  bindFramebuffer( getFramebufferHandle( name ) );
+}
+
+
+
+///
+/// \brief OpenGLWrapper::bindFramebuffer
+///
+///        Invalid (default constructed) handles bind the
+///        default framebuffer.
+///
+void
+OpenGLWrapper::bindFramebuffer( const FramebufferHandle framebuffer )
+{
+  const GLuint fbo = framebuffer.isValid( ) ? _get( framebuffers_, framebuffer, "framebuffer" ).fbo : 0;
+
+  OpenGLStateCache::get( ).bindFramebuffer( GL_FRAMEBUFFER, fbo );
 }
 
 
 
 void
 OpenGLWrapper::swapFramebuffers(
-                                const std::string fbo1,
-                                const std::string fbo2
+                                const std::string &fbo1,
+                                const std::string &fbo2
                                 )
 {
-  _checkItemExists( fbo1, framebuffers_, "framebuffer" );
-  _checkItemExists( fbo2, framebuffers_, "framebuffer" );
+  swapFramebuffers( getFramebufferHandle( fbo1 ), getFramebufferHandle( fbo2 ) );
+}
+
 
-  FrameBuffer temp = framebuffers_[ fbo1 ];
 
-  framebuffers_[ fbo1 ] = framebuffers_[ fbo2 ];
-  framebuffers_[ fbo2 ] = temp;
+void
+OpenGLWrapper::swapFramebuffers(
+                                const FramebufferHandle fbo1,
+                                const FramebufferHandle fbo2
+                                )
+{
+  std::swap( _get( framebuffers_, fbo1, "framebuffer" ), _get( framebuffers_, fbo2, "framebuffer" ) );
 }
 
 
@@ -422,143 +782,196 @@ OpenGLWrapper::clearWindow(
 
 
 
+UniformHandle
+OpenGLWrapper::getUniform(
+                          const std::string &program,
+                          const std::string &uniform
+                          )
+{
+  return getUniform( getProgramHandle( program ), uniform );
+}
+
+
+
+UniformHandle
+OpenGLWrapper::getUniform(
+                          const ProgramHandle program,
+                          const std::string  &uniform
+                          )
+{
+  return _get( programs_, program, "program" ).uniforms.getUniform( uniform );
+}
+
+
+
 void
-OpenGLWrapper::useProgram( const std::string program )
+OpenGLWrapper::useProgram( const std::string &program )
+{
+  useProgram( getProgramHandle( program ) );
+}
+
+
+
+void
+OpenGLWrapper::useProgram( const ProgramHandle program )
+{
+  OpenGLStateCache::get( ).useProgram( _get( programs_, program, "program" ).id );
+}
+
+
+
+void
+OpenGLWrapper::setTextureUniform(
+                                 const std::string &program,
+                                 const std::string &uniform,
+                                 const std::string &texture,
+                                 int                activeTex
+                                 )
 {
-  _checkItemExists( program, programs_, "programs" );
-  glUseProgram( programs_[ program ] );
+  setTextureUniform( getUniform( program, uniform ), getTextureHandle( texture ), activeTex );
 }
 
 
 
 void
 OpenGLWrapper::setTextureUniform(
-                                 const std::string program,
-                                 const std::string uniform,
-                                 const std::string texture,
-                                 int               activeTex
+                                 const UniformHandle &uniform,
+                                 const TextureHandle  texture,
+                                 int                  activeTex
                                  )
 {
-  _checkItemExists( program, programs_, "programs" );
-  _checkItemExists( texture, textures_, "textures" );
+  const GLuint textureId = getTexture( texture );
 
   switch ( activeTex )
   {
   case 0:
-    glActiveTexture( GL_TEXTURE0 );
+    OpenGLStateCache::get( ).activeTexture( GL_TEXTURE0 );
     break;
 
   case 1:
-    glActiveTexture( GL_TEXTURE1 );
+    OpenGLStateCache::get( ).activeTexture( GL_TEXTURE1 );
     break;
 
   case 2:
-    glActiveTexture( GL_TEXTURE2 );
+    OpenGLStateCache::get( ).activeTexture( GL_TEXTURE2 );
     break;
 
   default:
-    glActiveTexture( GL_TEXTURE3 );
+    OpenGLStateCache::get( ).activeTexture( GL_TEXTURE3 );
     break;
   } // switch
 
-  glUniform1i( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), activeTex );
-  glBindTexture( GL_TEXTURE_2D, textures_[ texture ] );
+  glUniform1i( uniform.location, activeTex );
+  OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, textureId );
 } // OpenGLWrapper::setTextureUniform
 
 
 
 void
 OpenGLWrapper::renderBuffer(
-                            const std::string buffer,
-                            const int         start,
-                            const int         verts,
-                            const GLenum      mode,
-                            const std::string ibo,
-                            const void       *pOffset,
-                            const GLenum      iboType
+                            const std::string &buffer,
+                            const int          start,
+                            const int          verts,
+                            const GLenum       mode,
+                            const std::string &ibo,
+                            const void        *pOffset,
+                            const GLenum       iboType
                             )
 {
-  const bool usingIBO = ibo.length( ) > 0;
+  renderBuffer(
+               getBufferHandle( buffer ),
+               start,
+               verts,
+               mode,
+               ibo.length( ) > 0 ? getIndexBufferHandle( ibo ) : IndexBufferHandle( ),
+               pOffset,
+               iboType
+               );
+}
+
 
-  _checkItemExists( buffer, buffers_, "buffer" );
 
-  GLuint vao = _getVAO( buffers_[ buffer ] );
+void
+OpenGLWrapper::renderBuffer(
+                            const BufferHandle      buffer,
+                            const int               start,
+                            const int               verts,
+                            const GLenum            mode,
+                            const IndexBufferHandle ibo,
+                            const void             *pOffset,
+                            const GLenum            iboType
+                            )
+{
+  const bool usingIBO = ibo.isValid( );
+
+  GLuint vao = _getVAO( buffer, _get( buffers_, buffer, "buffer" ) );
 
-  glBindVertexArray( vao );
+  OpenGLStateCache::get( ).bindVertexArray( vao );
 
 
   if ( usingIBO )
   {
-    _checkItemExists( ibo, indexBuffers_, "indexBuffer" );
-
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexBuffers_[ ibo ] );
+    OpenGLStateCache::get( ).bindBuffer( GL_ELEMENT_ARRAY_BUFFER, _get( indexBuffers_, ibo, "indexBuffer" ).ibo );
     glDrawElements( mode, verts, iboType, pOffset );
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
   }
   else
   {
     glDrawArrays( mode, start, verts );
   }
-
-  glBindVertexArray( 0 );
 } // OpenGLWrapper::renderBuffer
 
 
 
 void
 OpenGLWrapper::setBoolUniform(
-                              const std::string program,
-                              const std::string uniform,
-                              bool              var
+                              const std::string &program,
+                              const std::string &uniform,
+                              bool               var
                               )
 {
-  _checkItemExists( program, programs_, "programs" );
-  glUniform1i( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), var );
+  glUniform1i( _getUniformLocation( program, uniform ), var );
 }
 
 
 
 void
 OpenGLWrapper::setIntUniform(
-                             const std::string program,
-                             const std::string uniform,
-                             int               value
+                             const std::string &program,
+                             const std::string &uniform,
+                             int                value
                              )
 {
-  _checkItemExists( program, programs_, "programs" );
-  glUniform1i( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), value );
+  glUniform1i( _getUniformLocation( program, uniform ), value );
 }
 
 
 
 void
 OpenGLWrapper::setFloatUniform(
-                               const std::string program,
-                               const std::string uniform,
-                               const float      *pValue,
-                               const int         size,
-                               const int         count
+                               const std::string &program,
+                               const std::string &uniform,
+                               const float       *pValue,
+                               const int          size,
+                               const int          count
                                )
 {
-  _checkItemExists( program, programs_, "programs" );
-
   switch ( size )
   {
 
   case 1:
-    glUniform1f( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), *pValue );
+    glUniform1f( _getUniformLocation( program, uniform ), *pValue );
     break;
 
   case 2:
-    glUniform2fv( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), count, pValue );
+    glUniform2fv( _getUniformLocation( program, uniform ), count, pValue );
     break;
 
   case 3:
-    glUniform3fv( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), count, pValue );
+    glUniform3fv( _getUniformLocation( program, uniform ), count, pValue );
     break;
 
   case 4:
-    glUniform4fv( glGetUniformLocation( programs_[ program ], uniform.c_str( ) ), count, pValue );
+    glUniform4fv( _getUniformLocation( program, uniform ), count, pValue );
     break;
 
   default:
@@ -575,20 +988,18 @@ OpenGLWrapper::setFloatUniform(
 
 void
 OpenGLWrapper::setMatrixUniform(
-                                const std::string program,
-                                const std::string uniform,
-                                const float      *pValue,
-                                const int         size,
-                                const int         count
+                                const std::string &program,
+                                const std::string &uniform,
+                                const float       *pValue,
+                                const int          size,
+                                const int          count
                                 )
 {
-  _checkItemExists( program, programs_, "programs" );
-
   switch ( size )
   {
   case 2:
     glUniformMatrix2fv(
-                       glGetUniformLocation( programs_[ program ], uniform.c_str( ) ),
+                       _getUniformLocation( program, uniform ),
                        count,
                        GL_FALSE,
                        pValue
@@ -597,7 +1008,7 @@ OpenGLWrapper::setMatrixUniform(
 
   case 3:
     glUniformMatrix3fv(
-                       glGetUniformLocation( programs_[ program ], uniform.c_str( ) ),
+                       _getUniformLocation( program, uniform ),
                        count,
                        GL_FALSE,
                        pValue
@@ -607,7 +1018,7 @@ OpenGLWrapper::setMatrixUniform(
 
   case 4:
     glUniformMatrix4fv(
-                       glGetUniformLocation( programs_[ program ], uniform.c_str( ) ),
+                       _getUniformLocation( program, uniform ),
                        count,
                        GL_FALSE,
                        pValue
@@ -627,17 +1038,22 @@ OpenGLWrapper::setMatrixUniform(
 
 void
 OpenGLWrapper::swapTextures(
-                            const std::string tex1,
-                            const std::string tex2
+                            const std::string &tex1,
+                            const std::string &tex2
                             )
 {
-  _checkItemExists( tex1, textures_, "textures" );
-  _checkItemExists( tex2, textures_, "textures" );
+  swapTextures( getTextureHandle( tex1 ), getTextureHandle( tex2 ) );
+}
 
-  GLuint temp = textures_[ tex1 ];
 
-  textures_[ tex1 ] = textures_[ tex2 ];
-  textures_[ tex2 ] = temp;
+
+void
+OpenGLWrapper::swapTextures(
+                            const TextureHandle tex1,
+                            const TextureHandle tex2
+                            )
+{
+  std::swap( _get( textures_, tex1, "texture" ), _get( textures_, tex2, "texture" ) );
 }
 
 
@@ -673,15 +1089,15 @@ OpenGLWrapper::setViewportSize(
 
 void
 OpenGLWrapper::bindBufferToTexture(
-                                   const std::string texture,
-                                   GLuint            bufId,
-                                   int               alignment,
-                                   int               width,
-                                   int               height
+                                   const std::string &texture,
+                                   GLuint             bufId,
+                                   int                alignment,
+                                   int                width,
+                                   int                height
                                    )
 {
-  glBindTexture( GL_TEXTURE_2D, getTexture( texture ) );
-  glBindBuffer ( GL_PIXEL_UNPACK_BUFFER, bufId );
+  OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, getTexture( texture ) );
+  OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_UNPACK_BUFFER, bufId );
 
   glPixelStorei( GL_UNPACK_ALIGNMENT, alignment );
 
@@ -697,7 +1113,7 @@ OpenGLWrapper::bindBufferToTexture(
                0
                );
 
-  glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+  OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
 
 } // OpenGLWrapper::bindBufferToTexture
 
@@ -718,32 +1134,49 @@ OpenGLWrapper::setClearColor(
 
 void
 OpenGLWrapper::destroyTexture(
-                              const std::string name,
-                              const bool        glDelete
+                              const std::string &name,
+                              const bool         glDelete
                               )
 {
-  _checkItemExists( name, textures_, "textures" );
+  destroyTexture( getTextureHandle( name ), glDelete );
+}
+
+
+
+void
+OpenGLWrapper::destroyTexture(
+                              const TextureHandle texture,
+                              const bool          glDelete
+                              )
+{
+  Texture &tex = _get( textures_, texture, "texture" );
 
   if ( glDelete )
   {
-    glDeleteTextures( 1, &( textures_.at( name ) ) );
+    OpenGLStateCache::get( ).deleteTextures( 1, &tex.id );
   }
 
-  textures_.erase( name );
+  textures_.destroy( texture );
 }
 
 
 
 void
-OpenGLWrapper::destroyFramebuffer( const std::string name )
+OpenGLWrapper::destroyFramebuffer( const std::string &name )
 {
-  _checkItemExists( name, framebuffers_, "framebuffers" );
+  destroyFramebuffer( getFramebufferHandle( name ) );
+}
+
 
-  const FrameBuffer &buffer = framebuffers_.at( name );
-  glDeleteFramebuffers( 1, &( buffer.fbo ) );
+
+void
+OpenGLWrapper::destroyFramebuffer( const FramebufferHandle framebuffer )
+{
+  const FrameBuffer &buffer = _get( framebuffers_, framebuffer, "framebuffer" );
+  OpenGLStateCache::get( ).deleteFramebuffers( 1, &( buffer.fbo ) );
   glDeleteRenderbuffers( 1, &( buffer.rbo ) );
 
-  framebuffers_.erase( name );
+  framebuffers_.destroy( framebuffer );
 }
 
 
@@ -774,6 +1207,17 @@ OpenGLWrapper::_readFile( const std::string filePath )
 
 
 
+GLint
+OpenGLWrapper::_getUniformLocation(
+                                   const std::string &program,
+                                   const std::string &uniform
+                                   )
+{
+  return getUniform( program, uniform ).location;
+}
+
+
+
 GLuint
 OpenGLWrapper::_loadShader(
                            const std::string vertex_path,
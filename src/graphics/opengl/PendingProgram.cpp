@@ -0,0 +1,117 @@
+#include "shared/graphics/PendingProgram.hpp"
+
+#include <cstring>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+// GL_COMPLETION_STATUS_KHR shares its value with the ARB token
+constexpr GLenum COMPLETION_STATUS = GL_COMPLETION_STATUS_ARB;
+
+///
+/// \brief hasKhrParallelShaderCompile
+///
+///        glad only knows the ARB flavour, so look for the KHR
+///        extension in the string list.
+///
+bool
+hasKhrParallelShaderCompile( )
+{
+  GLint count = 0;
+  glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+
+  for ( GLint i = 0; i < count; ++i )
+  {
+    const GLubyte *pName = glGetStringi( GL_EXTENSIONS, static_cast< GLuint >( i ) );
+
+    if ( pName && std::strcmp( reinterpret_cast< const char* >( pName ),
+                               "GL_KHR_parallel_shader_compile" ) == 0 )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief PendingProgram::PendingProgram
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+PendingProgram::PendingProgram(
+                               std::shared_ptr< GLuint > spProgram,
+                               std::function< void( ) >  finish
+                               )
+  : spProgram_( std::move( spProgram ) )
+  , finish_( std::move( finish ) )
+{}
+
+
+
+/////////////////////////////////////////////
+/// \brief PendingProgram::isReady
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+PendingProgram::isReady( ) const
+{
+  if ( !finish_ || !isParallelCompileSupported( ) )
+  {
+    return true;
+  }
+
+  GLint complete = GL_FALSE;
+  glGetProgramiv( *spProgram_, COMPLETION_STATUS, &complete );
+
+  return complete != GL_FALSE;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief PendingProgram::get
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::shared_ptr< GLuint >
+PendingProgram::get( )
+{
+  if ( finish_ )
+  {
+    // only cleared on success so a failed program keeps throwing
+    finish_( );
+    finish_ = nullptr;
+  }
+
+  return spProgram_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief PendingProgram::isParallelCompileSupported
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+PendingProgram::isParallelCompileSupported( )
+{
+  static const bool supported = GLAD_GL_ARB_parallel_shader_compile || hasKhrParallelShaderCompile( );
+
+  return supported;
+}
+
+
+
+} // namespace shg
@@ -0,0 +1,240 @@
+#include "shared/graphics/ProgramCache.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+constexpr std::uint32_t FILE_MAGIC   = 0x43505348; // "SHPC"
+constexpr std::uint32_t FILE_VERSION = 1;
+
+constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr std::uint64_t FNV_PRIME  = 1099511628211ull;
+
+
+///
+/// \brief The FileHeader struct written in front of each binary
+///
+struct FileHeader
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t key;
+  std::uint32_t format;
+  std::uint32_t size;
+};
+
+
+///
+/// \brief fnv1a 64 bit FNV-1a over bytes, continuing from hash
+///
+std::uint64_t
+fnv1a(
+      std::uint64_t      hash,
+      const std::string &bytes
+      )
+{
+  for ( const char c : bytes )
+  {
+    hash ^= static_cast< unsigned char >( c );
+    hash *= FNV_PRIME;
+  }
+
+  // separator so { "ab", "c" } and { "a", "bc" } differ
+  hash ^= 0xff;
+  hash *= FNV_PRIME;
+
+  return hash;
+}
+
+
+std::string
+getGlString( const GLenum name )
+{
+  const GLubyte *pString = glGetString( name );
+
+  return pString ? reinterpret_cast< const char* >( pString ) : "";
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief ProgramCache::ProgramCache
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+ProgramCache::ProgramCache( const std::string &directory )
+  : directory_( directory )
+  , driver_(
+            getGlString( GL_VENDOR ) + "\n"
+            + getGlString( GL_RENDERER ) + "\n"
+            + getGlString( GL_VERSION )
+            )
+  , supported_( false )
+{
+  if ( !directory_.empty( ) && directory_.back( ) != '/' && directory_.back( ) != '\\' )
+  {
+    directory_ += '/';
+  }
+
+  if ( GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary )
+  {
+    GLint formats = 0;
+    glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &formats );
+
+    supported_ = formats > 0;
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ProgramCache::makeKey
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::uint64_t
+ProgramCache::makeKey( const std::vector< std::string > &parts ) const
+{
+  std::uint64_t hash = fnv1a( FNV_OFFSET, driver_ );
+
+  for ( const std::string &part : parts )
+  {
+    hash = fnv1a( hash, part );
+  }
+
+  return hash;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ProgramCache::load
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+GLuint
+ProgramCache::load( const std::uint64_t key )
+{
+  std::ifstream file( _getPath( key ), std::ios::in | std::ios::binary );
+
+  FileHeader header = { };
+
+  if ( !supported_
+      || !file.is_open( )
+      || !file.read( reinterpret_cast< char* >( &header ), sizeof( header ) )
+      || header.magic != FILE_MAGIC
+      || header.version != FILE_VERSION
+      || header.key != key )
+  {
+    ++stats_.misses;
+    return 0;
+  }
+
+  std::vector< char > binary( header.size );
+
+  if ( !file.read( binary.data( ), static_cast< std::streamsize >( binary.size( ) ) ) )
+  {
+    ++stats_.misses;
+    return 0;
+  }
+
+  GLuint program = glCreateProgram( );
+
+  glProgramBinary(
+                  program,
+                  header.format,
+                  binary.data( ),
+                  static_cast< GLsizei >( binary.size( ) )
+                  );
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv( program, GL_LINK_STATUS, &linked );
+
+  if ( linked == GL_FALSE )
+  {
+    glDeleteProgram( program );
+
+    ++stats_.stale;
+    ++stats_.misses;
+    return 0;
+  }
+
+  ++stats_.hits;
+  return program;
+} // ProgramCache::load
+
+
+
+/////////////////////////////////////////////
+/// \brief ProgramCache::store
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ProgramCache::store(
+                    const std::uint64_t key,
+                    const GLuint        program
+                    ) const
+{
+  if ( !supported_ )
+  {
+    return;
+  }
+
+  GLint length = 0;
+  glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &length );
+
+  if ( length <= 0 )
+  {
+    return;
+  }
+
+  std::vector< char > binary( static_cast< std::size_t >( length ) );
+  GLenum format = 0;
+
+  glGetProgramBinary( program, length, &length, &format, binary.data( ) );
+
+  const FileHeader header =
+  {
+    FILE_MAGIC,
+    FILE_VERSION,
+    key,
+    format,
+    static_cast< std::uint32_t >( length )
+  };
+
+  std::ofstream file( _getPath( key ), std::ios::out | std::ios::binary | std::ios::trunc );
+
+  file.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+  file.write( binary.data( ), length );
+} // ProgramCache::store
+
+
+
+/////////////////////////////////////////////
+/// \brief ProgramCache::_getPath
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::string
+ProgramCache::_getPath( const std::uint64_t key ) const
+{
+  std::stringstream path;
+  path << directory_ << std::hex << std::setw( 16 ) << std::setfill( '0' ) << key << ".glbin";
+
+  return path.str( );
+}
+
+
+
+} // namespace shg
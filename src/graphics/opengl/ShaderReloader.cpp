@@ -0,0 +1,282 @@
+#include "shared/graphics/ShaderReloader.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+///
+/// \brief splitPath
+/// \return directory and file name of filePath
+///
+std::pair< std::string, std::string >
+splitPath( const std::string &filePath )
+{
+  const size_t slash = filePath.find_last_of( "/\\" );
+
+  if ( slash == std::string::npos )
+  {
+    return std::make_pair( std::string( "." ), filePath );
+  }
+
+  return std::make_pair( filePath.substr( 0, slash ), filePath.substr( slash + 1 ) );
+}
+
+
+///
+/// \brief getModifiedTime
+/// \return seconds since epoch or -1 if the file can't be read
+///
+long long
+getModifiedTime( const std::string &filePath )
+{
+  struct stat info;
+
+  if ( stat( filePath.c_str( ), &info ) != 0 )
+  {
+    return -1;
+  }
+
+  return static_cast< long long >( info.st_mtime );
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief ShaderReloader::ShaderReloader
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+ShaderReloader::ShaderReloader( )
+  : inotify_( -1 )
+  , reloadCount_( 0 )
+{
+#ifdef __linux__
+  inotify_ = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+#endif
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ShaderReloader::~ShaderReloader
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+ShaderReloader::~ShaderReloader( )
+{
+#ifdef __linux__
+  if ( inotify_ >= 0 )
+  {
+    close( inotify_ );
+  }
+#endif
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ShaderReloader::watch
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ShaderReloader::watch(
+                      const std::vector< std::string > &filePaths,
+                      ReloadCallback                    onReload
+                      )
+{
+  WatchedProgram program;
+  program.filePaths = filePaths;
+  program.onReload  = std::move( onReload );
+  program.changed   = false;
+
+  for ( const std::string &filePath : filePaths )
+  {
+    program.modifiedTimes.emplace_back( getModifiedTime( filePath ) );
+
+#ifdef __linux__
+    if ( inotify_ >= 0 )
+    {
+      //
+      // watch the directory rather than the file since most
+      // editors save by replacing the file with a new one
+      //
+      const std::string directory = splitPath( filePath ).first;
+
+      const int wd = inotify_add_watch(
+                                       inotify_,
+                                       directory.c_str( ),
+                                       IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE
+                                       );
+
+      if ( wd < 0 )
+      {
+        throw std::runtime_error( "Could not watch directory: " + directory );
+      }
+
+      directories_[ wd ] = directory;
+    }
+#endif
+  }
+
+  programs_.emplace_back( std::move( program ) );
+} // ShaderReloader::watch
+
+
+
+/////////////////////////////////////////////
+/// \brief ShaderReloader::update
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ShaderReloader::update( )
+{
+  _pollChanges( );
+
+  for ( WatchedProgram &program : programs_ )
+  {
+    // wait for a running rebuild before starting another
+    if ( program.changed && !program.upPending )
+    {
+      program.changed = false;
+
+      try
+      {
+        program.upPending.reset( new PendingProgram(
+                                                    OpenGLHelper::createProgramAsync( program.filePaths )
+                                                    ) );
+      }
+      catch ( const std::exception &e )
+      {
+        lastError_ = e.what( );
+        std::cout << "(ShaderReloader) " << lastError_ << std::endl;
+      }
+    }
+
+    if ( !program.upPending || !program.upPending->isReady( ) )
+    {
+      continue;
+    }
+
+    std::unique_ptr< PendingProgram > upPending = std::move( program.upPending );
+    std::shared_ptr< GLuint > spProgram;
+
+    try
+    {
+      spProgram = upPending->get( );
+    }
+    catch ( const std::exception &e )
+    {
+      // the old program is still in use
+      lastError_ = e.what( );
+      std::cout << "(ShaderReloader) " << lastError_ << std::endl;
+      continue;
+    }
+
+    ++reloadCount_;
+    lastError_.clear( );
+
+    program.onReload( spProgram );
+  }
+} // ShaderReloader::update
+
+
+
+/////////////////////////////////////////////
+/// \brief ShaderReloader::_markChanged
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ShaderReloader::_markChanged( const std::string &filePath )
+{
+  const std::pair< std::string, std::string > changed = splitPath( filePath );
+
+  for ( WatchedProgram &program : programs_ )
+  {
+    for ( const std::string &watched : program.filePaths )
+    {
+      if ( splitPath( watched ) == changed )
+      {
+        program.changed = true;
+      }
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ShaderReloader::_pollChanges
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ShaderReloader::_pollChanges( )
+{
+#ifdef __linux__
+  if ( inotify_ >= 0 )
+  {
+    alignas( inotify_event ) char buffer[ 4096 ];
+
+    ssize_t length;
+
+    while ( ( length = read( inotify_, buffer, sizeof( buffer ) ) ) > 0 )
+    {
+      for ( size_t offset = 0; offset < static_cast< size_t >( length ); )
+      {
+        inotify_event event;
+        std::memcpy( &event, buffer + offset, sizeof( event ) );
+
+        if ( event.len > 0 && directories_.find( event.wd ) != directories_.end( ) )
+        {
+          _markChanged( directories_[ event.wd ] + "/" + ( buffer + offset + sizeof( event ) ) );
+        }
+
+        offset += sizeof( event ) + event.len;
+      }
+    }
+
+    return;
+  }
+#endif
+
+  for ( WatchedProgram &program : programs_ )
+  {
+    for ( size_t i = 0; i < program.filePaths.size( ); ++i )
+    {
+      const long long modified = getModifiedTime( program.filePaths[ i ] );
+
+      if ( modified != program.modifiedTimes[ i ] )
+      {
+        program.modifiedTimes[ i ] = modified;
+        program.changed            = true;
+      }
+    }
+  }
+} // ShaderReloader::_pollChanges
+
+
+
+} // namespace shg
@@ -0,0 +1,299 @@
+#include "shared/graphics/StreamingBuffer.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+// one second per wait, a GPU that misses every wait is treated as hung
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+constexpr unsigned MAX_FENCE_WAITS  = 5;
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::StreamingBuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+StreamingBuffer::StreamingBuffer(
+                                 const GLsizeiptr regionSize,
+                                 const unsigned   numRegions,
+                                 const GLenum     target
+                                 )
+  : target_    ( target )
+  , regionSize_( regionSize )
+  , persistent_( GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage )
+  , pMapped_   ( nullptr )
+  , fences_    ( std::max( numRegions, 1u ), nullptr )
+  , region_    ( 0 )
+  , used_      ( 0 )
+  , inFrame_   ( false )
+  , writing_   ( false )
+  , stalls_    ( 0 )
+{
+  if ( regionSize_ <= 0 )
+  {
+    throw std::runtime_error( "StreamingBuffer regions must have a positive size" );
+  }
+
+  spBuffer_ = std::shared_ptr< GLuint >( new GLuint,
+                                        [ ] ( auto pID )
+    {
+      OpenGLStateCache::get( ).deleteBuffers( 1, pID );
+      delete pID;
+    } );
+
+  const GLsizeiptr totalSize = regionSize_ * static_cast< GLsizeiptr >( fences_.size( ) );
+
+  glGenBuffers( 1, spBuffer_.get( ) );
+  OpenGLStateCache::get( ).bindBuffer( target_, *spBuffer_ );
+
+  if ( persistent_ )
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glBufferStorage( target_, totalSize, nullptr, flags );
+    pMapped_ = static_cast< char* >( glMapBufferRange( target_, 0, totalSize, flags ) );
+
+    if ( !pMapped_ )
+    {
+      throw std::runtime_error( "Failed to persistently map streaming buffer" );
+    }
+  }
+  else
+  {
+    glBufferData( target_, totalSize, nullptr, GL_STREAM_DRAW );
+  }
+
+  // first beginFrame( ) starts at region 0
+  region_ = getNumRegions( ) - 1;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::~StreamingBuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+StreamingBuffer::~StreamingBuffer( )
+{
+  for ( GLsync fence : fences_ )
+  {
+    if ( fence )
+    {
+      glDeleteSync( fence );
+    }
+  }
+
+  if ( pMapped_ )
+  {
+    OpenGLStateCache::get( ).bindBuffer( target_, *spBuffer_ );
+    glUnmapBuffer( target_ );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::beginFrame
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+StreamingBuffer::beginFrame( )
+{
+  if ( inFrame_ )
+  {
+    endFrame( );
+  }
+
+  region_  = ( region_ + 1 ) % getNumRegions( );
+  used_    = 0;
+  inFrame_ = true;
+  writing_ = true;
+
+  _waitForRegion( region_ );
+
+  if ( !persistent_ )
+  {
+    //
+    // the fence already guarantees the GPU is done with this
+    // region so the driver doesn't need to synchronize the map
+    //
+    OpenGLStateCache::get( ).bindBuffer( target_, *spBuffer_ );
+    pMapped_ = static_cast< char* >( glMapBufferRange(
+                                                      target_,
+                                                      region_ * regionSize_,
+                                                      regionSize_,
+                                                      GL_MAP_WRITE_BIT
+                                                      | GL_MAP_INVALIDATE_RANGE_BIT
+                                                      | GL_MAP_UNSYNCHRONIZED_BIT
+                                                      ) );
+
+    if ( !pMapped_ )
+    {
+      throw std::runtime_error( "Failed to map streaming buffer region" );
+    }
+  }
+} // StreamingBuffer::beginFrame
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::endFrame
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+StreamingBuffer::endFrame( )
+{
+  if ( !inFrame_ )
+  {
+    return;
+  }
+
+  finishWrites( );
+
+  fences_[ region_ ] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+  inFrame_           = false;
+} // StreamingBuffer::endFrame
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::finishWrites
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+StreamingBuffer::finishWrites( )
+{
+  if ( !writing_ )
+  {
+    return;
+  }
+
+  //
+  // drawing from a mapped buffer is an error
+  // unless the mapping is persistent
+  //
+  if ( !persistent_ )
+  {
+    OpenGLStateCache::get( ).bindBuffer( target_, *spBuffer_ );
+    glUnmapBuffer( target_ );
+    pMapped_ = nullptr;
+  }
+
+  writing_ = false;
+} // StreamingBuffer::finishWrites
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::allocate
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+GLintptr
+StreamingBuffer::allocate(
+                          const GLsizeiptr bytes,
+                          const GLsizeiptr alignment
+                          )
+{
+  if ( !writing_ )
+  {
+    throw std::runtime_error( "StreamingBuffer::allocate called outside beginFrame/finishWrites" );
+  }
+
+  const GLsizeiptr start = ( used_ + alignment - 1 ) & ~( alignment - 1 );
+
+  if ( start + bytes > regionSize_ )
+  {
+    std::stringstream msg;
+    msg << "StreamingBuffer region of " << regionSize_
+        << " bytes can not fit " << bytes
+        << " more bytes (" << used_ << " used)";
+
+    throw std::runtime_error( msg.str( ) );
+  }
+
+  used_ = start + bytes;
+
+  return region_ * regionSize_ + start;
+} // StreamingBuffer::allocate
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::getPointer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void*
+StreamingBuffer::getPointer( const GLintptr offset ) const
+{
+  // the fallback only has the current region mapped
+  return pMapped_ + ( persistent_ ? offset : offset - region_ * regionSize_ );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief StreamingBuffer::_waitForRegion
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+StreamingBuffer::_waitForRegion( const unsigned region )
+{
+  GLsync &fence = fences_[ region ];
+
+  if ( !fence )
+  {
+    return;
+  }
+
+  GLenum result = glClientWaitSync( fence, 0, 0 );
+
+  if ( result == GL_TIMEOUT_EXPIRED )
+  {
+    ++stalls_;
+
+    for ( unsigned wait = 0; wait < MAX_FENCE_WAITS && result == GL_TIMEOUT_EXPIRED; ++wait )
+    {
+      result = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS );
+    }
+  }
+
+  if ( result == GL_TIMEOUT_EXPIRED )
+  {
+    // keep the fence so the region stays off limits
+    throw std::runtime_error( "GPU did not release a streaming buffer region within "
+                             + std::to_string( MAX_FENCE_WAITS ) + " seconds" );
+  }
+
+  glDeleteSync( fence );
+  fence = nullptr;
+
+  if ( result == GL_WAIT_FAILED )
+  {
+    throw std::runtime_error( "Waiting on a streaming buffer fence failed" );
+  }
+} // StreamingBuffer::_waitForRegion
+
+
+
+} // namespace shg
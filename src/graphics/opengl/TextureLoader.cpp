@@ -0,0 +1,688 @@
+#include "shared/graphics/TextureLoader.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+
+namespace shg
+{
+
+
+constexpr std::size_t TextureLoader::NO_STAGING;
+
+
+namespace
+{
+
+///
+/// \brief The PpmDecoder class reads binary 8 bit PPMs
+///
+class PpmDecoder : public TextureLoader::Decoder
+{
+
+public:
+
+  explicit
+  PpmDecoder( const std::string &filePath )
+    : filePath_( filePath )
+    , width_( 0 )
+    , height_( 0 )
+  {}
+
+
+  virtual
+  bool
+  readSize(
+           int &width,
+           int &height
+           ) final
+  {
+    file_.open( filePath_, std::ios::in | std::ios::binary );
+
+    std::string magic;
+    int maxValue = 0;
+
+    if ( !( file_ >> magic ) || magic != "P6" )
+    {
+      throw std::runtime_error( "Not a binary PPM: " + filePath_ );
+    }
+
+    width_   = _readInt( );
+    height_  = _readInt( );
+    maxValue = _readInt( );
+
+    if ( maxValue != 255 )
+    {
+      throw std::runtime_error( "Only 8 bit PPMs are supported: " + filePath_ );
+    }
+
+    // single whitespace before the pixels
+    file_.get( );
+
+    width  = width_;
+    height = height_;
+
+    return file_.good( );
+  }
+
+
+  virtual
+  bool
+  readPixels( unsigned char *pRgba ) final
+  {
+    const std::size_t pixels = static_cast< std::size_t >( width_ ) * static_cast< std::size_t >( height_ );
+
+    std::vector< char > rgb( pixels * 3 );
+
+    if ( !file_.read( rgb.data( ), static_cast< std::streamsize >( rgb.size( ) ) ) )
+    {
+      return false;
+    }
+
+    for ( std::size_t i = 0; i < pixels; ++i )
+    {
+      pRgba[ i * 4 + 0 ] = static_cast< unsigned char >( rgb[ i * 3 + 0 ] );
+      pRgba[ i * 4 + 1 ] = static_cast< unsigned char >( rgb[ i * 3 + 1 ] );
+      pRgba[ i * 4 + 2 ] = static_cast< unsigned char >( rgb[ i * 3 + 2 ] );
+      pRgba[ i * 4 + 3 ] = 255;
+    }
+
+    return true;
+  }
+
+
+private:
+
+  ///
+  /// \brief _readInt next header number, skipping # comments
+  ///
+  int
+  _readInt( )
+  {
+    file_ >> std::ws;
+
+    while ( file_.peek( ) == '#' )
+    {
+      std::string comment;
+      std::getline( file_, comment );
+      file_ >> std::ws;
+    }
+
+    int value = 0;
+
+    if ( !( file_ >> value ) )
+    {
+      throw std::runtime_error( "Bad PPM header: " + filePath_ );
+    }
+
+    return value;
+  }
+
+
+  std::string filePath_;
+  std::ifstream file_;
+  int width_;
+  int height_;
+
+};
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::TextureLoader
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TextureLoader::TextureLoader(
+                             const std::size_t stagingSize,
+                             const std::size_t uploadBudget,
+                             const unsigned    numThreads
+                             )
+  : pStaging_   ( nullptr )
+  , stagingSize_( stagingSize )
+  , uploadBudget_( uploadBudget )
+  , stopping_   ( false )
+{
+  if ( stagingSize_ > 0 && ( GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage ) )
+  {
+    spStaging_ = std::shared_ptr< GLuint >( new GLuint,
+                                           [ ] ( auto pID )
+      {
+        OpenGLStateCache::get( ).deleteBuffers( 1, pID );
+        delete pID;
+      } );
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers( 1, spStaging_.get( ) );
+    OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_UNPACK_BUFFER, *spStaging_ );
+
+    glBufferStorage( GL_PIXEL_UNPACK_BUFFER, static_cast< GLsizeiptr >( stagingSize_ ), nullptr, flags );
+    pStaging_ = static_cast< unsigned char* >(
+      glMapBufferRange( GL_PIXEL_UNPACK_BUFFER, 0, static_cast< GLsizeiptr >( stagingSize_ ), flags )
+      );
+
+    // texture uploads elsewhere read client memory
+    OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+    if ( pStaging_ )
+    {
+      freeStaging_[ 0 ] = stagingSize_;
+    }
+  }
+
+  for ( unsigned i = 0; i < std::max( numThreads, 1u ); ++i )
+  {
+    workers_.emplace_back( &TextureLoader::_decodeJobs, this );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::~TextureLoader
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TextureLoader::~TextureLoader( )
+{
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    stopping_ = true;
+  }
+
+  workAvailable_.notify_all( );
+  stagingFreed_.notify_all( );
+
+  for ( std::thread &worker : workers_ )
+  {
+    worker.join( );
+  }
+
+  for ( Upload &upload : uploads_ )
+  {
+    glDeleteSync( upload.fence );
+  }
+
+  if ( pStaging_ )
+  {
+    OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_UNPACK_BUFFER, *spStaging_ );
+    glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+    OpenGLStateCache::get( ).bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::load
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TextureLoader::TextureHandle
+TextureLoader::load( std::unique_ptr< Decoder > upDecoder )
+{
+  const TextureHandle handle = handles_.create( );
+
+  if ( !handle.isValid( ) )
+  {
+    throw std::runtime_error( "Out of texture handles" );
+  }
+
+  if ( entries_.size( ) <= handle.getIndex( ) )
+  {
+    entries_.resize( handle.getIndex( ) + 1 );
+  }
+
+  std::shared_ptr< std::atomic< bool > > spCancelled = std::make_shared< std::atomic< bool > >( false );
+
+  entries_[ handle.getIndex( ) ] = Entry{ LOADING, nullptr, "", spCancelled };
+
+  std::unique_ptr< Job > upJob( new Job{ handle, std::move( upDecoder ), 0, 0, NO_STAGING, 0, { }, "", spCancelled } );
+
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    pending_.emplace_back( std::move( upJob ) );
+  }
+
+  workAvailable_.notify_one( );
+
+  return handle;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::loadFile
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TextureLoader::TextureHandle
+TextureLoader::loadFile( const std::string &filePath )
+{
+  return load( std::unique_ptr< Decoder >( new PpmDecoder( filePath ) ) );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::update
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TextureLoader::update( )
+{
+  _retireUploads( );
+
+  std::deque< std::unique_ptr< Job > > jobs;
+
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+
+    std::size_t bytes = 0;
+
+    while ( !decoded_.empty( ) && ( jobs.empty( ) || bytes < uploadBudget_ ) )
+    {
+      bytes += static_cast< std::size_t >( decoded_.front( )->width )
+               * static_cast< std::size_t >( decoded_.front( )->height ) * 4;
+
+      jobs.emplace_back( std::move( decoded_.front( ) ) );
+      decoded_.pop_front( );
+    }
+  }
+
+  Upload upload{ nullptr, { } };
+
+  for ( const std::unique_ptr< Job > &upJob : jobs )
+  {
+    const bool alive = handles_.isAlive( upJob->handle );
+
+    if ( alive && upJob->error.empty( ) )
+    {
+      Entry &entry = entries_[ upJob->handle.getIndex( ) ];
+
+      entry.spTexture   = _upload( *upJob );
+      entry.status      = READY;
+      entry.spCancelled = nullptr;
+    }
+    else if ( alive )
+    {
+      Entry &entry = entries_[ upJob->handle.getIndex( ) ];
+
+      entry.status      = FAILED;
+      entry.error       = upJob->error;
+      entry.spCancelled = nullptr;
+    }
+
+    if ( upJob->stagingOffset != NO_STAGING )
+    {
+      upload.ranges.emplace_back( upJob->stagingOffset, upJob->stagingSize );
+    }
+  }
+
+  if ( !upload.ranges.empty( ) )
+  {
+    // staging is reused once the GPU has copied out of it
+    upload.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    uploads_.emplace_back( std::move( upload ) );
+  }
+} // TextureLoader::update
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::getStatus
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TextureLoader::Status
+TextureLoader::getStatus( const TextureHandle handle ) const
+{
+  return handles_.isAlive( handle ) ? entries_[ handle.getIndex( ) ].status : FAILED;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::getTexture
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::shared_ptr< GLuint >
+TextureLoader::getTexture( const TextureHandle handle ) const
+{
+  return handles_.isAlive( handle ) ? entries_[ handle.getIndex( ) ].spTexture : nullptr;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::getError
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::string
+TextureLoader::getError( const TextureHandle handle ) const
+{
+  return handles_.isAlive( handle ) ? entries_[ handle.getIndex( ) ].error : "Unknown texture handle";
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::release
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TextureLoader::release( const TextureHandle handle )
+{
+  if ( !handles_.destroy( handle ) )
+  {
+    return;
+  }
+
+  Entry &entry = entries_[ handle.getIndex( ) ];
+
+  if ( entry.spCancelled )
+  {
+    *entry.spCancelled = true;
+
+    {
+      std::lock_guard< std::mutex > lock( mutex_ );
+
+      // not picked up by a decoder yet, never touched staging
+      pending_.erase(
+                     std::remove_if(
+                                    pending_.begin( ),
+                                    pending_.end( ),
+                                    [ handle ]( const std::unique_ptr< Job > &upJob )
+                                    {
+                                      return upJob->handle == handle;
+                                    }
+                                    ),
+                     pending_.end( )
+                     );
+    }
+
+    // a decoder may be waiting for staging space
+    stagingFreed_.notify_all( );
+  }
+
+  entry = Entry{ FAILED, nullptr, "", nullptr };
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::_decodeJobs
+///
+///        Decoder thread loop.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TextureLoader::_decodeJobs( )
+{
+  std::unique_lock< std::mutex > lock( mutex_ );
+
+  for ( ;; )
+  {
+    workAvailable_.wait( lock, [ this ] { return stopping_ || !pending_.empty( ); } );
+
+    if ( stopping_ )
+    {
+      break;
+    }
+
+    std::unique_ptr< Job > upJob = std::move( pending_.front( ) );
+    pending_.pop_front( );
+
+    lock.unlock( );
+    _decode( *upJob );
+    lock.lock( );
+
+    decoded_.emplace_back( std::move( upJob ) );
+  }
+} // TextureLoader::_decodeJobs
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::_decode
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TextureLoader::_decode( Job &job )
+{
+  const std::atomic< bool > &cancelled = *job.spCancelled;
+
+  try
+  {
+    if ( cancelled )
+    {
+      throw std::runtime_error( "Load cancelled" );
+    }
+
+    if ( !job.upDecoder->readSize( job.width, job.height ) || job.width <= 0 || job.height <= 0 )
+    {
+      throw std::runtime_error( "Could not read image size" );
+    }
+
+    const std::size_t size = static_cast< std::size_t >( job.width ) * static_cast< std::size_t >( job.height ) * 4;
+
+    unsigned char *pPixels = nullptr;
+
+    if ( pStaging_ && size <= stagingSize_ )
+    {
+      std::unique_lock< std::mutex > lock( mutex_ );
+
+      // uploads in flight free staging as the GPU finishes them
+      stagingFreed_.wait( lock, [ this, &job, &cancelled, size ]
+        {
+          return stopping_ || cancelled || ( job.stagingOffset = _allocateStaging( size ) ) != NO_STAGING;
+        } );
+
+      if ( job.stagingOffset == NO_STAGING )
+      {
+        throw std::runtime_error( cancelled ? "Load cancelled" : "Texture loader stopped" );
+      }
+
+      job.stagingSize = size;
+      pPixels         = pStaging_ + job.stagingOffset;
+    }
+    else
+    {
+      job.heapPixels.resize( size );
+      pPixels = job.heapPixels.data( );
+    }
+
+    // staging, if any, is handed back through update
+    if ( cancelled )
+    {
+      throw std::runtime_error( "Load cancelled" );
+    }
+
+    if ( !job.upDecoder->readPixels( pPixels ) )
+    {
+      throw std::runtime_error( "Could not read image pixels" );
+    }
+  }
+  catch ( const std::exception &e )
+  {
+    job.error = e.what( );
+  }
+
+  job.upDecoder = nullptr;
+} // TextureLoader::_decode
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::_upload
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::shared_ptr< GLuint >
+TextureLoader::_upload( const Job &job )
+{
+  OpenGLStateCache &cache = OpenGLStateCache::get( );
+
+  std::shared_ptr< GLuint > spTexture(
+                                      new GLuint,
+                                      [ ] ( auto pID )
+    {
+      OpenGLStateCache::get( ).deleteTextures( 1, pID );
+      delete pID;
+    }
+                                      );
+
+  glGenTextures( 1, spTexture.get( ) );
+  cache.bindTexture( GL_TEXTURE_2D, *spTexture );
+
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT );
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT );
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+
+  glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, job.width, job.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+
+  const void *pPixels = job.heapPixels.data( );
+
+  if ( job.stagingOffset != NO_STAGING )
+  {
+    // pointer is an offset into the bound unpack buffer
+    cache.bindBuffer( GL_PIXEL_UNPACK_BUFFER, *spStaging_ );
+    pPixels = reinterpret_cast< const void* >( job.stagingOffset );
+  }
+
+  glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+  glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, job.width, job.height, GL_RGBA, GL_UNSIGNED_BYTE, pPixels );
+
+  cache.bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+  glGenerateMipmap( GL_TEXTURE_2D );
+
+  return spTexture;
+} // TextureLoader::_upload
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::_retireUploads
+///
+///        Frees staging of uploads the GPU has finished, oldest
+///        first.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TextureLoader::_retireUploads( )
+{
+  bool freed = false;
+
+  while ( !uploads_.empty( )
+         && glClientWaitSync( uploads_.front( ).fence, 0, 0 ) != GL_TIMEOUT_EXPIRED )
+  {
+    glDeleteSync( uploads_.front( ).fence );
+
+    {
+      std::lock_guard< std::mutex > lock( mutex_ );
+
+      for ( const auto &range : uploads_.front( ).ranges )
+      {
+        _freeStaging( range.first, range.second );
+      }
+    }
+
+    uploads_.pop_front( );
+    freed = true;
+  }
+
+  if ( freed )
+  {
+    stagingFreed_.notify_all( );
+  }
+} // TextureLoader::_retireUploads
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::_allocateStaging
+///
+///        First fit. Sizes are RGBA8 images so offsets stay 4
+///        byte aligned.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::size_t
+TextureLoader::_allocateStaging( const std::size_t size )
+{
+  for ( auto it = freeStaging_.begin( ); it != freeStaging_.end( ); ++it )
+  {
+    if ( it->second >= size )
+    {
+      const std::size_t offset    = it->first;
+      const std::size_t remaining = it->second - size;
+
+      freeStaging_.erase( it );
+
+      if ( remaining > 0 )
+      {
+        freeStaging_[ offset + size ] = remaining;
+      }
+
+      return offset;
+    }
+  }
+
+  return NO_STAGING;
+} // TextureLoader::_allocateStaging
+
+
+
+/////////////////////////////////////////////
+/// \brief TextureLoader::_freeStaging
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TextureLoader::_freeStaging(
+                            const std::size_t offset,
+                            const std::size_t size
+                            )
+{
+  auto it = freeStaging_.emplace( offset, size ).first;
+
+  // merge with the following block
+  auto next = std::next( it );
+
+  if ( next != freeStaging_.end( ) && it->first + it->second == next->first )
+  {
+    it->second += next->second;
+    freeStaging_.erase( next );
+  }
+
+  // and the preceding one
+  if ( it != freeStaging_.begin( ) )
+  {
+    auto previous = std::prev( it );
+
+    if ( previous->first + previous->second == it->first )
+    {
+      previous->second += it->second;
+      freeStaging_.erase( it );
+    }
+  }
+} // TextureLoader::_freeStaging
+
+
+
+} // namespace shg
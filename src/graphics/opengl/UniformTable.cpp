@@ -0,0 +1,103 @@
+#include "shared/graphics/UniformTable.hpp"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace shg
+{
+
+
+/////////////////////////////////////////////
+/// \brief UniformTable::UniformTable
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+UniformTable::UniformTable( const GLuint program )
+  : program_( program )
+{
+  GLint numUniforms = 0;
+  GLint maxLength   = 0;
+
+  glGetProgramiv( program, GL_ACTIVE_UNIFORMS,           &numUniforms );
+  glGetProgramiv( program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength );
+
+  std::vector< GLchar > name( static_cast< size_t >( std::max( maxLength, 1 ) ) );
+
+  uniforms_.reserve( static_cast< size_t >( numUniforms ) );
+
+  for ( GLint i = 0; i < numUniforms; ++i )
+  {
+    GLsizei length = 0;
+    UniformHandle handle;
+
+    glGetActiveUniform(
+                       program,
+                       static_cast< GLuint >( i ),
+                       maxLength,
+                       &length,
+                       &handle.count,
+                       &handle.type,
+                       name.data( )
+                       );
+
+    std::string uniform( name.data( ), static_cast< size_t >( length ) );
+
+    handle.location = glGetUniformLocation( program, uniform.c_str( ) );
+
+    // uniform block members have no location
+    if ( handle.location < 0 )
+    {
+      continue;
+    }
+
+    // arrays are reported as "name[0]"
+    const std::string::size_type bracket = uniform.rfind( "[0]" );
+
+    if ( bracket != std::string::npos && bracket + 3 == uniform.size( ) )
+    {
+      uniforms_[ uniform.substr( 0, bracket ) ] = handle;
+    }
+
+    uniforms_[ std::move( uniform ) ] = handle;
+  }
+} // UniformTable::UniformTable
+
+
+
+/////////////////////////////////////////////
+/// \brief UniformTable::getUniform
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+UniformHandle
+UniformTable::getUniform( const std::string &name ) const
+{
+  auto it = uniforms_.find( name );
+
+  if ( it != uniforms_.end( ) )
+  {
+    return it->second;
+  }
+
+  //
+  // array elements past [0] and struct members aren't listed
+  // by GL_ACTIVE_UNIFORMS under every name they can be set by
+  //
+  UniformHandle handle;
+
+  if ( program_ != 0 )
+  {
+    handle.location = glGetUniformLocation( program_, name.c_str( ) );
+    handle.count    = handle.isValid( ) ? 1 : 0;
+  }
+
+  // misses are cached too so unknown names are only queried once
+  uniforms_.emplace( name, handle );
+
+  return handle;
+}
+
+
+
+} // namespace shg
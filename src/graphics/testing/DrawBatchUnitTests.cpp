@@ -0,0 +1,143 @@
+// DrawBatchUnitTests.cpp
+#include "shared/graphics/DrawBatch.hpp"
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+#include "SharedSimulationConfig.hpp"
+
+#include "gmock/gmock.h"
+
+#include <vector>
+
+
+namespace
+{
+
+
+///
+/// \brief Matches DrawData in shaders/indirect/shader.vert
+///
+struct DrawData
+{
+  float model[ 16 ];
+  float color[ 4 ];
+};
+
+
+///
+/// \brief The DrawBatchUnitTests class
+///
+class DrawBatchUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief DrawBatchUnitTests
+  /////////////////////////////////////////////////////////////////
+  DrawBatchUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+  }
+
+
+  static
+  DrawData
+  makeDraw(
+           const float x,
+           const float r,
+           const float g
+           )
+  {
+    return DrawData{
+             {
+               1, 0, 0, 0,
+               0, 1, 0, 0,
+               0, 0, 1, 0,
+               x, 0, 0, 1
+             },
+             { r, g, 0, 1 }
+    };
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief EachDrawUsesItsOwnData
+/////////////////////////////////////////////////////////////////
+TEST_F( DrawBatchUnitTests, EachDrawUsesItsOwnData )
+{
+  if ( !shg::DrawBatch::isSupported( ) )
+  {
+    EXPECT_THROW( shg::DrawBatch( sizeof( DrawData ) ), std::runtime_error );
+    return;
+  }
+
+  std::shared_ptr< GLuint > spProgram =
+    shg::OpenGLHelper::createProgram(
+                                     shs::SHADER_PATH + "indirect/shader.vert",
+                                     shs::SHADER_PATH + "indirect/shader.frag"
+                                     );
+
+  // a quad covering half the screen, drawn twice from the same buffers
+  const std::vector< float > vbo =
+  {
+    -0.5f, -1.0f, 0.0f,
+    0.5f,  -1.0f, 0.0f,
+    0.5f,  1.0f,  0.0f,
+    -0.5f, 1.0f,  0.0f
+  };
+  const std::vector< unsigned short > ibo = { 0, 1, 2, 0, 2, 3 };
+
+  std::shared_ptr< GLuint > spVbo = shg::OpenGLHelper::createBuffer( vbo.data( ), vbo.size( ) );
+  std::shared_ptr< GLuint > spIbo = shg::OpenGLHelper::createBuffer(
+                                                                    ibo.data( ),
+                                                                    ibo.size( ),
+                                                                    GL_ELEMENT_ARRAY_BUFFER
+                                                                    );
+  std::shared_ptr< GLuint > spVao = shg::OpenGLHelper::createVao(
+                                                                 spProgram,
+                                                                 spVbo,
+                                                                 0,
+                                                                 { { "inPosition", 3, GL_FLOAT, nullptr } }
+                                                                 );
+
+  shg::DrawBatch batch( sizeof( DrawData ) );
+
+  const DrawData left  = makeDraw( -0.5f, 1.0f, 0.0f );
+  const DrawData right = makeDraw(  0.5f, 0.0f, 1.0f );
+
+  batch.addDraw( 6, 0, 0, &left );
+  batch.addDraw( 6, 0, 0, &right );
+
+  EXPECT_EQ( 2u, batch.size( ) );
+
+  shg::OpenGLHelper::clearFramebuffer( );
+  shg::OpenGLHelper::useProgram( spProgram );
+  batch.submit( spVao, spIbo );
+
+  EXPECT_EQ( static_cast< GLenum >( GL_NO_ERROR ), glGetError( ) );
+
+  GLint viewport[ 4 ];
+  glGetIntegerv( GL_VIEWPORT, viewport );
+
+  unsigned char leftPixel[ 4 ], rightPixel[ 4 ];
+  glReadPixels( viewport[ 2 ] / 4,     viewport[ 3 ] / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, leftPixel );
+  glReadPixels( viewport[ 2 ] * 3 / 4, viewport[ 3 ] / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, rightPixel );
+
+  EXPECT_EQ( 255, leftPixel[ 0 ] );
+  EXPECT_EQ( 0,   leftPixel[ 1 ] );
+  EXPECT_EQ( 0,   rightPixel[ 0 ] );
+  EXPECT_EQ( 255, rightPixel[ 1 ] );
+
+  batch.clear( );
+  EXPECT_TRUE( batch.empty( ) );
+}
+
+
+} // namespace
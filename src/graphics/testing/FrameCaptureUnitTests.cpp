@@ -0,0 +1,141 @@
+// FrameCaptureUnitTests.cpp
+#include "shared/graphics/FrameCapture.hpp"
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+
+#include "gmock/gmock.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+
+namespace
+{
+
+
+const std::string RAW_PATH = "./FrameCaptureTest.raw";
+const std::string Y4M_PATH = "./FrameCaptureTest.y4m";
+
+
+///
+/// \brief The FrameCaptureUnitTests class
+///
+class FrameCaptureUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief FrameCaptureUnitTests
+  /////////////////////////////////////////////////////////////////
+  FrameCaptureUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+  }
+
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ~FrameCaptureUnitTests
+  /////////////////////////////////////////////////////////////////
+  virtual
+  ~FrameCaptureUnitTests( )
+  {
+    std::remove( RAW_PATH.c_str( ) );
+    std::remove( Y4M_PATH.c_str( ) );
+  }
+
+
+  static
+  std::string
+  readFile( const std::string &filePath )
+  {
+    std::ifstream file( filePath, std::ios::in | std::ios::binary );
+    return std::string( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >( ) );
+  }
+
+
+  ///
+  /// \brief captures frames cleared to red, green, blue, red, ...
+  ///
+  static
+  std::size_t
+  captureFrames(
+                const std::string &filePath,
+                const int          frames
+                )
+  {
+    const float colors[ 3 ][ 3 ] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+    shg::FrameCapture capture( filePath, 8, 4 );
+
+    for ( int i = 0; i < frames; ++i )
+    {
+      const float *color = colors[ i % 3 ];
+      glClearColor( color[ 0 ], color[ 1 ], color[ 2 ], 1.0f );
+      glClear( GL_COLOR_BUFFER_BIT );
+      capture.capture( );
+    }
+
+    EXPECT_EQ( static_cast< std::size_t >( frames ), capture.getFramesCaptured( ) );
+
+    return capture.getFramesDropped( );
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief RawFramesArriveInOrder
+/////////////////////////////////////////////////////////////////
+TEST_F( FrameCaptureUnitTests, RawFramesArriveInOrder )
+{
+  // more frames than buffers so slots are reused
+  ASSERT_EQ( 0u, captureFrames( RAW_PATH, 5 ) );
+
+  const std::string raw = readFile( RAW_PATH );
+  const std::size_t frameSize = 8 * 4 * 3;
+
+  ASSERT_EQ( 5 * frameSize, raw.size( ) );
+
+  for ( std::size_t frame = 0; frame < 5; ++frame )
+  {
+    for ( std::size_t channel = 0; channel < 3; ++channel )
+    {
+      const unsigned char expected = ( frame % 3 == channel ) ? 255 : 0;
+
+      EXPECT_EQ( expected, static_cast< unsigned char >( raw[ frame * frameSize + channel ] ) )
+        << "frame " << frame << " channel " << channel;
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief Y4mHasHeaderAndPlanes
+/////////////////////////////////////////////////////////////////
+TEST_F( FrameCaptureUnitTests, Y4mHasHeaderAndPlanes )
+{
+  ASSERT_EQ( 0u, captureFrames( Y4M_PATH, 2 ) );
+
+  const std::string y4m    = readFile( Y4M_PATH );
+  const std::string header = "YUV4MPEG2 W8 H4 F60:1 Ip A1:1 C444\n";
+  const std::size_t frame  = std::string( "FRAME\n" ).size( ) + 8 * 4 * 3;
+
+  ASSERT_EQ( header.size( ) + 2 * frame, y4m.size( ) );
+  EXPECT_EQ( header, y4m.substr( 0, header.size( ) ) );
+  EXPECT_EQ( "FRAME\n", y4m.substr( header.size( ), 6 ) );
+
+  // pure red in BT.601 studio range
+  EXPECT_EQ( 82,  static_cast< unsigned char >( y4m[ header.size( ) + 6 ] ) );
+  EXPECT_EQ( 240, static_cast< unsigned char >( y4m[ header.size( ) + 6 + 8 * 4 * 2 ] ) );
+}
+
+
+} // namespace
@@ -0,0 +1,234 @@
+// GpuProfilerUnitTests.cpp
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/GpuProfiler.hpp"
+
+#include "gmock/gmock.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+
+namespace
+{
+
+
+const std::string CSV_PATH = "./GpuProfilerTest.csv";
+
+
+///
+/// \brief The GpuProfilerUnitTests class
+///
+class GpuProfilerUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief GpuProfilerUnitTests
+  /////////////////////////////////////////////////////////////////
+  GpuProfilerUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+  }
+
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ~GpuProfilerUnitTests
+  /////////////////////////////////////////////////////////////////
+  virtual
+  ~GpuProfilerUnitTests( )
+  {
+    std::remove( CSV_PATH.c_str( ) );
+  }
+
+
+  ///
+  /// \brief records one frame with an outer and two inner scopes
+  ///
+  static
+  void
+  recordFrame( shg::GpuProfiler &profiler )
+  {
+    profiler.beginFrame( );
+
+    {
+      shg::GpuProfiler::Scope outer( &profiler, "outer" );
+
+      {
+        shg::GpuProfiler::Scope clear( &profiler, "clear" );
+        glClear( GL_COLOR_BUFFER_BIT );
+      }
+
+      {
+        shg::GpuProfiler::Scope wait( &profiler, "wait" );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+      }
+    }
+
+    profiler.endFrame( );
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief NestedScopesAreReadBackLater
+/////////////////////////////////////////////////////////////////
+TEST_F( GpuProfilerUnitTests, NestedScopesAreReadBackLater )
+{
+  ASSERT_TRUE( shg::GpuProfiler::isSupported( ) );
+
+  shg::GpuProfiler profiler( 3 );
+
+  EXPECT_TRUE( profiler.getTimings( ).empty( ) );
+
+  for ( int i = 0; i < 10; ++i )
+  {
+    recordFrame( profiler );
+    glFinish( );
+  }
+
+  // the newest frame is at most a ring behind
+  EXPECT_GE( profiler.getTimingsFrame( ), 7u );
+  EXPECT_EQ( 0u, profiler.getFramesDropped( ) );
+
+  const std::vector< shg::GpuProfiler::ScopeTiming > &timings = profiler.getTimings( );
+
+  ASSERT_EQ( 3u, timings.size( ) );
+
+  EXPECT_EQ( "outer", timings[ 0 ].name );
+  EXPECT_EQ( "clear", timings[ 1 ].name );
+  EXPECT_EQ( "wait",  timings[ 2 ].name );
+
+  EXPECT_EQ( 0, timings[ 0 ].depth );
+  EXPECT_EQ( 1, timings[ 1 ].depth );
+  EXPECT_EQ( 1, timings[ 2 ].depth );
+
+  EXPECT_GE( timings[ 2 ].cpuMs, 2.0 );
+  EXPECT_GE( timings[ 0 ].cpuMs, timings[ 1 ].cpuMs + timings[ 2 ].cpuMs );
+
+  for ( const auto &timing : timings )
+  {
+    EXPECT_GE( timing.gpuMs, 0.0 );
+  }
+
+  EXPECT_EQ( static_cast< GLenum >( GL_NO_ERROR ), glGetError( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ScopesOutsideFramesAreIgnored
+/////////////////////////////////////////////////////////////////
+TEST_F( GpuProfilerUnitTests, ScopesOutsideFramesAreIgnored )
+{
+  shg::GpuProfiler profiler;
+
+  {
+    shg::GpuProfiler::Scope ignored( &profiler, "ignored" );
+  }
+
+  // no profiler, no work
+  {
+    shg::GpuProfiler::Scope noop( nullptr, "noop" );
+  }
+
+  // unclosed scopes end with the frame
+  profiler.beginFrame( );
+  profiler.beginScope( "unclosed" );
+  profiler.endFrame( );
+
+  glFinish( );
+  profiler.endFrame( );
+
+  ASSERT_EQ( 1u, profiler.getTimings( ).size( ) );
+  EXPECT_EQ( "unclosed", profiler.getTimings( )[ 0 ].name );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief CsvHasOneRowPerScope
+/////////////////////////////////////////////////////////////////
+TEST_F( GpuProfilerUnitTests, CsvHasOneRowPerScope )
+{
+  {
+    shg::GpuProfiler profiler( 2 );
+    profiler.startCsv( CSV_PATH );
+
+    EXPECT_TRUE( profiler.isWritingCsv( ) );
+
+    for ( int i = 0; i < 4; ++i )
+    {
+      recordFrame( profiler );
+      glFinish( );
+    }
+
+    profiler.stopCsv( );
+  }
+
+  std::ifstream file( CSV_PATH );
+  std::string line;
+
+  ASSERT_TRUE( std::getline( file, line ) );
+  EXPECT_EQ( "frame,scope,depth,cpu_ms,gpu_ms", line );
+
+  int rows = 0;
+
+  while ( std::getline( file, line ) )
+  {
+    ++rows;
+  }
+
+  // every frame but the last was read back by the next one
+  EXPECT_GE( rows, 3 * 3 );
+  EXPECT_EQ( 0, rows % 3 );
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief CsvScopeNamesAreQuoted
+/////////////////////////////////////////////////////////////////
+TEST_F( GpuProfilerUnitTests, CsvScopeNamesAreQuoted )
+{
+  {
+    shg::GpuProfiler profiler( 2 );
+    profiler.startCsv( CSV_PATH );
+
+    for ( int i = 0; i < 3; ++i )
+    {
+      profiler.beginFrame( );
+
+      {
+        shg::GpuProfiler::Scope scope( &profiler, "draw \"a, b\"" );
+        glClear( GL_COLOR_BUFFER_BIT );
+      }
+
+      profiler.endFrame( );
+      glFinish( );
+    }
+
+    profiler.stopCsv( );
+  }
+
+  std::ifstream file( CSV_PATH );
+  std::string line;
+
+  ASSERT_TRUE( std::getline( file, line ) ); // header
+  ASSERT_TRUE( std::getline( file, line ) );
+
+  EXPECT_NE( std::string::npos, line.find( ",\"draw \"\"a, b\"\"\"," ) ) << line;
+}
+
+
+} // namespace
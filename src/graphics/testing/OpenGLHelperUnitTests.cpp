@@ -1,6 +1,7 @@
 // OpenGLHelperUnitTests.cpp
 #include "shared/graphics/GlfwWrapper.hpp"
 #include "shared/graphics/OpenGLHelper.hpp"
+#include "SharedSimulationConfig.hpp"
 
 #include "gmock/gmock.h"
 
@@ -349,4 +350,110 @@ TEST_F( OpenGLHelperUnitTests, DepthbufferDeletedAndReplaced )
 }
 
 
+
+/////////////////////////////////////////////////////////////////
+/// \brief UniformTableMatchesDriverLocations
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLHelperUnitTests, UniformTableMatchesDriverLocations )
+{
+  std::shared_ptr< GLuint > spProgram =
+    shg::OpenGLHelper::createProgram(
+                                     shs::SHADER_PATH + "simple/shader.vert",
+                                     shs::SHADER_PATH + "simple/shader.frag"
+                                     );
+
+  const shg::UniformHandle matrix = shg::OpenGLHelper::getUniform( spProgram, "projectionViewModel" );
+  const shg::UniformHandle color  = shg::OpenGLHelper::getUniform( spProgram, "color" );
+
+  ASSERT_TRUE( matrix.isValid( ) );
+  ASSERT_TRUE( color.isValid( ) );
+
+  EXPECT_EQ( glGetUniformLocation( *spProgram, "projectionViewModel" ), matrix.location );
+  EXPECT_EQ( glGetUniformLocation( *spProgram, "color" ),               color.location );
+
+  EXPECT_EQ( static_cast< GLenum >( GL_FLOAT_MAT4 ), matrix.type );
+  EXPECT_EQ( static_cast< GLenum >( GL_FLOAT_VEC3 ), color.type );
+
+  EXPECT_FALSE( shg::OpenGLHelper::getUniform( spProgram, "notAUniform" ).isValid( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief UniformTableFindsLaterArrayElements
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLHelperUnitTests, UniformTableFindsLaterArrayElements )
+{
+  std::shared_ptr< GLuint > spProgram =
+    shg::OpenGLHelper::createProgram(
+                                     shs::SHADER_PATH + "simple/shader.vert",
+                                     shs::SHADER_PATH + "lights/shader.frag"
+                                     );
+
+  const shg::UniformHandle light = shg::OpenGLHelper::getUniform( spProgram, "lightColors[2]" );
+
+  ASSERT_TRUE( light.isValid( ) );
+  EXPECT_EQ( glGetUniformLocation( *spProgram, "lightColors[2]" ), light.location );
+
+  const float color[] = { 0.25f, 0.5f, 0.75f };
+
+  shg::OpenGLHelper::useProgram( spProgram );
+  shg::OpenGLHelper::setFloatUniform( light, color, 3 );
+
+  float stored[ 3 ] = { };
+  glGetUniformfv( *spProgram, light.location, stored );
+
+  EXPECT_FLOAT_EQ( 0.25f, stored[ 0 ] );
+  EXPECT_FLOAT_EQ( 0.5f,  stored[ 1 ] );
+  EXPECT_FLOAT_EQ( 0.75f, stored[ 2 ] );
+
+  // [0] is untouched
+  glGetUniformfv( *spProgram, shg::OpenGLHelper::getUniform( spProgram, "lightColors" ).location, stored );
+
+  EXPECT_FLOAT_EQ( 0.0f, stored[ 0 ] );
+
+  // misses are cached as invalid handles
+  EXPECT_FALSE( shg::OpenGLHelper::getUniform( spProgram, "lightColors[7]" ).isValid( ) );
+  EXPECT_FALSE( shg::OpenGLHelper::getUniform( spProgram, "lightColors[7]" ).isValid( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief AsyncProgramsLinkOnGet
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLHelperUnitTests, AsyncProgramsLinkOnGet )
+{
+  // both submitted before either is checked
+  shg::PendingProgram simple =
+    shg::OpenGLHelper::createProgramAsync(
+                                          shs::SHADER_PATH + "simple/shader.vert",
+                                          shs::SHADER_PATH + "simple/shader.frag"
+                                          );
+
+  shg::PendingProgram instanced =
+    shg::OpenGLHelper::createProgramAsync(
+                                          shs::SHADER_PATH + "instanced/shader.vert",
+                                          shs::SHADER_PATH + "simple/shader.frag"
+                                          );
+
+  // polling never blocks, get may
+  while ( !simple.isReady( ) || !instanced.isReady( ) )
+  {}
+
+  std::shared_ptr< GLuint > spSimple    = simple.get( );
+  std::shared_ptr< GLuint > spInstanced = instanced.get( );
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv( *spInstanced, GL_LINK_STATUS, &linked );
+
+  EXPECT_EQ( GL_TRUE, linked );
+  EXPECT_EQ( spSimple, simple.get( ) );
+  EXPECT_TRUE( shg::OpenGLHelper::getUniform( spSimple, "projectionViewModel" ).isValid( ) );
+  EXPECT_TRUE( shg::OpenGLHelper::getUniform( spInstanced, "projectionView" ).isValid( ) );
+
+  EXPECT_THROW( shg::OpenGLHelper::createProgramAsync( "missing.vert" ), std::runtime_error );
+}
+
+
 } // namespace
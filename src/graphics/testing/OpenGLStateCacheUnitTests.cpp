@@ -0,0 +1,178 @@
+// OpenGLStateCacheUnitTests.cpp
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
+
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+
+#include "gmock/gmock.h"
+
+#include <vector>
+
+
+namespace
+{
+
+
+///
+/// \brief The OpenGLStateCacheUnitTests class
+///
+class OpenGLStateCacheUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief OpenGLStateCacheUnitTests
+  /////////////////////////////////////////////////////////////////
+  OpenGLStateCacheUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+    shg::OpenGLStateCache::get( ).endFrame( );
+  }
+
+
+  static
+  GLint
+  getInteger( const GLenum name )
+  {
+    GLint value = 0;
+    glGetIntegerv( name, &value );
+    return value;
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief RedundantBindsAreSkipped
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLStateCacheUnitTests, RedundantBindsAreSkipped )
+{
+  shg::OpenGLStateCache &cache = shg::OpenGLStateCache::get( );
+
+  const std::vector< float > data = { 0.0f, 0.0f, 0.0f, 0.0f };
+  std::shared_ptr< GLuint > spVbo = shg::OpenGLHelper::createBuffer( data.data( ), data.size( ) );
+
+  cache.endFrame( );
+
+  for ( int i = 0; i < 5; ++i )
+  {
+    cache.bindBuffer( GL_ARRAY_BUFFER, *spVbo );
+  }
+
+  cache.endFrame( );
+
+  // createBuffer left it bound
+  EXPECT_EQ( 0u, cache.getFrameCounters( ).issued );
+  EXPECT_EQ( 5u, cache.getFrameCounters( ).skipped );
+  EXPECT_EQ( static_cast< GLint >( *spVbo ), getInteger( GL_ARRAY_BUFFER_BINDING ) );
+
+  cache.invalidate( );
+  cache.bindBuffer( GL_ARRAY_BUFFER, *spVbo );
+  cache.endFrame( );
+
+  EXPECT_EQ( 1u, cache.getFrameCounters( ).issued );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ElementBuffersFollowTheVertexArray
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLStateCacheUnitTests, ElementBuffersFollowTheVertexArray )
+{
+  shg::OpenGLStateCache &cache = shg::OpenGLStateCache::get( );
+
+  GLuint vaos[ 2 ];
+  GLuint ibos[ 2 ];
+
+  glGenVertexArrays( 2, vaos );
+  glGenBuffers( 2, ibos );
+
+  cache.bindVertexArray( vaos[ 0 ] );
+  cache.bindBuffer( GL_ELEMENT_ARRAY_BUFFER, ibos[ 0 ] );
+
+  cache.bindVertexArray( vaos[ 1 ] );
+  cache.bindBuffer( GL_ELEMENT_ARRAY_BUFFER, ibos[ 1 ] );
+
+  // each vertex array kept its own element buffer
+  cache.bindVertexArray( vaos[ 0 ] );
+  cache.endFrame( );
+  cache.bindBuffer( GL_ELEMENT_ARRAY_BUFFER, ibos[ 0 ] );
+  cache.endFrame( );
+
+  EXPECT_EQ( 1u, cache.getFrameCounters( ).skipped );
+  EXPECT_EQ( static_cast< GLint >( ibos[ 0 ] ), getInteger( GL_ELEMENT_ARRAY_BUFFER_BINDING ) );
+
+  cache.deleteVertexArrays( 2, vaos );
+  cache.deleteBuffers( 2, ibos );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ReusedIdsAreRebound
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLStateCacheUnitTests, ReusedIdsAreRebound )
+{
+  shg::OpenGLStateCache &cache = shg::OpenGLStateCache::get( );
+
+  GLuint first = 0;
+  glGenTextures( 1, &first );
+
+  cache.activeTexture( GL_TEXTURE0 );
+  cache.bindTexture( GL_TEXTURE_2D, first );
+  cache.deleteTextures( 1, &first );
+
+  // drivers commonly hand the same name out again
+  GLuint second = 0;
+  glGenTextures( 1, &second );
+
+  cache.bindTexture( GL_TEXTURE_2D, second );
+
+  EXPECT_EQ( static_cast< GLint >( second ), getInteger( GL_TEXTURE_BINDING_2D ) );
+
+  cache.deleteTextures( 1, &second );
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief EachContextHasItsOwnCache
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLStateCacheUnitTests, EachContextHasItsOwnCache )
+{
+  shg::OpenGLStateCache &windowCache = shg::OpenGLStateCache::get( );
+
+  glfwMakeContextCurrent( nullptr );
+
+  EXPECT_NE( &windowCache, &shg::OpenGLStateCache::get( ) );
+
+  glfwMakeContextCurrent( glfw_.getWindow( ) );
+
+  EXPECT_EQ( &windowCache, &shg::OpenGLStateCache::get( ) );
+
+  windowCache.useProgram( 0 );
+
+  // a destroyed context's cache must not be handed out again
+  shg::OpenGLStateCache::releaseContext( glfw_.getWindow( ) );
+
+  shg::OpenGLStateCache &freshCache = shg::OpenGLStateCache::get( );
+
+  freshCache.endFrame( );
+  freshCache.useProgram( 0 );
+  freshCache.endFrame( );
+
+  EXPECT_EQ( 1u, freshCache.getFrameCounters( ).issued );
+}
+
+
+} // namespace
@@ -1,8 +1,12 @@
 // OpenGLWrapperUnitTests.cpp
 #include "shared/graphics/OpenGLWrapper.hpp"
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "SharedSimulationConfig.hpp"
 
 #include "gmock/gmock.h"
 
+#include <vector>
+
 
 namespace
 {
@@ -20,7 +24,10 @@ protected:
   /// \brief OpenGLWrapperUnitTests
   /////////////////////////////////////////////////////////////////
   OpenGLWrapperUnitTests( )
-  {}
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+  }
 
 
   /////////////////////////////////////////////////////////////////
@@ -30,6 +37,9 @@ protected:
   ~OpenGLWrapperUnitTests( )
   {}
 
+
+  shg::GlfwWrapper glfw_;
+
 };
 
 
@@ -41,4 +51,129 @@ TEST_F( OpenGLWrapperUnitTests, UnimplementedTest )
 
 
 
+/////////////////////////////////////////////////////////////////
+/// \brief HandlesMatchNamedResources
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLWrapperUnitTests, HandlesMatchNamedResources )
+{
+  shg::OpenGLWrapper graphics;
+
+  const shg::OpenGLWrapper::TextureHandle tex1 = graphics.addTextureArray( "tex1", 4, 4 );
+  const shg::OpenGLWrapper::TextureHandle tex2 = graphics.addTextureArray( "tex2", 4, 4 );
+
+  EXPECT_EQ( tex1, graphics.getTextureHandle( "tex1" ) );
+  EXPECT_EQ( graphics.getTexture( "tex1" ), graphics.getTexture( tex1 ) );
+  EXPECT_NE( graphics.getTexture( tex1 ), graphics.getTexture( tex2 ) );
+
+  // re-adding a name keeps its handle
+  EXPECT_EQ( tex1, graphics.addTextureArray( "tex1", 8, 8 ) );
+
+  const GLuint id1 = graphics.getTexture( tex1 );
+  const GLuint id2 = graphics.getTexture( tex2 );
+
+  graphics.swapTextures( tex1, tex2 );
+
+  EXPECT_EQ( id2, graphics.getTexture( "tex1" ) );
+  EXPECT_EQ( id1, graphics.getTexture( "tex2" ) );
+
+  const std::vector< float > vbo = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f };
+
+  const shg::OpenGLWrapper::BufferHandle buffer =
+    graphics.addBuffer( "buffer", vbo.data( ), vbo.size( ), GL_STATIC_DRAW, shg::VAOSettings( "program" ) );
+
+  EXPECT_EQ( buffer, graphics.getBufferHandle( "buffer" ) );
+  EXPECT_NE( 0u, graphics.getBuffer( buffer ) );
+  EXPECT_THROW( graphics.addBuffer( "buffer", vbo.data( ), vbo.size( ), GL_STATIC_DRAW, shg::VAOSettings( ) ),
+                std::runtime_error );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief DestroyedHandlesThrow
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLWrapperUnitTests, DestroyedHandlesThrow )
+{
+  shg::OpenGLWrapper graphics;
+
+  EXPECT_THROW( graphics.getTextureHandle( "missing" ), std::runtime_error );
+  EXPECT_THROW( graphics.useProgram( shg::OpenGLWrapper::ProgramHandle( ) ), std::runtime_error );
+
+  const shg::OpenGLWrapper::TextureHandle texture = graphics.addTextureArray( "texture", 4, 4 );
+  graphics.destroyTexture( texture );
+
+  EXPECT_THROW( graphics.getTexture( texture ), std::runtime_error );
+  EXPECT_THROW( graphics.getTexture( "texture" ), std::runtime_error );
+
+  // a new texture under the old name gets a new handle
+  const shg::OpenGLWrapper::TextureHandle replacement = graphics.addTextureArray( "texture", 4, 4 );
+
+  EXPECT_NE( texture, replacement );
+  EXPECT_THROW( graphics.getTexture( texture ), std::runtime_error );
+  EXPECT_NO_THROW( graphics.getTexture( replacement ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief VertexArraysAreBuiltForEveryContextUpFront
+/////////////////////////////////////////////////////////////////
+TEST_F( OpenGLWrapperUnitTests, VertexArraysAreBuiltForEveryContextUpFront )
+{
+  shg::OpenGLWrapper graphics;
+
+  // both "contexts" are really the one test context
+  int first    = 0;
+  int second   = 0;
+  int switches = 0;
+
+  graphics.registerContext( &first,  [ &switches ]( ){ ++switches; } );
+  graphics.registerContext( &second, [ &switches ]( ){ ++switches; } );
+  graphics.setCurrentContext( &first );
+
+  // registering the second context visited it once
+  EXPECT_EQ( 2, switches );
+
+  switches = 0;
+
+  // buffer before program, vertex arrays wait for the program
+  const std::vector< float > vbo = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+
+  shg::VAOSettings settings( "program" );
+  settings.settings.push_back( shg::VAOElement{ "inPosition", 3, GL_FLOAT, nullptr } );
+
+  const shg::OpenGLWrapper::BufferHandle buffer =
+    graphics.addBuffer( "buffer", vbo.data( ), vbo.size( ), GL_STATIC_DRAW, settings );
+
+  EXPECT_EQ( 0u, graphics.getVertexArrayCount( &first ) );
+
+  graphics.addProgram(
+                      "program",
+                      shs::SHADER_PATH + "simple/shader.vert",
+                      shs::SHADER_PATH + "simple/shader.frag"
+                      );
+
+  // switched to the second context and back twice
+  EXPECT_EQ( 4, switches );
+
+  // built in both contexts before anything was drawn
+  EXPECT_EQ( 1u, graphics.getVertexArrayCount( &first ) );
+  EXPECT_EQ( 1u, graphics.getVertexArrayCount( &second ) );
+
+  switches = 0;
+
+  graphics.useProgram( "program" );
+  graphics.renderBuffer( buffer, 0, 3, GL_TRIANGLES );
+
+  graphics.setCurrentContext( &second );
+  graphics.renderBuffer( buffer, 0, 3, GL_TRIANGLES );
+
+  // drawing never had to build anything in another context
+  EXPECT_EQ( 0, switches );
+  EXPECT_EQ( 1u, graphics.getVertexArrayCount( &first ) );
+  EXPECT_EQ( 1u, graphics.getVertexArrayCount( &second ) );
+  EXPECT_EQ( static_cast< GLenum >( GL_NO_ERROR ), glGetError( ) );
+}
+
+
 } // namespace
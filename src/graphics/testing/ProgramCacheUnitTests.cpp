@@ -0,0 +1,164 @@
+// ProgramCacheUnitTests.cpp
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/ProgramCache.hpp"
+#include "SharedSimulationConfig.hpp"
+
+#include "gmock/gmock.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace
+{
+
+
+///
+/// \brief The ProgramCacheUnitTests class
+///
+class ProgramCacheUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ProgramCacheUnitTests
+  /////////////////////////////////////////////////////////////////
+  ProgramCacheUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+
+    // binaries go in the working directory and are removed afterwards
+    spCache_ = std::make_shared< shg::ProgramCache >( "." );
+    shg::OpenGLHelper::setProgramCache( spCache_ );
+
+    key_ = spCache_->makeKey( {
+                                ".vert", readFile( shs::SHADER_PATH + "simple/shader.vert" ),
+                                ".frag", readFile( shs::SHADER_PATH + "simple/shader.frag" )
+                              } );
+    std::remove( getPath( ).c_str( ) );
+  }
+
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ~ProgramCacheUnitTests
+  /////////////////////////////////////////////////////////////////
+  virtual
+  ~ProgramCacheUnitTests( )
+  {
+    shg::OpenGLHelper::setProgramCache( nullptr );
+    std::remove( getPath( ).c_str( ) );
+  }
+
+
+  std::shared_ptr< GLuint >
+  createProgram( )
+  {
+    return shg::OpenGLHelper::createProgram(
+                                            shs::SHADER_PATH + "simple/shader.vert",
+                                            shs::SHADER_PATH + "simple/shader.frag"
+                                            );
+  }
+
+
+  std::string
+  getPath( ) const
+  {
+    std::stringstream path;
+    path << "./" << std::hex << std::setw( 16 ) << std::setfill( '0' ) << key_ << ".glbin";
+    return path.str( );
+  }
+
+
+  static
+  std::string
+  readFile( const std::string &filePath )
+  {
+    std::ifstream file( filePath );
+    std::stringstream contents;
+    contents << file.rdbuf( );
+    return contents.str( );
+  }
+
+
+  shg::GlfwWrapper glfw_;
+  std::shared_ptr< shg::ProgramCache > spCache_;
+  std::uint64_t key_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief SecondProgramComesFromCache
+/////////////////////////////////////////////////////////////////
+TEST_F( ProgramCacheUnitTests, SecondProgramComesFromCache )
+{
+  if ( !spCache_->isSupported( ) )
+  {
+    return; // driver has no binary formats
+  }
+
+  std::shared_ptr< GLuint > spCompiled = createProgram( );
+
+  EXPECT_EQ( 0u, spCache_->getStats( ).hits );
+  EXPECT_EQ( 1u, spCache_->getStats( ).misses );
+
+  std::shared_ptr< GLuint > spLoaded = createProgram( );
+
+  EXPECT_EQ( 1u, spCache_->getStats( ).hits );
+  EXPECT_NE( *spCompiled, *spLoaded );
+
+  // uniforms work the same on the loaded program
+  EXPECT_TRUE( shg::OpenGLHelper::getUniform( spLoaded, "color" ).isValid( ) );
+  EXPECT_EQ(
+            glGetUniformLocation( *spCompiled, "color" ),
+            shg::OpenGLHelper::getUniform( spLoaded, "color" ).location
+            );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief CorruptBinaryIsRebuilt
+/////////////////////////////////////////////////////////////////
+TEST_F( ProgramCacheUnitTests, CorruptBinaryIsRebuilt )
+{
+  if ( !spCache_->isSupported( ) )
+  {
+    return; // driver has no binary formats
+  }
+
+  createProgram( );
+
+  // keep the 24 byte header, garble the binary
+  {
+    std::fstream file( getPath( ), std::ios::in | std::ios::out | std::ios::binary );
+    file.seekp( 0, std::ios::end );
+    const std::streamoff size = file.tellp( );
+
+    for ( std::streamoff i = 24; i < size; ++i )
+    {
+      file.seekp( i );
+      file.put( static_cast< char >( i * 7 ) );
+    }
+  }
+
+  std::shared_ptr< GLuint > spProgram;
+  ASSERT_NO_THROW( spProgram = createProgram( ) );
+
+  EXPECT_TRUE( glIsProgram( *spProgram ) );
+  EXPECT_EQ( 0u, spCache_->getStats( ).hits );
+  EXPECT_EQ( 1u, spCache_->getStats( ).stale );
+
+  // rebuilt program replaced the bad binary
+  createProgram( );
+  EXPECT_EQ( 1u, spCache_->getStats( ).hits );
+}
+
+
+} // namespace
@@ -0,0 +1,161 @@
+// ShaderReloaderUnitTests.cpp
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/ShaderReloader.hpp"
+#include "SharedSimulationConfig.hpp"
+
+#include "gmock/gmock.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+
+namespace
+{
+
+
+const std::string VERT_PATH = "./ShaderReloaderTest.vert";
+const std::string FRAG_PATH = "./ShaderReloaderTest.frag";
+
+
+///
+/// \brief The ShaderReloaderUnitTests class
+///
+class ShaderReloaderUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ShaderReloaderUnitTests
+  /////////////////////////////////////////////////////////////////
+  ShaderReloaderUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+
+    writeFile( VERT_PATH, readFile( shs::SHADER_PATH + "simple/shader.vert" ) );
+    writeFile( FRAG_PATH, readFile( shs::SHADER_PATH + "simple/shader.frag" ) );
+  }
+
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ~ShaderReloaderUnitTests
+  /////////////////////////////////////////////////////////////////
+  virtual
+  ~ShaderReloaderUnitTests( )
+  {
+    std::remove( VERT_PATH.c_str( ) );
+    std::remove( FRAG_PATH.c_str( ) );
+  }
+
+
+  static
+  std::string
+  readFile( const std::string &filePath )
+  {
+    std::ifstream file( filePath );
+    return std::string( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >( ) );
+  }
+
+
+  static
+  void
+  writeFile(
+            const std::string &filePath,
+            const std::string &contents
+            )
+  {
+    std::ofstream file( filePath, std::ios::out | std::ios::trunc );
+    file << contents;
+  }
+
+
+  ///
+  /// \brief updates until done returns true or about two seconds pass
+  ///
+  template< typename Done >
+  void
+  updateUntil(
+              shg::ShaderReloader &reloader,
+              Done                 done
+              )
+  {
+    for ( int i = 0; i < 200 && !done( ); ++i )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+      reloader.update( );
+    }
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief EditedShaderSwapsProgram
+/////////////////////////////////////////////////////////////////
+TEST_F( ShaderReloaderUnitTests, EditedShaderSwapsProgram )
+{
+  std::shared_ptr< GLuint > spProgram = shg::OpenGLHelper::createProgram( VERT_PATH, FRAG_PATH );
+  const GLuint original = *spProgram;
+
+  shg::ShaderReloader reloader;
+  reloader.watch(
+                 { VERT_PATH, FRAG_PATH },
+                 [ &spProgram ] ( const std::shared_ptr< GLuint > &spNew )
+    {
+      spProgram = spNew;
+    } );
+
+  reloader.update( );
+  EXPECT_EQ( 0u, reloader.getReloadCount( ) );
+
+  // mtime polling only sees whole seconds
+  std::this_thread::sleep_for( std::chrono::milliseconds( 1100 ) );
+  writeFile( FRAG_PATH, readFile( FRAG_PATH ) + "\n// edited\n" );
+
+  updateUntil( reloader, [ &reloader ] { return reloader.getReloadCount( ) > 0; } );
+
+  ASSERT_EQ( 1u, reloader.getReloadCount( ) );
+  EXPECT_NE( original, *spProgram );
+  EXPECT_TRUE( shg::OpenGLHelper::getUniform( spProgram, "color" ).isValid( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief BrokenShaderKeepsOldProgram
+/////////////////////////////////////////////////////////////////
+TEST_F( ShaderReloaderUnitTests, BrokenShaderKeepsOldProgram )
+{
+  std::shared_ptr< GLuint > spProgram = shg::OpenGLHelper::createProgram( VERT_PATH, FRAG_PATH );
+  const GLuint original = *spProgram;
+
+  shg::ShaderReloader reloader;
+  reloader.watch(
+                 { VERT_PATH, FRAG_PATH },
+                 [ &spProgram ] ( const std::shared_ptr< GLuint > &spNew )
+    {
+      spProgram = spNew;
+    } );
+
+  // mtime polling only sees whole seconds
+  std::this_thread::sleep_for( std::chrono::milliseconds( 1100 ) );
+  writeFile( FRAG_PATH, "#version 410\nvoid main( void ) { notAFunction( ); }\n" );
+
+  updateUntil( reloader, [ &reloader ] { return !reloader.getLastError( ).empty( ); } );
+
+  EXPECT_FALSE( reloader.getLastError( ).empty( ) );
+  EXPECT_EQ   ( 0u, reloader.getReloadCount( ) );
+  EXPECT_EQ   ( original, *spProgram );
+  EXPECT_TRUE ( glIsProgram( *spProgram ) );
+}
+
+
+} // namespace
@@ -0,0 +1,120 @@
+// StreamingBufferUnitTests.cpp
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/StreamingBuffer.hpp"
+
+#include "gmock/gmock.h"
+
+#include <vector>
+
+
+namespace
+{
+
+
+///
+/// \brief The StreamingBufferUnitTests class
+///
+class StreamingBufferUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief StreamingBufferUnitTests
+  /////////////////////////////////////////////////////////////////
+  StreamingBufferUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief OffsetsStayInsideTheirRegion
+/////////////////////////////////////////////////////////////////
+TEST_F( StreamingBufferUnitTests, OffsetsStayInsideTheirRegion )
+{
+  shg::StreamingBuffer buffer( 256, 3 );
+
+  const std::vector< float > data( 10, 1.0f );
+
+  for ( unsigned frame = 0; frame < 7; ++frame )
+  {
+    buffer.beginFrame( );
+
+    const GLintptr regionStart = ( frame % 3 ) * 256;
+
+    const GLintptr first  = buffer.write( data.data( ), data.size( ) );
+    const GLintptr second = buffer.write( data.data( ), data.size( ) );
+
+    EXPECT_EQ( regionStart,      first );
+    EXPECT_EQ( regionStart + 48, second ); // 40 bytes rounded up to 16
+    EXPECT_EQ( 88, buffer.getBytesUsed( ) );
+
+    buffer.endFrame( );
+  }
+
+  EXPECT_TRUE( glIsBuffer( *buffer.getBuffer( ) ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief FullRegionThrows
+/////////////////////////////////////////////////////////////////
+TEST_F( StreamingBufferUnitTests, FullRegionThrows )
+{
+  shg::StreamingBuffer buffer( 64, 2 );
+
+  EXPECT_THROW( buffer.allocate( 16 ), std::runtime_error ); // outside a frame
+
+  buffer.beginFrame( );
+
+  EXPECT_NO_THROW( buffer.allocate( 64 ) );
+  EXPECT_THROW   ( buffer.allocate( 1 ), std::runtime_error );
+
+  buffer.endFrame( );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief WrittenDataReachesTheBuffer
+/////////////////////////////////////////////////////////////////
+TEST_F( StreamingBufferUnitTests, WrittenDataReachesTheBuffer )
+{
+  shg::StreamingBuffer buffer( 64, 2 );
+
+  const std::vector< float > data = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+  buffer.beginFrame( );
+  buffer.allocate( 4 );
+
+  const GLintptr offset = buffer.write( data.data( ), data.size( ) );
+
+  buffer.endFrame( );
+  glFinish( );
+
+  std::vector< float > result( data.size( ) );
+
+  glBindBuffer( GL_COPY_READ_BUFFER, *buffer.getBuffer( ) );
+  glGetBufferSubData(
+                     GL_COPY_READ_BUFFER,
+                     offset,
+                     static_cast< GLsizeiptr >( result.size( ) * sizeof( float ) ),
+                     result.data( )
+                     );
+  glBindBuffer( GL_COPY_READ_BUFFER, 0 );
+
+  EXPECT_EQ( 16, offset );
+  EXPECT_EQ( data, result );
+}
+
+
+} // namespace
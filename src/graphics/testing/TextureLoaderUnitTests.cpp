@@ -0,0 +1,345 @@
+// TextureLoaderUnitTests.cpp
+#include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/TextureLoader.hpp"
+
+#include "gmock/gmock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+
+const std::string PPM_PATH = "./TextureLoaderTest.ppm";
+
+
+///
+/// \brief The CheckerDecoder class makes a width x height checkerboard
+///
+class CheckerDecoder : public shg::TextureLoader::Decoder
+{
+
+public:
+
+  CheckerDecoder(
+                 const int width,
+                 const int height
+                 )
+    : width_( width ), height_( height )
+  {}
+
+
+  virtual
+  bool
+  readSize(
+           int &width,
+           int &height
+           ) final
+  {
+    width  = width_;
+    height = height_;
+    return true;
+  }
+
+
+  virtual
+  bool
+  readPixels( unsigned char *pRgba ) final
+  {
+    for ( int y = 0; y < height_; ++y )
+    {
+      for ( int x = 0; x < width_; ++x, pRgba += 4 )
+      {
+        const unsigned char value = ( ( x + y ) % 2 ) ? 255 : 0;
+        pRgba[ 0 ] = pRgba[ 1 ] = pRgba[ 2 ] = value;
+        pRgba[ 3 ] = 255;
+      }
+    }
+
+    return true;
+  }
+
+
+private:
+
+  int width_;
+  int height_;
+
+};
+
+
+///
+/// \brief The FailingDecoder class
+///
+class FailingDecoder : public shg::TextureLoader::Decoder
+{
+
+public:
+
+  virtual
+  bool
+  readSize(
+           int &width,
+           int &height
+           ) final
+  {
+    width  = 4;
+    height = 4;
+    return true;
+  }
+
+
+  virtual
+  bool
+  readPixels( unsigned char* ) final
+  {
+    return false;
+  }
+
+};
+
+
+///
+/// \brief The GatedDecoder class holds its worker in readSize
+///        until the gate opens and counts pixel reads
+///
+class GatedDecoder : public shg::TextureLoader::Decoder
+{
+
+public:
+
+  GatedDecoder(
+               const std::atomic< bool > &gate,
+               std::atomic< int >        &pixelReads
+               )
+    : gate_( gate ), pixelReads_( pixelReads )
+  {}
+
+
+  virtual
+  bool
+  readSize(
+           int &width,
+           int &height
+           ) final
+  {
+    while ( !gate_ )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    width  = 4;
+    height = 4;
+    return true;
+  }
+
+
+  virtual
+  bool
+  readPixels( unsigned char *pRgba ) final
+  {
+    ++pixelReads_;
+    std::fill( pRgba, pRgba + 4 * 4 * 4, static_cast< unsigned char >( 255 ) );
+    return true;
+  }
+
+
+private:
+
+  const std::atomic< bool > &gate_;
+  std::atomic< int > &pixelReads_;
+
+};
+
+
+///
+/// \brief The TextureLoaderUnitTests class
+///
+class TextureLoaderUnitTests : public ::testing::Test
+{
+
+protected:
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief TextureLoaderUnitTests
+  /////////////////////////////////////////////////////////////////
+  TextureLoaderUnitTests( )
+    : glfw_( false ) // no print statements
+  {
+    glfw_.createNewWindow( "", 720, 640 ); // init opengl
+  }
+
+
+  /////////////////////////////////////////////////////////////////
+  /// \brief ~TextureLoaderUnitTests
+  /////////////////////////////////////////////////////////////////
+  virtual
+  ~TextureLoaderUnitTests( )
+  {
+    std::remove( PPM_PATH.c_str( ) );
+  }
+
+
+  ///
+  /// \brief updates until none of handles is loading or about two seconds pass
+  ///
+  static
+  void
+  updateUntilDone(
+                  shg::TextureLoader                                &loader,
+                  const std::vector< shg::TextureLoader::TextureHandle > &handles
+                  )
+  {
+    for ( int i = 0; i < 200; ++i )
+    {
+      loader.update( );
+
+      bool loading = false;
+
+      for ( const auto &handle : handles )
+      {
+        loading |= ( loader.getStatus( handle ) == shg::TextureLoader::LOADING );
+      }
+
+      if ( !loading )
+      {
+        return;
+      }
+
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+  }
+
+
+  shg::GlfwWrapper glfw_;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief PpmFileUploadsWithMipmaps
+/////////////////////////////////////////////////////////////////
+TEST_F( TextureLoaderUnitTests, PpmFileUploadsWithMipmaps )
+{
+  {
+    std::ofstream file( PPM_PATH, std::ios::out | std::ios::binary );
+    file << "P6\n# test image\n4 2\n255\n";
+
+    for ( int i = 0; i < 8; ++i )
+    {
+      file.put( static_cast< char >( i * 10 ) ).put( 0 ).put( static_cast< char >( 255 - i ) );
+    }
+  }
+
+  shg::TextureLoader loader;
+  const shg::TextureLoader::TextureHandle handle = loader.loadFile( PPM_PATH );
+
+  EXPECT_EQ( shg::TextureLoader::LOADING, loader.getStatus( handle ) );
+  EXPECT_EQ( nullptr, loader.getTexture( handle ) );
+
+  updateUntilDone( loader, { handle } );
+
+  ASSERT_EQ( shg::TextureLoader::READY, loader.getStatus( handle ) ) << loader.getError( handle );
+
+  std::shared_ptr< GLuint > spTexture = loader.getTexture( handle );
+  ASSERT_NE( nullptr, spTexture );
+
+  shg::OpenGLStateCache::get( ).bindTexture( GL_TEXTURE_2D, *spTexture );
+
+  std::vector< unsigned char > texels( 4 * 2 * 4 );
+  glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data( ) );
+
+  for ( int i = 0; i < 8; ++i )
+  {
+    EXPECT_EQ( i * 10,  texels[ static_cast< size_t >( i * 4 + 0 ) ] );
+    EXPECT_EQ( 255 - i, texels[ static_cast< size_t >( i * 4 + 2 ) ] );
+    EXPECT_EQ( 255,     texels[ static_cast< size_t >( i * 4 + 3 ) ] );
+  }
+
+  GLint mipWidth = 0;
+  glGetTexLevelParameteriv( GL_TEXTURE_2D, 1, GL_TEXTURE_WIDTH, &mipWidth );
+  EXPECT_EQ( 2, mipWidth );
+
+  // handle is gone, the texture stays with its owner
+  loader.release( handle );
+  EXPECT_EQ( shg::TextureLoader::FAILED, loader.getStatus( handle ) );
+  EXPECT_TRUE( glIsTexture( *spTexture ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ManyLoadsShareSmallStaging
+/////////////////////////////////////////////////////////////////
+TEST_F( TextureLoaderUnitTests, ManyLoadsShareSmallStaging )
+{
+  // room for two 64x64 images at a time
+  shg::TextureLoader loader( 2 * 64 * 64 * 4, 64 * 64 * 4, 3 );
+
+  std::vector< shg::TextureLoader::TextureHandle > handles;
+
+  for ( int i = 0; i < 10; ++i )
+  {
+    handles.push_back( loader.load( std::unique_ptr< CheckerDecoder >( new CheckerDecoder( 64, 64 ) ) ) );
+  }
+
+  // too big to stage, decoded to the heap instead
+  handles.push_back( loader.load( std::unique_ptr< CheckerDecoder >( new CheckerDecoder( 256, 256 ) ) ) );
+
+  const shg::TextureLoader::TextureHandle failing =
+    loader.load( std::unique_ptr< FailingDecoder >( new FailingDecoder ) );
+
+  updateUntilDone( loader, handles );
+  updateUntilDone( loader, { failing } );
+
+  for ( const auto &handle : handles )
+  {
+    EXPECT_EQ( shg::TextureLoader::READY, loader.getStatus( handle ) ) << loader.getError( handle );
+  }
+
+  EXPECT_EQ( shg::TextureLoader::FAILED, loader.getStatus( failing ) );
+  EXPECT_FALSE( loader.getError( failing ).empty( ) );
+  EXPECT_EQ( static_cast< GLenum >( GL_NO_ERROR ), glGetError( ) );
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ReleasedLoadsAreCancelled
+/////////////////////////////////////////////////////////////////
+TEST_F( TextureLoaderUnitTests, ReleasedLoadsAreCancelled )
+{
+  std::atomic< bool > gate( false );
+  std::atomic< int > pixelReads( 0 );
+
+  // one decoder thread, so the second load waits behind the first
+  shg::TextureLoader loader( 64 << 10, 16 << 10, 1 );
+
+  const shg::TextureLoader::TextureHandle kept =
+    loader.load( std::unique_ptr< GatedDecoder >( new GatedDecoder( gate, pixelReads ) ) );
+
+  const shg::TextureLoader::TextureHandle released =
+    loader.load( std::unique_ptr< GatedDecoder >( new GatedDecoder( gate, pixelReads ) ) );
+
+  loader.release( released );
+  gate = true;
+
+  updateUntilDone( loader, { kept } );
+
+  EXPECT_EQ( shg::TextureLoader::READY, loader.getStatus( kept ) ) << loader.getError( kept );
+  EXPECT_EQ( shg::TextureLoader::FAILED, loader.getStatus( released ) );
+  EXPECT_EQ( 1, pixelReads.load( ) );
+}
+
+
+} // namespace
@@ -2,12 +2,18 @@
 
 #include "shared/graphics/GlfwWrapper.hpp"
 #include "shared/graphics/Callback.hpp"
+#include "shared/graphics/VulkanMemoryAllocator.hpp"
+#include "shared/graphics/VulkanUploader.hpp"
+#include "shared/core/JobSystem.hpp"
 
+#include <chrono>
 #include <iostream>
+#include <iterator>
 #include <set>
 #include <algorithm>
 #include <fstream>
 #include <cstring>
+#include <limits>
 
 
 namespace shg
@@ -249,6 +255,7 @@ struct QueueFamilyIndices
 
   int graphicsFamily_ = -1;
   int presentFamily_  = -1;
+  int transferFamily_ = -1; ///< transfer only family, -1 if there is none
 
   bool
   isComplete( )
@@ -351,13 +358,32 @@ findQueueFamilies(
   for ( const auto & queueFamily : queueFamilies )
   {
 
-    if ( queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT )
+    if ( indices.graphicsFamily_ < 0 && queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT )
     {
 
       indices.graphicsFamily_ = i;
 
     }
 
+    //
+    // families without graphics usually map to the DMA engines,
+    // which copy while the graphics queue keeps rendering
+    //
+    if ( queueFamily.queueCount > 0
+         && ( queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT )
+         && !( queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT ) )
+    {
+
+      // prefer transfer only over async compute families
+      if ( indices.transferFamily_ < 0 || !( queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT ) )
+      {
+
+        indices.transferFamily_ = i;
+
+      }
+
+    }
+
     VkBool32 presentSupport = false;
     vkGetPhysicalDeviceSurfaceSupportKHR(
                                          device,
@@ -366,20 +392,14 @@ findQueueFamilies(
                                          &presentSupport
                                          );
 
-    if ( queueFamily.queueCount > 0 && presentSupport )
+    if ( indices.presentFamily_ < 0 && queueFamily.queueCount > 0 && presentSupport )
     {
 
       indices.presentFamily_ = i;
 
     }
 
-    if ( indices.isComplete( ) )
-    {
-
-      break;
-
-    }
-
+    // no early out, transfer families tend to come last
     ++i;
 
   }
@@ -570,6 +590,46 @@ createShaderModule(
 
 
 
+///
+/// \brief isPipelineCacheCompatible
+///
+///        Checks the header Vulkan writes at the front of
+///        pipeline cache data against the current device.
+///        Data from another GPU or driver version is useless
+///        and some drivers handle it poorly.
+///
+/// \return
+///
+bool
+isPipelineCacheCompatible(
+                          const std::vector< char >        &data,
+                          const VkPhysicalDeviceProperties &properties
+                          )
+{
+
+  // headerLength, headerVersion, vendorID, deviceID, pipelineCacheUUID
+  const size_t headerSize = 4 * sizeof( uint32_t ) + VK_UUID_SIZE;
+
+  if ( data.size( ) < headerSize )
+  {
+
+    return false;
+
+  }
+
+  uint32_t header[ 4 ];
+  std::memcpy( header, data.data( ), sizeof( header ) );
+
+  return header[ 0 ] >= headerSize
+         && header[ 1 ] == static_cast< uint32_t >( VK_PIPELINE_CACHE_HEADER_VERSION_ONE )
+         && header[ 2 ] == properties.vendorID
+         && header[ 3 ] == properties.deviceID
+         && std::memcmp( data.data( ) + sizeof( header ), properties.pipelineCacheUUID, VK_UUID_SIZE ) == 0;
+
+}
+
+
+
 } // namespace
 
 
@@ -594,8 +654,9 @@ createShaderModule(
 
 
 
-VulkanGlfwWrapper::VulkanGlfwWrapper(  )
+VulkanGlfwWrapper::VulkanGlfwWrapper( const uint32_t framesInFlight )
   : upGlfw_( new shg::GlfwWrapper( true, false ) ) // no openGL
+  , framesInFlight_( std::max( framesInFlight, 1u ) )
 {}
 
 
@@ -606,15 +667,15 @@ VulkanGlfwWrapper::VulkanGlfwWrapper(  )
 VulkanGlfwWrapper::~VulkanGlfwWrapper( )
 {
 
-  if ( commandBuffers_.size( ) > 0 )
+  //
+  // pending frames still use their fences, semaphores and
+  // pools, all destroyed (and command buffers freed) below
+  //
+  if ( VkDevice( device_ ) != VK_NULL_HANDLE )
   {
 
-    vkFreeCommandBuffers(
-                         device_,
-                         commandPool_,
-                         static_cast< uint32_t >( commandBuffers_.size( ) ),
-                         commandBuffers_.data( )
-                         );
+    vkDeviceWaitIdle( device_ );
+    _savePipelineCache( );
 
   }
 
@@ -698,6 +759,60 @@ VulkanGlfwWrapper::createRenderPass()
 }
 
 
+///
+/// \brief VulkanGlfwWrapper::createPipelineCache
+/// \param filePath
+///
+void
+VulkanGlfwWrapper::createPipelineCache( const std::string &filePath )
+{
+
+  pipelineCacheFile_ = filePath;
+
+  std::vector< char > data;
+
+  if ( !filePath.empty( ) )
+  {
+
+    // a missing file just means a cold start
+    std::ifstream file( filePath, std::ios::binary );
+
+    if ( file.is_open( ) )
+    {
+
+      data.assign( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >( ) );
+
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties( physicalDevice_, &properties );
+
+    if ( !data.empty( ) && !isPipelineCacheCompatible( data, properties ) )
+    {
+
+      std::cout << "Ignoring pipeline cache from another device or driver: " << filePath << std::endl;
+      data.clear( );
+
+    }
+
+  }
+
+  VkPipelineCacheCreateInfo cacheInfo = {};
+  cacheInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  cacheInfo.initialDataSize = data.size( );
+  cacheInfo.pInitialData    = data.empty( ) ? nullptr : data.data( );
+
+  if ( vkCreatePipelineCache( device_, &cacheInfo, nullptr, pipelineCache_.replace( ) ) != VK_SUCCESS )
+  {
+
+    throw std::runtime_error( "Failed to create pipeline cache" );
+
+  }
+
+}
+
+
+
 ///
 /// \brief VulkanGlfwWrapper::createGraphicsPipeline
 /// \param vertFile
@@ -907,7 +1022,9 @@ VulkanGlfwWrapper::createGraphicsPipeline(
   pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
   pipelineInfo.basePipelineIndex  = -1; // Optional
 
-  if ( vkCreateGraphicsPipelines( device_, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, graphicsPipeline_.replace( ) )
+  auto startTime = std::chrono::steady_clock::now( );
+
+  if ( vkCreateGraphicsPipelines( device_, pipelineCache_, 1, &pipelineInfo, nullptr, graphicsPipeline_.replace( ) )
        != VK_SUCCESS )
   {
 
@@ -915,6 +1032,9 @@ VulkanGlfwWrapper::createGraphicsPipeline(
 
   }
 
+  std::chrono::duration< double, std::milli > creationTime = std::chrono::steady_clock::now( ) - startTime;
+  pipelineCreationMs_ = creationTime.count( );
+
 }
 
 
@@ -970,15 +1090,27 @@ VulkanGlfwWrapper::createCommandPool( )
   VkCommandPoolCreateInfo poolInfo = {};
   poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
   poolInfo.queueFamilyIndex = static_cast< uint32_t >( queueFamilyIndices.graphicsFamily_ );
-  poolInfo.flags            = 0; // Optional
+  poolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // re-recorded every frame
 
-  if ( vkCreateCommandPool( device_, &poolInfo, nullptr, commandPool_.replace( ) ) != VK_SUCCESS )
+  commandPools_.clear( );
+  commandPools_.resize( framesInFlight_, VDeleter< VkCommandPool >{ device_, vkDestroyCommandPool } );
+
+  for ( auto &commandPool : commandPools_ )
   {
 
-    throw std::runtime_error( "Failed to create command pool" );
+    if ( vkCreateCommandPool( device_, &poolInfo, nullptr, commandPool.replace( ) ) != VK_SUCCESS )
+    {
+
+      throw std::runtime_error( "Failed to create command pool" );
+
+    }
 
   }
 
+  // secondary pools are created as batches need them
+  secondaryCommandBuffers_.clear( );
+  secondaryCommandBuffers_.resize( framesInFlight_ );
+
 }
 
 
@@ -990,61 +1122,23 @@ void
 VulkanGlfwWrapper::createCommandBuffers( )
 {
 
-  commandBuffers_.resize( swapChainFramebuffers_.size( ) );
-
-  VkCommandBufferAllocateInfo allocInfo = {};
-  allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.commandPool        = commandPool_;
-  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandBufferCount = static_cast< uint32_t >( commandBuffers_.size( ) );
+  commandBuffers_.resize( framesInFlight_ );
+  acquireCommandBuffers_.resize( framesInFlight_ );
 
-  if ( vkAllocateCommandBuffers( device_, &allocInfo, commandBuffers_.data( ) ) != VK_SUCCESS )
+  for ( uint32_t frame = 0; frame < framesInFlight_; ++frame )
   {
 
-    throw std::runtime_error( "Failed to allocate command buffers" );
-
-  }
-
-  size_t size = commandBuffers_.size( );
-
-  for ( size_t i = 0; i < size; ++i )
-  {
-
-    VkCommandBufferBeginInfo beginInfo = {};
-    beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-    beginInfo.pInheritanceInfo = nullptr; // Optional
-
-    vkBeginCommandBuffer( commandBuffers_[ i ], &beginInfo );
-
-    VkRenderPassBeginInfo renderPassInfo = {};
-    renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass  = renderPass_;
-    renderPassInfo.framebuffer = swapChainFramebuffers_[ i ];
-
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = swapChainExtent_;
-
-    VkClearValue clearColor        = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues    = &clearColor;
-
-    // vkCmd functions record commands to the command buffer
-    vkCmdBeginRenderPass( commandBuffers_[ i ], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
-
-    // bind graphics pipeline
-    vkCmdBindPipeline( commandBuffers_[ i ], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_ );
-
-    // vertexCount, instanceCount, firstVertex, firstInstance
-    vkCmdDraw( commandBuffers_[ i ], 4, 1, 0, 0 );
-
-    // last command to finish render pass
-    vkCmdEndRenderPass( commandBuffers_[ i ] );
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = commandPools_[ frame ];
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
 
-    if ( vkEndCommandBuffer( commandBuffers_[ i ] ) != VK_SUCCESS )
+    if ( vkAllocateCommandBuffers( device_, &allocInfo, &commandBuffers_[ frame ] ) != VK_SUCCESS
+         || vkAllocateCommandBuffers( device_, &allocInfo, &acquireCommandBuffers_[ frame ] ) != VK_SUCCESS )
     {
 
-      throw std::runtime_error( "Failed to record command buffer" );
+      throw std::runtime_error( "Failed to allocate command buffers" );
 
     }
 
@@ -1055,25 +1149,48 @@ VulkanGlfwWrapper::createCommandBuffers( )
 
 
 ///
-/// \brief VulkanGlfwWrapper::createSemaphores
+/// \brief VulkanGlfwWrapper::createSyncObjects
 ///
 void
-VulkanGlfwWrapper::createSemaphores( )
+VulkanGlfwWrapper::createSyncObjects( )
 {
 
   VkSemaphoreCreateInfo semaphoreInfo = {};
   semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-  if ( vkCreateSemaphore( device_, &semaphoreInfo, nullptr, imageAvailableSemaphore_.replace( ) )
-       != VK_SUCCESS
-       || vkCreateSemaphore( device_, &semaphoreInfo, nullptr, renderFinishedSemaphore_.replace( ) )
-       != VK_SUCCESS )
+  // signaled so the first wait on each frame slot returns
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+  imageAvailableSemaphores_.clear( );
+  renderFinishedSemaphores_.clear( );
+  inFlightFences_.clear( );
+
+  imageAvailableSemaphores_.resize( framesInFlight_, VDeleter< VkSemaphore >{ device_, vkDestroySemaphore } );
+  renderFinishedSemaphores_.resize( framesInFlight_, VDeleter< VkSemaphore >{ device_, vkDestroySemaphore } );
+  inFlightFences_.resize( framesInFlight_, VDeleter< VkFence >{ device_, vkDestroyFence } );
+
+  for ( uint32_t frame = 0; frame < framesInFlight_; ++frame )
   {
 
-    throw std::runtime_error( "Failed to create semaphores" );
+    if ( vkCreateSemaphore( device_, &semaphoreInfo, nullptr, imageAvailableSemaphores_[ frame ].replace( ) )
+         != VK_SUCCESS
+         || vkCreateSemaphore( device_, &semaphoreInfo, nullptr, renderFinishedSemaphores_[ frame ].replace( ) )
+         != VK_SUCCESS
+         || vkCreateFence( device_, &fenceInfo, nullptr, inFlightFences_[ frame ].replace( ) )
+         != VK_SUCCESS )
+    {
+
+      throw std::runtime_error( "Failed to create frame synchronization objects" );
+
+    }
 
   }
 
+  imagesInFlight_.assign( swapChainImages_.size( ), VK_NULL_HANDLE );
+  currentFrame_ = 0;
+
 }
 
 
@@ -1102,34 +1219,100 @@ void
 VulkanGlfwWrapper::drawFrame( )
 {
 
+  VkFence frameFence = inFlightFences_[ currentFrame_ ];
+
+  //
+  // the GPU is done with this slot's command buffer and
+  // semaphores once the fence from its last submit signals
+  //
+  vkWaitForFences( device_, 1, &frameFence, VK_TRUE, std::numeric_limits< uint64_t >::max( ) );
+
   uint32_t imageIndex;
 
   vkAcquireNextImageKHR(
                         device_,
                         swapChain_,
                         std::numeric_limits< uint64_t >::max( ), // disable timeout
-                        imageAvailableSemaphore_,
+                        imageAvailableSemaphores_[ currentFrame_ ],
                         VK_NULL_HANDLE,
                         &imageIndex
                         );
 
+  //
+  // images can come back out of order, wait for whichever
+  // frame last rendered to this one
+  //
+  if ( imagesInFlight_[ imageIndex ] != VK_NULL_HANDLE && imagesInFlight_[ imageIndex ] != frameFence )
+  {
+
+    vkWaitForFences( device_, 1, &imagesInFlight_[ imageIndex ], VK_TRUE, std::numeric_limits< uint64_t >::max( ) );
+
+  }
+
+  imagesInFlight_[ imageIndex ] = frameFence;
+
+  vkResetCommandPool( device_, commandPools_[ currentFrame_ ], 0 );
+
+  //
+  // uploads queued since the last frame go out as one batch,
+  // and finished ones are acquired ahead of this frame's draws
+  //
+  upUploader_->submit( );
+  upUploader_->retire( );
+
+  VkCommandBuffer submitCommandBuffers[ 2 ];
+  uint32_t submitCount = 0;
+
+  VkCommandBuffer acquireCommandBuffer = acquireCommandBuffers_[ currentFrame_ ];
+
+  VkCommandBufferBeginInfo acquireBeginInfo = {};
+  acquireBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  acquireBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  vkBeginCommandBuffer( acquireCommandBuffer, &acquireBeginInfo );
+
+  //
+  // uploads from a separate transfer queue add semaphores here
+  //
+  std::vector< VkSemaphore > waitSemaphores      = { imageAvailableSemaphores_[ currentFrame_ ] };
+  std::vector< VkPipelineStageFlags > waitStages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+  const bool acquired = upUploader_->recordAcquire( acquireCommandBuffer, waitSemaphores, waitStages );
+
+  if ( vkEndCommandBuffer( acquireCommandBuffer ) != VK_SUCCESS )
+  {
+
+    throw std::runtime_error( "Failed to record upload acquire command buffer" );
+
+  }
+
+  if ( acquired )
+  {
+
+    submitCommandBuffers[ submitCount++ ] = acquireCommandBuffer;
+
+  }
+
+  _recordCommandBuffer( commandBuffers_[ currentFrame_ ], imageIndex );
+  submitCommandBuffers[ submitCount++ ] = commandBuffers_[ currentFrame_ ];
+
   VkSubmitInfo submitInfo = {};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-  VkSemaphore waitSemaphores[]      = { imageAvailableSemaphore_ };
-  VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-  submitInfo.waitSemaphoreCount     = 1;
-  submitInfo.pWaitSemaphores        = waitSemaphores;
-  submitInfo.pWaitDstStageMask      = waitStages;
+  submitInfo.waitSemaphoreCount = static_cast< uint32_t >( waitSemaphores.size( ) );
+  submitInfo.pWaitSemaphores    = waitSemaphores.data( );
+  submitInfo.pWaitDstStageMask  = waitStages.data( );
 
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers    = &commandBuffers_[ imageIndex ];
+  submitInfo.commandBufferCount = submitCount;
+  submitInfo.pCommandBuffers    = submitCommandBuffers;
 
-  VkSemaphore signalSemaphores[]  = { renderFinishedSemaphore_ };
+  VkSemaphore signalSemaphores[]  = { renderFinishedSemaphores_[ currentFrame_ ] };
   submitInfo.signalSemaphoreCount = 1;
   submitInfo.pSignalSemaphores    = signalSemaphores;
 
-  if ( vkQueueSubmit( graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS )
+  vkResetFences( device_, 1, &frameFence );
+
+  if ( vkQueueSubmit( graphicsQueue_, 1, &submitInfo, frameFence ) != VK_SUCCESS )
   {
 
     throw std::runtime_error( "Failed to submit draw command buffer" );
@@ -1149,6 +1332,8 @@ VulkanGlfwWrapper::drawFrame( )
 
   vkQueuePresentKHR( presentQueue_, &presentInfo );
 
+  currentFrame_ = ( currentFrame_ + 1 ) % framesInFlight_;
+
 }
 
 
@@ -1174,6 +1359,7 @@ VulkanGlfwWrapper::syncDevice( )
 {
 
   vkDeviceWaitIdle( device_ );
+  _savePipelineCache( );
 
 }
 
@@ -1191,6 +1377,25 @@ VulkanGlfwWrapper::setCallback( std::unique_ptr< Callback > upCallback )
 
 
 
+///
+/// \brief VulkanGlfwWrapper::setDrawRecorder
+///
+void
+VulkanGlfwWrapper::setDrawRecorder(
+                                   const std::size_t drawCount,
+                                   DrawRecorder      recorder,
+                                   const std::size_t drawsPerBuffer
+                                   )
+{
+
+  drawCount_      = drawCount;
+  drawRecorder_   = std::move( recorder );
+  drawsPerBuffer_ = drawsPerBuffer;
+
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////                                        ////////////////////
@@ -1260,6 +1465,26 @@ VulkanGlfwWrapper::_initVulkan(
   //
   _createVulkanLogicalDevice( );
 
+  //
+  // sub-allocates buffer and image memory
+  //
+  upMemoryAllocator_.reset( new VulkanMemoryAllocator( physicalDevice_, device_ ) );
+
+  //
+  // stages buffer and image data on the transfer queue
+  //
+  upUploader_.reset( new VulkanUploader(
+                                        device_,
+                                        *upMemoryAllocator_,
+                                        transferQueue_,
+                                        transferFamily_,
+                                        static_cast< uint32_t >(
+                                                                findQueueFamilies( physicalDevice_, surface_ )
+                                                                .graphicsFamily_
+                                                                ),
+                                        framesInFlight_
+                                        ) );
+
   //
   //
   //
@@ -1468,6 +1693,13 @@ VulkanGlfwWrapper::_createVulkanLogicalDevice( )
   std::vector< VkDeviceQueueCreateInfo > queueCreateInfos;
   std::set< int > uniqueQueueFamilies = { indices.graphicsFamily_, indices.presentFamily_ };
 
+  if ( indices.transferFamily_ >= 0 )
+  {
+
+    uniqueQueueFamilies.insert( indices.transferFamily_ );
+
+  }
+
   float queuePriority = 1.0f;
 
   for ( int queueFamily : uniqueQueueFamilies )
@@ -1519,6 +1751,11 @@ VulkanGlfwWrapper::_createVulkanLogicalDevice( )
   vkGetDeviceQueue( device_, static_cast< uint32_t >( indices.graphicsFamily_ ), 0, &graphicsQueue_ );
   vkGetDeviceQueue( device_, static_cast< uint32_t >( indices.presentFamily_ ),  0, &presentQueue_  );
 
+  // uploads share the graphics queue without a transfer family
+  transferFamily_ = static_cast< uint32_t >( indices.transferFamily_ >= 0 ? indices.transferFamily_
+                                                                           : indices.graphicsFamily_ );
+  vkGetDeviceQueue( device_, transferFamily_, 0, &transferQueue_ );
+
 } // VulkanGlfwWrapper::_createVulkanLogicalDevice
 
 
@@ -1672,6 +1909,253 @@ VulkanGlfwWrapper::_createImageViews( )
 }
 
 
+
+///
+/// \brief VulkanGlfwWrapper::_recordCommandBuffer
+///
+void
+VulkanGlfwWrapper::_recordCommandBuffer(
+                                        VkCommandBuffer commandBuffer,
+                                        const uint32_t  imageIndex
+                                        )
+{
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  beginInfo.pInheritanceInfo = nullptr; // Optional
+
+  vkBeginCommandBuffer( commandBuffer, &beginInfo );
+
+  VkRenderPassBeginInfo renderPassInfo = {};
+  renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  renderPassInfo.renderPass  = renderPass_;
+  renderPassInfo.framebuffer = swapChainFramebuffers_[ imageIndex ];
+
+  renderPassInfo.renderArea.offset = { 0, 0 };
+  renderPassInfo.renderArea.extent = swapChainExtent_;
+
+  VkClearValue clearColor        = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
+  renderPassInfo.clearValueCount = 1;
+  renderPassInfo.pClearValues    = &clearColor;
+
+  if ( drawRecorder_ && drawCount_ > 0 )
+  {
+
+    // batches are recorded before the render pass begins
+    const uint32_t secondaryCount = _recordSecondaryCommandBuffers( imageIndex );
+
+    vkCmdBeginRenderPass( commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+
+    vkCmdExecuteCommands( commandBuffer, secondaryCount, executeCommandBuffers_.data( ) );
+
+  }
+  else
+  {
+
+    // vkCmd functions record commands to the command buffer
+    vkCmdBeginRenderPass( commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
+
+    // bind graphics pipeline
+    vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_ );
+
+    // vertexCount, instanceCount, firstVertex, firstInstance
+    vkCmdDraw( commandBuffer, 4, 1, 0, 0 );
+
+  }
+
+  // last command to finish render pass
+  vkCmdEndRenderPass( commandBuffer );
+
+  if ( vkEndCommandBuffer( commandBuffer ) != VK_SUCCESS )
+  {
+
+    throw std::runtime_error( "Failed to record command buffer" );
+
+  }
+
+}
+
+
+///
+/// \brief VulkanGlfwWrapper::_recordSecondaryCommandBuffers
+///
+///        Each batch resets and records its own pool, so the
+///        job system may run batches on any thread in any order.
+///        The previous use of this frame's pools has finished
+///        since drawFrame waited on the frame's fence.
+///
+uint32_t
+VulkanGlfwWrapper::_recordSecondaryCommandBuffers( const uint32_t imageIndex )
+{
+
+  shs::JobSystem &jobs = pJobSystem_ ? *pJobSystem_ : shs::JobSystem::getSerial( );
+
+  std::size_t drawsPerBuffer = drawsPerBuffer_;
+
+  if ( drawsPerBuffer == 0 )
+  {
+
+    //
+    // a couple of batches per thread lets idle threads steal
+    // without paying for many tiny secondary buffers
+    //
+    const std::size_t targetBatches = std::size_t( jobs.getNumThreads( ) ) * 2;
+    drawsPerBuffer = ( drawCount_ + targetBatches - 1 ) / targetBatches;
+
+  }
+
+  const std::size_t batchCount = ( drawCount_ + drawsPerBuffer - 1 ) / drawsPerBuffer;
+
+  std::vector< std::unique_ptr< SecondaryCommandBuffer > > &secondaries = secondaryCommandBuffers_[ currentFrame_ ];
+
+  if ( secondaries.size( ) < batchCount )
+  {
+
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies( physicalDevice_, surface_ );
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = static_cast< uint32_t >( queueFamilyIndices.graphicsFamily_ );
+    poolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = 1;
+
+    while ( secondaries.size( ) < batchCount )
+    {
+
+      std::unique_ptr< SecondaryCommandBuffer > upSecondary( new SecondaryCommandBuffer( device_ ) );
+
+      if ( vkCreateCommandPool( device_, &poolInfo, nullptr, upSecondary->pool.replace( ) ) != VK_SUCCESS )
+      {
+
+        throw std::runtime_error( "Failed to create secondary command pool" );
+
+      }
+
+      allocInfo.commandPool = upSecondary->pool;
+
+      if ( vkAllocateCommandBuffers( device_, &allocInfo, &upSecondary->commandBuffer ) != VK_SUCCESS )
+      {
+
+        throw std::runtime_error( "Failed to allocate secondary command buffer" );
+
+      }
+
+      secondaries.push_back( std::move( upSecondary ) );
+
+    }
+
+  }
+
+  //
+  // secondaries continue the primary's render pass, which
+  // is how they inherit its framebuffer and attachments
+  //
+  VkCommandBufferInheritanceInfo inheritanceInfo = {};
+  inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass  = renderPass_;
+  inheritanceInfo.subpass     = 0;
+  inheritanceInfo.framebuffer = swapChainFramebuffers_[ imageIndex ];
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+                               | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+  executeCommandBuffers_.resize( batchCount );
+
+  jobs.parallelFor(
+                   0,
+                   batchCount,
+                   [ this, &secondaries, &beginInfo, drawsPerBuffer ]( const std::size_t batch )
+  {
+
+    const SecondaryCommandBuffer &secondary = *secondaries[ batch ];
+
+    vkResetCommandPool( device_, secondary.pool, 0 );
+    vkBeginCommandBuffer( secondary.commandBuffer, &beginInfo );
+
+    // pipeline state is not inherited from the primary buffer
+    vkCmdBindPipeline( secondary.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_ );
+
+    const std::size_t begin = batch * drawsPerBuffer;
+
+    drawRecorder_( secondary.commandBuffer, begin, std::min( drawCount_, begin + drawsPerBuffer ) );
+
+    if ( vkEndCommandBuffer( secondary.commandBuffer ) != VK_SUCCESS )
+    {
+
+      throw std::runtime_error( "Failed to record secondary command buffer" );
+
+    }
+
+    executeCommandBuffers_[ batch ] = secondary.commandBuffer;
+
+  },
+                   1
+                   );
+
+  return static_cast< uint32_t >( batchCount );
+
+}
+
+
+
+///
+/// \brief VulkanGlfwWrapper::_savePipelineCache
+///
+///        Failing to save only costs the next run its
+///        pipeline compiles, so errors are reported and ignored.
+///
+void
+VulkanGlfwWrapper::_savePipelineCache( )
+{
+
+  if ( pipelineCacheFile_.empty( ) || VkPipelineCache( pipelineCache_ ) == VK_NULL_HANDLE )
+  {
+
+    return;
+
+  }
+
+  size_t dataSize = 0;
+  std::vector< char > data;
+
+  if ( vkGetPipelineCacheData( device_, pipelineCache_, &dataSize, nullptr ) == VK_SUCCESS )
+  {
+
+    data.resize( dataSize );
+
+  }
+
+  if ( data.empty( )
+       || vkGetPipelineCacheData( device_, pipelineCache_, &dataSize, data.data( ) ) != VK_SUCCESS )
+  {
+
+    std::cerr << "WARNING: Failed to read pipeline cache data" << std::endl;
+    return;
+
+  }
+
+  std::ofstream file( pipelineCacheFile_, std::ios::binary | std::ios::trunc );
+
+  file.write( data.data( ), static_cast< std::streamsize >( dataSize ) );
+
+  if ( !file )
+  {
+
+    std::cerr << "WARNING: Failed to write pipeline cache " << pipelineCacheFile_ << std::endl;
+
+  }
+
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////                                        ////////////////////
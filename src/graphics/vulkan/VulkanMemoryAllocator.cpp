@@ -0,0 +1,668 @@
+#include "shared/graphics/VulkanMemoryAllocator.hpp"
+
+#include "shared/core/BuddyAllocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+VkDeviceSize
+nextPowerOfTwo( const VkDeviceSize value )
+{
+  VkDeviceSize result = 1;
+
+  while ( result < value )
+  {
+    result <<= 1;
+  }
+
+  return result;
+}
+
+
+void
+addStats(
+         VulkanMemoryAllocator::Stats       &total,
+         const VulkanMemoryAllocator::Stats &stats
+         )
+{
+  total.blockCount      += stats.blockCount;
+  total.dedicatedCount  += stats.dedicatedCount;
+  total.allocationCount += stats.allocationCount;
+  total.bytesReserved   += stats.bytesReserved;
+  total.bytesUsed       += stats.bytesUsed;
+}
+
+} // namespace
+
+
+constexpr uint32_t VulkanMemoryAllocator::DEDICATED;
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::VulkanMemoryAllocator
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanMemoryAllocator::VulkanMemoryAllocator(
+                                             VkPhysicalDevice   physicalDevice,
+                                             VkDevice           device,
+                                             const VkDeviceSize blockSize
+                                             )
+  : device_               ( device )
+  , deviceAllocationCount_( 0 )
+  , blockSize_            ( nextPowerOfTwo( blockSize ) )
+{
+  vkGetPhysicalDeviceMemoryProperties( physicalDevice, &memoryProperties_ );
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties( physicalDevice, &properties );
+
+  nonCoherentAtomSize_ = std::max< VkDeviceSize >( properties.limits.nonCoherentAtomSize, 1 );
+  maxAllocationCount_  = properties.limits.maxMemoryAllocationCount;
+
+  //
+  // a range never shares a bufferImageGranularity page with
+  // another range, so linear and optimal resources can sit
+  // next to each other in any block
+  //
+  minRangeSize_ = std::min(
+                           nextPowerOfTwo( std::max< VkDeviceSize >( properties.limits.bufferImageGranularity, 256 ) ),
+                           blockSize_
+                           );
+
+  memoryTypes_.resize( memoryProperties_.memoryTypeCount );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::~VulkanMemoryAllocator
+///
+///        Dedicated allocations are owned by whoever holds
+///        their Allocation and must be freed before this.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanMemoryAllocator::~VulkanMemoryAllocator( )
+{
+  for ( MemoryType &memoryType : memoryTypes_ )
+  {
+    for ( Block &block : memoryType.blocks )
+    {
+      if ( block.memory != VK_NULL_HANDLE )
+      {
+        _freeMemory( block.memory );
+      }
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::allocate
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanMemoryAllocator::Allocation
+VulkanMemoryAllocator::allocate(
+                                const VkMemoryRequirements &requirements,
+                                const VkMemoryPropertyFlags properties,
+                                const bool                  dedicated
+                                )
+{
+  const uint32_t memoryType = _findMemoryType( requirements.memoryTypeBits, properties );
+
+  Allocation allocation;
+  allocation.memoryType = memoryType;
+  allocation.size       = requirements.size;
+
+  if ( dedicated || requirements.size > blockSize_ / 2 )
+  {
+    allocation.memory = _allocateMemory( requirements.size, memoryType, &allocation.pMapped );
+    allocation.block  = DEDICATED;
+
+    ++memoryTypes_[ memoryType ].dedicatedCount;
+    memoryTypes_[ memoryType ].dedicatedBytes += requirements.size;
+
+    return allocation;
+  }
+
+  std::vector< Block > &blocks = memoryTypes_[ memoryType ].blocks;
+
+  for ( uint32_t block = 0; block < blocks.size( ); ++block )
+  {
+    if ( _allocateFromBlock( memoryType, block, requirements.size, requirements.alignment, &allocation ) )
+    {
+      return allocation;
+    }
+  }
+
+  const uint32_t block = _createBlock( memoryType );
+
+  if ( !_allocateFromBlock( memoryType, block, requirements.size, requirements.alignment, &allocation ) )
+  {
+    throw std::runtime_error( "Allocation does not fit in an empty memory block" );
+  }
+
+  return allocation;
+} // VulkanMemoryAllocator::allocate
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::free
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanMemoryAllocator::free( Allocation &allocation )
+{
+  if ( !allocation.isValid( ) )
+  {
+    return;
+  }
+
+  MemoryType &memoryType = memoryTypes_[ allocation.memoryType ];
+
+  if ( allocation.block == DEDICATED )
+  {
+    _freeMemory( allocation.memory );
+
+    --memoryType.dedicatedCount;
+    memoryType.dedicatedBytes -= allocation.size;
+  }
+  else
+  {
+    Block &block = memoryType.blocks[ allocation.block ];
+
+    block.upRanges->free( allocation.offset );
+    block.ranges.erase( allocation.offset );
+  }
+
+  allocation = Allocation( );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::createBuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VkBuffer
+VulkanMemoryAllocator::createBuffer(
+                                    const VkDeviceSize          size,
+                                    const VkBufferUsageFlags    usage,
+                                    const VkMemoryPropertyFlags properties,
+                                    Allocation                 *pAllocation
+                                    )
+{
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size        = size;
+  bufferInfo.usage       = usage;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  VkBuffer buffer = VK_NULL_HANDLE;
+
+  if ( vkCreateBuffer( device_, &bufferInfo, nullptr, &buffer ) != VK_SUCCESS )
+  {
+    throw std::runtime_error( "Failed to create buffer" );
+  }
+
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements( device_, buffer, &requirements );
+
+  try
+  {
+    *pAllocation = allocate( requirements, properties );
+  }
+  catch ( ... )
+  {
+    vkDestroyBuffer( device_, buffer, nullptr );
+    throw;
+  }
+
+  vkBindBufferMemory( device_, buffer, pAllocation->memory, pAllocation->offset );
+
+  return buffer;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::destroyBuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanMemoryAllocator::destroyBuffer(
+                                     VkBuffer    buffer,
+                                     Allocation &allocation
+                                     )
+{
+  vkDestroyBuffer( device_, buffer, nullptr );
+  free( allocation );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::bindImage
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanMemoryAllocator::bindImage(
+                                 VkImage                     image,
+                                 const VkMemoryPropertyFlags properties,
+                                 Allocation                 *pAllocation
+                                 )
+{
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements( device_, image, &requirements );
+
+  *pAllocation = allocate( requirements, properties );
+
+  vkBindImageMemory( device_, image, pAllocation->memory, pAllocation->offset );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::flush
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanMemoryAllocator::flush(
+                             const Allocation  &allocation,
+                             const VkDeviceSize offset,
+                             const VkDeviceSize size
+                             )
+{
+  const VkMemoryPropertyFlags flags = memoryProperties_.memoryTypes[ allocation.memoryType ].propertyFlags;
+
+  if ( !allocation.isValid( ) || ( flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT ) )
+  {
+    return;
+  }
+
+  //
+  // flushed ranges must be multiples of nonCoherentAtomSize,
+  // sub-allocated ranges are aligned well past that so
+  // rounding out stays inside the allocation's own range
+  //
+  const VkDeviceSize end = ( size == VK_WHOLE_SIZE ) ? allocation.size : std::min( offset + size, allocation.size );
+
+  VkDeviceSize begin = allocation.offset + offset;
+  VkDeviceSize last  = allocation.offset + end;
+
+  begin -= begin % nonCoherentAtomSize_;
+  last   = ( ( last + nonCoherentAtomSize_ - 1 ) / nonCoherentAtomSize_ ) * nonCoherentAtomSize_;
+
+  VkMappedMemoryRange range = {};
+  range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.memory = allocation.memory;
+  range.offset = begin;
+  range.size   = last - begin;
+
+  // the end of a dedicated allocation need not be a whole atom
+  if ( allocation.block == DEDICATED && last > allocation.size )
+  {
+    range.size = VK_WHOLE_SIZE;
+  }
+
+  vkFlushMappedMemoryRanges( device_, 1, &range );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::defragment
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+uint32_t
+VulkanMemoryAllocator::defragment(
+                                  const MoveFunction &move,
+                                  const VkDeviceSize  maxBytesMoved
+                                  )
+{
+  uint32_t movedCount     = 0;
+  VkDeviceSize bytesMoved = 0;
+
+  for ( uint32_t memoryType = 0; memoryType < memoryTypes_.size( ); ++memoryType )
+  {
+    std::vector< Block > &blocks = memoryTypes_[ memoryType ].blocks;
+
+    std::vector< uint32_t > order;
+
+    for ( uint32_t block = 0; block < blocks.size( ); ++block )
+    {
+      if ( blocks[ block ].memory != VK_NULL_HANDLE )
+      {
+        order.push_back( block );
+      }
+    }
+
+    // fullest first, allocations move from the back to the front
+    std::sort(
+              order.begin( ),
+              order.end( ),
+              [ &blocks ]( const uint32_t a, const uint32_t b )
+    {
+      return blocks[ a ].upRanges->getBytesUsed( ) > blocks[ b ].upRanges->getBytesUsed( );
+    } );
+
+    for ( std::size_t source = order.size( ); source-- > 1; )
+    {
+      Block &sourceBlock = blocks[ order[ source ] ];
+
+      // copied since moved ranges are erased as we go
+      const std::unordered_map< VkDeviceSize, Range > ranges = sourceBlock.ranges;
+
+      for ( const auto &offsetAndRange : ranges )
+      {
+        if ( bytesMoved >= maxBytesMoved )
+        {
+          releaseEmptyBlocks( );
+          return movedCount;
+        }
+
+        Allocation from;
+        from.memory     = sourceBlock.memory;
+        from.offset     = offsetAndRange.first;
+        from.size       = offsetAndRange.second.size;
+        from.pMapped    = sourceBlock.pMapped ? sourceBlock.pMapped + offsetAndRange.first : nullptr;
+        from.memoryType = memoryType;
+        from.block      = order[ source ];
+
+        Allocation to;
+
+        for ( std::size_t target = 0; target < source && !to.isValid( ); ++target )
+        {
+          _allocateFromBlock( memoryType, order[ target ], from.size, offsetAndRange.second.alignment, &to );
+        }
+
+        if ( !to.isValid( ) )
+        {
+          continue;
+        }
+
+        if ( move( from, to ) )
+        {
+          free( from );
+          ++movedCount;
+          bytesMoved += to.size;
+        }
+        else
+        {
+          free( to );
+        }
+      }
+    }
+  }
+
+  releaseEmptyBlocks( );
+
+  return movedCount;
+} // VulkanMemoryAllocator::defragment
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::releaseEmptyBlocks
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanMemoryAllocator::releaseEmptyBlocks( )
+{
+  for ( MemoryType &memoryType : memoryTypes_ )
+  {
+    for ( Block &block : memoryType.blocks )
+    {
+      if ( block.memory != VK_NULL_HANDLE && block.upRanges->isEmpty( ) )
+      {
+        _freeMemory( block.memory );
+        block = Block( );
+      }
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::getStats
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanMemoryAllocator::Stats
+VulkanMemoryAllocator::getStats( ) const
+{
+  Stats total;
+
+  for ( uint32_t memoryType = 0; memoryType < memoryTypes_.size( ); ++memoryType )
+  {
+    addStats( total, getStats( memoryType ) );
+  }
+
+  return total;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::getStats
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanMemoryAllocator::Stats
+VulkanMemoryAllocator::getStats( const uint32_t memoryType ) const
+{
+  const MemoryType &type = memoryTypes_.at( memoryType );
+
+  Stats stats;
+  stats.dedicatedCount  = type.dedicatedCount;
+  stats.allocationCount = type.dedicatedCount;
+  stats.bytesReserved   = type.dedicatedBytes;
+  stats.bytesUsed       = type.dedicatedBytes;
+
+  for ( const Block &block : type.blocks )
+  {
+    if ( block.memory != VK_NULL_HANDLE )
+    {
+      ++stats.blockCount;
+      stats.allocationCount += block.upRanges->getAllocationCount( );
+      stats.bytesReserved   += blockSize_;
+      stats.bytesUsed       += block.upRanges->getBytesUsed( );
+    }
+  }
+
+  return stats;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::_findMemoryType
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+uint32_t
+VulkanMemoryAllocator::_findMemoryType(
+                                       const uint32_t              typeBits,
+                                       const VkMemoryPropertyFlags properties
+                                       ) const
+{
+  for ( uint32_t memoryType = 0; memoryType < memoryProperties_.memoryTypeCount; ++memoryType )
+  {
+    if ( ( typeBits & ( 1u << memoryType ) )
+         && ( memoryProperties_.memoryTypes[ memoryType ].propertyFlags & properties ) == properties )
+    {
+      return memoryType;
+    }
+  }
+
+  throw std::runtime_error( "No memory type has the requested properties" );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::_allocateMemory
+///
+///        Allocates and, if host visible, maps device memory.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VkDeviceMemory
+VulkanMemoryAllocator::_allocateMemory(
+                                       const VkDeviceSize size,
+                                       const uint32_t     memoryType,
+                                       void             **ppMapped
+                                       )
+{
+  if ( deviceAllocationCount_ >= maxAllocationCount_ )
+  {
+    throw std::runtime_error( "Out of device memory allocations (maxMemoryAllocationCount)" );
+  }
+
+  VkMemoryAllocateInfo allocInfo = {};
+  allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize  = size;
+  allocInfo.memoryTypeIndex = memoryType;
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+
+  if ( vkAllocateMemory( device_, &allocInfo, nullptr, &memory ) != VK_SUCCESS )
+  {
+    throw std::runtime_error( "Failed to allocate device memory" );
+  }
+
+  ++deviceAllocationCount_;
+
+  *ppMapped = nullptr;
+
+  if ( memoryProperties_.memoryTypes[ memoryType ].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT )
+  {
+    if ( vkMapMemory( device_, memory, 0, VK_WHOLE_SIZE, 0, ppMapped ) != VK_SUCCESS )
+    {
+      _freeMemory( memory );
+      throw std::runtime_error( "Failed to map device memory" );
+    }
+  }
+
+  return memory;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::_freeMemory
+///
+///        Freeing memory unmaps it implicitly.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanMemoryAllocator::_freeMemory( VkDeviceMemory memory )
+{
+  vkFreeMemory( device_, memory, nullptr );
+  --deviceAllocationCount_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::_allocateFromBlock
+/// \return false if the block is released or full
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+VulkanMemoryAllocator::_allocateFromBlock(
+                                          const uint32_t     memoryType,
+                                          const uint32_t     block,
+                                          const VkDeviceSize size,
+                                          const VkDeviceSize alignment,
+                                          Allocation        *pAllocation
+                                          )
+{
+  Block &memoryBlock = memoryTypes_[ memoryType ].blocks[ block ];
+
+  if ( memoryBlock.memory == VK_NULL_HANDLE )
+  {
+    return false;
+  }
+
+  const VkDeviceSize offset = memoryBlock.upRanges->allocate( size, std::max( alignment, minRangeSize_ ) );
+
+  if ( offset == shs::BuddyAllocator::INVALID_OFFSET )
+  {
+    return false;
+  }
+
+  memoryBlock.ranges[ offset ] = Range{ size, alignment };
+
+  pAllocation->memory     = memoryBlock.memory;
+  pAllocation->offset     = offset;
+  pAllocation->size       = size;
+  pAllocation->pMapped    = memoryBlock.pMapped ? memoryBlock.pMapped + offset : nullptr;
+  pAllocation->memoryType = memoryType;
+  pAllocation->block      = block;
+
+  return true;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanMemoryAllocator::_createBlock
+/// \return index of a new empty block, reusing released slots
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+uint32_t
+VulkanMemoryAllocator::_createBlock( const uint32_t memoryType )
+{
+  std::vector< Block > &blocks = memoryTypes_[ memoryType ].blocks;
+
+  uint32_t index = 0;
+
+  while ( index < blocks.size( ) && blocks[ index ].memory != VK_NULL_HANDLE )
+  {
+    ++index;
+  }
+
+  if ( index == blocks.size( ) )
+  {
+    blocks.emplace_back( );
+  }
+
+  Block &block = blocks[ index ];
+
+  void *pMapped = nullptr;
+
+  block.memory   = _allocateMemory( blockSize_, memoryType, &pMapped );
+  block.pMapped  = static_cast< char* >( pMapped );
+  block.upRanges.reset( new shs::BuddyAllocator( blockSize_, minRangeSize_ ) );
+
+  return index;
+}
+
+
+
+} // namespace shg
@@ -0,0 +1,673 @@
+#include "shared/graphics/VulkanUploader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+
+namespace shg
+{
+
+
+namespace
+{
+
+// everything the graphics queue may read an upload with
+constexpr VkAccessFlags uploadReadAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+                                           | VK_ACCESS_INDEX_READ_BIT
+                                           | VK_ACCESS_UNIFORM_READ_BIT
+                                           | VK_ACCESS_SHADER_READ_BIT;
+
+constexpr VkPipelineStageFlags uploadReadStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+                                                  | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                                                  | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::VulkanUploader
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanUploader::VulkanUploader(
+                               VkDevice               device,
+                               VulkanMemoryAllocator &allocator,
+                               VkQueue                transferQueue,
+                               const uint32_t         transferFamily,
+                               const uint32_t         graphicsFamily,
+                               const uint32_t         framesInFlight,
+                               const VkDeviceSize     ringSize
+                               )
+  : device_             ( device )
+  , allocator_          ( allocator )
+  , transferQueue_      ( transferQueue )
+  , transferFamily_     ( transferFamily )
+  , graphicsFamily_     ( graphicsFamily )
+  , framesInFlight_     ( std::max( framesInFlight, 1u ) )
+  , ring_               ( VK_NULL_HANDLE )
+  , ringSize_           ( ringSize )
+  , head_               ( 0 )
+  , tail_               ( 0 )
+  , retiredSinceAcquire_( false )
+  , acquireCalls_       ( 0 )
+  , nextId_             ( 1 )
+  , completedId_        ( 0 )
+  , stalls_             ( 0 )
+{
+  ring_ = allocator_.createBuffer(
+                                  ringSize_,
+                                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                  &ringAllocation_
+                                  );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::~VulkanUploader
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VulkanUploader::~VulkanUploader( )
+{
+  for ( std::unique_ptr< Batch > &upBatch : inFlight_ )
+  {
+    vkWaitForFences( device_, 1, &upBatch->fence, VK_TRUE, std::numeric_limits< uint64_t >::max( ) );
+    _destroyBatch( *upBatch );
+  }
+
+  for ( std::unique_ptr< Batch > &upBatch : freeBatches_ )
+  {
+    _destroyBatch( *upBatch );
+  }
+
+  for ( const auto &waited : waitedSemaphores_ )
+  {
+    freeSemaphores_.push_back( waited.second );
+  }
+
+  freeSemaphores_.insert( freeSemaphores_.end( ), acquireSemaphores_.begin( ), acquireSemaphores_.end( ) );
+
+  for ( VkSemaphore semaphore : freeSemaphores_ )
+  {
+    vkDestroySemaphore( device_, semaphore, nullptr );
+  }
+
+  allocator_.destroyBuffer( ring_, ringAllocation_ );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::uploadBuffer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+uint64_t
+VulkanUploader::uploadBuffer(
+                             VkBuffer           buffer,
+                             const VkDeviceSize offset,
+                             const void        *pData,
+                             const VkDeviceSize size
+                             )
+{
+  BufferCopy copy;
+  copy.buffer           = buffer;
+  copy.region.srcOffset = _stage( pData, size, 16 );
+  copy.region.dstOffset = offset;
+  copy.region.size      = size;
+
+  bufferCopies_.push_back( copy );
+
+  return nextId_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::uploadImage
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+uint64_t
+VulkanUploader::uploadImage(
+                            VkImage                  image,
+                            const VkExtent3D         extent,
+                            const void              *pData,
+                            const VkDeviceSize       size,
+                            const VkImageAspectFlags aspect,
+                            const VkDeviceSize       alignment
+                            )
+{
+  ImageCopy copy = {};
+  copy.image     = image;
+
+  copy.region.bufferOffset      = _stage( pData, size, alignment );
+  copy.region.bufferRowLength   = 0; // tightly packed
+  copy.region.bufferImageHeight = 0;
+
+  copy.region.imageSubresource.aspectMask     = aspect;
+  copy.region.imageSubresource.mipLevel       = 0;
+  copy.region.imageSubresource.baseArrayLayer = 0;
+  copy.region.imageSubresource.layerCount     = 1;
+
+  copy.region.imageOffset = { 0, 0, 0 };
+  copy.region.imageExtent = extent;
+
+  imageCopies_.push_back( copy );
+
+  return nextId_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::submit
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanUploader::submit( )
+{
+  if ( bufferCopies_.empty( ) && imageCopies_.empty( ) )
+  {
+    return;
+  }
+
+  std::unique_ptr< Batch > upBatch;
+
+  if ( freeBatches_.empty( ) )
+  {
+    upBatch = _createBatch( );
+  }
+  else
+  {
+    upBatch = std::move( freeBatches_.back( ) );
+    freeBatches_.pop_back( );
+  }
+
+  Batch &batch = *upBatch;
+
+  vkResetCommandPool( device_, batch.pool, 0 );
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  vkBeginCommandBuffer( batch.commandBuffer, &beginInfo );
+
+  //
+  // images are written whole, so whatever they held is discarded.
+  // Earlier batches may still be copying to the same image, the
+  // transfer queue runs them in order but can overlap them.
+  //
+  std::vector< VkImageMemoryBarrier > imageBarriers( imageCopies_.size( ) );
+
+  for ( std::size_t i = 0; i < imageCopies_.size( ); ++i )
+  {
+    const VkImageSubresourceLayers &layers = imageCopies_[ i ].region.imageSubresource;
+
+    VkImageMemoryBarrier &barrier = imageBarriers[ i ];
+    barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = imageCopies_[ i ].image;
+    barrier.subresourceRange    = { layers.aspectMask, layers.mipLevel, 1, layers.baseArrayLayer, layers.layerCount };
+  }
+
+  if ( !imageBarriers.empty( ) )
+  {
+    vkCmdPipelineBarrier(
+                         batch.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         static_cast< uint32_t >( imageBarriers.size( ) ), imageBarriers.data( )
+                         );
+  }
+
+  //
+  // consecutive uploads to the same buffer share one copy command
+  //
+  std::vector< VkBufferCopy > regions;
+
+  for ( std::size_t i = 0; i < bufferCopies_.size( ); ++i )
+  {
+    regions.push_back( bufferCopies_[ i ].region );
+
+    if ( i + 1 == bufferCopies_.size( ) || bufferCopies_[ i + 1 ].buffer != bufferCopies_[ i ].buffer )
+    {
+      vkCmdCopyBuffer(
+                      batch.commandBuffer,
+                      ring_,
+                      bufferCopies_[ i ].buffer,
+                      static_cast< uint32_t >( regions.size( ) ),
+                      regions.data( )
+                      );
+      regions.clear( );
+    }
+  }
+
+  for ( const ImageCopy &copy : imageCopies_ )
+  {
+    vkCmdCopyBufferToImage(
+                           batch.commandBuffer,
+                           ring_,
+                           copy.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1,
+                           &copy.region
+                           );
+  }
+
+  //
+  // images move to their shader layout here. Across queue
+  // families the same barriers also release ownership, and
+  // matching acquires are kept for recordAcquire. On one
+  // queue the transition finishes ahead of later transfer
+  // work, which the barrier in recordAcquire waits on.
+  //
+  const bool release = usesTransferQueue( );
+
+  std::vector< VkBufferMemoryBarrier > bufferBarriers;
+
+  if ( release )
+  {
+    bufferBarriers.resize( bufferCopies_.size( ) );
+
+    for ( std::size_t i = 0; i < bufferCopies_.size( ); ++i )
+    {
+      VkBufferMemoryBarrier &barrier = bufferBarriers[ i ];
+      barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask       = 0;
+      barrier.srcQueueFamilyIndex = transferFamily_;
+      barrier.dstQueueFamilyIndex = graphicsFamily_;
+      barrier.buffer              = bufferCopies_[ i ].buffer;
+      barrier.offset              = bufferCopies_[ i ].region.dstOffset;
+      barrier.size                = bufferCopies_[ i ].region.size;
+    }
+  }
+
+  for ( VkImageMemoryBarrier &barrier : imageBarriers )
+  {
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = 0;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = release ? transferFamily_ : VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = release ? graphicsFamily_ : VK_QUEUE_FAMILY_IGNORED;
+  }
+
+  if ( !bufferBarriers.empty( ) || !imageBarriers.empty( ) )
+  {
+    vkCmdPipelineBarrier(
+                         batch.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         static_cast< uint32_t >( bufferBarriers.size( ) ), bufferBarriers.data( ),
+                         static_cast< uint32_t >( imageBarriers.size( ) ), imageBarriers.data( )
+                         );
+  }
+
+  if ( vkEndCommandBuffer( batch.commandBuffer ) != VK_SUCCESS )
+  {
+    freeBatches_.push_back( std::move( upBatch ) );
+    throw std::runtime_error( "Failed to record upload command buffer" );
+  }
+
+  // kept if a submit failed, never signalled then
+  if ( release && batch.semaphore == VK_NULL_HANDLE )
+  {
+    batch.semaphore = _getSemaphore( );
+  }
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &batch.commandBuffer;
+
+  if ( release )
+  {
+    // the graphics queue waits on it before acquiring
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores    = &batch.semaphore;
+  }
+
+  if ( vkQueueSubmit( transferQueue_, 1, &submitInfo, batch.fence ) != VK_SUCCESS )
+  {
+    freeBatches_.push_back( std::move( upBatch ) );
+    throw std::runtime_error( "Failed to submit upload command buffer" );
+  }
+
+  //
+  // acquires ignore srcAccessMask, the release made the copies
+  // available and the semaphore orders them before the acquire
+  //
+  if ( release )
+  {
+    for ( VkBufferMemoryBarrier &barrier : bufferBarriers )
+    {
+      barrier.srcAccessMask = 0;
+      barrier.dstAccessMask = uploadReadAccess;
+    }
+
+    for ( VkImageMemoryBarrier &barrier : imageBarriers )
+    {
+      barrier.srcAccessMask = 0;
+      barrier.dstAccessMask = uploadReadAccess;
+    }
+
+    batch.bufferAcquires = std::move( bufferBarriers );
+    batch.imageAcquires  = std::move( imageBarriers );
+  }
+
+  batch.id      = nextId_++;
+  batch.ringEnd = head_;
+
+  inFlight_.push_back( std::move( upBatch ) );
+
+  bufferCopies_.clear( );
+  imageCopies_.clear( );
+} // VulkanUploader::submit
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::retire
+///
+///        Batches finish in submission order on the one
+///        transfer queue, so only the oldest needs checking.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanUploader::retire( )
+{
+  while ( !inFlight_.empty( ) && vkGetFenceStatus( device_, inFlight_.front( )->fence ) == VK_SUCCESS )
+  {
+    Batch &batch = *inFlight_.front( );
+
+    tail_        = batch.ringEnd;
+    completedId_ = batch.id;
+
+    bufferAcquires_.insert( bufferAcquires_.end( ), batch.bufferAcquires.begin( ), batch.bufferAcquires.end( ) );
+    imageAcquires_.insert( imageAcquires_.end( ), batch.imageAcquires.begin( ), batch.imageAcquires.end( ) );
+    batch.bufferAcquires.clear( );
+    batch.imageAcquires.clear( );
+
+    if ( batch.semaphore != VK_NULL_HANDLE )
+    {
+      acquireSemaphores_.push_back( batch.semaphore );
+      batch.semaphore = VK_NULL_HANDLE;
+    }
+
+    retiredSinceAcquire_ = true;
+
+    vkResetFences( device_, 1, &batch.fence );
+
+    freeBatches_.push_back( std::move( inFlight_.front( ) ) );
+    inFlight_.pop_front( );
+  }
+} // VulkanUploader::retire
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::recordAcquire
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+VulkanUploader::recordAcquire(
+                              VkCommandBuffer                      commandBuffer,
+                              std::vector< VkSemaphore >          &waitSemaphores,
+                              std::vector< VkPipelineStageFlags > &waitStages
+                              )
+{
+  ++acquireCalls_;
+
+  //
+  // a submit waiting framesInFlight calls ago has finished,
+  // so its semaphores can be signalled again
+  //
+  while ( !waitedSemaphores_.empty( ) && waitedSemaphores_.front( ).first + framesInFlight_ <= acquireCalls_ )
+  {
+    freeSemaphores_.push_back( waitedSemaphores_.front( ).second );
+    waitedSemaphores_.pop_front( );
+  }
+
+  if ( !retiredSinceAcquire_ )
+  {
+    return false;
+  }
+
+  //
+  // the wait stage matches the barrier's source stage so the
+  // semaphore wait chains into the acquires
+  //
+  for ( VkSemaphore semaphore : acquireSemaphores_ )
+  {
+    waitSemaphores.push_back( semaphore );
+    waitStages.push_back( VK_PIPELINE_STAGE_TRANSFER_BIT );
+    waitedSemaphores_.emplace_back( acquireCalls_, semaphore );
+  }
+
+  acquireSemaphores_.clear( );
+
+  //
+  // on one queue submission order puts the copies in this
+  // barrier's first scope, it makes them visible to every
+  // stage reading uploads
+  //
+  VkMemoryBarrier memoryBarrier = {};
+  memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = uploadReadAccess;
+
+  vkCmdPipelineBarrier(
+                       commandBuffer,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       uploadReadStages,
+                       0,
+                       1, &memoryBarrier,
+                       static_cast< uint32_t >( bufferAcquires_.size( ) ), bufferAcquires_.data( ),
+                       static_cast< uint32_t >( imageAcquires_.size( ) ), imageAcquires_.data( )
+                       );
+
+  bufferAcquires_.clear( );
+  imageAcquires_.clear( );
+  retiredSinceAcquire_ = false;
+
+  return true;
+} // VulkanUploader::recordAcquire
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::_stage
+/// \return ring offset the data was copied to
+///
+///        Uploads never wrap around the end of the ring so each
+///        one is a single copy region.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VkDeviceSize
+VulkanUploader::_stage(
+                       const void        *pData,
+                       const VkDeviceSize size,
+                       const VkDeviceSize alignment
+                       )
+{
+  if ( size > ringSize_ )
+  {
+    throw std::runtime_error( "Upload is larger than the staging ring" );
+  }
+
+  bool stalled = false;
+
+  for ( ;; )
+  {
+    const VkDeviceSize position = head_ % ringSize_;
+
+    uint64_t start = head_ + ( alignment - position % alignment ) % alignment;
+
+    if ( start % ringSize_ + size > ringSize_ || start % ringSize_ < position )
+    {
+      start = ( head_ / ringSize_ + 1 ) * ringSize_;
+    }
+
+    if ( start + size - tail_ <= ringSize_ )
+    {
+      head_ = start + size;
+
+      const VkDeviceSize offset = start % ringSize_;
+
+      std::memcpy( static_cast< char* >( ringAllocation_.pMapped ) + offset, pData, static_cast< std::size_t >( size ) );
+
+      return offset;
+    }
+
+    //
+    // out of space, so everything staged so far has to be
+    // submitted and the oldest batch waited on
+    //
+    submit( );
+
+    if ( inFlight_.empty( ) )
+    {
+      // nothing staged is still in use, start over at the front
+      head_ = ( head_ / ringSize_ + 1 ) * ringSize_;
+      tail_ = head_;
+      continue;
+    }
+
+    if ( !stalled )
+    {
+      stalled = true;
+      ++stalls_;
+    }
+
+    vkWaitForFences( device_, 1, &inFlight_.front( )->fence, VK_TRUE, std::numeric_limits< uint64_t >::max( ) );
+    retire( );
+  }
+} // VulkanUploader::_stage
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::_createBatch
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::unique_ptr< VulkanUploader::Batch >
+VulkanUploader::_createBatch( )
+{
+  std::unique_ptr< Batch > upBatch( new Batch( ) );
+
+  VkCommandPoolCreateInfo poolInfo = {};
+  poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.queueFamilyIndex = transferFamily_;
+  poolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+  bool created = vkCreateCommandPool( device_, &poolInfo, nullptr, &upBatch->pool ) == VK_SUCCESS
+                 && vkCreateFence( device_, &fenceInfo, nullptr, &upBatch->fence ) == VK_SUCCESS;
+
+  if ( created )
+  {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = upBatch->pool;
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    created = vkAllocateCommandBuffers( device_, &allocInfo, &upBatch->commandBuffer ) == VK_SUCCESS;
+  }
+
+  if ( !created )
+  {
+    _destroyBatch( *upBatch );
+    throw std::runtime_error( "Failed to create upload command buffer" );
+  }
+
+  return upBatch;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::_destroyBatch
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+VulkanUploader::_destroyBatch( Batch &batch )
+{
+  if ( batch.fence != VK_NULL_HANDLE )
+  {
+    vkDestroyFence( device_, batch.fence, nullptr );
+  }
+
+  if ( batch.semaphore != VK_NULL_HANDLE )
+  {
+    vkDestroySemaphore( device_, batch.semaphore, nullptr );
+  }
+
+  if ( batch.pool != VK_NULL_HANDLE )
+  {
+    vkDestroyCommandPool( device_, batch.pool, nullptr );
+  }
+
+  batch = Batch( );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief VulkanUploader::_getSemaphore
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+VkSemaphore
+VulkanUploader::_getSemaphore( )
+{
+  if ( !freeSemaphores_.empty( ) )
+  {
+    VkSemaphore semaphore = freeSemaphores_.back( );
+    freeSemaphores_.pop_back( );
+    return semaphore;
+  }
+
+  VkSemaphoreCreateInfo semaphoreInfo = {};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+  VkSemaphore semaphore = VK_NULL_HANDLE;
+
+  if ( vkCreateSemaphore( device_, &semaphoreInfo, nullptr, &semaphore ) != VK_SUCCESS )
+  {
+    throw std::runtime_error( "Failed to create upload semaphore" );
+  }
+
+  return semaphore;
+}
+
+
+
+} // namespace shg
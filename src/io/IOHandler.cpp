@@ -101,6 +101,19 @@ IOHandler::waitForIO( )
 
 
 
+/////////////////////////////////////////////
+/// \brief IOHandler::interruptRequested
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+IOHandler::interruptRequested( )
+{
+  return signalCaught;
+}
+
+
+
 /////////////////////////////////////////////
 /// \brief IOHandler::onLoopExit
 ///
@@ -1,8 +1,12 @@
 #include "shared/core/ImguiOpenGLIOHandler.hpp"
 
 // shared
+#include "shared/core/Trace.hpp"
 #include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/FrameCapture.hpp"
+#include "shared/graphics/GpuProfiler.hpp"
 #include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
 #include "shared/graphics/ImguiCallback.hpp"
 #include "shared/graphics/SharedCallback.hpp"
 #include <imgui.h>
@@ -11,6 +15,7 @@
 
 // system
 #include <iostream>
+#include <string>
 
 
 namespace shs
@@ -90,16 +95,107 @@ ImguiOpenGLIOHandler::showWorld( const double alpha )
 
   _onGuiRender( );
 
-  _onRender( alpha );
+  shg::GpuProfiler *pProfiler = upGpuProfiler_.get( );
 
-  ImGui::Render( );
+  if ( pProfiler )
+  {
+    pProfiler->beginFrame( );
+  }
+
+  {
+    shg::GpuProfiler::Scope frameScope( pProfiler, "frame" );
+
+    {
+      shg::GpuProfiler::Scope renderScope( pProfiler, "render" );
+      _onRender( alpha );
+    }
 
-  upGlfwWrapper_->swapBuffers( );
+    // before the GUI so recordings only show the sim
+    if ( upFrameCapture_ )
+    {
+      shg::GpuProfiler::Scope captureScope( pProfiler, "capture" );
+      upFrameCapture_->capture( );
+    }
+
+    shg::GpuProfiler::Scope guiScope( pProfiler, "gui" );
+    ImGui::Render( );
+  }
+
+  if ( pProfiler )
+  {
+    pProfiler->endFrame( );
+  }
+
+  {
+    SHS_TRACE_SCOPE( "swapBuffers" );
+    upGlfwWrapper_->swapBuffers( );
+  }
+
+  shg::OpenGLStateCache::get( ).endFrame( );
 
 } // ImguiOpenGLIOHandler::showWorld
 
 
 
+///////////////////////////////////////////////////////////////
+/// \brief ImguiOpenGLIOHandler::_onProfilerGui
+///
+///        Per scope breakdown of the newest profiled frame. Does
+///        nothing while profiling is off.
+///
+/// \author Logan Barnes
+///////////////////////////////////////////////////////////////
+void
+ImguiOpenGLIOHandler::_onProfilerGui( const std::string &csvPath )
+{
+  shg::GpuProfiler *pProfiler = upGpuProfiler_.get( );
+
+  if ( !pProfiler || !ImGui::CollapsingHeader( "Profiler", "profiler", false, true ) )
+  {
+    return;
+  }
+
+  ImGui::Columns( 3, "profiler columns" );
+  ImGui::Text( "Scope"  );
+  ImGui::NextColumn( );
+  ImGui::Text( "CPU ms" );
+  ImGui::NextColumn( );
+  ImGui::Text( "GPU ms" );
+  ImGui::NextColumn( );
+  ImGui::Separator( );
+
+  for ( const auto &timing : pProfiler->getTimings( ) )
+  {
+    ImGui::Text( "%s%s", std::string( static_cast< size_t >( timing.depth ) * 2, ' ' ).c_str( ), timing.name.c_str( ) );
+    ImGui::NextColumn( );
+    ImGui::Text( "%.3f", timing.cpuMs );
+    ImGui::NextColumn( );
+    ImGui::Text( "%.3f", timing.gpuMs );
+    ImGui::NextColumn( );
+  }
+
+  ImGui::Columns( 1 );
+
+  ImGui::Text( "Dropped frames: %llu", static_cast< unsigned long long >( pProfiler->getFramesDropped( ) ) );
+
+  if ( !csvPath.empty( ) )
+  {
+    if ( pProfiler->isWritingCsv( ) )
+    {
+      if ( ImGui::Button( "Stop CSV" ) )
+      {
+        pProfiler->stopCsv( );
+      }
+    }
+    else if ( ImGui::Button( "Write CSV" ) )
+    {
+      pProfiler->startCsv( csvPath );
+    }
+  }
+}
+
+
+
 void
 ImguiOpenGLIOHandler::_onRender( const double )
 {
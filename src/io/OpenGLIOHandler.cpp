@@ -1,12 +1,19 @@
 #include "shared/core/OpenGLIOHandler.hpp"
 
 // shared
+#include "shared/core/Trace.hpp"
 #include "shared/graphics/GlfwWrapper.hpp"
+#include "shared/graphics/FrameCapture.hpp"
+#include "shared/graphics/GpuProfiler.hpp"
 #include "shared/graphics/OpenGLHelper.hpp"
+#include "shared/graphics/OpenGLStateCache.hpp"
 #include "shared/graphics/GlmCamera.hpp"
 #include "shared/graphics/SharedCallback.hpp"
 #include <glad/glad.h>
 
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+
 // system
 #include <iostream>
 
@@ -78,9 +85,41 @@ OpenGLIOHandler::~OpenGLIOHandler( )
 void
 OpenGLIOHandler::showWorld( const double alpha )
 {
-  glViewport( 0, 0, windowWidth_, windowHeight_ );
-  _onRender( alpha );
-  upGlfwWrapper_->swapBuffers( );
+  shg::GpuProfiler *pProfiler = upGpuProfiler_.get( );
+
+  if ( pProfiler )
+  {
+    pProfiler->beginFrame( );
+  }
+
+  {
+    shg::GpuProfiler::Scope frameScope( pProfiler, "frame" );
+
+    glViewport( 0, 0, windowWidth_, windowHeight_ );
+
+    {
+      shg::GpuProfiler::Scope renderScope( pProfiler, "render" );
+      _onRender( alpha );
+    }
+
+    if ( upFrameCapture_ )
+    {
+      shg::GpuProfiler::Scope captureScope( pProfiler, "capture" );
+      upFrameCapture_->capture( );
+    }
+  }
+
+  if ( pProfiler )
+  {
+    pProfiler->endFrame( );
+  }
+
+  {
+    SHS_TRACE_SCOPE( "swapBuffers" );
+    upGlfwWrapper_->swapBuffers( );
+  }
+
+  shg::OpenGLStateCache::get( ).endFrame( );
 } // OpenGLIOHandler::showWorld
 
 
@@ -124,6 +163,12 @@ OpenGLIOHandler::resize(
                         const int height ///< new window height
                         )
 {
+  // every frame of a recording has to be the same size
+  if ( width != windowWidth_ || height != windowHeight_ )
+  {
+    stopCapture( );
+  }
+
   windowWidth_  = width;
   windowHeight_ = height;
   upCamera_->setAspectRatio( windowWidth_ * 1.0f / windowHeight_ );
@@ -131,4 +176,61 @@ OpenGLIOHandler::resize(
 
 
 
+///////////////////////////////////////////////////////////////
+/// \brief OpenGLIOHandler::startCapture
+///
+/// \author Logan Barnes
+///////////////////////////////////////////////////////////////
+void
+OpenGLIOHandler::startCapture(
+                              const std::string &filePath,
+                              const int          fps
+                              )
+{
+  // finish the previous file first
+  upFrameCapture_ = nullptr;
+
+  // differs from the window size on HiDPI displays
+  int width  = 0;
+  int height = 0;
+  glfwGetFramebufferSize( upGlfwWrapper_->getWindow( ), &width, &height );
+
+  upFrameCapture_.reset( new shg::FrameCapture( filePath, width, height, fps ) );
+}
+
+
+
+///////////////////////////////////////////////////////////////
+/// \brief OpenGLIOHandler::stopCapture
+///
+/// \author Logan Barnes
+///////////////////////////////////////////////////////////////
+void
+OpenGLIOHandler::stopCapture( )
+{
+  upFrameCapture_ = nullptr;
+}
+
+
+
+///////////////////////////////////////////////////////////////
+/// \brief OpenGLIOHandler::setProfiling
+///
+/// \author Logan Barnes
+///////////////////////////////////////////////////////////////
+void
+OpenGLIOHandler::setProfiling( const bool profile )
+{
+  if ( !profile )
+  {
+    upGpuProfiler_ = nullptr;
+  }
+  else if ( !upGpuProfiler_ )
+  {
+    upGpuProfiler_.reset( new shg::GpuProfiler( ) );
+  }
+}
+
+
+
 } // namespace shs
@@ -2,6 +2,7 @@
 
 #include "shared/graphics/VulkanGlfwWrapper.hpp"
 #include "shared/graphics/SharedCallback.hpp"
+#include "shared/core/World.hpp"
 #include "ThirdpartyDefinesConfig.hpp"
 #include "SharedSimulationConfig.hpp"
 
@@ -19,8 +20,9 @@ namespace shs
 /// \author Logan Barnes
 /////////////////////////////////////////////
 VulkanIOHandler::VulkanIOHandler(
-                                 World &world,
-                                 bool  printInfo
+                                 World             &world,
+                                 bool               printInfo,
+                                 const std::string &pipelineCacheFile
                                  )
   : IOHandler( world, false )
   , upVulkanWrapper_( new shg::VulkanGlfwWrapper( ) )
@@ -38,6 +40,8 @@ VulkanIOHandler::VulkanIOHandler(
 
   upVulkanWrapper_->createRenderPass( );
 
+  upVulkanWrapper_->createPipelineCache( pipelineCacheFile );
+
   upVulkanWrapper_->createGraphicsPipeline(
                                            shs::SHADER_PATH + "vulkan/screenSpace/vert.spv",
                                            shs::SHADER_PATH + "vulkan/default/frag.spv"
@@ -49,7 +53,7 @@ VulkanIOHandler::VulkanIOHandler(
 
   upVulkanWrapper_->createCommandBuffers( );
 
-  upVulkanWrapper_->createSemaphores( );
+  upVulkanWrapper_->createSyncObjects( );
 }
 
 
@@ -105,6 +109,11 @@ VulkanIOHandler::updateIO( )
 void
 VulkanIOHandler::onRender( const double )
 {
+  //
+  // the driver hands the world its job system after
+  // this handler is built, so pick it up every frame
+  //
+  upVulkanWrapper_->setJobSystem( &world_.getJobSystem( ) );
   upVulkanWrapper_->drawFrame( );
 } // TerrainIOHandler::onRender
 
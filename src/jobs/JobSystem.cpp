@@ -0,0 +1,542 @@
+#include "shared/core/JobSystem.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+
+namespace shs
+{
+
+
+namespace
+{
+
+///
+/// \brief tlsOwner and tlsIndex identify the queue and
+///        scratch arena of each worker thread
+///
+thread_local const JobSystem *tlsOwner = nullptr;
+thread_local unsigned tlsIndex         = 0;
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief TaskGraph::addTask
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TaskGraph::TaskId
+TaskGraph::addTask(
+                   std::function< void( ) >        task,
+                   std::initializer_list< TaskId > dependencies
+                   )
+{
+  return addTask( std::move( task ), std::vector< TaskId >( dependencies ) );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TaskGraph::addTask
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TaskGraph::TaskId
+TaskGraph::addTask(
+                   std::function< void( ) >     task,
+                   const std::vector< TaskId > &dependencies
+                   )
+{
+  const TaskId id = nodes_.size( );
+
+  for ( const TaskId dependency : dependencies )
+  {
+    if ( dependency >= id )
+    {
+      throw std::out_of_range( "Task dependency " + std::to_string( dependency )
+                              + " has not been added to the graph" );
+    }
+  }
+
+  for ( const TaskId dependency : dependencies )
+  {
+    nodes_[ dependency ].successors.push_back( id );
+  }
+
+  nodes_.push_back( Node{ std::move( task ), {}, static_cast< unsigned >( dependencies.size( ) ) } );
+
+  return id;
+} // TaskGraph::addTask
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::JobSystem
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+JobSystem::JobSystem( unsigned numThreads )
+  : numWorkers_   ( 0 )
+  , queues_       ( )
+  , arenas_       ( )
+  , workers_      ( )
+  , queuedJobs_   ( 0 )
+  , running_      ( true )
+  , sleepMutex_   ( )
+  , wakeCondition_( )
+{
+  if ( numThreads == 0 )
+  {
+    numThreads = std::max( 1u, std::thread::hardware_concurrency( ) );
+  }
+
+  //
+  // the extra queue is shared by threads outside the pool
+  // (usually the driver), it is locked like every other queue.
+  // Arenas aren't, so outside threads get their own on demand.
+  //
+  for ( unsigned i = 0; i < numThreads; ++i )
+  {
+    queues_.emplace_back( new WorkQueue );
+  }
+
+  for ( unsigned i = 0; i + 1 < numThreads; ++i )
+  {
+    arenas_.emplace_back( new ScratchArena );
+  }
+
+  workers_.reserve( numThreads - 1 );
+
+  for ( unsigned i = 0; i + 1 < numThreads; ++i )
+  {
+    try
+    {
+      workers_.emplace_back( &JobSystem::_workerLoop, this, i );
+    }
+    catch ( const std::system_error& )
+    {
+      // run with the threads we could get
+      break;
+    }
+  }
+
+  numWorkers_ = static_cast< unsigned >( workers_.size( ) );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::~JobSystem
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+JobSystem::~JobSystem( )
+{
+  {
+    std::lock_guard< std::mutex > lock( sleepMutex_ );
+    running_ = false;
+  }
+
+  wakeCondition_.notify_all( );
+
+  for ( std::thread &worker : workers_ )
+  {
+    worker.join( );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::run
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::run( TaskGraph &graph )
+{
+  const std::size_t numTasks = graph.nodes_.size( );
+
+  if ( numTasks == 0 )
+  {
+    return;
+  }
+
+  std::unique_ptr< std::atomic< unsigned >[] > pending( new std::atomic< unsigned >[ numTasks ] );
+
+  for ( std::size_t i = 0; i < numTasks; ++i )
+  {
+    pending[ i ].store( graph.nodes_[ i ].dependencyCount, std::memory_order_relaxed );
+  }
+
+  WaitGroup group( numTasks );
+
+  std::function< Job( TaskGraph::TaskId ) > makeJob;
+
+  makeJob = [ this, &graph, &pending, &group, &makeJob ]( const TaskGraph::TaskId id )
+            {
+              return Job{ [ this, &graph, &pending, &group, &makeJob, id ]
+                          {
+                            const TaskGraph::Node &node = graph.nodes_[ id ];
+
+                            //
+                            // skip the task after a failure but still release
+                            // successors so the group can finish
+                            //
+                            if ( !group.failed )
+                            {
+                              try
+                              {
+                                node.task( );
+                              }
+                              catch ( ... )
+                              {
+                                group.fail( std::current_exception( ) );
+                              }
+                            }
+
+                            std::vector< Job > ready;
+
+                            for ( const TaskGraph::TaskId successor : node.successors )
+                            {
+                              if ( pending[ successor ].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+                              {
+                                ready.push_back( makeJob( successor ) );
+                              }
+                            }
+
+                            if ( !ready.empty( ) )
+                            {
+                              _submit( ready );
+                            }
+                          }, &group };
+            };
+
+  std::vector< Job > roots;
+
+  for ( std::size_t i = 0; i < numTasks; ++i )
+  {
+    if ( graph.nodes_[ i ].dependencyCount == 0 )
+    {
+      roots.push_back( makeJob( i ) );
+    }
+  }
+
+  _submit( roots );
+  _wait( group );
+  group.rethrowIfFailed( );
+} // JobSystem::run
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::getScratchArena
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+ScratchArena&
+JobSystem::getScratchArena( )
+{
+  if ( tlsOwner == this )
+  {
+    return *arenas_[ tlsIndex ];
+  }
+
+  std::lock_guard< std::mutex > lock( outsideArenaMutex_ );
+
+  std::unique_ptr< ScratchArena > &upArena = outsideArenas_[ std::this_thread::get_id( ) ];
+
+  if ( !upArena )
+  {
+    upArena.reset( new ScratchArena );
+  }
+
+  return *upArena;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::resetScratchArenas
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::resetScratchArenas( )
+{
+  for ( std::unique_ptr< ScratchArena > &upArena : arenas_ )
+  {
+    upArena->reset( );
+  }
+
+  std::lock_guard< std::mutex > lock( outsideArenaMutex_ );
+
+  for ( auto &threadArena : outsideArenas_ )
+  {
+    threadArena.second->reset( );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::getSerial
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+JobSystem&
+JobSystem::getSerial( )
+{
+  static JobSystem serial( 1 );
+
+  return serial;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::WaitGroup::fail
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::WaitGroup::fail( std::exception_ptr exception )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  if ( !exception_ )
+  {
+    exception_ = exception;
+  }
+
+  failed = true;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::WaitGroup::rethrowIfFailed
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::WaitGroup::rethrowIfFailed( )
+{
+  if ( failed )
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    std::rethrow_exception( exception_ );
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::_submit
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::_submit( std::vector< Job > &jobs )
+{
+  if ( numWorkers_ == 0 )
+  {
+    //
+    // nobody to hand the work to
+    //
+    for ( Job &job : jobs )
+    {
+      try
+      {
+        job.func( );
+      }
+      catch ( ... )
+      {
+        job.pGroup->fail( std::current_exception( ) );
+      }
+
+      job.pGroup->remaining.fetch_sub( 1, std::memory_order_acq_rel );
+    }
+    return;
+  }
+
+  {
+    WorkQueue &queue = *queues_[ _getThreadIndex( ) ];
+
+    std::lock_guard< std::mutex > lock( queue.mutex );
+
+    for ( Job &job : jobs )
+    {
+      queue.jobs.push_back( std::move( job ) );
+    }
+  }
+
+  queuedJobs_.fetch_add( jobs.size( ), std::memory_order_release );
+
+  //
+  // taking the lock orders the count above before
+  // any sleeping worker rechecks its wake condition
+  //
+  {
+    std::lock_guard< std::mutex > lock( sleepMutex_ );
+  }
+
+  if ( jobs.size( ) == 1 )
+  {
+    wakeCondition_.notify_one( );
+  }
+  else
+  {
+    wakeCondition_.notify_all( );
+  }
+} // JobSystem::_submit
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::_tryRunJob
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+bool
+JobSystem::_tryRunJob( const unsigned threadIndex )
+{
+  Job job{ nullptr, nullptr };
+  bool found = false;
+
+  //
+  // newest local work first while it's still in cache
+  //
+  {
+    WorkQueue &queue = *queues_[ threadIndex ];
+
+    std::lock_guard< std::mutex > lock( queue.mutex );
+
+    if ( !queue.jobs.empty( ) )
+    {
+      job = std::move( queue.jobs.back( ) );
+      queue.jobs.pop_back( );
+      found = true;
+    }
+  }
+
+  //
+  // otherwise steal the oldest (usually largest) job from another thread
+  //
+  const std::size_t numQueues = queues_.size( );
+
+  for ( std::size_t offset = 1; !found && offset < numQueues; ++offset )
+  {
+    WorkQueue &victim = *queues_[ ( threadIndex + offset ) % numQueues ];
+
+    std::lock_guard< std::mutex > lock( victim.mutex );
+
+    if ( !victim.jobs.empty( ) )
+    {
+      job = std::move( victim.jobs.front( ) );
+      victim.jobs.pop_front( );
+      found = true;
+    }
+  }
+
+  if ( !found )
+  {
+    return false;
+  }
+
+  queuedJobs_.fetch_sub( 1, std::memory_order_relaxed );
+
+  try
+  {
+    job.func( );
+  }
+  catch ( ... )
+  {
+    job.pGroup->fail( std::current_exception( ) );
+  }
+
+  // the waiting thread may destroy the group once this hits zero
+  job.pGroup->remaining.fetch_sub( 1, std::memory_order_acq_rel );
+
+  return true;
+} // JobSystem::_tryRunJob
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::_wait
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::_wait( WaitGroup &group )
+{
+  const unsigned threadIndex = _getThreadIndex( );
+
+  while ( group.remaining.load( std::memory_order_acquire ) > 0 )
+  {
+    if ( !_tryRunJob( threadIndex ) )
+    {
+      std::this_thread::yield( );
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::_workerLoop
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+JobSystem::_workerLoop( const unsigned threadIndex )
+{
+  tlsOwner = this;
+  tlsIndex = threadIndex;
+
+  while ( true )
+  {
+    if ( _tryRunJob( threadIndex ) )
+    {
+      continue;
+    }
+
+    std::unique_lock< std::mutex > lock( sleepMutex_ );
+
+    wakeCondition_.wait( lock, [ this ]
+                         {
+                           return !running_ || queuedJobs_.load( std::memory_order_acquire ) > 0;
+                         } );
+
+    if ( !running_ )
+    {
+      return;
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief JobSystem::_getThreadIndex
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+unsigned
+JobSystem::_getThreadIndex( ) const
+{
+  if ( tlsOwner == this )
+  {
+    return tlsIndex;
+  }
+
+  return static_cast< unsigned >( queues_.size( ) - 1 );
+}
+
+
+
+} // namespace shs
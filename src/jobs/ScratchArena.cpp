@@ -0,0 +1,128 @@
+#include "shared/core/ScratchArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace shs
+{
+
+
+
+/////////////////////////////////////////////
+/// \brief ScratchArena::ScratchArena
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+ScratchArena::ScratchArena( const std::size_t blockSize )
+  : blocks_   ( )
+  , blockSize_( std::max< std::size_t >( blockSize, 1 ) )
+  , offset_   ( 0 )
+  , bytesUsed_( 0 )
+{}
+
+
+
+/////////////////////////////////////////////
+/// \brief ScratchArena::allocate
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void*
+ScratchArena::allocate(
+                       const std::size_t bytes,
+                       const std::size_t alignment
+                       )
+{
+  if ( blocks_.empty( ) )
+  {
+    _addBlock( bytes + alignment );
+  }
+
+  Block *pBlock = &blocks_.back( );
+
+  std::uintptr_t address = reinterpret_cast< std::uintptr_t >( pBlock->memory.get( ) ) + offset_;
+  std::size_t padding    = ( alignment - address % alignment ) % alignment;
+
+  if ( offset_ + padding + bytes > pBlock->size )
+  {
+    _addBlock( bytes + alignment );
+
+    pBlock  = &blocks_.back( );
+    address = reinterpret_cast< std::uintptr_t >( pBlock->memory.get( ) );
+    padding = ( alignment - address % alignment ) % alignment;
+  }
+
+  void *pMemory = pBlock->memory.get( ) + offset_ + padding;
+
+  offset_    += padding + bytes;
+  bytesUsed_ += bytes;
+
+  return pMemory;
+} // ScratchArena::allocate
+
+
+
+/////////////////////////////////////////////
+/// \brief ScratchArena::reset
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ScratchArena::reset( )
+{
+  //
+  // merge overflow blocks so the next round
+  // of allocations fits in a single block
+  //
+  if ( blocks_.size( ) > 1 )
+  {
+    const std::size_t capacity = getCapacity( );
+
+    blocks_.clear( );
+    blockSize_ = std::max( blockSize_, capacity );
+  }
+
+  offset_    = 0;
+  bytesUsed_ = 0;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ScratchArena::getCapacity
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::size_t
+ScratchArena::getCapacity( ) const
+{
+  std::size_t capacity = 0;
+
+  for ( const Block &block : blocks_ )
+  {
+    capacity += block.size;
+  }
+
+  return capacity;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief ScratchArena::_addBlock
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+ScratchArena::_addBlock( const std::size_t minSize )
+{
+  const std::size_t size = std::max( blockSize_, minSize );
+
+  blocks_.push_back( Block{ std::unique_ptr< unsigned char[] >( new unsigned char[ size ] ), size } );
+  offset_ = 0;
+}
+
+
+
+} // namespace shs
@@ -0,0 +1,274 @@
+// JobSystemUnitTests.cpp
+#include "shared/core/JobSystem.hpp"
+#include "shared/core/World.hpp"
+
+#include "gmock/gmock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ParallelForVisitsEveryIndexOnce
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, ParallelForVisitsEveryIndexOnce )
+{
+  shs::JobSystem jobs( 4 );
+
+  EXPECT_GE( jobs.getNumThreads( ), 1u );
+
+  std::vector< std::atomic< unsigned > > visits( 10007 );
+
+  for ( std::atomic< unsigned > &visit : visits )
+  {
+    visit = 0;
+  }
+
+  jobs.parallelFor( 0, visits.size( ), [ &visits ]( const std::size_t i ) { ++visits[ i ]; } );
+
+  for ( const std::atomic< unsigned > &visit : visits )
+  {
+    ASSERT_EQ( 1u, visit );
+  }
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ParallelForRangeRespectsGrainSize
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, ParallelForRangeRespectsGrainSize )
+{
+  shs::JobSystem jobs( 3 );
+
+  std::atomic< std::size_t > total( 0 );
+  std::atomic< bool > chunksInRange( true );
+
+  jobs.parallelForRange(
+                        5,
+                        105,
+                        [ &total, &chunksInRange ]( const std::size_t begin, const std::size_t end )
+  {
+    chunksInRange = chunksInRange && begin < end && end - begin <= 8;
+    total        += end - begin;
+  },
+                        8
+                        );
+
+  EXPECT_TRUE( chunksInRange );
+  EXPECT_EQ( 100u, total );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief NestedParallelForDoesNotDeadlock
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, NestedParallelForDoesNotDeadlock )
+{
+  shs::JobSystem jobs( 2 );
+
+  std::atomic< unsigned > count( 0 );
+
+  jobs.parallelFor( 0, 16, [ &jobs, &count ]( const std::size_t )
+  {
+    jobs.parallelFor( 0, 16, [ &count ]( const std::size_t ) { ++count; }, 1 );
+  }, 1 );
+
+  EXPECT_EQ( 256u, count );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ExceptionsReachTheCaller
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, ExceptionsReachTheCaller )
+{
+  shs::JobSystem jobs( 4 );
+
+  EXPECT_THROW( jobs.parallelFor( 0, 100, [ ]( const std::size_t i )
+  {
+    if ( i == 77 )
+    {
+      throw std::runtime_error( "bad index" );
+    }
+  }, 1 ), std::runtime_error );
+
+  // still usable afterwards
+  std::atomic< unsigned > count( 0 );
+  jobs.parallelFor( 0, 100, [ &count ]( const std::size_t ) { ++count; } );
+  EXPECT_EQ( 100u, count );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief TaskGraphRunsDependenciesFirst
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, TaskGraphRunsDependenciesFirst )
+{
+  shs::JobSystem jobs( 4 );
+
+  std::atomic< unsigned > order( 0 );
+  unsigned a = 0, b = 0, c = 0, d = 0;
+
+  // diamond: b and c depend on a, d depends on b and c
+  shs::TaskGraph graph;
+
+  const shs::TaskGraph::TaskId taskA = graph.addTask( [ & ] { a = ++order; } );
+  const shs::TaskGraph::TaskId taskB = graph.addTask( [ & ] { b = ++order; }, { taskA } );
+  const shs::TaskGraph::TaskId taskC = graph.addTask( [ & ] { c = ++order; }, { taskA } );
+  graph.addTask( [ & ] { d = ++order; }, { taskB, taskC } );
+
+  EXPECT_EQ( 4u, graph.size( ) );
+
+  jobs.run( graph );
+
+  EXPECT_EQ( 1u, a );
+  EXPECT_LT( a, b );
+  EXPECT_LT( a, c );
+  EXPECT_EQ( 4u, d );
+
+  // graphs can be rerun
+  order = 0;
+  jobs.run( graph );
+  EXPECT_EQ( 4u, d );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief TaskGraphSkipsDependentsOfFailedTasks
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, TaskGraphSkipsDependentsOfFailedTasks )
+{
+  shs::JobSystem jobs( 2 );
+
+  bool dependentRan = false;
+
+  shs::TaskGraph graph;
+
+  const shs::TaskGraph::TaskId failing = graph.addTask( [ ] { throw std::runtime_error( "failed" ); } );
+  graph.addTask( [ &dependentRan ] { dependentRan = true; }, { failing } );
+
+  EXPECT_THROW( jobs.run( graph ), std::runtime_error );
+  EXPECT_FALSE( dependentRan );
+
+  EXPECT_THROW( graph.addTask( [ ] { }, { 5 } ), std::out_of_range );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ScratchArenasArePerThread
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, ScratchArenasArePerThread )
+{
+  shs::JobSystem jobs( 4 );
+
+  std::vector< std::uint64_t > sums( 64 );
+
+  jobs.parallelFor( 0, sums.size( ), [ &jobs, &sums ]( const std::size_t i )
+  {
+    shs::ScratchArena &arena = jobs.getScratchArena( );
+
+    std::uint64_t *pValues = arena.allocate< std::uint64_t >( 100 );
+
+    for ( std::uint64_t v = 0; v < 100; ++v )
+    {
+      pValues[ v ] = v * i;
+    }
+
+    sums[ i ] = std::accumulate( pValues, pValues + 100, std::uint64_t( 0 ) );
+  }, 1 );
+
+  for ( std::size_t i = 0; i < sums.size( ); ++i )
+  {
+    ASSERT_EQ( 4950u * i, sums[ i ] );
+  }
+
+  jobs.resetScratchArenas( );
+  EXPECT_EQ( 0u, jobs.getScratchArena( ).getBytesUsed( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief OutsideThreadsGetTheirOwnScratchArenas
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, OutsideThreadsGetTheirOwnScratchArenas )
+{
+  shs::JobSystem jobs( 2 );
+
+  shs::ScratchArena *pArenas[ 2 ] = { nullptr, nullptr };
+
+  std::thread first( [ &jobs, &pArenas ] { pArenas[ 0 ] = &jobs.getScratchArena( ); } );
+  std::thread second( [ &jobs, &pArenas ] { pArenas[ 1 ] = &jobs.getScratchArena( ); } );
+
+  first.join( );
+  second.join( );
+
+  EXPECT_NE( pArenas[ 0 ], pArenas[ 1 ] );
+  EXPECT_NE( pArenas[ 0 ], &jobs.getScratchArena( ) );
+  EXPECT_EQ( &jobs.getScratchArena( ), &jobs.getScratchArena( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ScratchArenaAlignsAndGrows
+/////////////////////////////////////////////////////////////////
+TEST( ScratchArenaUnitTests, ScratchArenaAlignsAndGrows )
+{
+  shs::ScratchArena arena( 64 );
+
+  arena.allocate( 3, 1 );
+
+  void *pAligned = arena.allocate( 16, 32 );
+  EXPECT_EQ( 0u, reinterpret_cast< std::uintptr_t >( pAligned ) % 32 );
+
+  // overflows into a second block
+  arena.allocate( 100 );
+  EXPECT_EQ( 119u, arena.getBytesUsed( ) );
+  EXPECT_GT( arena.getCapacity( ), 64u );
+
+  // merged into one block on reset
+  const std::size_t capacity = arena.getCapacity( );
+  arena.reset( );
+  arena.allocate( 100 );
+  EXPECT_GE( arena.getCapacity( ), capacity );
+  EXPECT_EQ( 100u, arena.getBytesUsed( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief WorldFallsBackToSerialJobs
+/////////////////////////////////////////////////////////////////
+TEST( JobSystemUnitTests, WorldFallsBackToSerialJobs )
+{
+  shs::World world;
+
+  EXPECT_EQ( 1u, world.getJobSystem( ).getNumThreads( ) );
+
+  unsigned count = 0;
+  world.getJobSystem( ).parallelFor( 0, 10, [ &count ]( const std::size_t ) { ++count; } );
+  EXPECT_EQ( 10u, count );
+
+  shs::JobSystem jobs( 2 );
+  world.setJobSystem( &jobs );
+  EXPECT_EQ( &jobs, &world.getJobSystem( ) );
+}
+
+
+
+} // namespace
@@ -0,0 +1,221 @@
+#include "shared/core/BuddyAllocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace shs
+{
+
+
+namespace
+{
+
+bool
+isPowerOfTwo( const std::uint64_t value )
+{
+  return value != 0 && ( value & ( value - 1 ) ) == 0;
+}
+
+
+std::uint32_t
+floorLog2( std::uint64_t value )
+{
+  std::uint32_t result = 0;
+
+  while ( value >>= 1 )
+  {
+    ++result;
+  }
+
+  return result;
+}
+
+} // namespace
+
+
+constexpr std::uint64_t BuddyAllocator::INVALID_OFFSET;
+
+
+
+/////////////////////////////////////////////
+/// \brief BuddyAllocator::BuddyAllocator
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+BuddyAllocator::BuddyAllocator(
+                               const std::uint64_t size,
+                               const std::uint64_t minRangeSize
+                               )
+  : minOrder_ ( floorLog2( minRangeSize ) )
+  , maxOrder_ ( floorLog2( size ) )
+  , bytesUsed_( 0 )
+{
+  if ( !isPowerOfTwo( size ) || !isPowerOfTwo( minRangeSize ) || minRangeSize > size )
+  {
+    throw std::invalid_argument( "BuddyAllocator sizes must be powers of two with minRangeSize <= size" );
+  }
+
+  freeRanges_.resize( maxOrder_ - minOrder_ + 1 );
+  freeRanges_.back( ).insert( 0 );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief BuddyAllocator::allocate
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::uint64_t
+BuddyAllocator::allocate(
+                         const std::uint64_t size,
+                         const std::uint64_t alignment
+                         )
+{
+  if ( size == 0 || size > getSize( ) || alignment > getSize( ) )
+  {
+    return INVALID_OFFSET;
+  }
+
+  // ranges are aligned to their own size
+  const std::uint32_t order = _orderFor( std::max( size, alignment ) );
+
+  std::uint32_t available = order;
+
+  while ( available <= maxOrder_ && freeRanges_[ available - minOrder_ ].empty( ) )
+  {
+    ++available;
+  }
+
+  if ( available > maxOrder_ )
+  {
+    return INVALID_OFFSET;
+  }
+
+  std::set< std::uint64_t > &freeRanges = freeRanges_[ available - minOrder_ ];
+
+  const std::uint64_t offset = *freeRanges.begin( );
+  freeRanges.erase( freeRanges.begin( ) );
+
+  //
+  // split down to the requested order, keeping the
+  // low half and freeing the high half each time
+  //
+  while ( available > order )
+  {
+    --available;
+    freeRanges_[ available - minOrder_ ].insert( offset + ( std::uint64_t( 1 ) << available ) );
+  }
+
+  allocated_[ offset ] = order;
+  bytesUsed_          += std::uint64_t( 1 ) << order;
+
+  return offset;
+} // BuddyAllocator::allocate
+
+
+
+/////////////////////////////////////////////
+/// \brief BuddyAllocator::free
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+BuddyAllocator::free( const std::uint64_t offset )
+{
+  auto it = allocated_.find( offset );
+
+  if ( it == allocated_.end( ) )
+  {
+    throw std::invalid_argument( "BuddyAllocator::free called with an unallocated offset" );
+  }
+
+  std::uint32_t order = it->second;
+  std::uint64_t range = offset;
+
+  allocated_.erase( it );
+  bytesUsed_ -= std::uint64_t( 1 ) << order;
+
+  //
+  // merge with the buddy for as long as it is free
+  //
+  while ( order < maxOrder_ )
+  {
+    std::set< std::uint64_t > &freeRanges = freeRanges_[ order - minOrder_ ];
+
+    auto buddy = freeRanges.find( range ^ ( std::uint64_t( 1 ) << order ) );
+
+    if ( buddy == freeRanges.end( ) )
+    {
+      break;
+    }
+
+    freeRanges.erase( buddy );
+    range &= ~( std::uint64_t( 1 ) << order );
+    ++order;
+  }
+
+  freeRanges_[ order - minOrder_ ].insert( range );
+} // BuddyAllocator::free
+
+
+
+/////////////////////////////////////////////
+/// \brief BuddyAllocator::getRangeSize
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::uint64_t
+BuddyAllocator::getRangeSize( const std::uint64_t offset ) const
+{
+  auto it = allocated_.find( offset );
+
+  return ( it == allocated_.end( ) ) ? 0 : std::uint64_t( 1 ) << it->second;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief BuddyAllocator::getLargestFreeRange
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::uint64_t
+BuddyAllocator::getLargestFreeRange( ) const
+{
+  for ( std::uint32_t order = maxOrder_ + 1; order > minOrder_; --order )
+  {
+    if ( !freeRanges_[ order - 1 - minOrder_ ].empty( ) )
+    {
+      return std::uint64_t( 1 ) << ( order - 1 );
+    }
+  }
+
+  return 0;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief BuddyAllocator::_orderFor
+/// \return smallest order holding size, at least minOrder_
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::uint32_t
+BuddyAllocator::_orderFor( const std::uint64_t size ) const
+{
+  std::uint32_t order = minOrder_;
+
+  while ( ( std::uint64_t( 1 ) << order ) < size )
+  {
+    ++order;
+  }
+
+  return order;
+}
+
+
+
+} // namespace shs
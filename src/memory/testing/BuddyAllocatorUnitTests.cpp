@@ -0,0 +1,153 @@
+// BuddyAllocatorUnitTests.cpp
+#include "shared/core/BuddyAllocator.hpp"
+
+#include "gmock/gmock.h"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+namespace
+{
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief RangesAreRoundedAndAligned
+/////////////////////////////////////////////////////////////////
+TEST( BuddyAllocatorUnitTests, RangesAreRoundedAndAligned )
+{
+  shs::BuddyAllocator allocator( 1024, 64 );
+
+  const std::uint64_t small   = allocator.allocate( 10 );
+  const std::uint64_t medium  = allocator.allocate( 100 );
+  const std::uint64_t aligned = allocator.allocate( 10, 256 );
+
+  EXPECT_EQ( 0u,   small );
+  EXPECT_EQ( 128u, medium );
+  EXPECT_EQ( 256u, aligned );
+
+  EXPECT_EQ( 64u,  allocator.getRangeSize( small ) );
+  EXPECT_EQ( 128u, allocator.getRangeSize( medium ) );
+  EXPECT_EQ( 256u, allocator.getRangeSize( aligned ) );
+  EXPECT_EQ( 0u,   allocator.getRangeSize( 64 ) );
+
+  EXPECT_EQ( 448u, allocator.getBytesUsed( ) );
+  EXPECT_EQ( 3u,   allocator.getAllocationCount( ) );
+  EXPECT_EQ( 512u, allocator.getLargestFreeRange( ) );
+
+  EXPECT_EQ( shs::BuddyAllocator::INVALID_OFFSET, allocator.allocate( 1024 ) );
+  EXPECT_EQ( shs::BuddyAllocator::INVALID_OFFSET, allocator.allocate( 0 ) );
+
+  EXPECT_THROW( allocator.free( 64 ), std::invalid_argument );
+  EXPECT_THROW( shs::BuddyAllocator( 1000, 64 ), std::invalid_argument );
+  EXPECT_THROW( shs::BuddyAllocator( 64, 128 ), std::invalid_argument );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief FreedBuddiesMerge
+/////////////////////////////////////////////////////////////////
+TEST( BuddyAllocatorUnitTests, FreedBuddiesMerge )
+{
+  shs::BuddyAllocator allocator( 1024, 64 );
+
+  std::vector< std::uint64_t > offsets;
+
+  for ( int i = 0; i < 16; ++i )
+  {
+    offsets.push_back( allocator.allocate( 64 ) );
+  }
+
+  EXPECT_EQ( shs::BuddyAllocator::INVALID_OFFSET, allocator.allocate( 1 ) );
+  EXPECT_EQ( 0u, allocator.getLargestFreeRange( ) );
+
+  // every other range free leaves nothing larger than 64 bytes
+  for ( std::size_t i = 0; i < offsets.size( ); i += 2 )
+  {
+    allocator.free( offsets[ i ] );
+  }
+
+  EXPECT_EQ( 64u, allocator.getLargestFreeRange( ) );
+  EXPECT_EQ( shs::BuddyAllocator::INVALID_OFFSET, allocator.allocate( 128 ) );
+
+  for ( std::size_t i = 1; i < offsets.size( ); i += 2 )
+  {
+    allocator.free( offsets[ i ] );
+  }
+
+  EXPECT_TRUE( allocator.isEmpty( ) );
+  EXPECT_EQ( 0u,    allocator.getBytesUsed( ) );
+  EXPECT_EQ( 1024u, allocator.getLargestFreeRange( ) );
+  EXPECT_EQ( 0u,    allocator.allocate( 1024 ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief RandomUseNeverOverlaps
+/////////////////////////////////////////////////////////////////
+TEST( BuddyAllocatorUnitTests, RandomUseNeverOverlaps )
+{
+  constexpr std::uint64_t size = 1 << 20;
+
+  shs::BuddyAllocator allocator( size, 256 );
+
+  std::mt19937 generator( 7 );
+  std::uniform_int_distribution< std::uint64_t > sizes( 1, 32 * 1024 );
+
+  std::vector< std::uint64_t > offsets;
+
+  for ( int i = 0; i < 2000; ++i )
+  {
+    if ( offsets.empty( ) || generator( ) % 3 != 0 )
+    {
+      const std::uint64_t offset = allocator.allocate( sizes( generator ) );
+
+      if ( offset != shs::BuddyAllocator::INVALID_OFFSET )
+      {
+        offsets.push_back( offset );
+      }
+    }
+    else
+    {
+      const std::size_t index = generator( ) % offsets.size( );
+
+      allocator.free( offsets[ index ] );
+      offsets[ index ] = offsets.back( );
+      offsets.pop_back( );
+    }
+
+    std::vector< bool > pages( size / 256, false );
+    std::uint64_t used = 0;
+
+    for ( const std::uint64_t offset : offsets )
+    {
+      const std::uint64_t rangeSize = allocator.getRangeSize( offset );
+
+      ASSERT_EQ( 0u, offset % rangeSize );
+      ASSERT_LE( offset + rangeSize, size );
+
+      for ( std::uint64_t page = offset / 256; page < ( offset + rangeSize ) / 256; ++page )
+      {
+        ASSERT_FALSE( pages[ page ] );
+        pages[ page ] = true;
+      }
+
+      used += rangeSize;
+    }
+
+    ASSERT_EQ( used, allocator.getBytesUsed( ) );
+  }
+
+  for ( const std::uint64_t offset : offsets )
+  {
+    allocator.free( offset );
+  }
+
+  EXPECT_EQ( size, allocator.getLargestFreeRange( ) );
+}
+
+
+} // namespace
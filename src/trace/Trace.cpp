@@ -0,0 +1,528 @@
+#include "shared/core/Trace.hpp"
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace shs
+{
+
+
+namespace
+{
+
+constexpr std::size_t EVENTS_PER_CHUNK = 4096;
+
+constexpr std::size_t DEFAULT_MAX_EVENTS_PER_THREAD = std::size_t( 1 ) << 20;
+
+// chunks a thread fills before collecting its own events
+constexpr std::size_t CHUNKS_PER_COLLECT = 16;
+
+
+///
+/// \brief steadyNs
+/// \return steady clock time in nanoseconds
+///
+std::uint64_t
+steadyNs( )
+{
+  return static_cast< std::uint64_t >(
+    std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::steady_clock::now( ).time_since_epoch( ) ).count( ) );
+}
+
+
+///
+/// \brief writeJsonString writes str quoted and escaped
+///
+void
+writeJsonString(
+                std::ostream      &out,
+                const std::string &str
+                )
+{
+  out << '"';
+
+  for ( const char c : str )
+  {
+    switch ( c )
+    {
+    case '"':
+      out << "\\\"";
+      break;
+
+    case '\\':
+      out << "\\\\";
+      break;
+
+    default:
+
+      if ( static_cast< unsigned char >( c ) < 0x20 )
+      {
+        out << ' ';
+      }
+      else
+      {
+        out << c;
+      }
+      break;
+    } // switch
+  }
+
+  out << '"';
+}
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief The Tracer::ThreadBuffer class
+///
+///        Single producer list of chunks. The owning thread
+///        fills the tail chunk and publishes each event with a
+///        release store of the chunk's count. The collector,
+///        holding the tracer mutex, reads up to that count and
+///        frees chunks once they are full, read, and the
+///        producer has moved past them.
+///
+/////////////////////////////////////////////
+class Tracer::ThreadBuffer
+{
+
+public:
+
+  struct Chunk
+  {
+    Event events[ EVENTS_PER_CHUNK ];
+    std::atomic< std::size_t > count;
+    std::atomic< Chunk* > pNext;
+
+    Chunk( )
+      : count( 0 )
+      , pNext( nullptr )
+    {}
+  };
+
+
+  explicit
+  ThreadBuffer( const std::size_t threadId )
+    : dropped( 0 )
+    , threadId_( threadId )
+    , pHead_( new Chunk )
+    , pTail_( pHead_ )
+    , chunksSinceCollect_( 0 )
+    , read_( 0 )
+  {}
+
+
+  ~ThreadBuffer( )
+  {
+    while ( pHead_ )
+    {
+      Chunk *pNext = pHead_->pNext.load( std::memory_order_acquire );
+      delete pHead_;
+      pHead_ = pNext;
+    }
+  }
+
+
+  ///
+  /// \brief push, owning thread only
+  /// \return true once enough chunks were filled that the
+  ///         thread should collect its own events
+  ///
+  bool
+  push( const Event &event )
+  {
+    std::size_t count = pTail_->count.load( std::memory_order_relaxed );
+
+    if ( count == EVENTS_PER_CHUNK )
+    {
+      Chunk *pChunk = new Chunk;
+      pTail_->pNext.store( pChunk, std::memory_order_release );
+      pTail_ = pChunk;
+      count  = 0;
+
+      ++chunksSinceCollect_;
+    }
+
+    pTail_->events[ count ] = event;
+    pTail_->count.store( count + 1, std::memory_order_release );
+
+    if ( chunksSinceCollect_ < CHUNKS_PER_COLLECT )
+    {
+      return false;
+    }
+
+    chunksSinceCollect_ = 0;
+    return true;
+  }
+
+
+  ///
+  /// \brief collect, tracer mutex held
+  ///
+  void
+  collect( const std::size_t maxEvents )
+  {
+    while ( true )
+    {
+      const std::size_t count = pHead_->count.load( std::memory_order_acquire );
+
+      collected.insert( collected.end( ), pHead_->events + read_, pHead_->events + count );
+      read_ = count;
+
+      Chunk *pNext = pHead_->pNext.load( std::memory_order_acquire );
+
+      if ( count < EVENTS_PER_CHUNK || !pNext )
+      {
+        break;
+      }
+
+      delete pHead_;
+      pHead_ = pNext;
+      read_  = 0;
+    }
+
+    if ( collected.size( ) > maxEvents )
+    {
+      const std::size_t excess = collected.size( ) - maxEvents;
+
+      collected.erase( collected.begin( ), collected.begin( ) + static_cast< std::ptrdiff_t >( excess ) );
+      dropped += excess;
+    }
+  }
+
+
+  std::size_t
+  getThreadId( ) const { return threadId_; }
+
+
+  std::string name;              ///< tracer mutex held
+  std::deque< Event > collected; ///< tracer mutex held, oldest first
+  std::size_t dropped;           ///< tracer mutex held
+
+
+private:
+
+  std::size_t threadId_;
+
+  Chunk *pHead_; ///< collector side
+  Chunk *pTail_; ///< producer side
+  std::size_t chunksSinceCollect_; ///< producer side
+  std::size_t read_;
+
+};
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::get
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+Tracer&
+Tracer::get( )
+{
+  static Tracer tracer;
+
+  return tracer;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::Tracer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+Tracer::Tracer( )
+  : enabled_( true )
+  , startNs_( steadyNs( ) )
+  , maxEventsPerThread_( DEFAULT_MAX_EVENTS_PER_THREAD )
+{}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::~Tracer
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+Tracer::~Tracer( )
+{
+  if ( !outputFile_.empty( ) )
+  {
+    try
+    {
+      writeChromeTrace( outputFile_ );
+    }
+    catch ( const std::exception &e )
+    {
+      std::cerr << "Failed to write trace: " << e.what( ) << std::endl;
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::now
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::uint64_t
+Tracer::now( ) const
+{
+  return steadyNs( ) - startNs_;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::record
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::record(
+               const char         *name,
+               const std::uint64_t startNs,
+               const std::uint64_t endNs
+               )
+{
+  ThreadBuffer &buffer = _getThreadBuffer( );
+
+  if ( buffer.push( Event{ name, startNs, endNs - startNs } ) )
+  {
+    // keeps memory bounded between writes, skipped if a write is under way
+    std::unique_lock< std::mutex > lock( mutex_, std::try_to_lock );
+
+    if ( lock.owns_lock( ) )
+    {
+      buffer.collect( maxEventsPerThread_ );
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::setThreadName
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::setThreadName( const std::string &name )
+{
+  ThreadBuffer &buffer = _getThreadBuffer( );
+
+  std::lock_guard< std::mutex > lock( mutex_ );
+  buffer.name = name;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::setOutputFile
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::setOutputFile( const std::string &filePath )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+  outputFile_ = filePath;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::writeChromeTrace
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::writeChromeTrace( const std::string &filePath )
+{
+  std::ofstream file( filePath, std::ios::out | std::ios::trunc );
+
+  if ( !file.is_open( ) )
+  {
+    throw std::runtime_error( "Failed to open trace file " + filePath );
+  }
+
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  _collect( );
+
+  // chrome trace timestamps are in microseconds
+  file << std::fixed << std::setprecision( 3 );
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+
+  for ( const auto &upBuffer : buffers_ )
+  {
+    if ( !upBuffer->name.empty( ) )
+    {
+      file << ( first ? "\n" : ",\n" )
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << upBuffer->getThreadId( )
+           << ",\"args\":{\"name\":";
+      writeJsonString( file, upBuffer->name );
+      file << "}}";
+      first = false;
+    }
+
+    for ( const Event &event : upBuffer->collected )
+    {
+      file << ( first ? "\n" : ",\n" ) << "{\"name\":";
+      writeJsonString( file, event.name );
+      file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << upBuffer->getThreadId( )
+           << ",\"ts\":" << static_cast< double >( event.startNs ) * 1.0e-3
+           << ",\"dur\":" << static_cast< double >( event.durationNs ) * 1.0e-3
+           << "}";
+      first = false;
+    }
+  }
+
+  file << "\n]}\n";
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::setMaxEventsPerThread
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::setMaxEventsPerThread( const std::size_t maxEvents )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+  maxEventsPerThread_ = maxEvents;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::getDroppedEventCount
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::size_t
+Tracer::getDroppedEventCount( )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  _collect( );
+
+  std::size_t dropped = 0;
+
+  for ( const auto &upBuffer : buffers_ )
+  {
+    dropped += upBuffer->dropped;
+  }
+
+  return dropped;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::getEvents
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+std::vector< std::vector< Tracer::Event > >
+Tracer::getEvents( )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  _collect( );
+
+  std::vector< std::vector< Event > > events;
+
+  for ( const auto &upBuffer : buffers_ )
+  {
+    events.emplace_back( upBuffer->collected.begin( ), upBuffer->collected.end( ) );
+  }
+
+  return events;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::clear
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::clear( )
+{
+  std::lock_guard< std::mutex > lock( mutex_ );
+
+  _collect( );
+
+  for ( const auto &upBuffer : buffers_ )
+  {
+    upBuffer->collected.clear( );
+    upBuffer->dropped = 0;
+  }
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::_getThreadBuffer
+///
+///        Registers a buffer on a thread's first event.
+///        Buffers belong to the tracer, so events from
+///        threads that have exited can still be written.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+Tracer::ThreadBuffer&
+Tracer::_getThreadBuffer( )
+{
+  static thread_local ThreadBuffer *pBuffer = nullptr;
+
+  if ( !pBuffer )
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+
+    buffers_.emplace_back( new ThreadBuffer( buffers_.size( ) ) );
+    pBuffer = buffers_.back( ).get( );
+  }
+
+  return *pBuffer;
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief Tracer::_collect
+///
+///        Moves published events out of every thread's
+///        chunks. Tracer mutex must be held.
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+Tracer::_collect( )
+{
+  for ( const auto &upBuffer : buffers_ )
+  {
+    upBuffer->collect( maxEventsPerThread_ );
+  }
+}
+
+
+
+} // namespace shs
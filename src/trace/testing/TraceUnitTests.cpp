@@ -0,0 +1,187 @@
+// TraceUnitTests.cpp
+#include "shared/core/Trace.hpp"
+
+#include "gmock/gmock.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+
+///
+/// \brief countEvents
+/// \return number of events named name in each thread
+///
+std::vector< std::size_t >
+countEvents( const std::string &name )
+{
+  std::vector< std::size_t > counts;
+
+  for ( const auto &threadEvents : shs::Tracer::get( ).getEvents( ) )
+  {
+    std::size_t count = 0;
+
+    for ( const shs::Tracer::Event &event : threadEvents )
+    {
+      count += ( name == event.name ) ? 1u : 0u;
+    }
+
+    if ( count > 0 )
+    {
+      counts.push_back( count );
+    }
+  }
+
+  return counts;
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief EventsAreKeptPerThread
+/////////////////////////////////////////////////////////////////
+TEST( TraceUnitTests, EventsAreKeptPerThread )
+{
+  shs::Tracer::get( ).clear( );
+
+  // more than one chunk per thread
+  constexpr std::size_t eventsPerThread = 10000;
+  constexpr std::size_t threadCount     = 4;
+
+  std::vector< std::thread > threads;
+
+  for ( std::size_t t = 0; t < threadCount; ++t )
+  {
+    threads.emplace_back( [ ]
+    {
+      for ( std::size_t i = 0; i < eventsPerThread; ++i )
+      {
+        shs::TraceScope scope( "threadWork" );
+      }
+    } );
+  }
+
+  // reading while threads are still recording only sees published events
+  EXPECT_GE( threadCount, countEvents( "threadWork" ).size( ) );
+
+  for ( auto &thread : threads )
+  {
+    thread.join( );
+  }
+
+  EXPECT_EQ( std::vector< std::size_t >( threadCount, eventsPerThread ), countEvents( "threadWork" ) );
+
+  shs::Tracer::get( ).clear( );
+
+  EXPECT_TRUE( countEvents( "threadWork" ).empty( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief DisabledTracerDropsEvents
+/////////////////////////////////////////////////////////////////
+TEST( TraceUnitTests, DisabledTracerDropsEvents )
+{
+  shs::Tracer::get( ).clear( );
+  shs::Tracer::get( ).setEnabled( false );
+
+  {
+    shs::TraceScope scope( "disabled" );
+  }
+
+  shs::Tracer::get( ).setEnabled( true );
+
+  {
+    shs::TraceScope scope( "enabled" );
+  }
+
+  EXPECT_TRUE( countEvents( "disabled" ).empty( ) );
+  EXPECT_EQ( std::vector< std::size_t >{ 1 }, countEvents( "enabled" ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ChromeTraceContainsEvents
+/////////////////////////////////////////////////////////////////
+TEST( TraceUnitTests, ChromeTraceContainsEvents )
+{
+  shs::Tracer &tracer = shs::Tracer::get( );
+
+  tracer.clear( );
+  tracer.setThreadName( "main \"thread\"" );
+  tracer.record( "outer", 1000, 5000 );
+  tracer.record( "inner\\", 2000, 3500 );
+
+  const std::string filePath = "shs_trace_test.json";
+
+  tracer.writeChromeTrace( filePath );
+
+  std::ifstream file( filePath );
+  ASSERT_TRUE( file.is_open( ) );
+
+  std::stringstream contents;
+  contents << file.rdbuf( );
+  file.close( );
+  std::remove( filePath.c_str( ) );
+
+  const std::string json = contents.str( );
+
+  EXPECT_EQ( 0u, json.find( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" ) );
+  EXPECT_NE( std::string::npos, json.find( "\"args\":{\"name\":\"main \\\"thread\\\"\"}" ) );
+  EXPECT_NE( std::string::npos, json.find( "{\"name\":\"outer\",\"ph\":\"X\"" ) );
+  EXPECT_NE( std::string::npos, json.find( "\"ts\":1.000,\"dur\":4.000}" ) );
+  EXPECT_NE( std::string::npos, json.find( "{\"name\":\"inner\\\\\",\"ph\":\"X\"" ) );
+  EXPECT_NE( std::string::npos, json.find( "\"ts\":2.000,\"dur\":1.500}" ) );
+  EXPECT_EQ( json.size( ) - 4, json.rfind( "\n]}\n" ) );
+
+  tracer.clear( );
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief OnlyTheNewestEventsAreKept
+/////////////////////////////////////////////////////////////////
+TEST( TraceUnitTests, OnlyTheNewestEventsAreKept )
+{
+  shs::Tracer &tracer = shs::Tracer::get( );
+
+  tracer.clear( );
+  tracer.setMaxEventsPerThread( 10 );
+
+  for ( std::uint64_t i = 0; i < 25; ++i )
+  {
+    tracer.record( "capped", i, i + 1 );
+  }
+
+  const std::vector< std::vector< shs::Tracer::Event > > events = tracer.getEvents( );
+
+  EXPECT_EQ( std::vector< std::size_t >{ 10 }, countEvents( "capped" ) );
+  EXPECT_EQ( 15u, tracer.getDroppedEventCount( ) );
+
+  for ( const auto &threadEvents : events )
+  {
+    if ( !threadEvents.empty( ) )
+    {
+      EXPECT_EQ( 15u, threadEvents.front( ).startNs );
+    }
+  }
+
+  tracer.setMaxEventsPerThread( std::size_t( 1 ) << 20 );
+  tracer.clear( );
+
+  EXPECT_EQ( 0u, tracer.getDroppedEventCount( ) );
+}
+
+
+} // namespace
@@ -0,0 +1,128 @@
+#include "shared/core/TransformBatch.hpp"
+
+#include "TransformBatchKernel.hpp"
+
+#if defined( SHS_SIMD_KERNELS ) && defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+
+namespace shs
+{
+
+
+namespace
+{
+
+///
+/// \brief detectSimdLevel
+///
+TransformBatch::SimdLevel
+detectSimdLevel( )
+{
+#if defined( SHS_SIMD_KERNELS ) && defined( _MSC_VER )
+
+  int info[ 4 ];
+  __cpuid( info, 1 );
+
+  const bool osSavesYmm = ( info[ 2 ] & ( 1 << 27 ) ) != 0 && ( _xgetbv( 0 ) & 0x6 ) == 0x6;
+  const bool cpuHasAvx  = ( info[ 2 ] & ( 1 << 28 ) ) != 0;
+
+  return ( osSavesYmm && cpuHasAvx ) ? TransformBatch::AVX : TransformBatch::SSE;
+
+#elif defined( SHS_SIMD_KERNELS )
+
+  // also checks the OS saves AVX registers
+  __builtin_cpu_init( );
+
+  if ( __builtin_cpu_supports( "avx" ) )
+  {
+    return TransformBatch::AVX;
+  }
+
+  return __builtin_cpu_supports( "sse2" ) ? TransformBatch::SSE : TransformBatch::SCALAR;
+
+#else
+
+  return TransformBatch::SCALAR;
+
+#endif
+} // detectSimdLevel
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief TransformBatch::update
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TransformBatch::update(
+                       const Arrays     &arrays,
+                       const std::size_t begin,
+                       const std::size_t end,
+                       const double      timestep
+                       )
+{
+  update( arrays, begin, end, timestep, getSupportedSimdLevel( ) );
+}
+
+
+
+/////////////////////////////////////////////
+/// \brief TransformBatch::update
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+TransformBatch::update(
+                       const Arrays     &arrays,
+                       const std::size_t begin,
+                       const std::size_t end,
+                       const double      timestep,
+                       const SimdLevel   level
+                       )
+{
+  const float dt = static_cast< float >( timestep );
+
+  switch ( level < getSupportedSimdLevel( ) ? level : getSupportedSimdLevel( ) )
+  {
+#ifdef SHS_SIMD_KERNELS
+
+  case AVX:
+    simd::transformRangeAvx( arrays, begin, end, dt );
+    break;
+
+  case SSE:
+    simd::transformRangeSse( arrays, begin, end, dt );
+    break;
+
+#endif
+
+  case SCALAR:
+  default:
+    simd::transformRange< simd::ScalarLane >( arrays, begin, end, dt );
+    break;
+  }
+} // TransformBatch::update
+
+
+
+/////////////////////////////////////////////
+/// \brief TransformBatch::getSupportedSimdLevel
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+TransformBatch::SimdLevel
+TransformBatch::getSupportedSimdLevel( )
+{
+  static const SimdLevel level = detectSimdLevel( );
+
+  return level;
+}
+
+
+
+} // namespace shs
@@ -0,0 +1,146 @@
+#include "TransformBatchKernel.hpp"
+
+#include <immintrin.h>
+
+
+namespace shs
+{
+
+namespace simd
+{
+
+namespace
+{
+
+
+///
+/// \brief Eight floats per AVX register. Only this file is
+///        built with AVX enabled.
+///
+struct AvxLane
+{
+  static constexpr std::size_t WIDTH = 8;
+
+  struct Mask
+  {
+    __m256 m;
+  };
+
+  __m256 v;
+
+  static AvxLane
+  set1( const float x ) { return AvxLane{ _mm256_set1_ps( x ) }; }
+
+  static AvxLane
+  load( const float *p ) { return AvxLane{ _mm256_loadu_ps( p ) }; }
+
+  static void
+  store(
+        float        *p,
+        const AvxLane a
+        ) { _mm256_storeu_ps( p, a.v ); }
+
+  static void
+  addRevolutions(
+                 std::int32_t *p,
+                 const AvxLane turns
+                 )
+  {
+    //
+    // AVX has no 256 bit integer add, so add each half
+    //
+    const __m256i whole = _mm256_cvttps_epi32( turns.v );
+
+    __m128i *pInts = reinterpret_cast< __m128i* >( p );
+
+    _mm_storeu_si128( pInts,     _mm_add_epi32( _mm_loadu_si128( pInts ),     _mm256_castsi256_si128( whole ) ) );
+    _mm_storeu_si128( pInts + 1, _mm_add_epi32( _mm_loadu_si128( pInts + 1 ), _mm256_extractf128_si256( whole, 1 ) ) );
+  }
+
+  static void
+  storeMatrices(
+                float *p,
+                const AvxLane( &m )[ 16 ]
+                )
+  {
+    //
+    // m[ 4 * column + row ] holds one element for eight entities;
+    // each 128 bit half transposes into four entity columns
+    //
+    for ( int column = 0; column < 4; ++column )
+    {
+      __m128 lo0 = _mm256_castps256_ps128( m[ 4 * column + 0 ].v );
+      __m128 lo1 = _mm256_castps256_ps128( m[ 4 * column + 1 ].v );
+      __m128 lo2 = _mm256_castps256_ps128( m[ 4 * column + 2 ].v );
+      __m128 lo3 = _mm256_castps256_ps128( m[ 4 * column + 3 ].v );
+
+      __m128 hi0 = _mm256_extractf128_ps( m[ 4 * column + 0 ].v, 1 );
+      __m128 hi1 = _mm256_extractf128_ps( m[ 4 * column + 1 ].v, 1 );
+      __m128 hi2 = _mm256_extractf128_ps( m[ 4 * column + 2 ].v, 1 );
+      __m128 hi3 = _mm256_extractf128_ps( m[ 4 * column + 3 ].v, 1 );
+
+      _MM_TRANSPOSE4_PS( lo0, lo1, lo2, lo3 );
+      _MM_TRANSPOSE4_PS( hi0, hi1, hi2, hi3 );
+
+      float *pColumn = p + 4 * column;
+
+      _mm_storeu_ps( pColumn,       lo0 );
+      _mm_storeu_ps( pColumn + 16,  lo1 );
+      _mm_storeu_ps( pColumn + 32,  lo2 );
+      _mm_storeu_ps( pColumn + 48,  lo3 );
+      _mm_storeu_ps( pColumn + 64,  hi0 );
+      _mm_storeu_ps( pColumn + 80,  hi1 );
+      _mm_storeu_ps( pColumn + 96,  hi2 );
+      _mm_storeu_ps( pColumn + 112, hi3 );
+    }
+  }
+
+};
+
+
+inline AvxLane operator+( AvxLane a, AvxLane b ) { return AvxLane{ _mm256_add_ps( a.v, b.v ) }; }
+inline AvxLane operator-( AvxLane a, AvxLane b ) { return AvxLane{ _mm256_sub_ps( a.v, b.v ) }; }
+inline AvxLane operator*( AvxLane a, AvxLane b ) { return AvxLane{ _mm256_mul_ps( a.v, b.v ) }; }
+inline AvxLane operator-( AvxLane a ) { return AvxLane{ _mm256_xor_ps( a.v, _mm256_set1_ps( -0.0f ) ) }; }
+
+inline AvxLane floor( AvxLane a ) { return AvxLane{ _mm256_floor_ps( a.v ) }; }
+
+inline AvxLane::Mask cmpEq( AvxLane a, AvxLane b ) { return AvxLane::Mask{ _mm256_cmp_ps( a.v, b.v, _CMP_EQ_OQ ) }; }
+inline AvxLane::Mask cmpGe( AvxLane a, AvxLane b ) { return AvxLane::Mask{ _mm256_cmp_ps( a.v, b.v, _CMP_GE_OQ ) }; }
+
+inline
+AvxLane
+select(
+       AvxLane::Mask mask,
+       AvxLane       a,
+       AvxLane       b
+       )
+{
+  return AvxLane{ _mm256_blendv_ps( b.v, a.v, mask.m ) };
+}
+
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief transformRangeAvx
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+transformRangeAvx(
+                  const TransformBatch::Arrays &arrays,
+                  const std::size_t             begin,
+                  const std::size_t             end,
+                  const float                   timestep
+                  )
+{
+  transformRange< AvxLane >( arrays, begin, end, timestep );
+}
+
+
+} // namespace simd
+
+} // namespace shs
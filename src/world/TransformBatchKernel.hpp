@@ -0,0 +1,279 @@
+// TransformBatchKernel.hpp
+#pragma once
+
+#include "shared/core/TransformBatch.hpp"
+
+#include <cmath>
+
+
+namespace shs
+{
+
+namespace simd
+{
+
+//
+// everything up to the kernel entry points has internal linkage so
+// inline code compiled with AVX flags can never be picked by the
+// linker for a translation unit built without them
+//
+namespace
+{
+
+
+//
+// The kernel is written once against a "lane" type: a pack of
+// WIDTH floats with arithmetic operators plus the few helpers
+// below. Each instruction set provides its own lane in its own
+// translation unit so only that file needs the ISA flags.
+//
+// A lane type L provides
+//
+//   L::WIDTH, L::Mask
+//   L::set1, L::load, L::store
+//   L::addRevolutions( int32_t*, L turns )
+//   L::storeMatrices( float*, const L ( & )[ 16 ] )
+//   +, -, * (binary), - (unary), floor, cmpEq, cmpGe, select
+//
+
+
+constexpr float TWO_PI      = 6.28318530717958647692f;
+constexpr float INV_TWO_PI  = 0.15915494309189533577f;
+constexpr float TWO_OVER_PI = 0.63661977236758134308f;
+
+// pi / 2 split in three parts for exact range reduction
+constexpr float PIO2_1 = 1.5703125f;
+constexpr float PIO2_2 = 4.837512969970703125e-4f;
+constexpr float PIO2_3 = 7.54978995489188216e-8f;
+
+// minimax coefficients on [-pi/4, pi/4]
+constexpr float SIN_1 = -1.6666654611e-1f;
+constexpr float SIN_2 = 8.3321608736e-3f;
+constexpr float SIN_3 = -1.9515295891e-4f;
+constexpr float COS_1 = 4.166664568298827e-2f;
+constexpr float COS_2 = -1.388731625493765e-3f;
+constexpr float COS_3 = 2.443315711809948e-5f;
+
+
+
+///
+/// \brief One float at a time. Used for remainders and as the
+///        fallback on CPUs without SSE.
+///
+struct ScalarLane
+{
+  static constexpr std::size_t WIDTH = 1;
+
+  typedef bool Mask;
+
+  float v;
+
+  static ScalarLane
+  set1( const float x ) { return ScalarLane{ x }; }
+
+  static ScalarLane
+  load( const float *p ) { return ScalarLane{ *p }; }
+
+  static void
+  store(
+        float           *p,
+        const ScalarLane a
+        ) { *p = a.v; }
+
+  static void
+  addRevolutions(
+                 std::int32_t    *p,
+                 const ScalarLane turns
+                 ) { *p += static_cast< std::int32_t >( turns.v ); }
+
+  static void
+  storeMatrices(
+                float *p,
+                const ScalarLane( &m )[ 16 ]
+                )
+  {
+    for ( int k = 0; k < 16; ++k )
+    {
+      p[ k ] = m[ k ].v;
+    }
+  }
+
+};
+
+
+inline ScalarLane operator+( ScalarLane a, ScalarLane b ) { return ScalarLane{ a.v + b.v }; }
+inline ScalarLane operator-( ScalarLane a, ScalarLane b ) { return ScalarLane{ a.v - b.v }; }
+inline ScalarLane operator*( ScalarLane a, ScalarLane b ) { return ScalarLane{ a.v * b.v }; }
+inline ScalarLane operator-( ScalarLane a ) { return ScalarLane{ -a.v }; }
+
+inline ScalarLane floor( ScalarLane a ) { return ScalarLane{ std::floor( a.v ) }; }
+inline bool cmpEq( ScalarLane a, ScalarLane b ) { return a.v == b.v; }
+inline bool cmpGe( ScalarLane a, ScalarLane b ) { return a.v >= b.v; }
+
+inline ScalarLane
+select(
+       bool       mask,
+       ScalarLane a,
+       ScalarLane b
+       ) { return mask ? a : b; }
+
+
+
+///////////////////////////////////////////////////////////////
+/// \brief sincos
+///
+///        Polynomial sine and cosine (Cephes sinf/cosf),
+///        accurate to a few ulp for the [0, 2pi) angles the
+///        kernel produces.
+///
+///////////////////////////////////////////////////////////////
+template< typename L >
+inline
+void
+sincos(
+       const L x,
+       L      &s,
+       L      &c
+       )
+{
+  // nearest multiple of pi/2 and the remainder in [-pi/4, pi/4]
+  const L j = floor( x * L::set1( TWO_OVER_PI ) + L::set1( 0.5f ) );
+  const L y = ( ( x - j * L::set1( PIO2_1 ) ) - j * L::set1( PIO2_2 ) ) - j * L::set1( PIO2_3 );
+  const L z = y * y;
+
+  const L sinPoly = y + y * z * ( L::set1( SIN_1 ) + z * ( L::set1( SIN_2 ) + z * L::set1( SIN_3 ) ) );
+  const L cosPoly = L::set1( 1.0f ) - L::set1( 0.5f ) * z
+                    + z * z * ( L::set1( COS_1 ) + z * ( L::set1( COS_2 ) + z * L::set1( COS_3 ) ) );
+
+  // quadrant 0..3 picks which polynomial and sign each result uses
+  const L quadrant = j - L::set1( 4.0f ) * floor( j * L::set1( 0.25f ) );
+
+  const typename L::Mask swap   = cmpEq( quadrant - L::set1( 2.0f ) * floor( quadrant * L::set1( 0.5f ) ),
+                                         L::set1( 1.0f ) );
+  const typename L::Mask sinNeg = cmpGe( quadrant, L::set1( 2.0f ) );
+  const typename L::Mask cosNeg = cmpEq( floor( ( quadrant + L::set1( 1.0f ) ) * L::set1( 0.5f ) ),
+                                         L::set1( 1.0f ) );
+
+  const L sinValue = select( swap, cosPoly, sinPoly );
+  const L cosValue = select( swap, sinPoly, cosPoly );
+
+  s = select( sinNeg, -sinValue, sinValue );
+  c = select( cosNeg, -cosValue, cosValue );
+} // sincos
+
+
+
+///////////////////////////////////////////////////////////////
+/// \brief transformBlock
+///
+///        Updates entities [i, i + L::WIDTH).
+///
+///////////////////////////////////////////////////////////////
+template< typename L >
+inline
+void
+transformBlock(
+               const TransformBatch::Arrays &a,
+               const std::size_t             i,
+               const L                       dt
+               )
+{
+  L angle = L::load( a.pAngles + i ) + L::load( a.pRotateRates + i ) * dt;
+
+  const L turns = floor( angle * L::set1( INV_TWO_PI ) );
+  angle = angle - turns * L::set1( TWO_PI );
+
+  L::store( a.pAngles + i, angle );
+
+  if ( a.pRevolutions )
+  {
+    L::addRevolutions( a.pRevolutions + i, turns );
+  }
+
+  L s, c;
+  sincos( angle, s, c );
+
+  const L x = L::load( a.pAxisX + i );
+  const L y = L::load( a.pAxisY + i );
+  const L z = L::load( a.pAxisZ + i );
+
+  const L t  = L::set1( 1.0f ) - c;
+  const L tx = t * x;
+  const L ty = t * y;
+  const L tz = t * z;
+  const L sx = s * x;
+  const L sy = s * y;
+  const L sz = s * z;
+
+  const L zero = L::set1( 0.0f );
+
+  // translate( position ) * rotate( angle, axis ), column major
+  const L matrix[ 16 ] =
+  {
+    tx * x + c,  tx * y + sz, tx * z - sy, zero,
+    tx * y - sz, ty * y + c,  ty * z + sx, zero,
+    tx * z + sy, ty * z - sx, tz * z + c,  zero,
+    L::load( a.pPositionX + i ), L::load( a.pPositionY + i ), L::load( a.pPositionZ + i ), L::set1( 1.0f )
+  };
+
+  L::storeMatrices( a.pMatrices + 16 * i, matrix );
+} // transformBlock
+
+
+
+///////////////////////////////////////////////////////////////
+/// \brief transformRange
+///
+///        Full lanes with L, the remainder one at a time.
+///
+///////////////////////////////////////////////////////////////
+template< typename L >
+inline
+void
+transformRange(
+               const TransformBatch::Arrays &arrays,
+               const std::size_t             begin,
+               const std::size_t             end,
+               const float                   timestep
+               )
+{
+  std::size_t i = begin;
+
+  for ( const L dt = L::set1( timestep ); i + L::WIDTH <= end; i += L::WIDTH )
+  {
+    transformBlock( arrays, i, dt );
+  }
+
+  for ( const ScalarLane dt = ScalarLane::set1( timestep ); i < end; ++i )
+  {
+    transformBlock( arrays, i, dt );
+  }
+}
+
+
+
+} // namespace
+
+
+
+///
+/// \brief Kernels built with their own instruction set flags
+///
+void transformRangeSse (
+                        const TransformBatch::Arrays &arrays,
+                        const std::size_t             begin,
+                        const std::size_t             end,
+                        const float                   timestep
+                        );
+
+void transformRangeAvx (
+                        const TransformBatch::Arrays &arrays,
+                        const std::size_t             begin,
+                        const std::size_t             end,
+                        const float                   timestep
+                        );
+
+
+} // namespace simd
+
+} // namespace shs
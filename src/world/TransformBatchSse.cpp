@@ -0,0 +1,138 @@
+#include "TransformBatchKernel.hpp"
+
+#include <emmintrin.h>
+
+
+namespace shs
+{
+
+namespace simd
+{
+
+namespace
+{
+
+
+///
+/// \brief Four floats per SSE register (SSE2 only, so this
+///        runs on every x86-64 CPU)
+///
+struct SseLane
+{
+  static constexpr std::size_t WIDTH = 4;
+
+  struct Mask
+  {
+    __m128 m;
+  };
+
+  __m128 v;
+
+  static SseLane
+  set1( const float x ) { return SseLane{ _mm_set1_ps( x ) }; }
+
+  static SseLane
+  load( const float *p ) { return SseLane{ _mm_loadu_ps( p ) }; }
+
+  static void
+  store(
+        float        *p,
+        const SseLane a
+        ) { _mm_storeu_ps( p, a.v ); }
+
+  static void
+  addRevolutions(
+                 std::int32_t *p,
+                 const SseLane turns
+                 )
+  {
+    __m128i *pInts = reinterpret_cast< __m128i* >( p );
+    _mm_storeu_si128( pInts, _mm_add_epi32( _mm_loadu_si128( pInts ), _mm_cvttps_epi32( turns.v ) ) );
+  }
+
+  static void
+  storeMatrices(
+                float *p,
+                const SseLane( &m )[ 16 ]
+                )
+  {
+    //
+    // m[ 4 * column + row ] holds one element for four entities;
+    // transposing each column gives four entity columns
+    //
+    for ( int column = 0; column < 4; ++column )
+    {
+      __m128 r0 = m[ 4 * column + 0 ].v;
+      __m128 r1 = m[ 4 * column + 1 ].v;
+      __m128 r2 = m[ 4 * column + 2 ].v;
+      __m128 r3 = m[ 4 * column + 3 ].v;
+
+      _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+      _mm_storeu_ps( p + 4 * column,      r0 );
+      _mm_storeu_ps( p + 4 * column + 16, r1 );
+      _mm_storeu_ps( p + 4 * column + 32, r2 );
+      _mm_storeu_ps( p + 4 * column + 48, r3 );
+    }
+  }
+
+};
+
+
+inline SseLane operator+( SseLane a, SseLane b ) { return SseLane{ _mm_add_ps( a.v, b.v ) }; }
+inline SseLane operator-( SseLane a, SseLane b ) { return SseLane{ _mm_sub_ps( a.v, b.v ) }; }
+inline SseLane operator*( SseLane a, SseLane b ) { return SseLane{ _mm_mul_ps( a.v, b.v ) }; }
+inline SseLane operator-( SseLane a ) { return SseLane{ _mm_xor_ps( a.v, _mm_set1_ps( -0.0f ) ) }; }
+
+inline SseLane::Mask cmpEq( SseLane a, SseLane b ) { return SseLane::Mask{ _mm_cmpeq_ps( a.v, b.v ) }; }
+inline SseLane::Mask cmpGe( SseLane a, SseLane b ) { return SseLane::Mask{ _mm_cmpge_ps( a.v, b.v ) }; }
+
+///
+/// \brief floor without SSE4.1 (valid for |a| < 2^31)
+///
+inline
+SseLane
+floor( SseLane a )
+{
+  const __m128 truncated = _mm_cvtepi32_ps( _mm_cvttps_epi32( a.v ) );
+  const __m128 tooBig    = _mm_and_ps( _mm_cmpgt_ps( truncated, a.v ), _mm_set1_ps( 1.0f ) );
+
+  return SseLane{ _mm_sub_ps( truncated, tooBig ) };
+}
+
+inline
+SseLane
+select(
+       SseLane::Mask mask,
+       SseLane       a,
+       SseLane       b
+       )
+{
+  return SseLane{ _mm_or_ps( _mm_and_ps( mask.m, a.v ), _mm_andnot_ps( mask.m, b.v ) ) };
+}
+
+
+} // namespace
+
+
+
+/////////////////////////////////////////////
+/// \brief transformRangeSse
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+transformRangeSse(
+                  const TransformBatch::Arrays &arrays,
+                  const std::size_t             begin,
+                  const std::size_t             end,
+                  const float                   timestep
+                  )
+{
+  transformRange< SseLane >( arrays, begin, end, timestep );
+}
+
+
+} // namespace simd
+
+} // namespace shs
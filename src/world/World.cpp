@@ -1,5 +1,7 @@
 #include "shared/core/World.hpp"
 
+#include "shared/core/JobSystem.hpp"
+
 
 namespace shs
 {
@@ -11,6 +13,8 @@ namespace shs
 /// \author Logan Barnes
 /////////////////////////////////////////////
 World::World( )
+  : requestExit_( false )
+  , pJobSystem_ ( nullptr )
 {}
 
 
@@ -38,4 +42,28 @@ World::update(
 
 
 
+/////////////////////////////////////////////
+/// \brief World::publishState
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+void
+World::publishState( )
+{}
+
+
+
+/////////////////////////////////////////////
+/// \brief World::getJobSystem
+///
+/// \author Logan Barnes
+/////////////////////////////////////////////
+JobSystem&
+World::getJobSystem( )
+{
+  return pJobSystem_ ? *pJobSystem_ : JobSystem::getSerial( );
+}
+
+
+
 } // namespace shs
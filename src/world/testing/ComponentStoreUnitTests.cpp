@@ -0,0 +1,156 @@
+// ComponentStoreUnitTests.cpp
+#include "shared/core/ComponentStore.hpp"
+
+#include "gmock/gmock.h"
+
+#include <string>
+
+
+namespace
+{
+
+
+struct TestEntity;
+
+typedef shs::ComponentStore< TestEntity, float, int, std::string > TestStore;
+
+enum TestComponent
+{
+  VALUE,
+  COUNT,
+  NAME
+};
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief DeadHandlesStayDead
+/////////////////////////////////////////////////////////////////
+TEST( HandleUnitTests, DeadHandlesStayDead )
+{
+  shs::HandleAllocator< TestEntity > allocator;
+
+  EXPECT_FALSE( shs::Handle< TestEntity >( ).isValid( ) );
+  EXPECT_FALSE( allocator.isAlive( shs::Handle< TestEntity >( ) ) );
+
+  const shs::Handle< TestEntity > first = allocator.create( );
+
+  EXPECT_TRUE ( allocator.isAlive( first ) );
+  EXPECT_TRUE ( allocator.destroy( first ) );
+  EXPECT_FALSE( allocator.isAlive( first ) );
+  EXPECT_FALSE( allocator.destroy( first ) );
+
+  // slot is reused with a new generation
+  const shs::Handle< TestEntity > second = allocator.create( );
+
+  EXPECT_EQ( first.getIndex( ), second.getIndex( ) );
+  EXPECT_NE( first, second );
+  EXPECT_FALSE( allocator.isAlive( first ) );
+  EXPECT_TRUE ( allocator.isAlive( second ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief SlotsRetireWhenGenerationsWrap
+/////////////////////////////////////////////////////////////////
+TEST( HandleUnitTests, SlotsRetireWhenGenerationsWrap )
+{
+  shs::HandleAllocator< TestEntity > allocator;
+
+  const shs::Handle< TestEntity > original = allocator.create( );
+  shs::Handle< TestEntity > handle         = original;
+
+  for ( unsigned i = 0; i < shs::Handle< TestEntity >::GENERATION_MASK; ++i )
+  {
+    allocator.destroy( handle );
+    handle = allocator.create( );
+    ASSERT_EQ( original.getIndex( ), handle.getIndex( ) );
+  }
+
+  allocator.destroy( handle );
+
+  // generation would wrap back to the original's, so a fresh slot is used
+  handle = allocator.create( );
+
+  EXPECT_NE( original.getIndex( ), handle.getIndex( ) );
+  EXPECT_FALSE( allocator.isAlive( original ) );
+  EXPECT_EQ( 2u, allocator.getSlotCount( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ComponentsAreContiguousAndAligned
+/////////////////////////////////////////////////////////////////
+TEST( ComponentStoreUnitTests, ComponentsAreContiguousAndAligned )
+{
+  TestStore store;
+
+  const TestStore::HandleType a = store.create( 1.0f, 10, "a" );
+  const TestStore::HandleType b = store.create( 2.0f, 20, "b" );
+  const TestStore::HandleType c = store.create( 3.0f, 30, "c" );
+
+  EXPECT_EQ( 3u, store.size( ) );
+
+  shs::ArrayView< float > values = store.getArray< VALUE >( );
+
+  EXPECT_EQ( 0u, reinterpret_cast< std::uintptr_t >( values.data( ) ) % 64 );
+  EXPECT_EQ( 3u, values.size( ) );
+
+  float sum = 0.0f;
+
+  for ( float value : values )
+  {
+    sum += value;
+  }
+
+  EXPECT_FLOAT_EQ( 6.0f, sum );
+
+  EXPECT_EQ( 20, store.get< COUNT >( b ) );
+  EXPECT_EQ( "c", store.get< NAME >( c ) );
+
+  store.get< COUNT >( a ) = 11;
+  EXPECT_EQ( 11, store.getArray< COUNT >( )[ store.getIndex( a ) ] );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief DestroySwapsInTheLastEntity
+/////////////////////////////////////////////////////////////////
+TEST( ComponentStoreUnitTests, DestroySwapsInTheLastEntity )
+{
+  TestStore store;
+
+  const TestStore::HandleType a = store.create( 1.0f, 10, "a" );
+  const TestStore::HandleType b = store.create( 2.0f, 20, "b" );
+  const TestStore::HandleType c = store.create( 3.0f, 30, "c" );
+
+  EXPECT_TRUE( store.destroy( a ) );
+  EXPECT_FALSE( store.destroy( a ) );
+
+  EXPECT_EQ   ( 2u, store.size( ) );
+  EXPECT_FALSE( store.contains( a ) );
+  EXPECT_EQ   ( 0u, store.getIndex( c ) );
+  EXPECT_EQ   ( c, store.getHandle( 0 ) );
+  EXPECT_EQ   ( "c", store.getArray< NAME >( )[ 0 ] );
+
+  // handles stay valid after moves
+  EXPECT_EQ( 20, store.get< COUNT >( b ) );
+  EXPECT_EQ( 30, store.get< COUNT >( c ) );
+
+  EXPECT_THROW( store.get< COUNT >( a ), std::out_of_range );
+
+  // destroying the last entity
+  EXPECT_TRUE( store.destroy( b ) );
+  EXPECT_EQ  ( 1u, store.size( ) );
+  EXPECT_EQ  ( "c", store.get< NAME >( c ) );
+
+  store.clear( );
+  EXPECT_TRUE ( store.empty( ) );
+  EXPECT_FALSE( store.contains( c ) );
+}
+
+
+
+} // namespace
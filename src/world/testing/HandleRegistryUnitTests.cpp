@@ -0,0 +1,98 @@
+// HandleRegistryUnitTests.cpp
+#include "shared/core/HandleRegistry.hpp"
+
+#include "gmock/gmock.h"
+
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+
+typedef shs::HandleRegistry< std::string > TestRegistry;
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief NamesResolveToHandles
+/////////////////////////////////////////////////////////////////
+TEST( HandleRegistryUnitTests, NamesResolveToHandles )
+{
+  TestRegistry registry;
+
+  const TestRegistry::HandleType first  = registry.create( "first value", "first" );
+  const TestRegistry::HandleType second = registry.create( "second value" );
+
+  EXPECT_EQ( 2u, registry.size( ) );
+  EXPECT_EQ( first, registry.find( "first" ) );
+  EXPECT_FALSE( registry.find( "second" ).isValid( ) );
+
+  ASSERT_NE( nullptr, registry.get( first ) );
+  ASSERT_NE( nullptr, registry.get( second ) );
+  EXPECT_EQ( "first value",  *registry.get( first ) );
+  EXPECT_EQ( "second value", *registry.get( second ) );
+
+  EXPECT_THROW( registry.create( "duplicate", "first" ), std::runtime_error );
+  EXPECT_EQ( 2u, registry.size( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief DestroyedHandlesStayDead
+/////////////////////////////////////////////////////////////////
+TEST( HandleRegistryUnitTests, DestroyedHandlesStayDead )
+{
+  TestRegistry registry;
+
+  const TestRegistry::HandleType original = registry.create( "original", "name" );
+
+  EXPECT_TRUE ( registry.destroy( original ) );
+  EXPECT_FALSE( registry.destroy( original ) );
+  EXPECT_FALSE( registry.contains( original ) );
+  EXPECT_EQ( nullptr, registry.get( original ) );
+  EXPECT_FALSE( registry.find( "name" ).isValid( ) );
+
+  // the slot and name are reused but the old handle does not alias them
+  const TestRegistry::HandleType replacement = registry.create( "replacement", "name" );
+
+  EXPECT_EQ( original.getIndex( ), replacement.getIndex( ) );
+  EXPECT_EQ( replacement, registry.find( "name" ) );
+  EXPECT_EQ( nullptr, registry.get( original ) );
+  EXPECT_EQ( "replacement", *registry.get( replacement ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ForEachVisitsLiveResources
+/////////////////////////////////////////////////////////////////
+TEST( HandleRegistryUnitTests, ForEachVisitsLiveResources )
+{
+  TestRegistry registry;
+
+  std::vector< TestRegistry::HandleType > handles;
+
+  for ( int i = 0; i < 5; ++i )
+  {
+    handles.push_back( registry.create( std::to_string( i ), "item" + std::to_string( i ) ) );
+  }
+
+  registry.destroy( handles[ 1 ] );
+  registry.destroy( handles[ 3 ] );
+
+  std::vector< std::string > visited;
+  registry.forEach( [ &visited ]( std::string &value ){ visited.push_back( value ); } );
+
+  EXPECT_THAT( visited, ::testing::ElementsAre( "0", "2", "4" ) );
+
+  registry.clear( );
+
+  EXPECT_EQ( 0u, registry.size( ) );
+  EXPECT_FALSE( registry.contains( handles[ 0 ] ) );
+  EXPECT_FALSE( registry.find( "item0" ).isValid( ) );
+}
+
+
+} // namespace
@@ -0,0 +1,194 @@
+// SnapshotBufferUnitTests.cpp
+#include "shared/core/SnapshotBuffer.hpp"
+
+#include "gmock/gmock.h"
+
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+
+///
+/// \brief The TestState struct
+///
+struct TestState
+{
+  double position[ 3 ];
+  unsigned step;
+};
+
+
+///
+/// \brief blend
+///
+TestState
+blend(
+      const TestState &previous,
+      const TestState &current,
+      const double     alpha
+      )
+{
+  TestState result;
+
+  for ( int i = 0; i < 3; ++i )
+  {
+    result.position[ i ] = shs::blend( previous.position[ i ], current.position[ i ], alpha );
+  }
+
+  result.step = shs::blend( previous.step, current.step, alpha );
+
+  return result;
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ReaderOnlySeesPublishedBuffers
+/////////////////////////////////////////////////////////////////
+TEST( TripleBufferUnitTests, ReaderOnlySeesPublishedBuffers )
+{
+  shs::TripleBuffer< int > buffer( -1 );
+
+  EXPECT_FALSE( buffer.update( ) );
+  EXPECT_EQ( -1, buffer.getReadBuffer( ) );
+
+  buffer.getWriteBuffer( ) = 1;
+
+  EXPECT_FALSE( buffer.update( ) );
+  EXPECT_EQ( -1, buffer.getReadBuffer( ) );
+
+  buffer.publish( );
+
+  EXPECT_TRUE ( buffer.update( ) );
+  EXPECT_EQ   ( 1, buffer.getReadBuffer( ) );
+  EXPECT_FALSE( buffer.update( ) );
+  EXPECT_EQ   ( 1, buffer.getReadBuffer( ) );
+
+  //
+  // reader skips straight to the newest buffer
+  //
+  buffer.getWriteBuffer( ) = 2;
+  buffer.publish( );
+  buffer.getWriteBuffer( ) = 3;
+  buffer.publish( );
+
+  EXPECT_TRUE( buffer.update( ) );
+  EXPECT_EQ  ( 3, buffer.getReadBuffer( ) );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief ConcurrentReadsNeverTear
+/////////////////////////////////////////////////////////////////
+TEST( TripleBufferUnitTests, ConcurrentReadsNeverTear )
+{
+  constexpr unsigned numPublishes = 100000;
+
+  shs::TripleBuffer< TestState > buffer( TestState{ { 0.0, 0.0, 0.0 }, 0 } );
+
+  std::thread writer(
+                     [ &buffer ]
+    {
+      for ( unsigned i = 1; i <= numPublishes; ++i )
+      {
+        TestState &state = buffer.getWriteBuffer( );
+        state.position[ 0 ] = i;
+        state.position[ 1 ] = i;
+        state.position[ 2 ] = i;
+        state.step          = i;
+        buffer.publish( );
+      }
+    } );
+
+  unsigned lastStep = 0;
+  bool consistent   = true;
+
+  while ( lastStep < numPublishes && consistent )
+  {
+    buffer.update( );
+
+    const TestState &state = buffer.getReadBuffer( );
+
+    consistent = state.step >= lastStep
+                 && state.position[ 0 ] == state.step
+                 && state.position[ 1 ] == state.step
+                 && state.position[ 2 ] == state.step;
+
+    lastStep = state.step;
+  }
+
+  writer.join( );
+
+  EXPECT_TRUE( consistent );
+  EXPECT_EQ( numPublishes, lastStep );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief SnapshotKeepsPreviousState
+/////////////////////////////////////////////////////////////////
+TEST( SnapshotBufferUnitTests, SnapshotKeepsPreviousState )
+{
+  shs::SnapshotBuffer< TestState > snapshots( TestState{ { 0.0, 0.0, 0.0 }, 0 } );
+
+  snapshots.publish( TestState{ { 1.0, 2.0, 3.0 }, 1 }, 0.1 );
+  snapshots.publish( TestState{ { 3.0, 4.0, 5.0 }, 2 }, 0.2 );
+
+  const shs::Snapshot< TestState > &snapshot = snapshots.latest( );
+
+  EXPECT_DOUBLE_EQ( 0.2, snapshot.worldTime );
+  EXPECT_EQ( 1u, snapshot.previous.step );
+  EXPECT_EQ( 2u, snapshot.current.step );
+
+  const TestState halfway = snapshots.interpolate( 0.5 );
+
+  EXPECT_DOUBLE_EQ( 2.0, halfway.position[ 0 ] );
+  EXPECT_DOUBLE_EQ( 3.0, halfway.position[ 1 ] );
+  EXPECT_DOUBLE_EQ( 4.0, halfway.position[ 2 ] );
+  EXPECT_EQ( 2u, halfway.step );
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief BlendsArrays
+/////////////////////////////////////////////////////////////////
+TEST( SnapshotBufferUnitTests, BlendsArrays )
+{
+  shs::SnapshotBuffer< std::array< float, 2 > > snapshots;
+
+  snapshots.publish( { { 0.0f, 10.0f } } );
+  snapshots.publish( { { 4.0f, 20.0f } } );
+
+  const std::array< float, 2 > blended = snapshots.interpolate( 0.25 );
+
+  EXPECT_FLOAT_EQ( 1.0f,  blended[ 0 ] );
+  EXPECT_FLOAT_EQ( 12.5f, blended[ 1 ] );
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief HoldsVariableSizedState
+/////////////////////////////////////////////////////////////////
+TEST( SnapshotBufferUnitTests, HoldsVariableSizedState )
+{
+  shs::SnapshotBuffer< std::vector< int > > snapshots;
+
+  snapshots.publish( { 1, 2 } );
+  snapshots.publish( { 3, 4, 5 } );
+
+  const shs::Snapshot< std::vector< int > > &snapshot = snapshots.latest( );
+
+  EXPECT_EQ( ( std::vector< int >{ 1, 2 } ),    snapshot.previous );
+  EXPECT_EQ( ( std::vector< int >{ 3, 4, 5 } ), snapshot.current );
+}
+
+
+} // namespace
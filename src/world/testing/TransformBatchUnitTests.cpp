@@ -0,0 +1,163 @@
+// TransformBatchUnitTests.cpp
+#include "shared/core/TransformBatch.hpp"
+
+#include "gmock/gmock.h"
+
+#include <cmath>
+#include <vector>
+
+
+namespace
+{
+
+
+///
+/// \brief The TestCubes struct
+///
+struct TestCubes
+{
+  explicit
+  TestCubes( const std::size_t count )
+    : axisX( count ), axisY( count ), axisZ( count )
+    , rates( count ), angles( count ), revolutions( count, 0 )
+    , posX( count ), posY( count ), posZ( count )
+    , matrices( count * 16, -1.0f )
+  {
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+      const double x = std::sin( 0.7 * double( i ) + 0.1 );
+      const double y = std::cos( 1.3 * double( i ) );
+      const double z = 0.5 - double( i % 3 ) * 0.4;
+      const double length = std::sqrt( x * x + y * y + z * z );
+
+      axisX[ i ] = static_cast< float >( x / length );
+      axisY[ i ] = static_cast< float >( y / length );
+      axisZ[ i ] = static_cast< float >( z / length );
+
+      rates[ i ]  = static_cast< float >( double( i % 7 ) * 1.5 - 3.0 );
+      angles[ i ] = static_cast< float >( double( i ) * 0.37 );
+
+      posX[ i ] = static_cast< float >( i );
+      posY[ i ] = -static_cast< float >( i ) * 0.5f;
+      posZ[ i ] = 2.0f;
+    }
+  }
+
+  shs::TransformBatch::Arrays
+  arrays( )
+  {
+    return shs::TransformBatch::Arrays{
+      axisX.data( ), axisY.data( ), axisZ.data( ),
+      rates.data( ),
+      angles.data( ), revolutions.data( ),
+      posX.data( ), posY.data( ), posZ.data( ),
+      matrices.data( )
+    };
+  }
+
+  std::vector< float > axisX, axisY, axisZ;
+  std::vector< float > rates, angles;
+  std::vector< std::int32_t > revolutions;
+  std::vector< float > posX, posY, posZ;
+  std::vector< float > matrices;
+};
+
+
+///
+/// \brief referenceMatrix translate( p ) * rotate( angle, axis ) in double precision
+///
+std::vector< double >
+referenceMatrix(
+                const TestCubes  &cubes,
+                const std::size_t i
+                )
+{
+  const double x = cubes.axisX[ i ], y = cubes.axisY[ i ], z = cubes.axisZ[ i ];
+  const double c = std::cos( double( cubes.angles[ i ] ) );
+  const double s = std::sin( double( cubes.angles[ i ] ) );
+  const double t = 1.0 - c;
+
+  return {
+           t * x * x + c,     t * x * y + s * z, t * x * z - s * y, 0.0,
+           t * x * y - s * z, t * y * y + c,     t * y * z + s * x, 0.0,
+           t * x * z + s * y, t * y * z - s * x, t * z * z + c,     0.0,
+           cubes.posX[ i ],   cubes.posY[ i ],   cubes.posZ[ i ],   1.0
+  };
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief EveryLevelMatchesReference
+/////////////////////////////////////////////////////////////////
+TEST( TransformBatchUnitTests, EveryLevelMatchesReference )
+{
+  const shs::TransformBatch::SimdLevel levels[] =
+  {
+    shs::TransformBatch::SCALAR,
+    shs::TransformBatch::SSE,
+    shs::TransformBatch::AVX
+  };
+
+  for ( const shs::TransformBatch::SimdLevel level : levels )
+  {
+    // odd count and offset exercise the scalar remainders
+    TestCubes cubes( 37 );
+
+    shs::TransformBatch::update( cubes.arrays( ), 3, 37, 0.25, level );
+
+    for ( std::size_t i = 0; i < 37; ++i )
+    {
+      if ( i < 3 )
+      {
+        EXPECT_FLOAT_EQ( -1.0f, cubes.matrices[ i * 16 ] ) << "entity outside range was written";
+        continue;
+      }
+
+      ASSERT_GE( cubes.angles[ i ], 0.0f );
+      ASSERT_LE( cubes.angles[ i ], 6.2831855f );
+
+      const std::vector< double > expected = referenceMatrix( cubes, i );
+
+      for ( std::size_t k = 0; k < 16; ++k )
+      {
+        ASSERT_NEAR( expected[ k ], cubes.matrices[ i * 16 + k ], 2e-6 )
+          << "level " << level << " entity " << i << " element " << k;
+      }
+    }
+  }
+}
+
+
+
+/////////////////////////////////////////////////////////////////
+/// \brief AnglesWrapAndCountRevolutions
+/////////////////////////////////////////////////////////////////
+TEST( TransformBatchUnitTests, AnglesWrapAndCountRevolutions )
+{
+  TestCubes cubes( 16 );
+
+  for ( std::size_t i = 0; i < 16; ++i )
+  {
+    cubes.rates[ i ]  = 1.0f;
+    cubes.angles[ i ] = 0.0f;
+  }
+
+  //
+  // 1 rad per step for 20 steps is 3 full turns plus 1.150444 rad
+  //
+  for ( int step = 0; step < 20; ++step )
+  {
+    shs::TransformBatch::update( cubes.arrays( ), 0, 16, 1.0 );
+  }
+
+  for ( std::size_t i = 0; i < 16; ++i )
+  {
+    EXPECT_EQ  ( 3, cubes.revolutions[ i ] );
+    EXPECT_NEAR( 20.0 - 3.0 * 6.283185307179586, cubes.angles[ i ], 1e-5 );
+  }
+}
+
+
+
+} // namespace